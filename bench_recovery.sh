@@ -0,0 +1,189 @@
+#!/bin/bash
+#Crash-recovery benchmark
+#Load a sysbench dataset once, then for each run: restore the dataset, run a write
+#workload, kill -9 the server after a random delay, restart it and record the
+#recovery phases and the time-to-first-query into $RESULT_FILE (CSV)
+#
+#The server must be built with -DUNIV_TRACE_RECOVERY_TIME added to the BUILD_NAME of
+#build_mysql.sh, the phases are parsed from the RECOVERY_TIME_MS line it prints
+#Analysis is the checkpoint lookup (classic redo) or pm_ppl_analysis() (PPL)
+#Redo phase1 is the log scan and parse, redo phase2 applies the recs to the pages
+#
+#Runs of different variants are comparable when they use the same SEED, the same
+#workload options and the same list of kill delays: the delays come from SEED only
+#
+#Usage: ./bench_recovery.sh <variant> [n_runs]
+
+#install dir of the build under test, rebuild with build_mysql.sh to switch between
+#classic redo, PPL and PMEM_BUF
+MYSQL_BASE=/usr/local/mysql
+BENCH_DIR=/home/vldb/bench_recovery
+DATA_DIR=$BENCH_DIR/data
+LOAD_DIR=$BENCH_DIR/data_loaded
+PMEM_DIR=/mnt/pmem1
+SOCKET=$BENCH_DIR/mysql.sock
+RESULT_FILE=$BENCH_DIR/recovery.csv
+
+#workload
+SYSBENCH=sysbench
+N_TABLES=16
+TABLE_SIZE=1000000
+N_THREADS=32
+WORKLOAD=oltp_write_only
+#the server is killed between KILL_MIN and KILL_MAX seconds after the workload starts
+KILL_MIN=60
+KILL_MAX=300
+SEED=1234
+N_RUNS=10
+#seconds to wait for the restarted server before the run is marked failed
+RECOVERY_TIMEOUT=3600
+
+BUF_POOL_SIZE=32G
+LOG_FILE_SIZE=2G
+
+#Variants, each one is the build used and the extra server options
+case "$1" in
+	## Classic redo, build without PMEM flags
+	classic)
+		VARIANT_OPTS=""
+		;;
+	## PPL, BUILD_NAME="-DUNIV_PMEMOBJ_PART_PL -DUNIV_TRACE_RECOVERY_TIME", the line count is the number of log buckets
+	ppl256)
+		VARIANT_OPTS="--innodb_ppl_n_log_buckets=256"
+		;;
+	ppl1024)
+		VARIANT_OPTS="--innodb_ppl_n_log_buckets=1024"
+		;;
+	ppl4096)
+		VARIANT_OPTS="--innodb_ppl_n_log_buckets=4096"
+		;;
+	## PMEM_BUF, BUILD_NAME="-DUNIV_PMEMOBJ_BUF -DUNIV_PMEMOBJ_BUF_FLUSHER -DUNIV_PMEMOBJ_BUF_RECOVERY -DUNIV_TRACE_RECOVERY_TIME"
+	pmembuf)
+		VARIANT_OPTS=""
+		;;
+	## PMEM_BUF partitioned, add -DUNIV_PMEMOBJ_BUF_PARTITION to the build above
+	pmembuf_part)
+		VARIANT_OPTS=""
+		;;
+	*)
+		echo "Usage: $0 <classic|ppl256|ppl1024|ppl4096|pmembuf|pmembuf_part> [n_runs]"
+		exit 1
+		;;
+esac
+VARIANT=$1
+if [ -n "$2" ]; then
+	N_RUNS=$2
+fi
+
+MYSQLD_OPTS="--no-defaults --basedir=$MYSQL_BASE --datadir=$DATA_DIR --socket=$SOCKET \
+	--skip-networking --user=root \
+	--innodb_buffer_pool_size=$BUF_POOL_SIZE --innodb_log_file_size=$LOG_FILE_SIZE \
+	--innodb_flush_log_at_trx_commit=1 --innodb_pmem_home_dir=$PMEM_DIR $VARIANT_OPTS"
+MYSQL="$MYSQL_BASE/bin/mysql --no-defaults -uroot --socket=$SOCKET"
+SB_OPTS="--db-driver=mysql --mysql-user=root --mysql-socket=$SOCKET --mysql-db=sbtest \
+	--tables=$N_TABLES --table-size=$TABLE_SIZE --threads=$N_THREADS --rand-seed=$SEED"
+
+#time in ms since the epoch
+now_ms() {
+	date +%s%3N
+}
+
+start_server() {
+	$MYSQL_BASE/bin/mysqld $MYSQLD_OPTS > $1 2>&1 &
+	MYSQLD_PID=$!
+}
+
+#wait until a query on the dataset succeeds, return 1 on timeout or server exit
+wait_first_query() {
+	local deadline=$((SECONDS + RECOVERY_TIMEOUT))
+	while [ $SECONDS -lt $deadline ]; do
+		if $MYSQL -e "SELECT id FROM sbtest.sbtest1 LIMIT 1" > /dev/null 2>&1; then
+			return 0
+		fi
+		if ! kill -0 $MYSQLD_PID 2> /dev/null; then
+			return 1
+		fi
+		sleep 0.1
+	done
+	return 1
+}
+
+stop_server() {
+	$MYSQL_BASE/bin/mysqladmin --no-defaults -uroot --socket=$SOCKET shutdown > /dev/null 2>&1
+	wait $MYSQLD_PID 2> /dev/null
+}
+
+#the PMEM pool is part of the database state of the PMEM variants
+restore_dataset() {
+	rm -rf $DATA_DIR
+	cp -a $LOAD_DIR $DATA_DIR
+	rm -f $PMEM_DIR/pmemobjfile*
+	if ls $LOAD_DIR.pmem/pmemobjfile* > /dev/null 2>&1; then
+		cp $LOAD_DIR.pmem/pmemobjfile* $PMEM_DIR/
+	fi
+}
+
+mkdir -p $BENCH_DIR
+LOG_DIR=$BENCH_DIR/log_$VARIANT
+mkdir -p $LOG_DIR
+
+#Load once per variant, the on-disk and on-PMEM formats differ between builds
+if [ ! -f $LOAD_DIR/.loaded_$VARIANT ]; then
+	echo "LOAD: $N_TABLES tables of $TABLE_SIZE rows for $VARIANT"
+	rm -rf $DATA_DIR $LOAD_DIR $LOAD_DIR.pmem
+	rm -f $PMEM_DIR/pmemobjfile*
+	$MYSQL_BASE/bin/mysqld --no-defaults --basedir=$MYSQL_BASE --datadir=$DATA_DIR \
+		--user=root --initialize-insecure > $LOG_DIR/init.log 2>&1 || exit 1
+	start_server $LOG_DIR/load.log
+	wait_first_query
+	$MYSQL -e "CREATE DATABASE IF NOT EXISTS sbtest"
+	$SYSBENCH $WORKLOAD $SB_OPTS prepare > $LOG_DIR/prepare.log 2>&1 || exit 1
+	stop_server
+	cp -a $DATA_DIR $LOAD_DIR
+	mkdir -p $LOAD_DIR.pmem
+	cp $PMEM_DIR/pmemobjfile* $LOAD_DIR.pmem/ 2> /dev/null
+	touch $LOAD_DIR/.loaded_$VARIANT
+fi
+
+if [ ! -f $RESULT_FILE ]; then
+	echo "variant,run,seed,kill_sec,analysis_ms,redo1_ms,rseg_ms,redo2_ms,others_ms,total_ms,first_query_ms" > $RESULT_FILE
+fi
+
+#the same SEED gives the same kill delays for every variant
+RANDOM=$SEED
+for ((run = 1; run <= N_RUNS; run++)); do
+	KILL_SEC=$((KILL_MIN + RANDOM % (KILL_MAX - KILL_MIN + 1)))
+	echo "RUN $run/$N_RUNS: $VARIANT kill after $KILL_SEC s"
+
+	restore_dataset
+	start_server $LOG_DIR/run${run}_workload.log
+	wait_first_query || { echo "ERROR: server did not start, see $LOG_DIR"; exit 1; }
+
+	$SYSBENCH $WORKLOAD $SB_OPTS --time=$((KILL_SEC + 60)) --report-interval=10 run \
+		> $LOG_DIR/run${run}_sysbench.log 2>&1 &
+	SB_PID=$!
+	sleep $KILL_SEC
+	kill -9 $MYSQLD_PID
+	wait $MYSQLD_PID 2> /dev/null
+	kill $SB_PID 2> /dev/null
+	wait $SB_PID 2> /dev/null
+
+	RECV_LOG=$LOG_DIR/run${run}_recovery.log
+	T_START=$(now_ms)
+	start_server $RECV_LOG
+	if wait_first_query; then
+		FIRST_QUERY=$(($(now_ms) - T_START))
+	else
+		FIRST_QUERY=-1
+	fi
+	stop_server
+
+	PHASES=$(grep "^RECOVERY_TIME_MS" $RECV_LOG | tail -1 | \
+		sed 's/RECOVERY_TIME_MS //; s/[a-z0-9]*=//g; s/ /,/g')
+	if [ -z "$PHASES" ]; then
+		echo "WARN: no RECOVERY_TIME_MS line in $RECV_LOG, is the build traced?"
+		PHASES="-1,-1,-1,-1,-1,-1"
+	fi
+
+	echo "$VARIANT,$run,$SEED,$KILL_SEC,$PHASES,$FIRST_QUERY" | tee -a $RESULT_FILE
+done
@@ -13,6 +13,24 @@ IS_DEBUG=0
 #BUILD_NAME="-DUNIV_NVM_LOG -DUNIV_PMEMOBJ_WAL -DUNIV_TRACE_FLUSH_TIME"
 BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME" #benchmark
 #BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PART_PL_DEBUG -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_FLUSH_TIME"
+## PPL with compact log rec encoding (page index per logbuf, delta LSN)
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_COMPACT -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with a crc32 per log rec in the logbufs, cur_off is not persisted at each write
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_CHECKSUM -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with per-CPU magazines of free log bufs in DRAM instead of the persistent free list
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_MAGAZINE -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL hybrid: system/undo tablespaces on the classic redo log, user tablespaces on PPL
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_HYBRID -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with the cross-line sorted read scheduler in recovery
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_RECV_SCHED -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with the background reclaimer of log blocks and log bufs
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_RECLAIMER -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with the page cleaner flushing the pages of log-pressured lines first
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_PRESSURE_FLUSH -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with the log bufs, lines and log workers placed per NUMA node
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_PPL_NUMA -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
+## PPL with per-transaction log blocks, selected by innodb_ppl_log_mode=1
+#BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_LOG -DUNIV_PMEMOBJ_PART_PL -DUNIV_PMEMOBJ_USE_TT -DUNIV_PMEMOBJ_TX_LOG -DUNIV_PMEMOBJ_PL -DUNIV_TRACE_RECOVERY_TIME"
 #######################################
 
 ##### Simulate latency PL-NVM######################
@@ -120,11 +138,37 @@ BUILD_NAME="-DUNIV_PMEMOBJ_PERSIST -DUNIV_PMEMOBJ_PPL_STAT -DUNIV_PMEMOBJ_PAGE_L
 
 #BUILD_NAME=-DUNIV_NVM_LOG
 #BUILD_NAME=-DUNIV_PMEMOBJ_LOG
+## Classic redo with the log buffer on NVM, commit is durable after memcpy + fence, a spill thread writes ib_logfile in background
+#BUILD_NAME="-DUNIV_PMEMOBJ_LOG -DUNIV_PMEMOBJ_LOG_SPILL -DUNIV_TRACE_FLUSH_TIME"
 #BUILD_NAME="-DUNIV_NVM_LOG -DUNIV_PMEMOBJ_LOG"
 
 ## WAL is the new log optimization that integrate log buffer and log file into one place in NVM
 #BUILD_NAME="-DUNIV_PMEMOBJ_DBW -DUNIV_TRACE_FLUSH_TIME"
 #BUILD_NAME="-DUNIV_PMEMOBJ_WAL -DUNIV_TRACE_FLUSH_TIME"
+## DBW partitioned per page cleaner, page images persisted on PMEM slots without disk write
+#BUILD_NAME="-DUNIV_PMEMOBJ_DBW -DUNIV_PMEMOBJ_DBW_PARTITION -DUNIV_TRACE_FLUSH_TIME"
+## Undo records appended without redo log, the undo page image is persisted on a PMEM slot at mtr commit
+#BUILD_NAME="-DUNIV_PMEMOBJ_DBW -DUNIV_PMEMOBJ_UNDO -DUNIV_TRACE_FLUSH_TIME"
+## Buffer pool dump mirrors the clean hot pages on PMEM, the load at startup copies them instead of reading the datafiles
+#BUILD_NAME="-DUNIV_PMEMOBJ_DBW -DUNIV_PMEMOBJ_BUF_WARM -DUNIV_TRACE_FLUSH_TIME"
+## Clean pages evicted from the buffer pool are kept in a PMEM victim cache, a read miss copies them back instead of reading the datafiles
+#BUILD_NAME="-DUNIV_PMEMOBJ_DBW -DUNIV_PMEMOBJ_BUF_VCACHE -DUNIV_TRACE_FLUSH_TIME"
+## lock_sys split in shards by page and table, only waits, deadlock checks and page reorganizations latch all shards
+#BUILD_NAME="-DUNIV_LOCK_SYS_SHARDED"
+## Read views are a commit sequence number instead of a copy of the active trx ids
+#BUILD_NAME="-DUNIV_MVCC_CSN"
+## mtr commit claims its redo lsn range under log_sys->mutex and copies the records into the log buffer after releasing it, classic redo only
+#BUILD_NAME="-DUNIV_LOG_CONCURRENT_COPY"
+## Linux native AIO on io_uring instead of libaio (liburing and Linux >= 5.11), not with UNIV_PMEMOBJ_BUF that calls io_submit() itself
+#BUILD_NAME="-DUNIV_IO_URING"
+## ALTER TABLE ... ADD INDEX scans the clustered index by key ranges in parallel and sorts and bulk loads the non-unique indexes concurrently
+#BUILD_NAME="-DUNIV_PARALLEL_INDEX_BUILD"
+## COUNT(*) and CHECK TABLE read the clustered index by key ranges in parallel threads sharing the read view
+#BUILD_NAME="-DUNIV_PARALLEL_READ"
+## table and full index scans get batches of rows from the InnoDB fetch cache, which grows from 8 to 256 rows
+#BUILD_NAME="-DUNIV_BATCHED_FETCH"
+## adaptive hash index lookups read the hash chains without the search latch, removed nodes are reused after two epochs
+#BUILD_NAME="-DUNIV_AHI_EPOCH"
 
 ##the stable version: use free pool, no flusher
 #BUILD_NAME=-DUNIV_PMEMOBJ_BUF
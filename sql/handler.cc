@@ -2955,6 +2955,46 @@ int handler::ha_rnd_next(uchar *buf)
 }
 
 
+/**
+  Read the next rows of a random scan in one call.
+
+  @param[out] buf       Buffer for max_rows records, the record i is at
+                        buf + i * table->s->rec_buff_length
+  @param      max_rows  Maximum number of rows to read
+  @param[out] n_rows    Number of rows read
+
+  @return Operation status
+    @retval 0     Success, at least one row was read
+    @retval != 0  Error (error code returned)
+*/
+
+int handler::ha_rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+{
+  int result;
+  DBUG_ENTER("handler::ha_rnd_next_batch");
+  DBUG_ASSERT(table_share->tmp_table != NO_TMP_TABLE ||
+              m_lock_type != F_UNLCK);
+  DBUG_ASSERT(inited == RND);
+  DBUG_ASSERT(max_rows > 0);
+
+  // Set status for the need to update generated fields
+  m_update_generated_read_fields= table->has_gcol();
+
+  *n_rows= 0;
+  MYSQL_TABLE_IO_WAIT(PSI_TABLE_FETCH_ROW, MAX_KEY, result,
+    { result= rnd_next_batch(buf, max_rows, n_rows); })
+  DBUG_ASSERT(result || (*n_rows > 0 && *n_rows <= max_rows));
+  if (!result && m_update_generated_read_fields)
+  {
+    for (uint i= 0; i < *n_rows && !result; i++)
+      result= update_generated_read_fields(
+        buf + i * table_share->rec_buff_length, table);
+    m_update_generated_read_fields= false;
+  }
+  DBUG_RETURN(result);
+}
+
+
 /**
   Read row via random scan from position.
 
@@ -3125,6 +3165,48 @@ int handler::ha_index_next(uchar * buf)
 }
 
 
+/**
+  Reads the next rows via index in one call.
+
+  @param[out] buf       Buffer for max_rows records, the record i is at
+                        buf + i * table->s->rec_buff_length
+  @param      max_rows  Maximum number of rows to read
+  @param[out] n_rows    Number of rows read
+
+  @return Operation status.
+    @retval  0                   Success, at least one row was read
+    @retval  HA_ERR_END_OF_FILE  Row not found
+    @retval  != 0                Error
+*/
+
+int handler::ha_index_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+{
+  int result;
+  DBUG_ENTER("handler::ha_index_next_batch");
+  DBUG_ASSERT(table_share->tmp_table != NO_TMP_TABLE ||
+              m_lock_type != F_UNLCK);
+  DBUG_ASSERT(inited == INDEX);
+  DBUG_ASSERT(!pushed_idx_cond);
+  DBUG_ASSERT(max_rows > 0);
+
+  // Set status for the need to update generated fields
+  m_update_generated_read_fields= table->has_gcol();
+
+  *n_rows= 0;
+  MYSQL_TABLE_IO_WAIT(PSI_TABLE_FETCH_ROW, active_index, result,
+    { result= index_next_batch(buf, max_rows, n_rows); })
+  DBUG_ASSERT(result || (*n_rows > 0 && *n_rows <= max_rows));
+  if (!result && m_update_generated_read_fields)
+  {
+    for (uint i= 0; i < *n_rows && !result; i++)
+      result= update_generated_read_fields(
+        buf + i * table_share->rec_buff_length, table, active_index);
+    m_update_generated_read_fields= false;
+  }
+  DBUG_RETURN(result);
+}
+
+
 /**
   Reads the previous row via index.
 
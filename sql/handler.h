@@ -294,6 +294,14 @@ enum enum_alter_inplace_result {
 */
 #define HA_CAN_INDEX_VIRTUAL_GENERATED_COLUMN (1LL << 47)
 
+/**
+  Handler can return several rows from one call of ha_rnd_next_batch()
+  and ha_index_next_batch(). The rows are the ones rnd_next() and
+  index_next() would return, and position() works on any of them once it
+  is copied to record[0].
+*/
+#define HA_READ_BATCH                   (1LL << 48)
+
 /* bits in index_flags(index_number) for what you can do with index */
 #define HA_READ_NEXT            1       /* TODO really use this flag */
 #define HA_READ_PREV            2       /* supports ::index_prev */
@@ -2376,6 +2384,8 @@ public:
   int ha_index_first(uchar * buf);
   int ha_index_last(uchar * buf);
   int ha_index_next_same(uchar *buf, const uchar *key, uint keylen);
+  int ha_rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows);
+  int ha_index_next_batch(uchar *buf, uint max_rows, uint *n_rows);
   int ha_reset();
   /* this is necessary in many places, e.g. in HANDLER command */
   int ha_index_or_rnd_end()
@@ -2806,6 +2816,21 @@ protected:
    { return  HA_ERR_WRONG_COMMAND; }
   /// @returns @see index_read_map().
   virtual int index_next_same(uchar *buf, const uchar *key, uint keylen);
+  /**
+     @brief
+     Reads the next rows of the index into consecutive records of buf,
+     the record i is at buf + i * table->s->rec_buff_length. At least one
+     row is read when the call succeeds. The default reads one row.
+     @param      buf       Buffer for max_rows records
+     @param      max_rows  Maximum number of rows to read
+     @param[out] n_rows    Number of rows read
+     @returns @see index_read_map().
+  */
+  virtual int index_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+  {
+    *n_rows= 1;
+    return index_next(buf);
+  }
   /**
      @brief
      The following functions works like index_read, but it find the last
@@ -2850,6 +2875,16 @@ public:
 protected:
   /// @returns @see index_read_map().
   virtual int rnd_next(uchar *buf)=0;
+  /**
+     @brief
+     Reads the next rows of a table scan, see index_next_batch().
+     @returns @see index_read_map().
+  */
+  virtual int rnd_next_batch(uchar *buf, uint max_rows, uint *n_rows)
+  {
+    *n_rows= 1;
+    return rnd_next(buf);
+  }
   /// @returns @see index_read_map().
   virtual int rnd_pos(uchar * buf, uchar *pos)=0;
 public:
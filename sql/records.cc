@@ -26,6 +26,8 @@
 #include "sql_class.h"                          // THD
 #include "sql_select.h"          // JOIN_TAB
 
+#include <algorithm>
+
 
 static int rr_quick(READ_RECORD *info);
 int rr_sequential(READ_RECORD *info);
@@ -40,6 +42,10 @@ static int rr_index_last(READ_RECORD *info);
 static int rr_index(READ_RECORD *info);
 static int rr_index_desc(READ_RECORD *info);
 
+/** Rows and bytes of the buffer of a batched read */
+static const uint READ_BATCH_MAX_ROWS= 64;
+static const uint READ_BATCH_MAX_BYTES= 128 * 1024;
+
 
 /**
   Initialize READ_RECORD structure to perform full index scan in desired 
@@ -313,6 +319,7 @@ bool init_read_record(READ_RECORD *info,THD *thd,
     info->read_record=rr_sequential;
     if ((error= table->file->ha_rnd_init(1)))
       goto err;
+    init_read_batch(info);
     /* We can use record cache if we don't update dynamic length tables */
     if (!table->no_cache &&
 	(use_record_cache > 0 ||
@@ -504,10 +511,99 @@ static int rr_index_desc(READ_RECORD *info)
 }
 
 
+/**
+  Read several rows per handler call for a scan, see ha_rnd_next_batch().
+
+  The rows are copied to info->record one by one by read_batch_next().
+  Only reads without write locks use batches, the rows must not have BLOBs
+  kept in handler memory and a pushed index condition needs the rows in
+  record[0]. The handler sets HA_READ_BATCH only if the batches are the
+  rows its own cursor would return one by one.
+
+  @param info  READ_RECORD of a table scan or a full index scan
+*/
+
+void init_read_batch(READ_RECORD *info)
+{
+  TABLE *const table= info->table;
+  handler *const file= table->file;
+
+  info->batch_n= info->batch_pos= 0;
+  info->batch_max= 0;
+
+  /* Compare with the row by row reads in the tests */
+  DBUG_EXECUTE_IF("read_batch_off", return;);
+
+  if (!(file->ha_table_flags() & HA_READ_BATCH) ||
+      info->record != table->record[0] ||
+      table->reginfo.lock_type > TL_READ_NO_INSERT ||
+      table->s->blob_fields ||
+      file->pushed_idx_cond)
+    return;
+
+  const uint stride= table->s->rec_buff_length;
+  const uint n_rows= std::min(READ_BATCH_MAX_ROWS,
+                              READ_BATCH_MAX_BYTES / stride);
+  if (n_rows < 2)
+    return;
+
+  /* The buffer lives as long as the TABLE, the scan can restart often */
+  if (!table->read_batch_buf)
+  {
+    if (!(table->read_batch_buf=
+          (uchar*) alloc_root(&table->mem_root, n_rows * stride)))
+      return;
+    for (uint i= 0; i < n_rows; i++)
+      memcpy(table->read_batch_buf + i * stride, table->s->default_values,
+             table->s->reclength);
+  }
+  info->batch_buf= table->read_batch_buf;
+  info->batch_max= n_rows;
+}
+
+
+/**
+  Copy the next row of the batch to info->record, read a new batch when
+  all the rows were copied.
+
+  @param info   READ_RECORD set up by init_read_batch()
+  @param index  true for a full index scan, false for a table scan
+
+  @return 0 or the error of the handler
+*/
+
+int read_batch_next(READ_RECORD *info, bool index)
+{
+  TABLE *const table= info->table;
+
+  if (info->batch_pos == info->batch_n)
+  {
+    uint n_rows;
+    int error= index ?
+      table->file->ha_index_next_batch(info->batch_buf, info->batch_max,
+                                       &n_rows) :
+      table->file->ha_rnd_next_batch(info->batch_buf, info->batch_max,
+                                     &n_rows);
+    info->batch_n= info->batch_pos= 0;
+    if (error)
+      return error;
+    info->batch_n= n_rows;
+  }
+
+  memcpy(info->record,
+         info->batch_buf + info->batch_pos * table->s->rec_buff_length,
+         table->s->reclength);
+  info->batch_pos++;
+  return 0;
+}
+
+
 int rr_sequential(READ_RECORD *info)
 {
   int tmp;
-  while ((tmp=info->table->file->ha_rnd_next(info->record)))
+  while ((tmp= info->batch_max ?
+          read_batch_next(info, false) :
+          info->table->file->ha_rnd_next(info->record)))
   {
     /*
       ha_rnd_next can return RECORD_DELETED for MyISAM when one thread is
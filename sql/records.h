@@ -70,6 +70,14 @@ struct READ_RECORD
   struct st_io_cache *io_cache;
   bool print_error, ignore_not_found_rows;
 
+  /**
+    Rows read by ha_rnd_next_batch() or ha_index_next_batch(), batch_pos
+    is the next one to copy to record. batch_max is 0 when the rows are
+    read one by one.
+  */
+  uchar *batch_buf;
+  uint batch_max, batch_n, batch_pos;
+
 public:
   READ_RECORD() {}
 };
@@ -82,6 +90,8 @@ bool init_read_record_idx(READ_RECORD *info, THD *thd, TABLE *table,
                           bool print_error, uint idx, bool reverse);
 void end_read_record(READ_RECORD *info);
 
+void init_read_batch(READ_RECORD *info);
+int read_batch_next(READ_RECORD *info, bool index);
 void rr_unlock_row(QEP_TAB *tab);
 int rr_sequential(READ_RECORD *info);
 
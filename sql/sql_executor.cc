@@ -2433,6 +2433,7 @@ int read_first_record_seq(QEP_TAB *tab)
 {
   if (tab->read_record.table->file->ha_rnd_init(1))
     return 1;
+  init_read_batch(&tab->read_record);
   return (*tab->read_record.read_record)(&tab->read_record);
 }
 
@@ -2633,6 +2634,7 @@ join_read_first(QEP_TAB *tab)
     (void) report_handler_error(table, error);
     return 1;
   }
+  init_read_batch(&tab->read_record);
   if ((error= table->file->ha_index_first(tab->table()->record[0])))
   {
     if (error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
@@ -2647,7 +2649,9 @@ static int
 join_read_next(READ_RECORD *info)
 {
   int error;
-  if ((error= info->table->file->ha_index_next(info->record)))
+  if ((error= info->batch_max ?
+       read_batch_next(info, true) :
+       info->table->file->ha_index_next(info->record)))
     return report_handler_error(info->table, error);
   return 0;
 }
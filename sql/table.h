@@ -1017,6 +1017,7 @@ public:
   uchar *write_row_record;		/* Used as optimisation in
 					   THD::write_row */
   uchar *insert_values;                  /* used by INSERT ... UPDATE */
+  uchar *read_batch_buf;                 /* rows of a batched read */
   /* 
     Map of keys that can be used to retrieve all data from this table 
     needed by the query without reading the row.
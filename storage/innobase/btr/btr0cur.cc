@@ -3000,6 +3000,14 @@ btr_cur_ins_lock_and_undo(
 		return(err);
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The PPL log records of the insert depend on its undo log
+	record in log_sys, see trx_undo_report_row_operation() */
+	if (!(flags & BTR_NO_UNDO_LOG_FLAG)) {
+		mtr->add_hybrid_dep(thr_get_trx(thr)->hybrid_classic_lsn);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/* Now we can fill in the roll ptr field in entry
 	(except if table is intrinsic) */
 
@@ -3560,10 +3568,25 @@ btr_cur_upd_lock_and_undo(
 
 	/* Append the info about the update in the undo log */
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	err = trx_undo_report_row_operation(
+		flags, TRX_UNDO_MODIFY_OP, thr,
+		index, NULL, update,
+		cmpl_info, rec, offsets, roll_ptr);
+
+	/* The PPL log records of the update depend on its undo log
+	record in log_sys, see trx_undo_report_row_operation() */
+	if (err == DB_SUCCESS && !(flags & BTR_NO_UNDO_LOG_FLAG)) {
+		mtr->add_hybrid_dep(thr_get_trx(thr)->hybrid_classic_lsn);
+	}
+
+	return(err);
+#else
 	return(trx_undo_report_row_operation(
 		       flags, TRX_UNDO_MODIFY_OP, thr,
 		       index, NULL, update,
 		       cmpl_info, rec, offsets, roll_ptr));
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 }
 
 /***********************************************************//**
@@ -4863,6 +4886,14 @@ btr_cur_del_mark_set_clust_rec(
 		return(err);
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The PPL log records of the delete-mark depend on its undo log
+	record in log_sys, see trx_undo_report_row_operation() */
+	if (!(flags & BTR_NO_UNDO_LOG_FLAG)) {
+		mtr->add_hybrid_dep(thr_get_trx(thr)->hybrid_classic_lsn);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/* The search latch is not needed here, because
 	the adaptive hash index does not depend on the delete-mark
 	and the delete-mark is being updated in place. */
@@ -79,6 +79,56 @@ byte		btr_sea_pad2[64];
 /** The adaptive hash index */
 btr_search_sys_t*	btr_search_sys;
 
+#if defined (UNIV_AHI_EPOCH)
+/** Epoch of the adaptive hash index */
+ulint			btr_search_epoch;
+
+/** padding to keep the reader slots off the cache line of
+btr_search_epoch, which the readers only read */
+byte			btr_sea_pad3[CACHE_LINE_SIZE];
+
+/** Reader slots of the adaptive hash index epochs */
+btr_search_epoch_slot_t	btr_search_epoch_slots[BTR_SEARCH_EPOCH_SLOTS];
+
+/** Advance the epoch if no reader is left in the previous one.
+@return current epoch */
+ulint
+btr_search_epoch_try_advance()
+{
+	ulint	epoch = btr_search_epoch;
+	ulint	parity = (epoch + 1) & 1;
+
+	os_rmb;
+
+	for (ulint i = 0; i < BTR_SEARCH_EPOCH_SLOTS; ++i) {
+		if (btr_search_epoch_slots[i].n_readers[parity] != 0) {
+			return(epoch);
+		}
+	}
+
+	/* The readers entering now see epoch, or retry when the
+	epoch has changed under them */
+	if (os_compare_and_swap_ulint(&btr_search_epoch, epoch, epoch + 1)) {
+		return(epoch + 1);
+	}
+
+	return(btr_search_epoch);
+}
+
+/** Wait until the readers that are in an epoch now have exited it. */
+void
+btr_search_epoch_wait()
+{
+	/* The full barrier orders the caller's stores before the read
+	of the epoch and of the reader slots */
+	ulint	epoch = os_atomic_increment_ulint(&btr_search_epoch, 0);
+
+	while (btr_search_epoch_try_advance() < epoch + 2) {
+		os_thread_yield();
+	}
+}
+#endif /* UNIV_AHI_EPOCH */
+
 /** If the number of records on the page divided by this parameter
 would have been successfully accessed using a hash index, the index
 is then built on the page, assuming the global limit has been reached */
@@ -347,6 +397,12 @@ btr_search_disable(
 		mutex_exit(&dict_sys->mutex);
 	}
 
+#if defined (UNIV_AHI_EPOCH)
+	/* The lock-free searches that saw btr_search_enabled must be
+	gone before the nodes and the blocks are cleared */
+	btr_search_epoch_wait();
+#endif /* UNIV_AHI_EPOCH */
+
 	/* Set all block->index = NULL. */
 	buf_pool_clear_hash_index();
 
@@ -354,6 +410,9 @@ btr_search_disable(
 	for (ulint i = 0; i < btr_ahi_parts; ++i) {
 		hash_table_clear(btr_search_sys->hash_tables[i]);
 		mem_heap_empty(btr_search_sys->hash_tables[i]->heap);
+#if defined (UNIV_AHI_EPOCH)
+		ha_forget_retired(btr_search_sys->hash_tables[i]);
+#endif /* UNIV_AHI_EPOCH */
 	}
 
 	btr_search_x_unlock_all();
@@ -916,6 +975,73 @@ btr_search_failure(btr_search_t* info, btr_cur_t* cursor)
 	info->last_hash_succ = FALSE;
 }
 
+#if defined (UNIV_AHI_EPOCH)
+/** Look up a record in the adaptive hash index without the search latch,
+and latch its page. The node found may be removed meanwhile, the page is
+used only if the node is still in the hash table after the modify clock
+of the block is read, and the clock is the same once the page is latched.
+@param[in]	index		index
+@param[in]	fold		fold of the searched tuple
+@param[in]	latch_mode	BTR_SEARCH_LEAF or BTR_MODIFY_LEAF
+@param[out]	block		latched block of the record
+@param[in,out]	mtr		mini transaction
+@return record, or NULL if not found or not valid */
+static
+const rec_t*
+btr_search_guess_lock_free(
+	const dict_index_t*	index,
+	ulint			fold,
+	ulint			latch_mode,
+	buf_block_t**		block,
+	mtr_t*			mtr)
+{
+	ulint		token = btr_search_epoch_enter();
+
+	if (!btr_search_enabled) {
+		btr_search_epoch_exit(token);
+		return(NULL);
+	}
+
+	/* The table is freed by btr_search_sys_resize() only after
+	btr_search_disable() has waited for this epoch */
+	hash_table_t*	table = btr_get_search_table(index);
+
+	const rec_t*	rec = ha_search_and_get_data_lock_free(table, fold);
+
+	if (rec == NULL) {
+		btr_search_epoch_exit(token);
+		return(NULL);
+	}
+
+	*block = buf_block_from_ahi(rec);
+
+	ib_uint64_t	modify_clock = (*block)->modify_clock;
+
+	os_rmb;
+
+	if (ha_search_and_get_data_lock_free(table, fold) != rec
+	    || !buf_page_get_known_nowait(
+		    latch_mode, *block, BUF_MAKE_YOUNG_LOCK_FREE,
+		    __FILE__, __LINE__, mtr)) {
+
+		btr_search_epoch_exit(token);
+		return(NULL);
+	}
+
+	btr_search_epoch_exit(token);
+
+	if (buf_block_get_modify_clock(*block) != modify_clock) {
+
+		btr_leaf_page_release(*block, latch_mode, mtr);
+		return(NULL);
+	}
+
+	buf_block_dbg_add_level(*block, SYNC_TREE_NODE_FROM_HASH);
+
+	return(rec);
+}
+#endif /* UNIV_AHI_EPOCH */
+
 /** Tries to guess the right search position based on the hash search info
 of the index. Note that if mode is PAGE_CUR_LE, which is used in inserts,
 and the function returns TRUE, then cursor->up_match and cursor->low_match
@@ -935,6 +1061,7 @@ both have sensible values.
 				search system: RW_S/X_LATCH or 0
 @param[in]	mtr		mini transaction
 @return TRUE if succeeded */
+
 ibool
 btr_search_guess_on_hash(
 	dict_index_t*	index,
@@ -947,6 +1074,7 @@ btr_search_guess_on_hash(
 	mtr_t*		mtr)
 {
 	const rec_t*	rec;
+	buf_block_t*	block;
 	ulint		fold;
 	index_id_t	index_id;
 #ifdef notdefined
@@ -992,6 +1120,21 @@ btr_search_guess_on_hash(
 	cursor->fold = fold;
 	cursor->flag = BTR_CUR_HASH;
 
+#if defined (UNIV_AHI_EPOCH)
+	if (!has_search_latch) {
+		rec = btr_search_guess_lock_free(
+			index, fold, latch_mode, &block, mtr);
+
+		if (rec == NULL) {
+			btr_search_failure(info, cursor);
+
+			return(FALSE);
+		}
+
+		goto page_latched;
+	}
+#endif /* UNIV_AHI_EPOCH */
+
 	if (!has_search_latch) {
 		btr_search_s_lock(index);
 
@@ -1021,7 +1164,7 @@ btr_search_guess_on_hash(
 		return(FALSE);
 	}
 
-	buf_block_t*	block = buf_block_from_ahi(rec);
+	block = buf_block_from_ahi(rec);
 
 	if (!has_search_latch) {
 
@@ -1043,6 +1186,9 @@ btr_search_guess_on_hash(
 		buf_block_dbg_add_level(block, SYNC_TREE_NODE_FROM_HASH);
 	}
 
+#if defined (UNIV_AHI_EPOCH)
+page_latched:
+#endif /* UNIV_AHI_EPOCH */
 	if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE) {
 
 		ut_ad(buf_block_get_state(block) == BUF_BLOCK_REMOVE_HASH);
@@ -1326,6 +1472,13 @@ next_rec:
 			folds[i], page);
 	}
 
+#if defined (UNIV_AHI_EPOCH)
+	/* A lock-free search that found a node of this page before it
+	was removed fails on the modify clock. The page may only be
+	s-latched here, so the clock is incremented atomically. */
+	os_atomic_increment_uint64(&block->modify_clock, 1);
+#endif /* UNIV_AHI_EPOCH */
+
 	info = btr_search_get_info(block->index);
 	ut_a(info->ref_count > 0);
 	info->ref_count--;
@@ -450,6 +450,49 @@ buf_pool_get_oldest_modification(void)
 	return(oldest_lsn);
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Gets the smallest oldest_modification lsn of the pages logged in
+log_sys (system and undo tablespaces). The flush lists also hold the pages
+of the user tablespaces, whose oldest_modification is a PPL time, so the
+log_sys pages are read from buf_pool->classic_flush_list.
+@return oldest log_sys modification in pool, zero if none */
+lsn_t
+buf_pool_get_oldest_classic_modification(void)
+{
+	lsn_t		oldest_lsn = 0;
+
+	log_flush_order_mutex_enter();
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool;
+
+		buf_pool = buf_pool_from_array(i);
+
+		buf_flush_list_mutex_enter(buf_pool);
+
+		buf_page_t*	bpage;
+
+		bpage = UT_LIST_GET_LAST(buf_pool->classic_flush_list);
+
+		if (bpage != NULL) {
+			ut_ad(bpage->in_flush_list);
+			ut_ad(is_system_or_undo_tablespace(bpage->id.space()));
+
+			if (!oldest_lsn
+			    || oldest_lsn > bpage->oldest_modification) {
+				oldest_lsn = bpage->oldest_modification;
+			}
+		}
+
+		buf_flush_list_mutex_exit(buf_pool);
+	}
+
+	log_flush_order_mutex_exit();
+
+	return(oldest_lsn);
+}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 /********************************************************************//**
 Get total buffer pool statistics. */
 void
@@ -1755,6 +1798,10 @@ buf_pool_init_instance(
 		UT_LIST_INIT(buf_pool->withdraw, &buf_page_t::list);
 		buf_pool->withdraw_target = 0;
 		UT_LIST_INIT(buf_pool->flush_list, &buf_page_t::list);
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		UT_LIST_INIT(buf_pool->classic_flush_list,
+			     &buf_page_t::classic_list);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 		UT_LIST_INIT(buf_pool->unzip_LRU, &buf_block_t::unzip_LRU);
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
@@ -1928,6 +1975,43 @@ buf_pool_free_instance(
 	buf_pool->allocator.~ut_allocator();
 }
 
+#if defined (UNIV_IO_URING)
+/** Register the chunks of all buffer pool instances as the fixed buffers
+of the io_urings of the page i/o arrays. */
+static
+void
+buf_pool_register_io_buffers()
+{
+	ulint	n_chunks = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		n_chunks += buf_pool_from_array(i)->n_chunks;
+	}
+
+	byte**	bufs = static_cast<byte**>(
+		ut_malloc_nokey(n_chunks * sizeof(*bufs)));
+	ulint*	lens = static_cast<ulint*>(
+		ut_malloc_nokey(n_chunks * sizeof(*lens)));
+	ulint	n = 0;
+
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*	buf_pool = buf_pool_from_array(i);
+		buf_chunk_t*	chunk = buf_pool->chunks;
+
+		for (ulint j = 0; j < buf_pool->n_chunks; j++, chunk++) {
+			bufs[n] = chunk->mem;
+			lens[n] = chunk->mem_size();
+			n++;
+		}
+	}
+
+	os_aio_uring_register_buffers(bufs, lens, n);
+
+	ut_free(lens);
+	ut_free(bufs);
+}
+#endif /* UNIV_IO_URING */
+
 /********************************************************************//**
 Creates the buffer pool.
 @return DB_SUCCESS if success, DB_ERROR if not enough memory or error */
@@ -1974,6 +2058,10 @@ buf_pool_init(
 
 	btr_search_sys_create(buf_pool_get_curr_size() / sizeof(void*) / 64);
 
+#if defined (UNIV_IO_URING)
+	buf_pool_register_io_buffers();
+#endif /* UNIV_IO_URING */
+
 	return(DB_SUCCESS);
 }
 
@@ -2551,6 +2639,12 @@ buf_pool_resize()
 	ut_ad(!buf_pool_withdrawing);
 	ut_ad(srv_buf_pool_chunk_unit > 0);
 
+#if defined (UNIV_IO_URING)
+	/* The chunks are freed or moved, stop using them as fixed
+	buffers until the resize is completed */
+	os_aio_uring_unregister_buffers();
+#endif /* UNIV_IO_URING */
+
 	new_instance_size = srv_buf_pool_size / srv_buf_pool_instances;
 	new_instance_size /= UNIV_PAGE_SIZE;
 
@@ -2986,6 +3080,10 @@ calc_buf_pool_size:
 		ib::info() << "Re-enabled adaptive hash index.";
 	}
 
+#if defined (UNIV_IO_URING)
+	buf_pool_register_io_buffers();
+#endif /* UNIV_IO_URING */
+
 	char	now[32];
 
 	ut_sprintf_timestamp(now);
@@ -3899,8 +3997,13 @@ buf_block_from_ahi(const byte* ptr)
 	/* Read the state of the block without holding a mutex.
 	A state transition from BUF_BLOCK_FILE_PAGE to
 	BUF_BLOCK_REMOVE_HASH is possible during this execution. */
+#if defined (UNIV_AHI_EPOCH)
+	/* A lock-free lookup may find a node of a block that has been
+	freed since, the caller validates the block after latching it */
+#else
 	ut_d(const buf_page_state state = buf_block_get_state(block));
 	ut_ad(state == BUF_BLOCK_FILE_PAGE || state == BUF_BLOCK_REMOVE_HASH);
+#endif /* UNIV_AHI_EPOCH */
 	return(block);
 }
 
@@ -4825,6 +4928,17 @@ buf_page_get_known_nowait(
 		return(FALSE);
 	}
 
+#if defined (UNIV_AHI_EPOCH)
+	if (mode == BUF_MAKE_YOUNG_LOCK_FREE
+	    && buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE) {
+		/* A lock-free search of the adaptive hash index found
+		a block that has been freed or reused since */
+		buf_page_mutex_exit(block);
+
+		return(FALSE);
+	}
+#endif /* UNIV_AHI_EPOCH */
+
 	ut_a(buf_block_get_state(block) == BUF_BLOCK_FILE_PAGE);
 
 	buf_block_buf_fix_inc(block, file, line);
@@ -4835,7 +4949,7 @@ buf_page_get_known_nowait(
 
 	buf_pool = buf_pool_from_block(block);
 
-	if (mode == BUF_MAKE_YOUNG) {
+	if (mode != BUF_KEEP_OLD) {
 		buf_page_make_young_if_needed(&block->page);
 	}
 
@@ -4875,7 +4989,13 @@ buf_page_get_known_nowait(
 #endif /* UNIV_DEBUG || UNIV_BUF_DEBUG */
 
 #ifdef UNIV_DEBUG
-	if (mode != BUF_KEEP_OLD) {
+	if (mode != BUF_KEEP_OLD
+#if defined (UNIV_AHI_EPOCH)
+	    /* A lock-free search of the adaptive hash index may latch
+	    a freed page, it checks the modify clock afterwards */
+	    && mode != BUF_MAKE_YOUNG_LOCK_FREE
+#endif /* UNIV_AHI_EPOCH */
+	    ) {
 		/* If mode == BUF_KEEP_OLD, we are executing an I/O
 		completion routine.  Avoid a bogus assertion failure
 		when ibuf_merge_or_delete_for_page() is processing a
@@ -5003,6 +5123,9 @@ buf_page_init_low(
 	bpage->access_time = 0;
 	bpage->newest_modification = 0;
 	bpage->oldest_modification = 0;
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	bpage->hybrid_dep_lsn = 0;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	HASH_INVALIDATE(bpage, hash);
 
 	ut_d(bpage->file_page_was_freed = FALSE);
@@ -5401,6 +5524,12 @@ buf_page_create(
 	DBUG_PRINT("ib_buf", ("create page " UINT32PF ":" UINT32PF,
 			      page_id.space(), page_id.page_no()));
 
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	/* The page is initialized without a read, its older image must not
+	be read after the next eviction. */
+	buf_vcache_invalidate(page_id);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 	block = free_block;
 
 	buf_page_mutex_enter(block);
@@ -125,6 +125,117 @@ buf_dblwr_sync_datafiles()
 	fil_flush_file_spaces(FIL_TYPE_TABLESPACE);
 }
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+/****************************************************************//**
+Checks that the NVM doublewrite area of an existing pool has slots of the
+page size of this server. The slot size is fixed when the area is
+allocated.
+@return true if the area is new or usable */
+static
+bool
+buf_dblwr_part_check(void)
+/*======================*/
+{
+	const PMEM_DBW*	pdbw = gb_pmw->pdbw;
+
+	if (pdbw == NULL || pdbw->slot_size == UNIV_PAGE_SIZE) {
+		return(true);
+	}
+
+	ib::error() << "The doublewrite buffer in the PMEM pool "
+		<< gb_pmw->name << " has slots of " << pdbw->slot_size
+		<< " bytes, but innodb_page_size is " << UNIV_PAGE_SIZE
+		<< ". The pool was created for another page size, start"
+		" with that page size or use another pool.";
+
+	return(false);
+}
+
+/****************************************************************//**
+Splits the slots of the NVM doublewrite area into one partition per
+buffer pool instance. The number of slots is fixed when the area is
+allocated, the partitions are rebuilt in DRAM at every startup. */
+static
+void
+buf_dblwr_part_init(void)
+/*=====================*/
+{
+	PMEM_DBW*	pdbw = gb_pmw->pdbw;
+	ulint		slots_per_part;
+
+	ut_ad(pdbw->slot_size == UNIV_PAGE_SIZE);
+
+	buf_dblwr->n_parts = srv_buf_pool_instances;
+
+	slots_per_part = pdbw->n_slots / buf_dblwr->n_parts;
+	ut_a(slots_per_part > 0);
+
+	buf_dblwr->parts = static_cast<buf_dblwr_part_t*>(
+		ut_zalloc_nokey(buf_dblwr->n_parts
+				* sizeof(buf_dblwr_part_t)));
+
+	for (ulint i = 0; i < buf_dblwr->n_parts; i++) {
+		buf_dblwr_part_t*	part = &buf_dblwr->parts[i];
+
+		/* The partitions are never latched together. */
+		mutex_create(LATCH_ID_BUF_DBLWR, &part->mutex);
+
+		part->event = os_event_create("dblwr_part_event");
+		part->first_slot = i * slots_per_part;
+		part->n_slots = slots_per_part;
+		part->n_reserved = 0;
+		part->n_in_flight = 0;
+		part->syncing = false;
+
+		part->state = static_cast<buf_dblwr_slot_state_t*>(
+			ut_zalloc_nokey(slots_per_part
+					* sizeof(buf_dblwr_slot_state_t)));
+		part->buf_block_arr = static_cast<const buf_page_t**>(
+			ut_zalloc_nokey(slots_per_part * sizeof(void*)));
+	}
+
+	ib::info() << "Doublewrite buffer on PMEM: " << buf_dblwr->n_parts
+		<< " partitions of " << slots_per_part << " pages";
+}
+
+/****************************************************************//**
+Frees the doublewrite partitions. */
+static
+void
+buf_dblwr_part_free(void)
+/*=====================*/
+{
+	for (ulint i = 0; i < buf_dblwr->n_parts; i++) {
+		buf_dblwr_part_t*	part = &buf_dblwr->parts[i];
+
+		ut_ad(part->n_reserved == 0);
+
+		os_event_destroy(part->event);
+		mutex_free(&part->mutex);
+		ut_free(part->state);
+		ut_free(part->buf_block_arr);
+	}
+
+	ut_free(buf_dblwr->parts);
+	buf_dblwr->parts = NULL;
+	buf_dblwr->n_parts = 0;
+}
+
+/****************************************************************//**
+Gets the doublewrite partition a page is written through.
+@return the partition of the buffer pool instance of the page */
+UNIV_INLINE
+buf_dblwr_part_t*
+buf_dblwr_get_part(
+/*===============*/
+	const buf_page_t*	bpage)	/*!< in: buffer block descriptor */
+{
+	const buf_pool_t*	buf_pool = buf_pool_from_bpage(bpage);
+
+	return(&buf_dblwr->parts[buf_pool->instance_no % buf_dblwr->n_parts]);
+}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 /****************************************************************//**
 Creates or initialializes the doublewrite buffer at a database start. */
 static
@@ -136,7 +247,7 @@ buf_dblwr_init(
 {
 	ulint	buf_size;
 
-#if defined (UNIV_PMEMOBJ_DBW)
+#if defined (UNIV_PMEMOBJ_DBW) && !defined (UNIV_PMEMOBJ_DBW_PARTITION)
 	dberr_t		err;
 	byte*		buf;
 #endif 
@@ -182,7 +293,30 @@ buf_dblwr_init(
 //	}
 	//[TODO] Recovery handler
 //#endif /* UNIV_PMEMOBJ_BUF */
-#if defined (UNIV_PMEMOBJ_DBW)
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	//Allocate the partitioned double write buffer on PMEM
+	buf_dblwr->load_from_disk = false;
+	if (!gb_pmw->pdbw) {
+		if (pm_wrapper_dbw_part_alloc(gb_pmw,
+				srv_buf_pool_instances * srv_pmem_dbw_slots_per_part,
+				UNIV_PAGE_SIZE) == PMEM_ERROR) {
+			ib::fatal() << "Cannot allocate the doublewrite buffer"
+				" on PMEM";
+		}
+		/* The previous run may have used the doublewrite
+		buffer on disk */
+		buf_dblwr->load_from_disk = true;
+	}
+	buf_dblwr_part_init();
+
+	/* The DRAM write buffer is only used to load the doublewrite
+	pages on disk in buf_dblwr_init_or_load_pages() */
+	buf_dblwr->write_buf_unaligned = static_cast<byte*>(
+		ut_malloc_nokey((1 + buf_size) * UNIV_PAGE_SIZE));
+	buf_dblwr->write_buf = static_cast<byte*>(
+		ut_align(buf_dblwr->write_buf_unaligned,
+			 UNIV_PAGE_SIZE));
+#elif defined (UNIV_PMEMOBJ_DBW)
 	//Allocate the double write buffer on PMEM
 	if (!gb_pmw->pdbw){
 		if ( pm_wrapper_dbw_alloc(gb_pmw, (1 + buf_size) * UNIV_PAGE_SIZE)
@@ -288,6 +422,13 @@ start_again:
 		/* The doublewrite buffer has already been created:
 		just read in some numbers */
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+		if (!buf_dblwr_part_check()) {
+			mtr_commit(&mtr);
+			buf_dblwr_being_created = FALSE;
+			return(false);
+		}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
 		buf_dblwr_init(doublewrite);
 
 		mtr_commit(&mtr);
@@ -491,6 +632,12 @@ buf_dblwr_init_or_load_pages(
 #if defined(UNIV_PMEMOBJ_DBW)
 		gb_dbw_file = file;
 #endif 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+		if (!buf_dblwr_part_check()) {
+			ut_free(unaligned_read_buf);
+			return(DB_ERROR);
+		}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
 		buf_dblwr_init(doublewrite);
 
 		block1 = buf_dblwr->block1;
@@ -517,7 +664,22 @@ buf_dblwr_init_or_load_pages(
 	}
 
 	/* Read the pages from the doublewrite buffer to memory */
-#if defined (UNIV_PMEMOBJ_DBW)
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	if (!buf_dblwr->load_from_disk) {
+		/* Only a slot in flight may hold the copy of a torn page.
+		The recovery reads those copies directly from PMEM. */
+		for (ulint i = 0; i < gb_pmw->pdbw->n_slots; i++) {
+			if (pm_dbw_part_slot_in_flight(gb_pmw->pdbw, i)) {
+				recv_dblwr.add(
+					pm_dbw_part_get_slot(gb_pmw->pdbw, i));
+			}
+		}
+
+		ut_free(unaligned_read_buf);
+
+		return(DB_SUCCESS);
+	}
+#elif defined (UNIV_PMEMOBJ_DBW)
 	//when the program reach here, the buf_dblwr_init() is called and gb_pmw->pdbw is allocated
 	goto skip_load_dbw;	
 #endif /* UNIV_PMEMOBJ_DBW */
@@ -555,7 +717,7 @@ buf_dblwr_init_or_load_pages(
 		return(err);
 	}
 
-#if defined (UNIV_PMEMOBJ_DBW)
+#if defined (UNIV_PMEMOBJ_DBW) && !defined (UNIV_PMEMOBJ_DBW_PARTITION)
 skip_load_dbw:
 #endif /* UNIV_PMEMOBJ_DBW */
 
@@ -789,6 +951,15 @@ buf_dblwr_process(void)
 	recv_dblwr.pages.clear();
 
 	fil_flush_file_spaces(FIL_TYPE_TABLESPACE);
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	/* The datafiles are synced, the NVM copies are not needed
+	anymore. */
+	for (ulint i = 0; i < gb_pmw->pdbw->n_slots; i++) {
+		if (pm_dbw_part_slot_in_flight(gb_pmw->pdbw, i)) {
+			pm_dbw_part_clear_slot(gb_pmw->pop, gb_pmw->pdbw, i);
+		}
+	}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
 	ut_free(unaligned_read_buf);
 }
 
@@ -805,7 +976,10 @@ buf_dblwr_free(void)
 
 	os_event_destroy(buf_dblwr->b_event);
 	os_event_destroy(buf_dblwr->s_event);
-#if defined(UNIV_PMEMOBJ_DBW)
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	buf_dblwr_part_free();
+	ut_free(buf_dblwr->write_buf_unaligned);
+#elif defined(UNIV_PMEMOBJ_DBW)
 	//We don't free it here, we will do that later in pm_wrapper_free()
 #else //original
 	ut_free(buf_dblwr->write_buf_unaligned);
@@ -823,6 +997,76 @@ buf_dblwr_free(void)
 	buf_dblwr = NULL;
 }
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+/********************************************************************//**
+Releases the doublewrite slot of a page when its datafile write is
+completed. As in the batch doublewrite, a slot is reused only after the
+datafiles are synced: the last completion of the partition syncs the
+datafiles and frees every written slot. */
+static
+void
+buf_dblwr_part_update(
+/*==================*/
+	const buf_page_t*	bpage)	/*!< in: buffer block descriptor */
+{
+	buf_dblwr_part_t*	part = buf_dblwr_get_part(bpage);
+	ulint			i;
+
+	mutex_enter(&part->mutex);
+
+	for (i = 0; i < part->n_slots; ++i) {
+		if (part->state[i] == BUF_DBLWR_SLOT_IN_FLIGHT
+		    && part->buf_block_arr[i] == bpage) {
+			part->state[i] = BUF_DBLWR_SLOT_WRITTEN;
+			part->n_in_flight--;
+			break;
+		}
+	}
+
+	/* The block we are looking for must exist as a reserved block. */
+	ut_a(i < part->n_slots);
+
+	while (part->n_in_flight == 0 && !part->syncing) {
+		ulint	n_syncing = 0;
+
+		for (i = 0; i < part->n_slots; ++i) {
+			if (part->state[i] == BUF_DBLWR_SLOT_WRITTEN) {
+				part->state[i] = BUF_DBLWR_SLOT_SYNCING;
+				n_syncing++;
+			}
+		}
+
+		if (n_syncing == 0) {
+			break;
+		}
+
+		part->syncing = true;
+		mutex_exit(&part->mutex);
+
+		fil_flush_file_spaces(FIL_TYPE_TABLESPACE);
+
+		mutex_enter(&part->mutex);
+
+		for (i = 0; i < part->n_slots; ++i) {
+			if (part->state[i] == BUF_DBLWR_SLOT_SYNCING) {
+				pm_dbw_part_clear_slot(
+					gb_pmw->pop, gb_pmw->pdbw,
+					part->first_slot + i);
+
+				part->state[i] = BUF_DBLWR_SLOT_FREE;
+				part->buf_block_arr[i] = NULL;
+				part->n_reserved--;
+			}
+		}
+
+		part->syncing = false;
+		os_event_set(part->event);
+	}
+
+	mutex_exit(&part->mutex);
+}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 /********************************************************************//**
 Updates the doublewrite buffer when an IO request is completed. */
 void
@@ -839,6 +1083,12 @@ buf_dblwr_update(
 
 	ut_ad(!srv_read_only_mode);
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	/* Batch and single page flushes use the same slots */
+	buf_dblwr_part_update(bpage);
+	return;
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
@@ -1057,6 +1307,97 @@ buf_dblwr_write_block_to_datafile(
 	}
 }
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+/********************************************************************//**
+Writes a page through the doublewrite partition of its buffer pool
+instance. The page image is persisted on a free slot of the partition with
+memcpy + flush and the datafile write is posted at once: there is no batch,
+no doublewrite write to disk and no global doublewrite mutex. If all the
+slots of the partition are in use we wait here for one to become free. */
+static
+void
+buf_dblwr_part_write_page(
+/*======================*/
+	buf_page_t*	bpage,	/*!< in: buffer block to write */
+	bool		sync)	/*!< in: true if sync IO requested */
+{
+	buf_dblwr_part_t*	part = buf_dblwr_get_part(bpage);
+	ulint			i;
+
+	if (buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE) {
+
+		/* Check that the actual page in the buffer pool is
+		not corrupt and the LSN values are sane. */
+		buf_dblwr_check_block((buf_block_t*) bpage);
+
+		if (!bpage->zip.data) {
+			buf_dblwr_check_page_lsn(
+				((buf_block_t*) bpage)->frame);
+		}
+	}
+
+retry:
+	mutex_enter(&part->mutex);
+
+	if (part->n_reserved == part->n_slots) {
+
+		/* All slots are reserved. They are released by the IO
+		handler threads, make sure our posted writes reach the
+		operating system before we wait. */
+		int64_t	sig_count = os_event_reset(part->event);
+		mutex_exit(&part->mutex);
+
+		os_aio_simulated_wake_handler_threads();
+		os_event_wait_low(part->event, sig_count);
+
+		goto retry;
+	}
+
+	for (i = 0; i < part->n_slots; ++i) {
+		if (part->state[i] == BUF_DBLWR_SLOT_FREE) {
+			break;
+		}
+	}
+
+	/* We are guaranteed to find a slot. */
+	ut_a(i < part->n_slots);
+
+	part->state[i] = BUF_DBLWR_SLOT_IN_FLIGHT;
+	part->buf_block_arr[i] = bpage;
+	part->n_reserved++;
+	part->n_in_flight++;
+
+	mutex_exit(&part->mutex);
+
+	/* increment the doublewrite flushed pages counter */
+	srv_stats.dblwr_pages_written.inc();
+	srv_stats.dblwr_writes.inc();
+
+	if (bpage->size.is_compressed()) {
+		UNIV_MEM_ASSERT_RW(bpage->zip.data, bpage->size.physical());
+
+		pm_dbw_part_write_slot(gb_pmw->pop, gb_pmw->pdbw,
+				       part->first_slot + i,
+				       bpage->zip.data,
+				       bpage->size.physical());
+	} else {
+		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
+
+		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
+				   bpage->size.logical());
+
+		pm_dbw_part_write_slot(gb_pmw->pop, gb_pmw->pdbw,
+				       part->first_slot + i,
+				       ((buf_block_t*) bpage)->frame,
+				       bpage->size.logical());
+	}
+
+	/* The page image is durable on PMEM, we can write the page to
+	its intended position. */
+	buf_dblwr_write_block_to_datafile(bpage, sync);
+}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 /********************************************************************//**
 Flushes possible buffered writes from the doublewrite memory buffer to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
@@ -1079,6 +1420,13 @@ buf_dblwr_flush_buffered_writes(void)
 
 	ut_ad(!srv_read_only_mode);
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	/* Nothing is buffered, every page is posted to its datafile
+	as soon as its image is on PMEM. */
+	os_aio_simulated_wake_handler_threads();
+	return;
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 try_again:
 	mutex_enter(&buf_dblwr->mutex);
 
@@ -1228,6 +1576,11 @@ buf_dblwr_add_to_batch(
 {
 	ut_a(buf_page_in_file(bpage));
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	buf_dblwr_part_write_page(bpage, false);
+	return;
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 try_again:
 	mutex_enter(&buf_dblwr->mutex);
 
@@ -1340,6 +1693,11 @@ buf_dblwr_write_single_page(
 	ut_a(srv_use_doublewrite_buf);
 	ut_a(buf_dblwr != NULL);
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	buf_dblwr_part_write_page(bpage, sync);
+	return;
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 	/* total number of slots available for single page flushes
 	starts from srv_doublewrite_batch_size to the end of the
 	buffer. */
@@ -44,6 +44,17 @@ Created April 08, 2011 Vasil Dimov
 
 #include <algorithm>
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+#include "buf0rea.h"
+#include "my_pmemobj.h"
+#include "os0atomic.h"
+#include "ut0rnd.h"
+
+#include <vector>
+
+extern PMEM_WRAPPER* gb_pmw;
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 enum status_severity {
 	STATUS_VERBOSE,
 	STATUS_INFO,
@@ -250,6 +261,375 @@ buf_dump_generate_path(
 	}
 }
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+/* Warm restart from NVM
+=====================
+A buffer pool dump also copies the hottest pages to the slots of an NVM
+area, in LRU order until the slots are used, and a load at startup copies
+them back to the buffer pool frames before reading the rest of the dump from
+the datafiles.
+
+Only clean uncompressed pages are copied, under an S-latch, so a slot holds
+the datafile page. A page write drops the slot of the page before the page
+is written, which keeps the slots valid across a crash and the recovery
+after it. buf_LRU_flush_or_remove_pages() drops the slots of a tablespace
+whose pages go away without a write. The area is valid from a dump until
+the next load, the writes are only looked up in that window.
+
+The page writes look up their slot without a latch: an open addressing
+index from the page to its slot is only filled by the dump and emptied
+with the area, and a slot is dropped by a compare-and-swap on the page it
+holds. Whoever finds the page in a slot clears the NVM slot before it
+returns, a page write never goes ahead of the clear. */
+
+/** Pages of the NVM slots, keyed by BUF_DUMP_CREATE(), loaded in that
+order */
+typedef std::vector<
+	std::pair<ib_uint64_t, ulint>,
+	ut_allocator<std::pair<ib_uint64_t, ulint> > >	buf_warm_pages_t;
+
+/** DRAM bookkeeping of the NVM warm restart area */
+struct buf_warm_t {
+	/** serializes the dump, the load and the tablespace drops, the
+	page writes do not take it */
+	ib_mutex_t		mutex;
+	/** BUF_DUMP_CREATE() + 1 of the page on each slot, or 0 if the
+	slot is not valid */
+	ulint*			slot_page;
+	/** slot + 1 of a page at its fold, or after it, or 0 */
+	ulint*			cells;
+	/** number of cells, a power of 2 at least twice the slots */
+	ulint			n_cells;
+};
+
+/** The NVM warm restart area */
+static buf_warm_t*	buf_warm = NULL;
+
+/** @return the slot_page value of a page */
+UNIV_INLINE
+ulint
+buf_warm_page_key(
+	ulint	space,
+	ulint	page_no)
+{
+	return(static_cast<ulint>(BUF_DUMP_CREATE(space, page_no)) + 1);
+}
+
+/** Looks up the slot of a page without a latch.
+@param[in]	key	buf_warm_page_key() of the page
+@return the slot, or ULINT_UNDEFINED if no slot holds the page */
+static
+ulint
+buf_warm_find(
+	ulint	key)
+{
+	const ulint	mask = buf_warm->n_cells - 1;
+
+	for (ulint i = ut_fold_ull(key) & mask;; i = (i + 1) & mask) {
+		const ulint	cell = buf_warm->cells[i];
+
+		if (cell == 0) {
+			return(ULINT_UNDEFINED);
+		}
+
+		os_rmb;
+
+		if (buf_warm->slot_page[cell - 1] == key) {
+			return(cell - 1);
+		}
+	}
+}
+
+/** Publishes the page of a slot, called by the dump or at startup with
+buf_warm->mutex held.
+@param[in]	key	buf_warm_page_key() of the page
+@param[in]	slot	valid slot that holds the page */
+static
+void
+buf_warm_insert(
+	ulint	key,
+	ulint	slot)
+{
+	const ulint	mask = buf_warm->n_cells - 1;
+	ulint		i = ut_fold_ull(key) & mask;
+
+	ut_ad(mutex_own(&buf_warm->mutex));
+
+	while (buf_warm->cells[i] != 0) {
+		i = (i + 1) & mask;
+	}
+
+	buf_warm->slot_page[slot] = key;
+	os_wmb;
+	buf_warm->cells[i] = slot + 1;
+}
+
+/** Empties the DRAM index, called with buf_warm->mutex held while the
+area is not valid. */
+static
+void
+buf_warm_clear()
+{
+	ut_ad(mutex_own(&buf_warm->mutex));
+
+	memset(buf_warm->cells, 0x0, buf_warm->n_cells * sizeof(ulint));
+	memset(buf_warm->slot_page, 0x0,
+	       gb_pmw->pwarm->n_slots * sizeof(ulint));
+}
+
+/** Drops a slot: clears the NVM slot, then the DRAM slot_page. Both
+clear the NVM slot if a page write races with a tablespace drop.
+@param[in]	key	buf_warm_page_key() of the page
+@param[in]	slot	slot that held the page */
+static
+void
+buf_warm_drop(
+	ulint	key,
+	ulint	slot)
+{
+	pm_warm_clear_slot(gb_pmw->pop, gb_pmw->pwarm, slot);
+
+	os_compare_and_swap_ulint(&buf_warm->slot_page[slot], key, 0);
+}
+
+/** Opens or allocates the NVM warm restart area and builds its DRAM
+bookkeeping. Called at startup before the redo log is applied. */
+void
+buf_warm_init(void)
+{
+	PMEM_WARM*	pwarm;
+
+	if (pm_wrapper_warm_alloc_or_open(
+			gb_pmw, srv_pmem_warm_slots, UNIV_PAGE_SIZE)
+	    == PMEM_ERROR) {
+		ib::fatal() << "Cannot allocate the warm restart area on PMEM";
+	}
+
+	pwarm = gb_pmw->pwarm;
+	ut_a(pwarm->slot_size == UNIV_PAGE_SIZE);
+
+	buf_warm = UT_NEW_NOKEY(buf_warm_t());
+
+	mutex_create(LATCH_ID_BUF_WARM, &buf_warm->mutex);
+
+	buf_warm->n_cells = ut_2_power_up(2 * pwarm->n_slots);
+	buf_warm->cells = static_cast<ulint*>(
+		ut_zalloc_nokey(buf_warm->n_cells * sizeof(ulint)));
+	buf_warm->slot_page = static_cast<ulint*>(
+		ut_zalloc_nokey(pwarm->n_slots * sizeof(ulint)));
+
+	/* Without a load the images would only slow down the page
+	writes until the next dump. */
+	if (pwarm->state == PMEM_WARM_VALID
+	    && (srv_read_only_mode || !srv_buffer_pool_load_at_startup)) {
+		pm_warm_set_state(gb_pmw->pop, pwarm, PMEM_WARM_EMPTY);
+	}
+
+	ulint	n_pages = 0;
+
+	if (pwarm->state == PMEM_WARM_VALID) {
+		mutex_enter(&buf_warm->mutex);
+
+		for (ulint i = 0; i < pwarm->n_slots; i++) {
+			const PMEM_WARM_SLOT_HDR*	hdr
+				= pm_warm_get_slot_hdr(pwarm, i);
+
+			if (hdr->state == PMEM_WARM_VALID) {
+				buf_warm_insert(buf_warm_page_key(
+					hdr->space, hdr->page_no), i);
+				n_pages++;
+			}
+		}
+
+		mutex_exit(&buf_warm->mutex);
+	}
+
+	ib::info() << "Warm restart area on PMEM: " << pwarm->n_slots
+		<< " slots, " << n_pages << " pages to load";
+}
+
+/** Frees the DRAM bookkeeping of the NVM warm restart area. */
+void
+buf_warm_free(void)
+{
+	if (buf_warm == NULL) {
+		return;
+	}
+
+	mutex_free(&buf_warm->mutex);
+
+	ut_free(buf_warm->cells);
+	ut_free(buf_warm->slot_page);
+
+	UT_DELETE(buf_warm);
+	buf_warm = NULL;
+}
+
+/** Drops the NVM image of a page that is about to be written to its
+datafile, the image would be older than the datafile page.
+@param[in]	page_id	page being written */
+void
+buf_warm_invalidate(
+	const page_id_t&	page_id)
+{
+	/* A page that is written while the area becomes valid is
+	dirty, the dump does not copy it. */
+	if (buf_warm == NULL
+	    || gb_pmw->pwarm->state != PMEM_WARM_VALID) {
+		return;
+	}
+
+	const ulint	key = buf_warm_page_key(
+		page_id.space(), page_id.page_no());
+	const ulint	slot = buf_warm_find(key);
+
+	if (slot != ULINT_UNDEFINED) {
+		buf_warm_drop(key, slot);
+	}
+}
+
+/** Drops the NVM images of all the pages of a tablespace that is dropped,
+discarded, truncated or imported. Its pages are not written to the datafile
+any more, or are replaced without the buffer pool, nothing else would drop
+the images.
+@param[in]	space_id	tablespace id */
+void
+buf_warm_invalidate_space(
+	ulint	space_id)
+{
+	if (buf_warm == NULL
+	    || gb_pmw->pwarm->state != PMEM_WARM_VALID) {
+		return;
+	}
+
+	mutex_enter(&buf_warm->mutex);
+
+	for (ulint i = 0; i < gb_pmw->pwarm->n_slots; i++) {
+		const ulint	key = buf_warm->slot_page[i];
+
+		if (key != 0 && BUF_DUMP_SPACE(key - 1) == space_id) {
+			buf_warm_drop(key, i);
+		}
+	}
+
+	mutex_exit(&buf_warm->mutex);
+}
+
+/** Empties the NVM area and makes it valid for the slots of a new dump.
+@return number of slots */
+static
+ulint
+buf_warm_dump_start()
+{
+	if (buf_warm == NULL) {
+		return(0);
+	}
+
+	mutex_enter(&buf_warm->mutex);
+
+	pm_warm_set_state(gb_pmw->pop, gb_pmw->pwarm, PMEM_WARM_EMPTY);
+	buf_warm_clear();
+	pm_warm_set_state(gb_pmw->pop, gb_pmw->pwarm, PMEM_WARM_VALID);
+
+	mutex_exit(&buf_warm->mutex);
+
+	return(gb_pmw->pwarm->n_slots);
+}
+
+/** Copies a page to an NVM slot if it is clean and not compressed.
+@param[in]	buf_pool	buffer pool instance of the page
+@param[in]	page_id		page to copy
+@param[in]	slot		free slot
+@return true if the slot holds the page */
+static
+bool
+buf_warm_mirror_page(
+	buf_pool_t*		buf_pool,
+	const page_id_t&	page_id,
+	ulint			slot)
+{
+	rw_lock_t*	hash_lock;
+	buf_page_t*	bpage;
+	buf_block_t*	block;
+	bool		mirrored = false;
+
+	bpage = buf_page_hash_get_s_locked(buf_pool, page_id, &hash_lock);
+
+	if (bpage == NULL) {
+		return(false);
+	}
+
+	if (buf_page_get_state(bpage) != BUF_BLOCK_FILE_PAGE
+	    || bpage->size.is_compressed()) {
+		rw_lock_s_unlock(hash_lock);
+		return(false);
+	}
+
+	block = reinterpret_cast<buf_block_t*>(bpage);
+	buf_block_buf_fix_inc(block, __FILE__, __LINE__);
+	rw_lock_s_unlock(hash_lock);
+
+	/* A page being read or modified is X-latched, skip it rather
+	than wait. The S-latch keeps the frame equal to the datafile page
+	until the slot is in the map, a later write then drops the slot. */
+	if (rw_lock_s_lock_nowait(&block->lock, __FILE__, __LINE__)) {
+
+		if (bpage->oldest_modification == 0) {
+			pm_warm_write_slot(gb_pmw->pop, gb_pmw->pwarm, slot,
+					   block->frame, page_id.space(),
+					   page_id.page_no());
+
+			mutex_enter(&buf_warm->mutex);
+			buf_warm_insert(buf_warm_page_key(
+				page_id.space(), page_id.page_no()), slot);
+			mutex_exit(&buf_warm->mutex);
+
+			mirrored = true;
+		}
+
+		rw_lock_s_unlock(&block->lock);
+	}
+
+	buf_block_buf_fix_dec(block);
+
+	return(mirrored);
+}
+
+/** Copies the dumped pages of a buffer pool instance to the NVM slots.
+@param[in]	buf_pool	buffer pool instance
+@param[in]	dump		pages of the instance, LRU order
+@param[in]	n_pages		number of pages in dump
+@param[in]	slot		first free slot
+@param[in]	limit		slots up to this one may be used
+@param[in]	obey_shutdown	quit if we are in a shutting down state
+@return the first free slot after the copy */
+static
+ulint
+buf_warm_mirror(
+	buf_pool_t*		buf_pool,
+	const buf_dump_t*	dump,
+	ulint			n_pages,
+	ulint			slot,
+	ulint			limit,
+	ibool			obey_shutdown)
+{
+	for (ulint j = 0;
+	     j < n_pages && slot < limit
+	     && !(SHUTTING_DOWN() && obey_shutdown);
+	     j++) {
+
+		const page_id_t	page_id(BUF_DUMP_SPACE(dump[j]),
+					BUF_DUMP_PAGE(dump[j]));
+
+		if (buf_warm_mirror_page(buf_pool, page_id, slot)) {
+			slot++;
+		}
+	}
+
+	return(slot);
+}
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -271,6 +651,10 @@ buf_dump(
 	FILE*	f;
 	ulint	i;
 	int	ret;
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	ulint	warm_slot = 0;
+	ulint	n_warm_slots;
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
 
 	buf_dump_generate_path(full_filename, sizeof(full_filename));
 
@@ -289,6 +673,10 @@ buf_dump(
 	}
 	/* else */
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	n_warm_slots = buf_warm_dump_start();
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 	/* walk through each buffer pool */
 	for (i = 0; i < srv_buf_pool_instances && !SHOULD_QUIT(); i++) {
 		buf_pool_t*		buf_pool;
@@ -349,6 +737,15 @@ buf_dump(
 
 		buf_pool_mutex_exit(buf_pool);
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+		/* Each instance gets its share of the slots, and the
+		share the previous ones did not use. */
+		warm_slot = buf_warm_mirror(
+			buf_pool, dump, n_pages, warm_slot,
+			(i + 1) * n_warm_slots / srv_buf_pool_instances,
+			obey_shutdown);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
 			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
 				      BUF_DUMP_SPACE(dump[j]),
@@ -481,6 +878,136 @@ buf_load_throttle_if_needed(
 	*last_activity_count = srv_get_activity_count();
 }
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+/** Copies the pages of the NVM area to the buffer pool, then empties the
+area. A page that is already in the buffer pool keeps its frame. */
+static
+void
+buf_warm_load()
+{
+	PMEM_WARM*		pwarm;
+	buf_warm_pages_t	pages;
+	buf_warm_pages_t::const_iterator	it;
+	ulint			n_loaded = 0;
+	ulint			cur_space_id = ULINT_UNDEFINED;
+	fil_space_t*		space = NULL;
+	page_size_t		page_size(univ_page_size);
+
+	if (buf_warm == NULL
+	    || gb_pmw->pwarm->state != PMEM_WARM_VALID) {
+		return;
+	}
+
+	pwarm = gb_pmw->pwarm;
+
+	/* The copy is sorted by (space, page) like a dump. */
+	mutex_enter(&buf_warm->mutex);
+
+	for (ulint i = 0; i < pwarm->n_slots; i++) {
+		const ulint	key = buf_warm->slot_page[i];
+
+		if (key != 0) {
+			pages.push_back(std::make_pair(
+				ib_uint64_t(key - 1), i));
+		}
+	}
+
+	mutex_exit(&buf_warm->mutex);
+
+	std::sort(pages.begin(), pages.end());
+
+	buf_load_status(STATUS_INFO,
+			"Loading " ULINTPF " pages from NVM",
+			(ulint) pages.size());
+
+	for (it = pages.begin();
+	     it != pages.end() && !SHUTTING_DOWN() && !buf_load_abort_flag;
+	     ++it) {
+
+		const ulint	this_space_id = BUF_DUMP_SPACE(it->first);
+		buf_page_t*	bpage;
+		dberr_t		err;
+
+		if (this_space_id != cur_space_id) {
+			if (space != NULL) {
+				fil_space_release(space);
+			}
+
+			cur_space_id = this_space_id;
+			space = fil_space_acquire_silent(cur_space_id);
+
+			if (space != NULL) {
+				const page_size_t	cur_page_size(
+					space->flags);
+				page_size.copy_from(cur_page_size);
+			}
+		}
+
+		if (space == NULL
+		    || page_size.is_compressed()
+		    || page_size.physical() != pwarm->slot_size) {
+			continue;
+		}
+
+		const page_id_t	page_id(this_space_id,
+					BUF_DUMP_PAGE(it->first));
+		const ulint	key = static_cast<ulint>(it->first) + 1;
+
+		if (buf_warm->slot_page[it->second] != key) {
+			/* written since the copy of the slots */
+			continue;
+		}
+
+		bpage = buf_page_init_for_read(
+			&err, BUF_READ_ANY_PAGE, page_id, page_size, FALSE);
+
+		if (bpage != NULL) {
+			byte*	frame = reinterpret_cast<buf_block_t*>(
+				bpage)->frame;
+
+			/* Once the page is io-fixed in the buffer pool it
+			cannot be written. If it was read, written and evicted
+			since the check above, the slot is dropped and the
+			datafile page is newer. */
+			os_rmb;
+
+			if (buf_warm->slot_page[it->second] == key) {
+				memcpy(frame,
+				       pm_warm_get_slot(pwarm, it->second),
+				       page_size.physical());
+			} else {
+				IORequest	request(IORequest::READ);
+
+				err = fil_io(request, true, page_id, page_size,
+					     0, page_size.physical(), frame,
+					     bpage);
+				ut_a(err == DB_SUCCESS);
+			}
+
+			/* Checks the page and releases the io-fix as
+			after a datafile read. */
+			buf_page_io_complete(bpage);
+			n_loaded++;
+		}
+	}
+
+	if (space != NULL) {
+		fil_space_release(space);
+	}
+
+	/* The pages are in the buffer pool, the area is not needed until
+	the next dump. */
+	mutex_enter(&buf_warm->mutex);
+	pm_warm_set_state(gb_pmw->pop, pwarm, PMEM_WARM_EMPTY);
+	buf_warm_clear();
+	mutex_exit(&buf_warm->mutex);
+
+	buf_load_status(STATUS_INFO,
+			"Loaded " ULINTPF "/" ULINTPF " pages from NVM",
+			n_loaded, (ulint) pages.size());
+}
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 /*****************************************************************//**
 Perform a buffer pool load from the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
@@ -506,6 +1033,12 @@ buf_load()
 	/* Ignore any leftovers from before */
 	buf_load_abort_flag = FALSE;
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	/* The rest of the dump is read from the datafiles, the pages
+	copied from NVM are skipped by buf_read_page_background(). */
+	buf_warm_load();
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 	buf_dump_generate_path(full_filename, sizeof(full_filename));
 
 	buf_load_status(STATUS_INFO,
@@ -35,6 +35,7 @@ Created 11/11/1995 Heikki Tuuri
 
 #include "buf0buf.h"
 #include "buf0checksum.h"
+#include "buf0dump.h"
 #include "srv0start.h"
 #include "srv0srv.h"
 #include "page0zip.h"
@@ -468,6 +469,18 @@ buf_flush_insert_into_flush_list(
 	block->page.oldest_modification = lsn;
 
 	UT_LIST_ADD_FIRST(buf_pool->flush_list, &block->page);
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The system and undo pages come in log_sys lsn order under
+	log_flush_order_mutex, keep them on their own list for the
+	checkpoint */
+	if (is_system_or_undo_tablespace(block->page.id.space())) {
+		ut_ad(UT_LIST_GET_FIRST(buf_pool->classic_flush_list) == NULL
+		      || UT_LIST_GET_FIRST(buf_pool->classic_flush_list)
+			 ->oldest_modification <= lsn);
+
+		UT_LIST_ADD_FIRST(buf_pool->classic_flush_list, &block->page);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 //#if defined (UNIV_PMEMOBJ_PART_PL)
 //	printf("buf_flush_insert_into_flush_list() space %zu page_no %zu oldest_lsn %zu\n", 
 //			block->page.id.space(), block->page.id.page_no(),
@@ -578,6 +591,30 @@ buf_flush_insert_sorted_into_flush_list(
 		UT_LIST_INSERT_AFTER(buf_pool->flush_list, prev_b, &block->page);
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (is_system_or_undo_tablespace(block->page.id.space())) {
+		prev_b = NULL;
+
+		b = UT_LIST_GET_FIRST(buf_pool->classic_flush_list);
+
+		while (b != NULL && b->oldest_modification
+		       > block->page.oldest_modification) {
+
+			ut_ad(b->in_flush_list);
+			prev_b = b;
+			b = UT_LIST_GET_NEXT(classic_list, b);
+		}
+
+		if (prev_b == NULL) {
+			UT_LIST_ADD_FIRST(buf_pool->classic_flush_list,
+					  &block->page);
+		} else {
+			UT_LIST_INSERT_AFTER(buf_pool->classic_flush_list,
+					     prev_b, &block->page);
+		}
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	incr_flush_list_size_in_bytes(block, buf_pool);
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
@@ -698,6 +735,12 @@ buf_flush_remove(
 		break;
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (is_system_or_undo_tablespace(bpage->id.space())) {
+		UT_LIST_REMOVE(buf_pool->classic_flush_list, bpage);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/* If the flush_rbt is active then delete from there as well. */
 	if (buf_pool->flush_rbt != NULL) {
 		buf_flush_delete_from_flush_rbt(bpage);
@@ -794,6 +837,22 @@ buf_flush_relocate_on_flush_list(
 	should be the same control block as in flush_rbt. */
 	ut_a(buf_pool->flush_rbt == NULL || prev_b == prev);
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (is_system_or_undo_tablespace(bpage->id.space())) {
+		buf_page_t*	classic_prev;
+
+		classic_prev = UT_LIST_GET_PREV(classic_list, bpage);
+		UT_LIST_REMOVE(buf_pool->classic_flush_list, bpage);
+
+		if (classic_prev) {
+			UT_LIST_INSERT_AFTER(buf_pool->classic_flush_list,
+					     classic_prev, dpage);
+		} else {
+			UT_LIST_ADD_FIRST(buf_pool->classic_flush_list, dpage);
+		}
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 	ut_a(buf_flush_validate_low(buf_pool));
 #endif /* UNIV_DEBUG || UNIV_BUF_DEBUG */
@@ -830,6 +889,16 @@ buf_flush_write_complete(
 	buf_dblwr_update(bpage, flush_type);
 #endif /* UNIV_PMEMOBJ_BUF */
 
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	if (srv_ppl_log_mode == PMEM_LOG_MODE_TX) {
+		/*release the log blocks pinned by this page*/
+		pm_ptxl_on_flush_page(
+				gb_pmw->pop, gb_pmw->ptxl,
+				bpage->id.fold(),
+				bpage->newest_modification);
+		return;
+	}
+#endif //UNIV_PMEMOBJ_TX_LOG
 #if defined (UNIV_PMEMOBJ_PART_PL)
 	//we only call pm_ppl_flush_page when the flushed page is persist on storage
 	pm_ppl_flush_page(
@@ -1074,9 +1143,29 @@ buf_flush_write_block_low(
 
 	ut_ad(bpage->newest_modification != 0);
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	buf_warm_invalidate(bpage->id);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	buf_vcache_invalidate(bpage->id);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 	/* Force the log to the disk before writing the modified block */
 	if (!srv_read_only_mode) {
-#if defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		/* WAL for the system and undo pages, whose newest_modification
+		is a log_sys lsn. The newest_modification of a user page is a
+		PPL time, not a log_sys lsn: the PPL records of the page are
+		persistent before the mtr releases it, but PPL recovery skips
+		them unless log_sys is recovered up to the undo or ibuf log
+		records they depend on. Force those before the page, which
+		has the changes, reaches the disk. */
+		if (mtr_t::is_classic_space(bpage->id.space())) {
+			log_write_up_to(bpage->newest_modification, true);
+		} else if (bpage->hybrid_dep_lsn > 0) {
+			log_write_up_to(bpage->hybrid_dep_lsn, true);
+		}
+#elif defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
 		//Since the log records are persist in NVM we don't need to follow WAL rule
 		//Skip flush log here
 #else //original 
@@ -1898,6 +1987,227 @@ buf_do_flush_list_batch(
 	return(count);
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+/** A dirty page whose PPL line is under log space pressure */
+struct buf_flush_ppl_cand_t {
+	ulint	pressure;	/*!< pressure_pct of the line */
+	ulint	space;		/*!< tablespace id */
+	ulint	page_no;	/*!< page number */
+};
+
+/** This utility flushes first the dirty blocks whose PPL line is under log
+space pressure. The oldest log block of a line holds the log file of the line
+from its start offset, so flushing its page gives back the most space on the
+lines nearest to the forced checkpoint. The candidates come from the end of
+the flush_list, they are ranked by the pressure of their line and keep the
+flush_list order within a line.
+The calling thread is not allowed to own any latches on pages!
+@param[in]	buf_pool	buffer pool instance
+@param[in]	min_n		wished minimum mumber of blocks flushed
+@param[in]	lsn_limit	only blocks whose oldest_modification is
+smaller than this are considered
+@return number of blocks for which the write request was queued */
+static
+ulint
+buf_do_ppl_pressure_flush_batch(
+	buf_pool_t*		buf_pool,
+	ulint			min_n,
+	lsn_t			lsn_limit)
+{
+	PMEM_PAGE_PART_LOG*	ppl = gb_pmw->ppl;
+	buf_flush_ppl_cand_t*	cands;
+	ulint			n_cands = 0;
+	ulint			scanned = 0;
+	ulint			count = 0;
+	ulint			scan_max;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	if (min_n == 0 || ppl->n_pressured_lines == 0) {
+		return(0);
+	}
+
+	/* The length is only a bound for the scan, the list is scanned
+	again under the flush_list mutex. */
+	scan_max = ut_min(UT_LIST_GET_LEN(buf_pool->flush_list),
+			  4 * ut_min(min_n, srv_max_io_capacity));
+
+	if (scan_max == 0) {
+		return(0);
+	}
+
+	cands = static_cast<buf_flush_ppl_cand_t*>(
+		ut_malloc_nokey(scan_max * sizeof(*cands)));
+
+	buf_flush_list_mutex_enter(buf_pool);
+
+	for (buf_page_t* bpage = UT_LIST_GET_LAST(buf_pool->flush_list);
+	     bpage != NULL && scanned < scan_max
+	     && bpage->oldest_modification < lsn_limit;
+	     bpage = UT_LIST_GET_PREV(list, bpage), ++scanned) {
+
+		PMEM_PAGE_LOG_HASHED_LINE*	pline;
+		uint64_t			key = bpage->id.fold();
+		uint64_t			hashed;
+		ulint				pressure;
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		/* these pages are logged in log_sys, not in PPL */
+		if (is_system_or_undo_tablespace(bpage->id.space())) {
+			continue;
+		}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
+		PMEM_LOG_HASH_KEY(hashed, key, ppl->n_buckets);
+		pline = D_RW(D_RW(ppl->buckets)[hashed]);
+
+		pressure = pline->pressure_pct;
+
+		if (pressure >= srv_ppl_flush_pressure_pct) {
+			cands[n_cands].pressure = pressure;
+			cands[n_cands].space = bpage->id.space();
+			cands[n_cands].page_no = bpage->id.page_no();
+			++n_cands;
+		}
+	}
+
+	buf_flush_list_mutex_exit(buf_pool);
+
+	std::stable_sort(cands, cands + n_cands,
+			 [](const buf_flush_ppl_cand_t& a,
+			    const buf_flush_ppl_cand_t& b) {
+				 return(a.pressure > b.pressure);
+			 });
+
+	for (ulint i = 0; i < n_cands && count < min_n; i++) {
+		const page_id_t	page_id(cands[i].space, cands[i].page_no);
+		rw_lock_t*	hash_lock;
+		buf_page_t*	bpage;
+
+		/* The page can not be evicted while we hold the
+		buf_pool mutex, it may have been flushed meanwhile. */
+		bpage = buf_page_hash_get_s_locked(buf_pool, page_id,
+						   &hash_lock);
+
+		if (bpage == NULL) {
+			continue;
+		}
+
+		rw_lock_s_unlock(hash_lock);
+
+		buf_flush_page_and_try_neighbors(
+			bpage, BUF_FLUSH_LIST, min_n, &count);
+	}
+
+	ut_free(cands);
+
+	if (count) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			count);
+	}
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	return(count);
+}
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** This utility flushes the dirty blocks of the system and undo tablespaces
+from the end of buf_pool->classic_flush_list. They hold back the log_sys
+checkpoint, and a flush_list batch may stop at a page with a newer PPL time
+before it reaches them, as the flush_list is not ordered across the two lsn
+domains. The page ids are taken under the flush_list mutex, the pages are
+looked up again to flush them.
+The calling thread is not allowed to own any latches on pages!
+@param[in]	buf_pool	buffer pool instance
+@param[in]	min_n		wished minimum mumber of blocks flushed
+@param[in]	lsn_limit	all blocks whose oldest_modification is smaller
+than this log_sys lsn should be flushed (if their number does not exceed min_n)
+@return number of blocks for which the write request was queued */
+static
+ulint
+buf_do_classic_flush_list_batch(
+	buf_pool_t*		buf_pool,
+	ulint			min_n,
+	lsn_t			lsn_limit)
+{
+	page_id_t*	ids;
+	ulint		n_ids = 0;
+	ulint		count = 0;
+	ulint		scan_max;
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	if (min_n == 0 || lsn_limit == 0) {
+		return(0);
+	}
+
+	/* The length is only a bound for the scan, the list is scanned
+	again under the flush_list mutex. */
+	scan_max = ut_min(UT_LIST_GET_LEN(buf_pool->classic_flush_list),
+			  ut_min(min_n, srv_max_io_capacity));
+
+	if (scan_max == 0) {
+		return(0);
+	}
+
+	ids = static_cast<page_id_t*>(
+		ut_malloc_nokey(scan_max * sizeof(*ids)));
+
+	buf_flush_list_mutex_enter(buf_pool);
+
+	for (buf_page_t* bpage
+		= UT_LIST_GET_LAST(buf_pool->classic_flush_list);
+	     bpage != NULL && n_ids < scan_max
+	     && bpage->oldest_modification < lsn_limit;
+	     bpage = UT_LIST_GET_PREV(classic_list, bpage)) {
+
+		ut_ad(bpage->in_flush_list);
+
+		new (&ids[n_ids++]) page_id_t(bpage->id);
+	}
+
+	buf_flush_list_mutex_exit(buf_pool);
+
+	for (ulint i = 0; i < n_ids && count < min_n; i++) {
+		rw_lock_t*	hash_lock;
+		buf_page_t*	bpage;
+
+		/* The page can not be evicted while we hold the
+		buf_pool mutex, it may have been flushed meanwhile. */
+		bpage = buf_page_hash_get_s_locked(buf_pool, ids[i],
+						   &hash_lock);
+
+		if (bpage == NULL) {
+			continue;
+		}
+
+		rw_lock_s_unlock(hash_lock);
+
+		buf_flush_page_and_try_neighbors(
+			bpage, BUF_FLUSH_LIST, min_n, &count);
+	}
+
+	ut_free(ids);
+
+	if (count) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			count);
+	}
+
+	ut_ad(buf_pool_mutex_own(buf_pool));
+
+	return(count);
+}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 /** This utility flushes dirty blocks from the end of the LRU list or
 flush_list.
 NOTE 1: in the case of an LRU flush the calling thread may own latches to
@@ -1932,6 +2242,18 @@ buf_flush_batch(
 	}
 #endif /* UNIV_DEBUG */
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* lsn_limit is a PPL time, see log_preflush_pool_modified_pages().
+	Translate it before the buf_pool mutex, the log mutex is above it
+	in the latching order. */
+	lsn_t	classic_lsn_limit = 0;
+	ulint	classic_count = 0;
+
+	if (flush_type == BUF_FLUSH_LIST) {
+		classic_lsn_limit = log_hybrid_time_to_lsn(lsn_limit);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	buf_pool_mutex_enter(buf_pool);
 
 	ulint	count = 0;
@@ -1943,7 +2265,34 @@ buf_flush_batch(
 		count = buf_do_LRU_batch(buf_pool, min_n);
 		break;
 	case BUF_FLUSH_LIST:
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		/* The log_sys pages first, they hold back the checkpoint */
+		classic_count = buf_do_classic_flush_list_batch(
+			buf_pool, min_n, classic_lsn_limit);
+
+		if (classic_count >= min_n) {
+			count = classic_count;
+			break;
+		}
+
+		min_n -= classic_count;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+		/* The pages of the pressured PPL lines first, then the
+		end of the flush_list for the remainder */
+		count = buf_do_ppl_pressure_flush_batch(
+			buf_pool, min_n, lsn_limit);
+
+		if (count < min_n) {
+			count += buf_do_flush_list_batch(
+				buf_pool, min_n - count, lsn_limit);
+		}
+#else
 		count = buf_do_flush_list_batch(buf_pool, min_n, lsn_limit);
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		count += classic_count;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 		break;
 	default:
 		ut_error;
@@ -2512,6 +2861,37 @@ af_get_pct_for_lsn(
 		/ 7.5));
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+/*********************************************************************//**
+Calculates if flushing is required based on the log space pressure of the
+PPL lines, log_sys->lsn does not show how full the per-line logs are.
+@return percent of io_capacity to flush to free PPL log space */
+static
+ulint
+af_get_pct_for_ppl_pressure(void)
+/*=============================*/
+{
+	ulint	max_pct = pm_ppl_get_max_pressure(gb_pmw->ppl);
+	ulint	ckpt_pct;
+	ulint	pressure_factor;
+
+	if (max_pct < srv_ppl_flush_pressure_pct) {
+		return(0);
+	}
+
+	/* 100 at the point the line requests a checkpoint, as the
+	max_async_age in af_get_pct_for_lsn() */
+	ckpt_pct = static_cast<ulint>(srv_ppl_ckpt_threshold * 100);
+	pressure_factor = (max_pct * 100) / ut_max(ckpt_pct, 1UL);
+
+	ut_ad(srv_max_io_capacity >= srv_io_capacity);
+	return(static_cast<ulint>(
+		((srv_max_io_capacity / srv_io_capacity)
+		* (pressure_factor * sqrt((double)pressure_factor)))
+		/ 7.5));
+}
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
+
 /*********************************************************************//**
 This function is called approximately once every second by the
 page_cleaner thread. Based on various factors it decides if there is a
@@ -2550,7 +2930,12 @@ page_cleaner_flush_pages_recommendation(
 		return(0);
 	}
 
-	if (prev_lsn == cur_lsn) {
+	if (prev_lsn == cur_lsn
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	    /* the PPL lines fill up without moving log_sys->lsn */
+	    && gb_pmw->ppl->n_pressured_lines == 0
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
+	    ) {
 		return(0);
 	}
 
@@ -2665,7 +3050,13 @@ page_cleaner_flush_pages_recommendation(
 		sum_pages = 0;
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The age is in the log_sys domain, the pages of the user
+	tablespaces carry PPL times */
+	oldest_lsn = buf_pool_get_oldest_classic_modification();
+#else
 	oldest_lsn = buf_pool_get_oldest_modification();
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	ut_ad(oldest_lsn <= log_get_lsn());
 
@@ -2675,6 +3066,9 @@ page_cleaner_flush_pages_recommendation(
 	pct_for_lsn = af_get_pct_for_lsn(age);
 
 	pct_total = ut_max(pct_for_dirty, pct_for_lsn);
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	pct_total = ut_max(pct_total, af_get_pct_for_ppl_pressure());
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
 
 	/* Estimate pages to be flushed for the lsn progress */
 	ulint	sum_pages_for_lsn = 0;
@@ -4158,6 +4552,7 @@ DECLARE_THREAD(pm_log_flusher_worker)(
 			os_thread_create */
 {
 	ulint i;
+	ulint first = 0;
 
 	PMEM_LOG_FLUSHER* flusher = gb_pmw->ppl->flusher;
 
@@ -4165,6 +4560,11 @@ DECLARE_THREAD(pm_log_flusher_worker)(
 
 	my_thread_init();
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*the workers are spread over the nodes*/
+	ulint node = pm_numa_bind_next_thread();
+#endif
+
 	mutex_enter(&flusher->mutex);
 	flusher->n_workers++;
 	os_event_reset(flusher->is_log_all_closed);
@@ -4177,7 +4577,18 @@ retry:
 		//looking for a full list in wait-list and flush it
 		mutex_enter(&flusher->mutex);
 		if (flusher->n_requested > 0) {
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+			/*start from a log buf whose data is on the node of this worker, if any*/
+			first = 0;
 			for (i = 0; i < flusher->size; i++) {
+				plogbuf = flusher->flush_list_arr[i];
+				if (plogbuf != NULL && plogbuf->node == node) {
+					first = i;
+					break;
+				}
+			}
+#endif
+			for (i = first; i < flusher->size; i++) {
 				plogbuf = flusher->flush_list_arr[i];
 				if (plogbuf != NULL)
 				{
@@ -4223,6 +4634,53 @@ retry:
 
 /////////// END FLUSHER /////////////////////
 
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+/*Background reclaimer of the PPL
+ * Resets the log blocks of the flushed pages and returns the finished log
+ * bufs posted by the IO completion path, see pm_ppl_reclaimer_drain()
+ * Exits when the page cleaners are gone and the queue is empty
+@return a dummy parameter */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(pm_ppl_reclaimer_thread)(
+/*==========================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	PMEM_PPL_RECLAIMER* reclaimer = gb_pmw->ppl->reclaimer;
+	int64_t sig_count;
+
+	my_thread_init();
+
+	os_atomic_increment_ulint(&reclaimer->n_workers, 1);
+
+	while (true) {
+		sig_count = os_event_reset(reclaimer->event);
+
+		if (pm_ppl_reclaimer_drain(gb_pmw->pop, gb_pmw->ppl) > 0) {
+			continue;
+		}
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_FLUSH_PHASE
+		    && !buf_page_cleaner_is_active) {
+			break;
+		}
+
+		/*wake up on a full batch, a log buf, or every 10ms*/
+		os_event_wait_time_low(reclaimer->event, 10000, sig_count);
+	}
+
+	os_atomic_decrement_ulint(&reclaimer->n_workers, 1);
+
+	my_thread_end();
+
+	os_thread_exit();
+
+	OS_THREAD_DUMMY_RETURN;
+}
+#endif /* UNIV_PMEMOBJ_PPL_RECLAIMER */
+
 /////////// REDOER /////////////////////
 
 /*
@@ -4392,6 +4850,14 @@ DECLARE_THREAD(pm_log_redoer_worker)(
 
 	printf("Redoers thread %zu lines_per_thread %zu created \n",idx, lines_per_thread);
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*the lines are split by node in contiguous ranges, so is the segment of this redoer*/
+	if (idx * lines_per_thread < redoer->size) {
+		pm_numa_bind_thread(pm_numa_node_of_line(
+					idx * lines_per_thread, redoer->size, gb_pmw->ppl->n_nodes));
+	}
+#endif
+
 	while (true) {
 		//worker thread wait until there is is_requested signal 
 retry:
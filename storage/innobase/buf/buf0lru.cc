@@ -50,6 +50,18 @@ Created 11/5/1995 Heikki Tuuri
 #include "srv0mon.h"
 #include "lock0lock.h"
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+#include "buf0dump.h"
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+#include "my_pmemobj.h"
+
+#include <unordered_map>
+
+extern PMEM_WRAPPER* gb_pmw;
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 /** The number of blocks from the LRU_old pointer onward, including
 the block pointed to, must be buf_pool->LRU_old_ratio/BUF_LRU_OLD_RATIO_DIV
 of the whole LRU list length, except that the tolerance defined below
@@ -950,7 +962,582 @@ buf_LRU_flush_or_remove_pages(
 
 		buf_LRU_remove_pages(buf_pool, id, buf_remove, trx);
 	}
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	buf_warm_invalidate_space(id);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	buf_vcache_invalidate_space(id);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+}
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+/* Victim cache on NVM
+===================
+Clean pages evicted from the buffer pool are copied to the slots of an NVM
+area and buf_read_page_low() looks a page up there before reading its
+datafile. The cache is exclusive: a hit frees the slot, the page is in the
+buffer pool again.
+
+Admission follows TinyLFU. A count-min sketch estimates how often a page
+was read from below the buffer pool, an evicted page takes a slot only if
+it was read more often than the least read page of a few slots after the
+hand. The counters are halved every BUF_VCACHE_SKETCH_SAMPLE reads per
+counter of a row, so the estimates follow the working set.
+
+A slot is reserved under buf_pool->mutex before the page leaves the page
+hash, and filled after the mutex is released. A page that is created or
+written meanwhile finds the reservation and cancels it, so a slot never
+holds an image older than the datafile page. The mapping is DRAM only, the
+area is reused empty on every start.
+
+The pages are split in shards by the fold of their page id. A shard has a
+range of the slots, its own map, sketch and hand, and its own mutex, so the
+reads and evictions of pages of different shards do not contend. A page is
+only admitted against the victims of its shard. */
+
+/** Number of rows of the frequency sketch */
+static const ulint	BUF_VCACHE_SKETCH_DEPTH = 4;
+
+/** Reads per counter of a row between two halvings of the sketch */
+static const ulint	BUF_VCACHE_SKETCH_SAMPLE = 10;
+
+/** A sketch counter saturates at this value */
+static const byte	BUF_VCACHE_SKETCH_MAX = 15;
+
+/** Number of valid slots compared to choose a victim */
+static const ulint	BUF_VCACHE_VICTIM_SAMPLE = 8;
+
+/** Maximum number of shards, each with BUF_VCACHE_VICTIM_SAMPLE slots
+or more */
+static const ulint	BUF_VCACHE_N_SHARDS = 16;
+
+/** Key of a page in the victim cache */
+#define BUF_VCACHE_KEY(id)						\
+	((static_cast<ib_uint64_t>((id).space()) << 32) | (id).page_no())
+
+/** State of a victim cache slot */
+enum buf_vcache_slot_state_t {
+	BUF_VCACHE_FREE,	/*!< not used */
+	BUF_VCACHE_FILLING,	/*!< reserved by an eviction, not readable */
+	BUF_VCACHE_VALID,	/*!< holds the datafile page */
+	BUF_VCACHE_READING	/*!< being copied to a buffer pool frame */
+};
+
+/** DRAM descriptor of a victim cache slot */
+struct buf_vcache_slot_t {
+	/** page of the slot, BUF_VCACHE_KEY() */
+	ib_uint64_t		key;
+	/** state of the slot */
+	buf_vcache_slot_state_t	state;
+	/** the reservation was cancelled, the fill frees the slot */
+	bool			stale;
+};
+
+/** Map from a page to its slot, for the filling and valid slots */
+typedef std::unordered_map<
+	ib_uint64_t,
+	ulint,
+	std::hash<ib_uint64_t>,
+	std::equal_to<ib_uint64_t>,
+	ut_allocator<std::pair<const ib_uint64_t, ulint> > >	buf_vcache_map_t;
+
+/** A shard of the victim cache: the pages of a page id fold hash value,
+a range of the slots and the frequency sketch of those pages */
+struct buf_vcache_shard_t {
+	/** protects all the fields below and the descriptors of the
+	slots of the shard */
+	ib_mutex_t		mutex;
+	/** first slot of the shard */
+	ulint			first;
+	/** number of slots of the shard */
+	ulint			n_slots;
+	/** next slot looked at for a victim, from 0 to n_slots - 1 */
+	ulint			hand;
+	/** slot of each page */
+	buf_vcache_map_t	pages;
+	/** frequency sketch, BUF_VCACHE_SKETCH_DEPTH rows of counters */
+	byte*			sketch;
+	/** counters per row - 1, a power of 2 minus 1 */
+	ulint			sketch_mask;
+	/** reads added since the last halving */
+	ulint			sketch_n_adds;
+	/** pages copied from the cache */
+	ulint			n_hits;
+	/** reads that missed the cache */
+	ulint			n_misses;
+	/** evicted pages given a slot */
+	ulint			n_admits;
+	/** evicted pages refused by the sketch */
+	ulint			n_rejects;
+	/** slots dropped by a page write, a page create or a space drop */
+	ulint			n_invalidates;
+};
+
+/** DRAM bookkeeping of the NVM victim cache */
+struct buf_vcache_t {
+	/** NVM slots */
+	PMEM_VCACHE*		pvcache;
+	/** number of slots */
+	ulint			n_slots;
+	/** slot descriptors */
+	buf_vcache_slot_t*	slots;
+	/** number of shards */
+	ulint			n_shards;
+	/** shards */
+	buf_vcache_shard_t*	shards;
+};
+
+/** The NVM victim cache */
+static buf_vcache_t*	buf_vcache = NULL;
+
+/** Gets the shard of a page.
+@param[in]	page_id	page
+@return shard */
+static inline
+buf_vcache_shard_t*
+buf_vcache_get_shard(
+	const page_id_t&	page_id)
+{
+	return(&buf_vcache->shards[
+		ut_hash_ulint(page_id.fold(), buf_vcache->n_shards)]);
+}
+
+/** Gets the counter of a page in a row of the sketch.
+@param[in]	shard	shard of the page
+@param[in]	key	page
+@param[in]	row	row of the sketch
+@return counter */
+static inline
+byte*
+buf_vcache_sketch_counter(
+	const buf_vcache_shard_t*	shard,
+	ib_uint64_t			key,
+	ulint				row)
+{
+	ib_uint64_t	h;
+
+	h = (key ^ (row * 0xC2B2AE3D27D4EB4FULL)) * 0x9E3779B97F4A7C15ULL;
+
+	return(shard->sketch
+	       + row * (shard->sketch_mask + 1)
+	       + (static_cast<ulint>(h >> 32) & shard->sketch_mask));
+}
+
+/** Estimates how often a page was read. The caller holds the mutex of
+the shard.
+@param[in]	shard	shard of the page
+@param[in]	key	page
+@return estimated number of reads */
+static
+ulint
+buf_vcache_sketch_estimate(
+	const buf_vcache_shard_t*	shard,
+	ib_uint64_t			key)
+{
+	ulint	freq = BUF_VCACHE_SKETCH_MAX;
+
+	for (ulint row = 0; row < BUF_VCACHE_SKETCH_DEPTH; row++) {
+		freq = ut_min(freq, static_cast<ulint>(
+			*buf_vcache_sketch_counter(shard, key, row)));
+	}
+
+	return(freq);
+}
+
+/** Counts a read of a page. Only the smallest counters are incremented
+(conservative update), which keeps the overestimate low. The caller holds
+the mutex of the shard.
+@param[in,out]	shard	shard of the page
+@param[in]	key	page */
+static
+void
+buf_vcache_sketch_add(
+	buf_vcache_shard_t*	shard,
+	ib_uint64_t		key)
+{
+	ulint	freq = buf_vcache_sketch_estimate(shard, key);
+
+	if (freq < BUF_VCACHE_SKETCH_MAX) {
+		for (ulint row = 0; row < BUF_VCACHE_SKETCH_DEPTH; row++) {
+			byte*	counter = buf_vcache_sketch_counter(
+				shard, key, row);
+
+			if (*counter == freq) {
+				(*counter)++;
+			}
+		}
+	}
+
+	if (++shard->sketch_n_adds
+	    >= BUF_VCACHE_SKETCH_SAMPLE * (shard->sketch_mask + 1)) {
+
+		ulint	n = BUF_VCACHE_SKETCH_DEPTH * (shard->sketch_mask + 1);
+
+		for (ulint i = 0; i < n; i++) {
+			shard->sketch[i] >>= 1;
+		}
+
+		shard->sketch_n_adds /= 2;
+	}
+}
+
+/** Opens or allocates the NVM victim cache and builds its DRAM
+bookkeeping, the cache starts empty. */
+void
+buf_vcache_init(void)
+{
+	PMEM_VCACHE*	pvcache;
+
+	if (pm_wrapper_vcache_alloc_or_open(
+			gb_pmw, srv_pmem_vcache_slots, UNIV_PAGE_SIZE)
+	    == PMEM_ERROR) {
+		ib::fatal() << "Cannot allocate the victim cache on PMEM";
+	}
+
+	pvcache = gb_pmw->pvcache;
+	ut_a(pvcache->slot_size == UNIV_PAGE_SIZE);
+
+	buf_vcache = UT_NEW_NOKEY(buf_vcache_t());
+
+	buf_vcache->pvcache = pvcache;
+	buf_vcache->n_slots = pvcache->n_slots;
+	buf_vcache->slots = UT_NEW_ARRAY_NOKEY(
+		buf_vcache_slot_t, buf_vcache->n_slots);
+
+	for (ulint i = 0; i < buf_vcache->n_slots; i++) {
+		buf_vcache->slots[i].key = 0;
+		buf_vcache->slots[i].state = BUF_VCACHE_FREE;
+		buf_vcache->slots[i].stale = false;
+	}
+
+	buf_vcache->n_shards = ut_max(static_cast<ulint>(1), ut_min(
+		BUF_VCACHE_N_SHARDS,
+		buf_vcache->n_slots / BUF_VCACHE_VICTIM_SAMPLE));
+	buf_vcache->shards = UT_NEW_ARRAY_NOKEY(
+		buf_vcache_shard_t, buf_vcache->n_shards);
+
+	for (ulint i = 0; i < buf_vcache->n_shards; i++) {
+		buf_vcache_shard_t*	shard = &buf_vcache->shards[i];
+		ulint			width;
+
+		mutex_create(LATCH_ID_BUF_VCACHE, &shard->mutex);
+
+		shard->first = i * buf_vcache->n_slots / buf_vcache->n_shards;
+		shard->n_slots = (i + 1) * buf_vcache->n_slots
+			/ buf_vcache->n_shards - shard->first;
+		shard->hand = 0;
+		shard->pages.reserve(shard->n_slots);
+
+		width = ut_2_power_up(shard->n_slots);
+		shard->sketch_mask = width - 1;
+		shard->sketch = static_cast<byte*>(
+			ut_zalloc_nokey(BUF_VCACHE_SKETCH_DEPTH * width));
+		shard->sketch_n_adds = 0;
+
+		shard->n_hits = 0;
+		shard->n_misses = 0;
+		shard->n_admits = 0;
+		shard->n_rejects = 0;
+		shard->n_invalidates = 0;
+	}
+
+	ib::info() << "Victim cache on PMEM: " << buf_vcache->n_slots
+		<< " slots in " << buf_vcache->n_shards << " shards";
+}
+
+/** Prints the victim cache counters and frees its DRAM bookkeeping. */
+void
+buf_vcache_free(void)
+{
+	ulint	n_hits = 0;
+	ulint	n_misses = 0;
+	ulint	n_admits = 0;
+	ulint	n_rejects = 0;
+	ulint	n_invalidates = 0;
+
+	if (buf_vcache == NULL) {
+		return;
+	}
+
+	for (ulint i = 0; i < buf_vcache->n_shards; i++) {
+		buf_vcache_shard_t*	shard = &buf_vcache->shards[i];
+
+		n_hits += shard->n_hits;
+		n_misses += shard->n_misses;
+		n_admits += shard->n_admits;
+		n_rejects += shard->n_rejects;
+		n_invalidates += shard->n_invalidates;
+
+		mutex_free(&shard->mutex);
+		ut_free(shard->sketch);
+	}
+
+	ib::info() << "Victim cache on PMEM: " << n_hits
+		<< " hits, " << n_misses << " misses, "
+		<< n_admits << " admitted, "
+		<< n_rejects << " rejected, "
+		<< n_invalidates << " invalidated pages";
+
+	UT_DELETE_ARRAY(buf_vcache->shards);
+	UT_DELETE_ARRAY(buf_vcache->slots);
+
+	UT_DELETE(buf_vcache);
+	buf_vcache = NULL;
+}
+
+/** Reserves a slot for a clean page that is being evicted. Called under
+buf_pool->mutex before the page is removed from the page hash.
+@param[in]	page_id	page being evicted
+@return slot to fill with buf_vcache_fill(), or ULINT_UNDEFINED if the
+page is not admitted */
+ulint
+buf_vcache_reserve(
+	const page_id_t&	page_id)
+{
+	ib_uint64_t		key = BUF_VCACHE_KEY(page_id);
+	buf_vcache_shard_t*	shard;
+	ulint			freq;
+	ulint			victim = ULINT_UNDEFINED;
+	ulint			victim_freq = ULINT_UNDEFINED;
+	ulint			n_sampled = 0;
+
+	if (buf_vcache == NULL) {
+		return(ULINT_UNDEFINED);
+	}
+
+	shard = buf_vcache_get_shard(page_id);
+
+	mutex_enter(&shard->mutex);
+
+	if (shard->pages.find(key) != shard->pages.end()) {
+		mutex_exit(&shard->mutex);
+		return(ULINT_UNDEFINED);
+	}
+
+	freq = buf_vcache_sketch_estimate(shard, key);
+
+	/* A free slot is taken at once, otherwise the victim is the
+	least read of the next valid slots of the shard. */
+	for (ulint n = 0;
+	     n < shard->n_slots && n_sampled < BUF_VCACHE_VICTIM_SAMPLE;
+	     n++) {
+
+		ulint			i = shard->first + shard->hand;
+		buf_vcache_slot_t*	slot = &buf_vcache->slots[i];
+
+		shard->hand = (shard->hand + 1) % shard->n_slots;
+
+		if (slot->state == BUF_VCACHE_FREE) {
+			victim = i;
+			victim_freq = 0;
+			break;
+		}
+
+		if (slot->state == BUF_VCACHE_VALID) {
+			ulint	slot_freq = buf_vcache_sketch_estimate(
+				shard, slot->key);
+
+			if (victim == ULINT_UNDEFINED
+			    || slot_freq < victim_freq) {
+				victim = i;
+				victim_freq = slot_freq;
+			}
+			n_sampled++;
+		}
+	}
+
+	if (victim == ULINT_UNDEFINED
+	    || (buf_vcache->slots[victim].state == BUF_VCACHE_VALID
+		&& freq <= victim_freq)) {
+
+		shard->n_rejects++;
+		mutex_exit(&shard->mutex);
+		return(ULINT_UNDEFINED);
+	}
+
+	if (buf_vcache->slots[victim].state == BUF_VCACHE_VALID) {
+		shard->pages.erase(buf_vcache->slots[victim].key);
+	}
+
+	buf_vcache->slots[victim].key = key;
+	buf_vcache->slots[victim].state = BUF_VCACHE_FILLING;
+	buf_vcache->slots[victim].stale = false;
+	shard->pages[key] = victim;
+
+	shard->n_admits++;
+
+	mutex_exit(&shard->mutex);
+
+	return(victim);
+}
+
+/** Copies an evicted page to its reserved slot. Called after the page
+left the page hash, with no buffer pool mutex held.
+@param[in]	slot	slot returned by buf_vcache_reserve()
+@param[in]	frame	page frame, not yet freed */
+void
+buf_vcache_fill(
+	ulint		slot,
+	const byte*	frame)
+{
+	buf_vcache_slot_t*	s = &buf_vcache->slots[slot];
+
+	ut_ad(s->state == BUF_VCACHE_FILLING);
+
+	/* The key was set by buf_vcache_reserve() in this thread and
+	does not change until the slot is freed. */
+	const page_id_t		page_id(static_cast<ulint>(s->key >> 32),
+					static_cast<ulint>(
+						s->key & ULINT32_MASK));
+	buf_vcache_shard_t*	shard = buf_vcache_get_shard(page_id);
+
+	pm_vcache_write_slot(buf_vcache->pvcache, slot, frame);
+
+	mutex_enter(&shard->mutex);
+
+	if (s->stale) {
+		/* buf_vcache_invalidate() removed the page from the map */
+		s->state = BUF_VCACHE_FREE;
+		s->stale = false;
+	} else {
+		s->state = BUF_VCACHE_VALID;
+	}
+
+	mutex_exit(&shard->mutex);
+}
+
+/** Copies a page from the victim cache to a buffer pool frame and frees
+its slot. The read is counted in the frequency sketch either way.
+@param[in]	page_id	page being read
+@param[out]	dst	frame of the page
+@return true if the page was in the cache */
+bool
+buf_vcache_read(
+	const page_id_t&	page_id,
+	byte*			dst)
+{
+	ib_uint64_t			key = BUF_VCACHE_KEY(page_id);
+	buf_vcache_shard_t*		shard;
+	buf_vcache_map_t::iterator	it;
+	ulint				slot;
+
+	if (buf_vcache == NULL) {
+		return(false);
+	}
+
+	shard = buf_vcache_get_shard(page_id);
+
+	mutex_enter(&shard->mutex);
+
+	buf_vcache_sketch_add(shard, key);
+
+	it = shard->pages.find(key);
+
+	if (it == shard->pages.end()
+	    || buf_vcache->slots[it->second].state != BUF_VCACHE_VALID) {
+
+		shard->n_misses++;
+		mutex_exit(&shard->mutex);
+		return(false);
+	}
+
+	slot = it->second;
+	shard->pages.erase(it);
+	buf_vcache->slots[slot].state = BUF_VCACHE_READING;
+	shard->n_hits++;
+
+	mutex_exit(&shard->mutex);
+
+	pm_vcache_read_slot(buf_vcache->pvcache, slot, dst);
+
+	mutex_enter(&shard->mutex);
+	buf_vcache->slots[slot].state = BUF_VCACHE_FREE;
+	mutex_exit(&shard->mutex);
+
+	return(true);
+}
+
+/** Drops the slot of a page. The caller holds the mutex of the shard.
+@param[in,out]	shard	shard of the page
+@param[in]	it	the page in shard->pages */
+static
+void
+buf_vcache_drop_low(
+	buf_vcache_shard_t*		shard,
+	buf_vcache_map_t::iterator	it)
+{
+	buf_vcache_slot_t*	s = &buf_vcache->slots[it->second];
+
+	if (s->state == BUF_VCACHE_FILLING) {
+		s->stale = true;
+	} else {
+		ut_ad(s->state == BUF_VCACHE_VALID);
+		s->state = BUF_VCACHE_FREE;
+	}
+
+	shard->pages.erase(it);
+	shard->n_invalidates++;
+}
+
+/** Drops the image of a page that is written to its datafile or created
+in the buffer pool, it would be older than the datafile page.
+@param[in]	page_id	page */
+void
+buf_vcache_invalidate(
+	const page_id_t&	page_id)
+{
+	buf_vcache_shard_t*		shard;
+	buf_vcache_map_t::iterator	it;
+
+	if (buf_vcache == NULL) {
+		return;
+	}
+
+	shard = buf_vcache_get_shard(page_id);
+
+	mutex_enter(&shard->mutex);
+
+	it = shard->pages.find(BUF_VCACHE_KEY(page_id));
+
+	if (it != shard->pages.end()) {
+		buf_vcache_drop_low(shard, it);
+	}
+
+	mutex_exit(&shard->mutex);
+}
+
+/** Drops the images of all the pages of a tablespace that is dropped,
+discarded or truncated, its id may be reused for other pages.
+@param[in]	space_id	tablespace id */
+void
+buf_vcache_invalidate_space(
+	ulint	space_id)
+{
+	if (buf_vcache == NULL) {
+		return;
+	}
+
+	for (ulint i = 0; i < buf_vcache->n_shards; i++) {
+		buf_vcache_shard_t*	shard = &buf_vcache->shards[i];
+
+		mutex_enter(&shard->mutex);
+
+		for (buf_vcache_map_t::iterator it = shard->pages.begin();
+		     it != shard->pages.end();) {
+
+			buf_vcache_map_t::iterator	cur = it++;
+
+			if ((cur->first >> 32) == space_id) {
+				buf_vcache_drop_low(shard, cur);
+			}
+		}
+
+		mutex_exit(&shard->mutex);
+	}
 }
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /********************************************************************//**
@@ -1875,6 +2462,9 @@ buf_LRU_free_page(
 	rw_lock_t*	hash_lock = buf_page_hash_lock_get(buf_pool, bpage->id);
 
 	BPageMutex*	block_mutex = buf_page_get_mutex(bpage);
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	ulint		vcache_slot = ULINT_UNDEFINED;
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 
 	ut_ad(buf_pool_mutex_own(buf_pool));
 	ut_ad(buf_page_in_file(bpage));
@@ -1927,7 +2517,24 @@ func_exit:
         ut_ad(rw_lock_own(hash_lock, RW_LOCK_X));
 	ut_ad(buf_page_can_relocate(bpage));
 
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	/* The slot is reserved while the page is still hashed, a create
+	or a read of the page after its removal must see the slot. */
+	if (b == NULL
+	    && buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE
+	    && !bpage->size.is_compressed()
+	    && bpage->oldest_modification == 0
+	    && !fsp_is_system_temporary(bpage->id.space())) {
+
+		vcache_slot = buf_vcache_reserve(bpage->id);
+	}
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 	if (!buf_LRU_block_remove_hashed(bpage, zip)) {
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+		/* only compressed-only pages are freed here */
+		ut_ad(vcache_slot == ULINT_UNDEFINED);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 		return(true);
 	}
 
@@ -2066,6 +2673,13 @@ func_exit:
 
 	UNIV_MEM_VALID(((buf_block_t*) bpage)->frame,
 		       UNIV_PAGE_SIZE);
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	/* The block is BUF_BLOCK_REMOVE_HASH, no other thread can reach
+	the frame until it is freed below. */
+	if (vcache_slot != ULINT_UNDEFINED) {
+		buf_vcache_fill(vcache_slot, ((buf_block_t*) bpage)->frame);
+	}
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 	btr_search_drop_page_hash_index((buf_block_t*) bpage);
 	UNIV_MEM_INVALID(((buf_block_t*) bpage)->frame,
 			 UNIV_PAGE_SIZE);
@@ -237,6 +237,23 @@ buf_read_page_low(
 	else {
   // if the page_id is not in pmem buffer, read it from disk as normal
 #endif /*UNIV_PMEMOBJ_BUF*/
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	if (!page_size.is_compressed()
+	    && buf_vcache_read(page_id, static_cast<byte*>(dst))) {
+
+		if (sync) {
+			thd_wait_end(NULL);
+		}
+
+		/* The copy is done, complete an async read here as well,
+		like a read from the PMEM buffer. */
+		if (!buf_page_io_complete(bpage)) {
+			return(0);
+		}
+
+		return(1);
+	}
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 	IORequest	request(type | IORequest::READ);
 
 	*err = fil_io(
@@ -923,7 +940,8 @@ pm_ppl_buf_read_recv_pages(
 	int read_ret;
 
 	if (space == NULL) {
-			printf("==== > recv_line %zu has space_id %zu NULL\n", recv_line->hashed_id, space_id);
+		ib::warn() << "PPL recovery line " << recv_line->hashed_id
+			<< " has recs of the missing tablespace " << space_id;
 		/* The tablespace is missing: do nothing */
 		return;
 	}
@@ -982,6 +1000,91 @@ pm_ppl_buf_read_recv_pages(
 	os_aio_simulated_wake_handler_threads();
 
 }
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+/*
+ * Issue a batch of the recovery read scheduler
+ * reqs are sorted by (space, page_no) and may belong to different lines,
+ * the reads are queued without waking the AIO handlers so that the
+ * neighbouring pages are merged, the handlers are woken once per batch.
+ * Only the simulated AIO handlers merge the requests
+ * (innodb_use_native_aio=OFF), the native AIO reads are submitted one by
+ * one, in page order.
+ * */
+void
+pm_ppl_buf_read_recv_sorted(
+	PMEMobjpool*			pop,
+	PMEM_PAGE_PART_LOG*		ppl,
+	const PMEM_RECV_IO_REQ*	reqs,
+	ulint					n_reqs)
+{
+	ulint			count;
+	dberr_t			err;
+	ulint			i;
+	ulint			cur_space_id = ULINT_UNDEFINED;
+	fil_space_t*	space = NULL;
+	int				read_ret;
+
+	for (i = 0; i < n_reqs; i++) {
+		buf_pool_t*		buf_pool;
+
+		if (reqs[i].space != cur_space_id) {
+			cur_space_id = reqs[i].space;
+			space = fil_space_get(cur_space_id);
+
+			if (space == NULL) {
+				ib::warn() << "PPL recovery line "
+					<< reqs[i].recv_line->hashed_id
+					<< " has recs of the missing tablespace "
+					<< cur_space_id;
+			} else {
+				fil_space_open_if_needed(space);
+			}
+		}
+
+		if (space == NULL) {
+			/* The tablespace is missing: do nothing */
+			continue;
+		}
+
+		const page_size_t	page_size(space->flags);
+		const page_id_t		cur_page_id(cur_space_id, reqs[i].page_no);
+
+		count = 0;
+
+		buf_pool = buf_pool_get(cur_page_id);
+
+		while (buf_pool->n_pend_reads >= recv_n_pool_free_frames / 2) {
+			/* let the queued reads complete */
+			os_aio_simulated_wake_handler_threads();
+			os_thread_sleep(10000);
+
+			count++;
+
+			if (!(count % 1000)) {
+
+				ib::error()
+					<< "Waited for " << count / 100
+					<< " seconds for "
+					<< buf_pool->n_pend_reads
+					<< " pending reads";
+			}
+		}
+
+		read_ret = buf_read_page_low(
+				&err, false,
+				IORequest::DO_NOT_WAKE,
+				BUF_READ_ANY_PAGE,
+				cur_page_id, page_size, true);
+
+		if (read_ret == 1){
+			__sync_fetch_and_add(&reqs[i].recv_line->n_read_reqs, 1);
+		}
+	}
+
+	os_aio_simulated_wake_handler_threads();
+}
+#endif //UNIV_PMEMOBJ_PPL_RECV_SCHED
 #endif //UNIV_PMEMOBJ_PART_PL
 
 /** Issues read requests for pages which recovery wants to read in.
@@ -7200,6 +7200,153 @@ pm_lsb_flush_spaces_in_list(
 }
 #endif //UNIV_PMEMOBJ_LSB
 #endif 
+#if defined (UNIV_IO_URING)
+/** fil_flush() of a set of tablespaces, the fsyncs of all their modified
+files are submitted together by os_file_flush_batch(). A space with a file
+already being flushed by another thread goes through fil_flush().
+@param[in]	space_ids	ids of the tablespaces
+@param[in]	n_space_ids	number of tablespaces */
+static
+void
+fil_flush_batch(
+	const ulint*	space_ids,
+	ulint		n_space_ids)
+{
+	fil_space_t**	spaces;
+	fil_node_t**	nodes;
+	int64_t*	mod_counters;
+	os_file_t*	files;
+	ulint*		deferred;
+	ulint		n_spaces = 0;
+	ulint		n_nodes = 0;
+	ulint		n_deferred = 0;
+	ulint		max_nodes = 0;
+
+	mutex_enter(&fil_system->mutex);
+
+	for (ulint i = 0; i < n_space_ids; i++) {
+		fil_space_t*	space = fil_space_get_by_id(space_ids[i]);
+
+		if (space != NULL) {
+			max_nodes += UT_LIST_GET_LEN(space->chain);
+		}
+	}
+
+	spaces = static_cast<fil_space_t**>(
+		ut_malloc_nokey(n_space_ids * sizeof(*spaces)));
+	deferred = static_cast<ulint*>(
+		ut_malloc_nokey(n_space_ids * sizeof(*deferred)));
+	nodes = static_cast<fil_node_t**>(
+		ut_malloc_nokey((max_nodes + 1) * sizeof(*nodes)));
+	mod_counters = static_cast<int64_t*>(
+		ut_malloc_nokey((max_nodes + 1) * sizeof(*mod_counters)));
+	files = static_cast<os_file_t*>(
+		ut_malloc_nokey((max_nodes + 1) * sizeof(*files)));
+
+	for (ulint i = 0; i < n_space_ids; i++) {
+		fil_space_t*	space = fil_space_get_by_id(space_ids[i]);
+		fil_node_t*	node;
+		bool		busy = false;
+
+		if (space == NULL
+		    || space->purpose != FIL_TYPE_TABLESPACE
+		    || space->stop_new_ops
+		    || space->is_being_truncated
+		    || fil_buffering_disabled(space)) {
+			continue;
+		}
+
+		for (node = UT_LIST_GET_FIRST(space->chain);
+		     node != NULL;
+		     node = UT_LIST_GET_NEXT(chain, node)) {
+
+			if (node->modification_counter > node->flush_counter
+			    && node->n_pending_flushes > 0) {
+				busy = true;
+				break;
+			}
+		}
+
+		if (busy) {
+			/* fil_flush() waits for the other flush */
+			deferred[n_deferred++] = space->id;
+			continue;
+		}
+
+		/* prevent dropping of the space while we are flushing */
+		space->n_pending_flushes++;
+		spaces[n_spaces++] = space;
+
+		for (node = UT_LIST_GET_FIRST(space->chain);
+		     node != NULL;
+		     node = UT_LIST_GET_NEXT(chain, node)) {
+
+			if (node->modification_counter
+			    <= node->flush_counter) {
+				continue;
+			}
+
+			ut_a(node->is_open);
+
+			fil_n_pending_tablespace_flushes++;
+			node->n_pending_flushes++;
+
+			nodes[n_nodes] = node;
+			mod_counters[n_nodes] = node->modification_counter;
+			files[n_nodes] = node->handle.m_file;
+			n_nodes++;
+		}
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	os_file_flush_batch(files, n_nodes);
+
+	mutex_enter(&fil_system->mutex);
+
+	for (ulint i = 0; i < n_nodes; i++) {
+		fil_node_t*	node = nodes[i];
+		fil_space_t*	space = node->space;
+
+		os_event_set(node->sync_event);
+
+		node->n_pending_flushes--;
+
+		if (node->flush_counter < mod_counters[i]) {
+			node->flush_counter = mod_counters[i];
+
+			if (space->is_in_unflushed_spaces
+			    && fil_space_is_flushed(space)) {
+
+				space->is_in_unflushed_spaces = false;
+
+				UT_LIST_REMOVE(
+					fil_system->unflushed_spaces,
+					space);
+			}
+		}
+
+		fil_n_pending_tablespace_flushes--;
+	}
+
+	for (ulint i = 0; i < n_spaces; i++) {
+		spaces[i]->n_pending_flushes--;
+	}
+
+	mutex_exit(&fil_system->mutex);
+
+	for (ulint i = 0; i < n_deferred; i++) {
+		fil_flush(deferred[i]);
+	}
+
+	ut_free(files);
+	ut_free(mod_counters);
+	ut_free(nodes);
+	ut_free(deferred);
+	ut_free(spaces);
+}
+#endif /* UNIV_IO_URING */
+
 /** Flush to disk the writes in file spaces of the given type
 possibly cached by the OS.
 @param[in]	purpose	FIL_TYPE_TABLESPACE or FIL_TYPE_LOG */
@@ -7245,6 +7392,14 @@ fil_flush_file_spaces(
 
 	mutex_exit(&fil_system->mutex);
 
+#if defined (UNIV_IO_URING)
+	if (srv_use_io_uring && purpose == FIL_TYPE_TABLESPACE) {
+		fil_flush_batch(space_ids, n_space_ids);
+		ut_free(space_ids);
+		return;
+	}
+#endif /* UNIV_IO_URING */
+
 	/* Flush the spaces.  It will not hurt to call fil_flush() on
 	a non-existing space id. */
 	for (ulint i = 0; i < n_space_ids; i++) {
@@ -8214,6 +8369,11 @@ fil_names_clear(
 
 	mtr.start();
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* Only the user tablespaces are named and their MLOG_FILE_NAME
+	records go to PPL, see pm_ppl_fil_names_clear(). log_sys only needs
+	the MLOG_CHECKPOINT marker. */
+#else
 	for (fil_space_t* space = UT_LIST_GET_FIRST(fil_system->named_spaces);
 	     space != NULL; ) {
 		fil_space_t*	next = UT_LIST_GET_NEXT(named_spaces, space);
@@ -8252,6 +8412,7 @@ fil_names_clear(
 
 		space = next;
 	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	if (do_write) {
 		mtr.commit_checkpoint(lsn, true);
@@ -8895,8 +9056,8 @@ pm_log_fil_io(
 	mode = OS_AIO_LOG;
 
 	//pointer to the src logbuf	
-	pdata = ppl->p_align;
-	log_src = pdata + plogbuf->pmemaddr;
+	pdata = PMEM_LOG_BUF_DATA(ppl, plogbuf);
+	log_src = pdata;
 
 	start_offset = 0;
 	end_offset = plogbuf->size;
@@ -8908,7 +9069,8 @@ pm_log_fil_io(
 	
 	assert(plogbuf->hashed_id >= 0);	
 	
-	group = ppl->log_groups[plogbuf->hashed_id];
+	/*opens the log file on the first write of the line*/
+	group = pm_ppl_get_log_group(pop, ppl, plogbuf->hashed_id);
 	
 	/*if the previous AIO is not finish while this AIO happen, write_diskaddr < diskaddr. 
 	 * Otherwise, write_diskaddr == diskaddr. 
@@ -8926,18 +9088,6 @@ pm_log_fil_io(
 	space = ppl->log_space;
 	node = ppl->node_arr[plogbuf->hashed_id];
 	
-	//open node if not
-	if (!node->is_open) {
-		bool success;
-		node->handle = os_file_create(
-				innodb_log_file_key, node->name, OS_FILE_OPEN,
-				OS_FILE_AIO, OS_LOG_FILE, false, &success);	   
-		if (!success){
-			printf("Cannot open log file %s handle %zu\n", node->name, node->handle);
-		}
-		node->is_open = true;
-	}
-	
 	/*if a log group is full, we extend it to double size*/
 	if (next_offset + len > group->file_size){
 		float size_temp = (group->file_size * 1.0) / (1024 * 1024);
@@ -8995,21 +9145,10 @@ pm_log_fil_read(
 	mode = OS_AIO_SYNC;
 	//mode = OS_AIO_LOG;
 
-	group = ppl->log_groups[pline->hashed_id];
-
+	group = pm_ppl_get_log_group(pop, ppl, pline->hashed_id);
 
 	space = ppl->log_space;
 	node = ppl->node_arr[pline->hashed_id];
-	if (!node->is_open) {
-		bool success;
-		node->handle = os_file_create(
-				innodb_log_file_key, node->name, OS_FILE_OPEN,
-				OS_FILE_AIO, OS_LOG_FILE, false, &success);	   
-		if (!success){
-			printf("Cannot open log file %s handle %zu\n", node->name, node->handle);
-		}
-		node->is_open = true;
-	}
 
 	err = os_aio(
 		req_type,
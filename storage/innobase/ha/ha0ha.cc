@@ -196,6 +196,57 @@ ha_clear(
 	}
 }
 
+#if defined (UNIV_AHI_EPOCH)
+/** Take a retired node whose grace period is over. Lock-free readers
+that entered an epoch before the node was retired may still be on it, the
+node is free when the epoch has advanced twice since then.
+@param[in,out]	table	hash table
+@return node, or NULL if none is free */
+static
+ha_node_t*
+ha_get_free_node(
+	hash_table_t*	table)
+{
+	if (table->free_nodes == NULL && table->retired != NULL) {
+		ulint	epoch = btr_search_epoch_try_advance();
+
+		while (table->retired != NULL
+		       && table->retired->retire_epoch + 2 <= epoch) {
+
+			ha_node_t*	node = table->retired;
+
+			table->retired = node->retired_next;
+			node->retired_next = table->free_nodes;
+			table->free_nodes = node;
+		}
+
+		if (table->retired == NULL) {
+			table->retired_last = NULL;
+		}
+	}
+
+	ha_node_t*	node = table->free_nodes;
+
+	if (node != NULL) {
+		table->free_nodes = node->retired_next;
+	}
+
+	return(node);
+}
+
+/** Forget the retired and free nodes of a hash table, when its heap is
+emptied.
+@param[in,out]	table	hash table */
+void
+ha_forget_retired(
+	hash_table_t*	table)
+{
+	table->retired = NULL;
+	table->retired_last = NULL;
+	table->free_nodes = NULL;
+}
+#endif /* UNIV_AHI_EPOCH */
+
 /*************************************************************//**
 Inserts an entry into a hash table. If an entry with the same fold number
 is found, its node is updated to point to the new data, and no new node
@@ -262,8 +313,18 @@ ha_insert_for_fold_func(
 
 	/* We have to allocate a new chain node */
 
+#if defined (UNIV_AHI_EPOCH)
+	node = ha_get_free_node(table);
+
+	if (node == NULL) {
+		node = static_cast<ha_node_t*>(
+			mem_heap_alloc(hash_get_heap(table, fold),
+				       sizeof(ha_node_t)));
+	}
+#else
 	node = static_cast<ha_node_t*>(
 		mem_heap_alloc(hash_get_heap(table, fold), sizeof(ha_node_t)));
+#endif /* UNIV_AHI_EPOCH */
 
 	if (node == NULL) {
 		/* It was a btr search type memory heap and at the moment
@@ -287,6 +348,11 @@ ha_insert_for_fold_func(
 
 	node->next = NULL;
 
+#if defined (UNIV_AHI_EPOCH)
+	/* Lock-free readers must see the fields before the node */
+	os_wmb;
+#endif /* UNIV_AHI_EPOCH */
+
 	prev_node = static_cast<ha_node_t*>(cell->node);
 
 	if (prev_node == NULL) {
@@ -345,7 +411,39 @@ ha_delete_hash_node(
 	}
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 
+#if defined (UNIV_AHI_EPOCH)
+	hash_cell_t*	cell = hash_get_nth_cell(
+		table, hash_calc_hash(del_node->fold, table));
+
+	/* Unlink the node but keep its next pointer and its place in the
+	heap: a lock-free reader on it goes on in the chain, the node is
+	reused after a grace period */
+	if (cell->node == del_node) {
+		cell->node = del_node->next;
+	} else {
+		ha_node_t*	prev = static_cast<ha_node_t*>(cell->node);
+
+		while (prev->next != del_node) {
+			prev = prev->next;
+			ut_a(prev != NULL);
+		}
+
+		prev->next = del_node->next;
+	}
+
+	del_node->retired_next = NULL;
+	del_node->retire_epoch = btr_search_epoch_retire();
+
+	if (table->retired_last != NULL) {
+		table->retired_last->retired_next = del_node;
+	} else {
+		table->retired = del_node;
+	}
+
+	table->retired_last = del_node;
+#else
 	HASH_DELETE_AND_COMPACT(ha_node_t, next, table, del_node);
+#endif /* UNIV_AHI_EPOCH */
 }
 
 /*********************************************************//**
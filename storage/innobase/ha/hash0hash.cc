@@ -286,6 +286,11 @@ hash_create(
 	table->heaps = NULL;
 #endif /* !UNIV_HOTBACKUP */
 	table->heap = NULL;
+#if defined (UNIV_AHI_EPOCH)
+	table->retired = NULL;
+	table->retired_last = NULL;
+	table->free_nodes = NULL;
+#endif /* UNIV_AHI_EPOCH */
 	ut_d(table->magic_n = HASH_TABLE_MAGIC_N);
 
 	/* Initialize the cell array */
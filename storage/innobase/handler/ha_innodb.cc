@@ -92,6 +92,9 @@ this program; if not, write to the Free Software Foundation, Inc.,
 #include "row0ins.h"
 #include "row0merge.h"
 #include "row0mysql.h"
+#if defined (UNIV_PARALLEL_READ)
+#include "row0pread.h"
+#endif /* UNIV_PARALLEL_READ */
 #include "row0quiesce.h"
 #include "row0sel.h"
 #include "row0trunc.h"
@@ -433,11 +436,13 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 #  endif /* UNIV_DEBUG */
 	PSI_KEY(buf_dblwr_mutex),
 	PSI_KEY(trx_undo_mutex),
+	PSI_KEY(trx_undo_nvm_mutex),
 	PSI_KEY(trx_pool_mutex),
 	PSI_KEY(trx_pool_manager_mutex),
 	PSI_KEY(srv_sys_mutex),
 	PSI_KEY(lock_mutex),
 	PSI_KEY(lock_wait_mutex),
+	PSI_KEY(lock_sys_shard_mutex),
 	PSI_KEY(trx_mutex),
 	PSI_KEY(srv_threads_mutex),
 #  ifndef PFS_SKIP_EVENT_MUTEX
@@ -449,6 +454,8 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	PSI_KEY(rtr_path_mutex),
 	PSI_KEY(rtr_ssn_mutex),
 	PSI_KEY(trx_sys_mutex),
+	PSI_KEY(trx_sys_csn_mutex),
+	PSI_KEY(mvcc_mutex),
 	PSI_KEY(thread_mutex),
 	PSI_KEY(sync_array_mutex),
 	PSI_KEY(zip_pad_mutex),
@@ -480,6 +487,13 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	PSI_RWLOCK_KEY(index_online_log),
 	PSI_RWLOCK_KEY(dict_table_stats),
 	PSI_RWLOCK_KEY(hash_table_locks),
+#if defined (UNIV_PMEMOBJ_PART_PL)
+	PSI_KEY(pm_ppl_line_lock),
+	PSI_KEY(pm_ppl_line_meta_lock),
+	PSI_KEY(pm_ppl_free_pool_lock),
+	PSI_KEY(pm_ppl_ckpt_lock),
+	PSI_KEY(pm_ppl_tt_entry_lock),
+#endif
 };
 # endif /* UNIV_PFS_RWLOCK */
 
@@ -521,7 +535,10 @@ performance schema instrumented if "UNIV_PFS_IO" is defined */
 static PSI_file_info	all_innodb_files[] = {
 	PSI_KEY(innodb_data_file),
 	PSI_KEY(innodb_log_file),
-	PSI_KEY(innodb_temp_file)
+	PSI_KEY(innodb_temp_file),
+#if defined (UNIV_PMEMOBJ_PART_PL)
+	PSI_KEY(pm_ppl_persist_file),
+#endif
 };
 # endif /* UNIV_PFS_IO */
 #endif /* HAVE_PSI_INTERFACE */
@@ -912,6 +929,10 @@ static SHOW_VAR innodb_status_variables[]= {
   (char*) &export_vars.innodb_rows_inserted,		  SHOW_LONG, SHOW_SCOPE_GLOBAL},
   {"rows_read",
   (char*) &export_vars.innodb_rows_read,		  SHOW_LONG, SHOW_SCOPE_GLOBAL},
+#if defined (UNIV_BATCHED_FETCH)
+  {"rows_read_batched",
+  (char*) &export_vars.innodb_rows_read_batched,	  SHOW_LONG, SHOW_SCOPE_GLOBAL},
+#endif /* UNIV_BATCHED_FETCH */
   {"rows_updated",
   (char*) &export_vars.innodb_rows_updated,		  SHOW_LONG, SHOW_SCOPE_GLOBAL},
   {"num_open_files",
@@ -2813,7 +2834,7 @@ ha_innobase::ha_innobase(
 			  | HA_CAN_FULLTEXT
 			  | HA_CAN_FULLTEXT_EXT
 			  | HA_CAN_FULLTEXT_HINTS
-#ifdef WL6742
+#if defined(WL6742) || defined(UNIV_PARALLEL_READ)
 			  | HA_HAS_RECORDS
 #endif
 			  | HA_CAN_EXPORT
@@ -2822,6 +2843,9 @@ ha_innobase::ha_innobase(
 			  | HA_GENERATED_COLUMNS
 			  | HA_ATTACHABLE_TRX_COMPATIBLE
 			  | HA_CAN_INDEX_VIRTUAL_GENERATED_COLUMN
+#if defined (UNIV_BATCHED_FETCH)
+			  | HA_READ_BATCH
+#endif /* UNIV_BATCHED_FETCH */
 		  ),
 	m_start_of_scan(),
 	m_num_write_row(),
@@ -3719,6 +3743,31 @@ innobase_init(
 		srv_aio_n_slots_per_seg = 256;
 	}
 #endif
+#if defined(UNIV_LOCK_SYS_SHARDED)
+	if (!srv_lock_sys_n_shards) {
+		srv_lock_sys_n_shards = 64;
+	}
+#endif
+#if defined(UNIV_MVCC_CSN)
+	if (!srv_mvcc_csn_slots) {
+		srv_mvcc_csn_slots = 1048576;
+	}
+#endif
+#if defined(UNIV_LOG_CONCURRENT_COPY)
+	if (!srv_log_recent_written_size) {
+		srv_log_recent_written_size = 1048576;
+	}
+#endif
+#if defined(UNIV_PARALLEL_INDEX_BUILD)
+	if (!srv_parallel_index_build_threads) {
+		srv_parallel_index_build_threads = 4;
+	}
+#endif
+#if defined(UNIV_PARALLEL_READ)
+	if (!srv_parallel_read_threads) {
+		srv_parallel_read_threads = 4;
+	}
+#endif
 #if defined(UNIV_PMEMOBJ_BUF) || defined (UNIV_PMEMOBJ_DBW) || defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PART_PL)
 	if (!srv_pmem_home_dir) {
 		srv_pmem_home_dir = (char*) "/mnt/pmem1";
@@ -3762,6 +3811,46 @@ innobase_init(
 	if (!srv_ppl_n_redoer_threads) {
 		srv_ppl_n_redoer_threads = 32;
 	}
+	if (!srv_ppl_n_init_threads) {
+		srv_ppl_n_init_threads = 8;
+	}
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	if (!srv_ppl_recv_read_batch) {
+		srv_ppl_recv_read_batch = 1024;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	if (!srv_ptxl_n_buckets) {
+		srv_ptxl_n_buckets = 128;
+	}
+	if (!srv_ptxl_blocks_per_bucket) {
+		srv_ptxl_blocks_per_bucket = 64;
+	}
+	if (!srv_ptxl_block_size) {
+		srv_ptxl_block_size = 64 * 1024;
+	}
+	if (!srv_ptxl_dpt_n_lines) {
+		srv_ptxl_dpt_n_lines = 512;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	if (!srv_ppl_reclaim_queue_size) {
+		srv_ppl_reclaim_queue_size = 65536;
+	}
+	if (!srv_ppl_reclaim_batch) {
+		srv_ppl_reclaim_batch = 256;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	if (!srv_ppl_magazine_size) {
+		srv_ppl_magazine_size = 8;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	if (!srv_ppl_flush_pressure_pct) {
+		srv_ppl_flush_pressure_pct = 50;
+	}
+#endif
 	if (!srv_ppl_log_file_size) {
 		srv_ppl_log_file_size = 16*1024;
 	}
@@ -3774,6 +3863,31 @@ innobase_init(
 		srv_pmem_sim_latency = 1000 ; //1000 ns
 	}
 #endif
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	if (!srv_pmem_dbw_slots_per_part) {
+		srv_pmem_dbw_slots_per_part = 128;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	if (!srv_pmem_log_spill_interval) {
+		srv_pmem_log_spill_interval = 100;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_UNDO)
+	if (!srv_pmem_undo_slots) {
+		srv_pmem_undo_slots = 1024;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	if (!srv_pmem_warm_slots) {
+		srv_pmem_warm_slots = 65536;
+	}
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	if (!srv_pmem_vcache_slots) {
+		srv_pmem_vcache_slots = 65536;
+	}
+#endif
 
 #if defined(UNIV_PMEMOBJ_BUF) 
 	if (!srv_pmem_buf_bucket_size) {
@@ -9217,6 +9331,68 @@ ha_innobase::index_next(
 	return(general_fetch(buf, ROW_SEL_NEXT, 0));
 }
 
+#if defined (UNIV_BATCHED_FETCH)
+/** Move the rows left in the fetch cache by the last fetch behind the row
+it returned. They were converted under the page latch by row_search_mvcc(),
+the batch is the same rows that the next fetches would pop.
+@param[in,out]	buf		first row of the batch, the others are
+stored every table->s->rec_buff_length bytes
+@param[in]	max_rows	rows in the batch buffer
+@return number of rows in the batch, 1 or more */
+uint
+ha_innobase::fetch_cached_rows(
+	uchar*	buf,
+	uint	max_rows)
+{
+	/* A pushed index condition is evaluated on record[0], and
+	keep_other_fields_on_keyread keeps the columns already in buf:
+	these fetches return one row */
+	if (max_rows == 1
+	    || m_prebuilt->n_fetch_cached == 0
+	    || m_prebuilt->idx_cond
+	    || m_prebuilt->keep_other_fields_on_keyread) {
+
+		return(1);
+	}
+
+	ulint	n = row_sel_dequeue_cached_rows_for_mysql(
+		buf + table->s->rec_buff_length, table->s->rec_buff_length,
+		max_rows - 1, m_prebuilt);
+
+	srv_stats.n_rows_read.add(
+		thd_get_thread_id(m_prebuilt->trx->mysql_thd), n);
+
+	return(static_cast<uint>(n + 1));
+}
+
+/** Reads the next rows from a cursor, the first one is fetched as in
+index_next() and the rows cached by that fetch follow it.
+@param[out]	buf		batch buffer
+@param[in]	max_rows	rows in the batch buffer
+@param[out]	n_rows		number of rows read
+@return 0, HA_ERR_END_OF_FILE, or error number */
+int
+ha_innobase::index_next_batch(
+	uchar*	buf,
+	uint	max_rows,
+	uint*	n_rows)
+{
+	int	error = index_next(buf);
+
+	if (error == 0) {
+		*n_rows = fetch_cached_rows(buf, max_rows);
+
+		for (uint i = 1; i < *n_rows; i++) {
+			ha_statistic_increment(&SSV::ha_read_next_count);
+		}
+
+		srv_stats.n_rows_read_batched.add(*n_rows - 1);
+	}
+
+	return(error);
+}
+#endif /* UNIV_BATCHED_FETCH */
+
 /*******************************************************************//**
 Reads the next row matching to the key value given as the parameter.
 @return 0, HA_ERR_END_OF_FILE, or error number */
@@ -9374,6 +9550,34 @@ ha_innobase::rnd_next(
 	DBUG_RETURN(error);
 }
 
+#if defined (UNIV_BATCHED_FETCH)
+/** Reads the next rows in a table scan, see index_next_batch().
+@param[out]	buf		batch buffer
+@param[in]	max_rows	rows in the batch buffer
+@param[out]	n_rows		number of rows read
+@return 0, HA_ERR_END_OF_FILE, or error number */
+int
+ha_innobase::rnd_next_batch(
+	uchar*	buf,
+	uint	max_rows,
+	uint*	n_rows)
+{
+	int	error = rnd_next(buf);
+
+	if (error == 0) {
+		*n_rows = fetch_cached_rows(buf, max_rows);
+
+		for (uint i = 1; i < *n_rows; i++) {
+			ha_statistic_increment(&SSV::ha_read_rnd_next_count);
+		}
+
+		srv_stats.n_rows_read_batched.add(*n_rows - 1);
+	}
+
+	return(error);
+}
+#endif /* UNIV_BATCHED_FETCH */
+
 /**********************************************************************//**
 Fetches a row from the table based on a row reference.
 @return 0, HA_ERR_KEY_NOT_FOUND, or error code */
@@ -13423,7 +13627,7 @@ ha_innobase::rename_table(
 
 
 
-#ifdef WL6742
+#if defined(WL6742) || defined(UNIV_PARALLEL_READ)
 
 /*********************************************************************//**
 
@@ -13496,16 +13700,36 @@ ha_innobase::records(
 		DBUG_RETURN(HA_ERR_TABLE_DEF_CHANGED);
 	}
 
-	/* (Re)Build the m_prebuilt->mysql_template if it is null to use
-	the clustered index and just the key, no off-record data. */
-	m_prebuilt->index = index;
-	dtuple_set_n_fields(m_prebuilt->search_tuple, 0);
-	m_prebuilt->read_just_key = 1;
-	build_template(false);
+#if defined (UNIV_PARALLEL_READ)
+	if (m_prebuilt->select_lock_type == LOCK_NONE
+	    && !dict_table_is_intrinsic(m_prebuilt->table)) {
+		/* Count the records in the clustered index */
+		ret = row_pread_count(m_prebuilt->trx, index,
+				      srv_parallel_read_threads, &n_rows);
+	} else
+#endif /* UNIV_PARALLEL_READ */
+	{
+		/* The parallel reader does consistent reads only, the
+		locking reads and the intrinsic tables are counted by
+		the serial scan. The server ignores an error of
+		records() in some callers. */
+
+		/* (Re)Build the m_prebuilt->mysql_template if it is null
+		to use the clustered index and just the key, no
+		off-record data. */
+		m_prebuilt->index = index;
+		dtuple_set_n_fields(m_prebuilt->search_tuple, 0);
+		m_prebuilt->read_just_key = 1;
+		build_template(false);
 
-	/* Count the records in the clustered index */
-	ret = row_scan_index_for_mysql(m_prebuilt, index, false, &n_rows);
-	reset_template();
+		/* Count the records in the clustered index */
+		ret = row_scan_index_for_mysql(m_prebuilt, index,
+#ifdef WL6742
+					       false,
+#endif
+					       &n_rows);
+		reset_template();
+	}
 	switch (ret) {
 	case DB_SUCCESS:
 		break;
@@ -13537,6 +13761,60 @@ ha_innobase::records(
 }
 #endif
 
+#if defined (UNIV_PARALLEL_READ)
+/*********************************************************************//**
+Reads the clustered index of the table with the parallel reader, in the
+read view of the transaction, for the callers that can consume the rows
+from several threads. The callback gets the InnoDB records of the read
+view, see row_pread_scan(). Locking reads are not supported.
+@param[in]	n_threads	number of scan threads, 0 for
+innodb_parallel_read_threads
+@param[in]	func		callback
+@param[in,out]	arg		argument of the callback
+@return 0 or error number */
+
+int
+ha_innobase::parallel_scan(
+	ulint			n_threads,
+	row_pread_func_t	func,
+	void*			arg)
+{
+	DBUG_ENTER("ha_innobase::parallel_scan");
+
+	update_thd();
+
+	if (dict_table_is_discarded(m_prebuilt->table)
+	    || m_prebuilt->table->ibd_file_missing) {
+		DBUG_RETURN(HA_ERR_TABLESPACE_MISSING);
+	} else if (m_prebuilt->table->corrupted) {
+		DBUG_RETURN(HA_ERR_INDEX_CORRUPT);
+	} else if (m_prebuilt->select_lock_type != LOCK_NONE
+		   || dict_table_is_intrinsic(m_prebuilt->table)) {
+		DBUG_RETURN(HA_ERR_WRONG_COMMAND);
+	}
+
+	TrxInInnoDB	trx_in_innodb(m_prebuilt->trx);
+
+	dict_index_t*	index = dict_table_get_first_index(m_prebuilt->table);
+
+	if (!row_merge_is_index_usable(m_prebuilt->trx, index)) {
+		DBUG_RETURN(HA_ERR_TABLE_DEF_CHANGED);
+	}
+
+	m_prebuilt->trx->op_info = "parallel scan";
+
+	dberr_t	err = row_pread_scan(
+		m_prebuilt->trx, index,
+		n_threads > 0 ? n_threads : srv_parallel_read_threads,
+		func, arg);
+
+	m_prebuilt->trx->op_info = "";
+
+	DBUG_RETURN(convert_error_code_to_mysql(
+		err, m_prebuilt->table->flags, m_user_thd));
+}
+#endif /* UNIV_PARALLEL_READ */
+
 /*********************************************************************//**
 Estimates the number of index records in a range.
 @return estimated number of rows */
@@ -14739,6 +15017,16 @@ ha_innobase::check(
 		/* Scan this index. */
 		if (dict_index_is_spatial(index)) {
 			ret = row_count_rtree_recs(m_prebuilt, &n_rows);
+#if defined (UNIV_PARALLEL_READ)
+		} else if (dict_index_is_clust(index)
+			   && srv_parallel_read_threads > 1
+			   && !dict_table_is_intrinsic(m_prebuilt->table)) {
+			/* The secondary indexes are scanned in the same
+			read view, assigned by the parallel reader */
+			ret = row_scan_index_parallel_for_mysql(
+				m_prebuilt, index, srv_parallel_read_threads,
+				&n_rows);
+#endif /* UNIV_PARALLEL_READ */
 		} else {
 			ret = row_scan_index_for_mysql(
 				m_prebuilt, index, &n_rows);
@@ -19593,6 +19881,46 @@ static MYSQL_SYSVAR_ULONG(aio_n_slots_per_seg, srv_aio_n_slots_per_seg,
   "Max number of slots per segment in AIO, from 1 to 65536, default is 256.",
   NULL, NULL, 256, 1, 65536, 0);
 #endif 
+#if defined(UNIV_LOCK_SYS_SHARDED)
+static MYSQL_SYSVAR_ULONG(lock_sys_n_shards, srv_lock_sys_n_shards,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of shards of the lock system, record and table locks are latched by the shard of their page or table, from 1 to 1024, default is 64.",
+  NULL, NULL, 64, 1, 1024, 0);
+#endif
+#if defined(UNIV_MVCC_CSN)
+static MYSQL_SYSVAR_ULONG(mvcc_csn_slots, srv_mvcc_csn_slots,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of slots of the map from transaction id to commit sequence number, rounded up to a power of 2, from 1024 to 1073741824, default is 1048576.",
+  NULL, NULL, 1048576, 1024, 1073741824, 0);
+#endif
+#if defined(UNIV_LOG_CONCURRENT_COPY)
+static MYSQL_SYSVAR_ULONG(log_recent_written_size, srv_log_recent_written_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size in bytes of the redo log window copied concurrently into the log buffer, rounded up to a power of 2, from 4096 to 1073741824, default is 1048576.",
+  NULL, NULL, 1048576, 4096, 1073741824, 0);
+#endif
+#if defined(UNIV_IO_URING)
+static MYSQL_SYSVAR_BOOL(use_io_uring, srv_use_io_uring,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Use io_uring instead of libaio for Linux native AIO, needs innodb_use_native_aio (enabled by default).",
+  NULL, NULL, TRUE);
+static MYSQL_SYSVAR_BOOL(io_uring_poll, srv_io_uring_poll,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Poll the io_uring completions of the tablespace i/o, needs innodb_flush_method = O_DIRECT or O_DIRECT_NO_FSYNC (disabled by default).",
+  NULL, NULL, FALSE);
+#endif
+#if defined(UNIV_PARALLEL_INDEX_BUILD)
+static MYSQL_SYSVAR_ULONG(parallel_index_build_threads, srv_parallel_index_build_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads scanning the clustered index and loading the secondary indexes when indexes are added to a table that is not rebuilt, 1 for the serial build, from 1 to 64, default is 4.",
+  NULL, NULL, 4, 1, 64, 0);
+#endif
+#if defined(UNIV_PARALLEL_READ)
+static MYSQL_SYSVAR_ULONG(parallel_read_threads, srv_parallel_read_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads reading the clustered index in key ranges for COUNT(*) and CHECK TABLE, 1 reads in the user thread, from 1 to 64, default is 4.",
+  NULL, NULL, 4, 1, 64, 0);
+#endif
 #if defined(UNIV_PMEMOBJ_BUF_FLUSHER)
 static MYSQL_SYSVAR_ULONG(pmem_n_flush_threads, srv_pmem_n_flush_threads,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
@@ -19635,6 +19963,41 @@ static MYSQL_SYSVAR_ULONG(pmem_sim_latency, srv_pmem_sim_latency,
   NULL, NULL, 1000, 1, 10000000,0);
 #endif
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+static MYSQL_SYSVAR_ULONG(pmem_dbw_slots_per_part, srv_pmem_dbw_slots_per_part,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of PMEM double write slots (pages) per page cleaner partition, used when the PMEM double write buffer is created, from 1 to 65536, default is 128.",
+  NULL, NULL, 128, 1, 65536, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+static MYSQL_SYSVAR_ULONG(pmem_log_spill_interval, srv_pmem_log_spill_interval,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Milliseconds between two writes of the NVM log buffer to the redo log files, the spill thread also wakes up when the log buffer is half full, from 1 to 10000, default is 100.",
+  NULL, NULL, 100, 1, 10000, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+static MYSQL_SYSVAR_ULONG(pmem_undo_slots, srv_pmem_undo_slots,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of PMEM slots (pages) that hold undo pages modified without redo log, used when the PMEM undo page area is created, from 16 to 1048576, default is 1024.",
+  NULL, NULL, 1024, 16, 1048576, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+static MYSQL_SYSVAR_ULONG(pmem_warm_slots, srv_pmem_warm_slots,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of PMEM slots (pages) that mirror the hottest clean pages at buffer pool dump, used when the PMEM warm restart area is created, from 16 to 16777216, default is 65536.",
+  NULL, NULL, 65536, 16, 16777216, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+static MYSQL_SYSVAR_ULONG(pmem_vcache_slots, srv_pmem_vcache_slots,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of PMEM slots (pages) of the victim cache that keeps the clean pages evicted from the buffer pool, used when the PMEM victim cache area is created, from 16 to 16777216, default is 65536.",
+  NULL, NULL, 65536, 16, 16777216, 0);
+#endif
+
 #if defined (UNIV_PMEMOBJ_BUF) || defined (UNIV_PMEMOBJ_DBW) || defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PART_PL)
 static MYSQL_SYSVAR_STR(pmem_home_dir, srv_pmem_home_dir,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
@@ -19720,6 +20083,78 @@ static MYSQL_SYSVAR_ULONG(ppl_n_redoer_threads, srv_ppl_n_redoer_threads,
   "Number of redoer threads to handle REDO , default is 32",
   NULL, NULL, 32, 1, 256, 0);
 
+static MYSQL_SYSVAR_ULONG(ppl_n_init_threads, srv_ppl_n_init_threads,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads to rebuild the per-line DRAM structures at startup, default is 8",
+  NULL, NULL, 8, 1, 64, 0);
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+static MYSQL_SYSVAR_ULONG(ppl_recv_read_batch, srv_ppl_recv_read_batch,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of recovery page reads sorted and issued together across all lines, merged by the simulated AIO handlers only, default is 1024",
+  NULL, NULL, 1024, 64, 65536, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+static MYSQL_SYSVAR_ULONG(ppl_log_mode, srv_ppl_log_mode,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Logging mode chosen at startup, 0: per-page log lines, 1: one log block per transaction, default is 0",
+  NULL, NULL, 0, 0, 1, 0);
+
+static MYSQL_SYSVAR_ULONG(ptxl_n_buckets, srv_ptxl_n_buckets,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of lines of per-transaction log blocks, default is 128",
+  NULL, NULL, 128, 1, 65536, 0);
+
+static MYSQL_SYSVAR_ULONG(ptxl_blocks_per_bucket, srv_ptxl_blocks_per_bucket,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of per-transaction log blocks per line, default is 64",
+  NULL, NULL, 64, 1, 65536, 0);
+
+static MYSQL_SYSVAR_ULONG(ptxl_block_size, srv_ptxl_block_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Size in bytes of a per-transaction log block, a larger transaction chains more blocks, default is 64KB",
+  NULL, NULL, 64 * 1024, 4096, 64 * 1024 * 1024, 0);
+
+static MYSQL_SYSVAR_ULONG(ptxl_dpt_n_lines, srv_ptxl_dpt_n_lines,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of hashed lines in the dirty page table of the per-transaction log, default is 512",
+  NULL, NULL, 512, 1, 1048576, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+static MYSQL_SYSVAR_ULONG(ppl_reclaim_queue_size, srv_ppl_reclaim_queue_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of slots in the queue of flushed page notices for the PPL reclaimer, rounded up to a power of 2, default is 65536",
+  NULL, NULL, 65536, 1024, 16 * 1024 * 1024, 0);
+
+static MYSQL_SYSVAR_ULONG(ppl_reclaim_batch, srv_ppl_reclaim_batch,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Max number of notices the PPL reclaimer takes per batch, default is 256",
+  NULL, NULL, 256, 1, 65536, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+static MYSQL_SYSVAR_ULONG(ppl_magazine_size, srv_ppl_magazine_size,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Number of free PPL log bufs moved at once between a per-CPU magazine and the shared depot, a magazine holds twice as many, default is 8",
+  NULL, NULL, 8, 1, 1024, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+static MYSQL_SYSVAR_ULONG(ppl_flush_pressure_pct, srv_ppl_flush_pressure_pct,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "Percent of a partition log file in use from which the page cleaner flushes the pages of that line first, default is 50",
+  NULL, NULL, 50, 1, 100, 0);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+static MYSQL_SYSVAR_STR(pmem_numa_home_dirs, srv_pmem_numa_home_dirs,
+  PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
+  "PMEM dirs of the NUMA nodes in node order separated by ';', a node without dir uses pmem_home_dir.",
+  NULL, NULL, NULL);
+#endif
+
 static MYSQL_SYSVAR_ULONG(ppl_log_file_size, srv_ppl_log_file_size,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Size of the partition log file in 4-KB, default is 16*1024",
@@ -20541,6 +20976,25 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #if defined(UNIV_AIO_IMPROVE)
   MYSQL_SYSVAR(aio_n_slots_per_seg),
 #endif
+#if defined(UNIV_LOCK_SYS_SHARDED)
+  MYSQL_SYSVAR(lock_sys_n_shards),
+#endif
+#if defined(UNIV_MVCC_CSN)
+  MYSQL_SYSVAR(mvcc_csn_slots),
+#endif
+#if defined(UNIV_LOG_CONCURRENT_COPY)
+  MYSQL_SYSVAR(log_recent_written_size),
+#endif
+#if defined(UNIV_IO_URING)
+  MYSQL_SYSVAR(use_io_uring),
+  MYSQL_SYSVAR(io_uring_poll),
+#endif
+#if defined(UNIV_PARALLEL_INDEX_BUILD)
+  MYSQL_SYSVAR(parallel_index_build_threads),
+#endif
+#if defined(UNIV_PARALLEL_READ)
+  MYSQL_SYSVAR(parallel_read_threads),
+#endif
 #if defined (UNIV_PMEMOBJ_BUF)
   MYSQL_SYSVAR(pmem_buf_bucket_size),
 #endif
@@ -20551,6 +21005,21 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #if defined (UNIV_PMEM_SIM_LATENCY)
   MYSQL_SYSVAR(pmem_sim_latency),
 #endif
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+  MYSQL_SYSVAR(pmem_dbw_slots_per_part),
+#endif
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+  MYSQL_SYSVAR(pmem_log_spill_interval),
+#endif
+#if defined (UNIV_PMEMOBJ_UNDO)
+  MYSQL_SYSVAR(pmem_undo_slots),
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+  MYSQL_SYSVAR(pmem_warm_slots),
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+  MYSQL_SYSVAR(pmem_vcache_slots),
+#endif
 #if defined (UNIV_PMEMOBJ_BUF_PARTITION)
   MYSQL_SYSVAR(pmem_n_space_bits),
   MYSQL_SYSVAR(pmem_page_per_bucket_bits),
@@ -20583,6 +21052,30 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(ppl_log_flusher_wake_threshold),
   MYSQL_SYSVAR(ppl_n_log_flush_threads),
   MYSQL_SYSVAR(ppl_n_redoer_threads),
+  MYSQL_SYSVAR(ppl_n_init_threads),
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+  MYSQL_SYSVAR(ppl_recv_read_batch),
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+  MYSQL_SYSVAR(ppl_log_mode),
+  MYSQL_SYSVAR(ptxl_n_buckets),
+  MYSQL_SYSVAR(ptxl_blocks_per_bucket),
+  MYSQL_SYSVAR(ptxl_block_size),
+  MYSQL_SYSVAR(ptxl_dpt_n_lines),
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+  MYSQL_SYSVAR(ppl_reclaim_queue_size),
+  MYSQL_SYSVAR(ppl_reclaim_batch),
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+  MYSQL_SYSVAR(ppl_magazine_size),
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+  MYSQL_SYSVAR(ppl_flush_pressure_pct),
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+  MYSQL_SYSVAR(pmem_numa_home_dirs),
+#endif
   MYSQL_SYSVAR(ppl_log_file_size),
   MYSQL_SYSVAR(ppl_log_files_per_bucket),
 #endif //UNIV_PMEMOBJ_PART_PL
@@ -18,6 +18,10 @@ this program; if not, write to the Free Software Foundation, Inc.,
 
 /* The InnoDB handler: the interface between MySQL and InnoDB. */
 
+#if defined (UNIV_PARALLEL_READ)
+#include "row0pread.h"
+#endif /* UNIV_PARALLEL_READ */
+
 /** "GEN_CLUST_INDEX" is the name reserved for InnoDB default
 system clustered index when there is no primary key. */
 extern const char innobase_index_reserve_name[];
@@ -163,6 +167,12 @@ public:
 
 	int rnd_next(uchar *buf);
 
+#if defined (UNIV_BATCHED_FETCH)
+	int index_next_batch(uchar* buf, uint max_rows, uint* n_rows);
+
+	int rnd_next_batch(uchar* buf, uint max_rows, uint* n_rows);
+#endif /* UNIV_BATCHED_FETCH */
+
 	int rnd_pos(uchar * buf, uchar *pos);
 
 	int ft_init();
@@ -202,10 +212,16 @@ public:
 
 	void position(uchar *record);
 
-#ifdef WL6742
+#if defined(WL6742) || defined(UNIV_PARALLEL_READ)
 	/* Removing WL6742 as part of Bug #23046302 */
 	virtual int records(ha_rows* num_rows);
 #endif
+#if defined (UNIV_PARALLEL_READ)
+	int parallel_scan(
+		ulint			n_threads,
+		row_pread_func_t	func,
+		void*			arg);
+#endif /* UNIV_PARALLEL_READ */
 	ha_rows records_in_range(
 		uint			inx,
 		key_range*		min_key,
@@ -445,6 +461,10 @@ protected:
 
 	int general_fetch(uchar* buf, uint direction, uint match_mode);
 
+#if defined (UNIV_BATCHED_FETCH)
+	uint fetch_cached_rows(uchar* buf, uint max_rows);
+#endif /* UNIV_BATCHED_FETCH */
+
 	virtual dict_index_t* innobase_get_index(uint keynr);
 
 	/** Builds a 'template' to the prebuilt struct.
@@ -3150,7 +3150,7 @@ ha_innopart::truncate()
 	DBUG_RETURN(error);
 }
 
-#ifdef WL6742
+#if defined(WL6742) || defined(UNIV_PARALLEL_READ)
 
 /* Removing Wl6742 as part of Bug#23046302 */
 
@@ -29,13 +29,14 @@ class partition_info;
 
 /** HA_DUPLICATE_POS and HA_READ_BEFORE_WRITE_REMOVAL is not
 set from ha_innobase, but cannot yet be supported in ha_innopart.
-Full text and geometry is not yet supported. */
+Full text, geometry and batched reads are not yet supported. */
 const handler::Table_flags	HA_INNOPART_DISABLED_TABLE_FLAGS =
 	( HA_CAN_FULLTEXT
 	| HA_CAN_FULLTEXT_EXT
 	| HA_CAN_GEOMETRY
 	| HA_DUPLICATE_POS
-	| HA_READ_BEFORE_WRITE_REMOVAL);
+	| HA_READ_BEFORE_WRITE_REMOVAL
+	| HA_READ_BATCH);
 
 /** InnoDB partition specific Handler_share. */
 class Ha_innopart_share : public Partition_share
@@ -1220,7 +1221,7 @@ protected:
 		uchar*	record,
 		uchar*	pos);
 
-#ifdef WL6742
+#if defined(WL6742) || defined(UNIV_PARALLEL_READ)
 	/* Removing WL6742 as part of Bug 23046302 */
 	int
 	records(
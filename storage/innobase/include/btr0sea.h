@@ -328,6 +328,55 @@ extern rw_lock_t**		btr_search_latches;
 /** The adaptive hash index */
 extern btr_search_sys_t*	btr_search_sys;
 
+#if defined (UNIV_AHI_EPOCH)
+/** Number of reader slots of the adaptive hash index epochs */
+#define BTR_SEARCH_EPOCH_SLOTS	64
+
+/** Readers of the adaptive hash index that are in an epoch, counted by
+the parity of the epoch. Each slot is on its own cache line. */
+struct btr_search_epoch_slot_t {
+	ulint	n_readers[2];	/*!< readers in the even and odd epochs */
+	byte	pad[CACHE_LINE_SIZE - 2 * sizeof(ulint)];
+};
+
+/** Epoch of the adaptive hash index. A node removed from a hash chain
+is reused when the epoch has advanced twice, the lock-free readers that
+could see it are gone by then. */
+extern ulint			btr_search_epoch;
+
+/** Reader slots of the adaptive hash index epochs */
+extern btr_search_epoch_slot_t	btr_search_epoch_slots[BTR_SEARCH_EPOCH_SLOTS];
+
+/** Enter the current epoch of the adaptive hash index, before reading the
+hash chains without a search latch.
+@return token to pass to btr_search_epoch_exit() */
+UNIV_INLINE
+ulint
+btr_search_epoch_enter();
+
+/** Exit the epoch entered by btr_search_epoch_enter().
+@param[in]	token	return value of btr_search_epoch_enter() */
+UNIV_INLINE
+void
+btr_search_epoch_exit(ulint token);
+
+/** Read the epoch when a node is removed from its hash chain. The full
+barrier orders the unlink before the read.
+@return epoch of the removed node */
+UNIV_INLINE
+ulint
+btr_search_epoch_retire();
+
+/** Advance the epoch if no reader is left in the previous one.
+@return current epoch */
+ulint
+btr_search_epoch_try_advance();
+
+/** Wait until the readers that are in an epoch now have exited it. */
+void
+btr_search_epoch_wait();
+#endif /* UNIV_AHI_EPOCH */
+
 #ifdef UNIV_SEARCH_PERF_STAT
 /** Number of successful adaptive hash index lookups */
 extern ulint	btr_search_n_succ;
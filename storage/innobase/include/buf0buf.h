@@ -73,6 +73,13 @@ struct fil_addr_t;
 					pool*/
 #define BUF_KEEP_OLD	52		/*!< Preserve the current LRU
 					position of the block. */
+#if defined (UNIV_AHI_EPOCH)
+#define BUF_MAKE_YOUNG_LOCK_FREE 53	/*!< Like BUF_MAKE_YOUNG, for a
+					lock-free search of the adaptive
+					hash index: the block may have been
+					freed or reused, and the caller
+					checks the modify clock */
+#endif /* UNIV_AHI_EPOCH */
 /* @} */
 
 #define MAX_BUFFER_POOLS_BITS	6	/*!< Number of bits to representing
@@ -433,6 +440,14 @@ zero if all modified pages have been flushed to disk.
 lsn_t
 buf_pool_get_oldest_modification(void);
 /*==================================*/
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Gets the smallest oldest_modification lsn of the pages logged in
+log_sys (system and undo tablespaces). The flush lists also hold the pages
+of the user tablespaces, whose oldest_modification is a PPL time.
+@return oldest log_sys modification in pool, zero if none */
+lsn_t
+buf_pool_get_oldest_classic_modification(void);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 /********************************************************************//**
 Allocates a buf_page_t descriptor. This function must succeed. In case
@@ -1612,6 +1627,15 @@ public:
 					BUF_BLOCK_MEMORY,
 					BUF_BLOCK_REMOVE_HASH or
 					BUF_BLOCK_READY_IN_USE. */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	UT_LIST_NODE_T(buf_page_t) classic_list;
+					/*!< node of
+					buf_pool->classic_flush_list when
+					the page belongs to the system or an
+					undo tablespace and is in flush_list;
+					covered by
+					buf_pool->flush_list_mutex */
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 #ifdef UNIV_DEBUG
 	ibool		in_flush_list;	/*!< TRUE if in buf_pool->flush_list;
@@ -1652,6 +1676,15 @@ public:
 					and buf_pool->flush_list_mutex. Hence
 					reads can happen while holding
 					any one of the two mutexes */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	lsn_t		hybrid_dep_lsn;
+					/*!< log_sys lsn the PPL log
+					records of this user page depend
+					on, log_sys must be flushed up to
+					it before the page is written;
+					zero if none. Protected by the
+					page latch */
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	/* @} */
 	/** @name LRU replacement algorithm fields
 	These fields are protected by buf_pool->mutex only (not
@@ -2148,6 +2181,17 @@ struct buf_pool_t{
 	UT_LIST_BASE_NODE_T(buf_page_t) flush_list;
 					/*!< base node of the modified block
 					list */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	UT_LIST_BASE_NODE_T(buf_page_t) classic_flush_list;
+					/*!< the pages of flush_list that
+					belong to the system or an undo
+					tablespace, in log_sys lsn order.
+					The oldest_modification of the other
+					pages is a PPL time, so their place
+					in flush_list says nothing about the
+					log_sys checkpoint. Protected by
+					flush_list_mutex */
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	ibool		init_flush[BUF_FLUSH_N_TYPES];
 					/*!< this is TRUE when a flush of the
 					given type is being initialized */
@@ -122,6 +122,39 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync);	/*!< in: true if sync IO requested */
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+/** State of a slot in a doublewrite partition */
+enum buf_dblwr_slot_state_t {
+	BUF_DBLWR_SLOT_FREE = 0,	/*!< the slot can be reserved */
+	BUF_DBLWR_SLOT_IN_FLIGHT,	/*!< the page image is on NVM and
+					the datafile write is posted */
+	BUF_DBLWR_SLOT_WRITTEN,		/*!< the datafile write is completed
+					but not yet synced */
+	BUF_DBLWR_SLOT_SYNCING		/*!< the datafiles are being synced
+					for this slot */
+};
+
+/** A range of NVM doublewrite slots owned by one page cleaner slot
+(one buffer pool instance). Pages of an instance are only written through
+its own partition, so concurrent page cleaners never share a mutex. */
+struct buf_dblwr_part_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the fields below */
+	ulint		first_slot;/*!< index of the first slot of this
+				partition in the NVM doublewrite area */
+	ulint		n_slots;/*!< number of slots in this partition */
+	ulint		n_reserved;/*!< number of slots not free */
+	ulint		n_in_flight;/*!< number of slots whose datafile
+				write is not completed */
+	bool		syncing;/*!< true if a thread is syncing the
+				datafiles for the written slots */
+	os_event_t	event;	/*!< event where threads wait for a
+				free slot */
+	buf_dblwr_slot_state_t*	state;/*!< state of each slot */
+	const buf_page_t**	buf_block_arr;/*!< page written through
+				each slot */
+};
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
 /** Doublewrite control struct */
 struct buf_dblwr_t{
 	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
@@ -154,6 +187,14 @@ struct buf_dblwr_t{
 	buf_page_t**	buf_block_arr;/*!< array to store pointers to
 				the buffer blocks which have been
 				cached to write_buf */
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	ulint		n_parts;/*!< number of partitions, one per
+				buffer pool instance */
+	buf_dblwr_part_t*	parts;/*!< the NVM doublewrite partitions */
+	bool		load_from_disk;/*!< true if the NVM area was created
+				at this startup, crash recovery must then
+				use the doublewrite pages on disk */
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
 };
 
 
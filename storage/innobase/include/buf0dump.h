@@ -66,4 +66,31 @@ DECLARE_THREAD(buf_dump_thread)(
 	void*	arg);				/*!< in: a dummy parameter
 						required by os_thread_create */
 
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+class page_id_t;
+
+/** Opens or allocates the NVM warm restart area and builds its DRAM
+bookkeeping. Called at startup before the redo log is applied. */
+void
+buf_warm_init(void);
+
+/** Frees the DRAM bookkeeping of the NVM warm restart area. */
+void
+buf_warm_free(void);
+
+/** Drops the NVM image of a page that is about to be written to its
+datafile, the image would be older than the datafile page.
+@param[in]	page_id	page being written */
+void
+buf_warm_invalidate(
+	const page_id_t&	page_id);
+
+/** Drops the NVM images of all the pages of a tablespace that is dropped,
+discarded, truncated or imported.
+@param[in]	space_id	tablespace id */
+void
+buf_warm_invalidate_space(
+	ulint	space_id);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
 #endif /* buf0dump_h */
@@ -220,6 +220,61 @@ buf_LRU_adjust_hp(
 	buf_pool_t*		buf_pool,/*!< in: buffer pool instance */
 	const buf_page_t*	bpage);	/*!< in: control block */
 
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+class page_id_t;
+
+/** Opens or allocates the NVM victim cache and builds its DRAM
+bookkeeping, the cache starts empty. */
+void
+buf_vcache_init(void);
+
+/** Prints the victim cache counters and frees its DRAM bookkeeping. */
+void
+buf_vcache_free(void);
+
+/** Reserves a slot for a clean page that is being evicted. Called under
+buf_pool->mutex before the page is removed from the page hash.
+@param[in]	page_id	page being evicted
+@return slot to fill with buf_vcache_fill(), or ULINT_UNDEFINED if the
+page is not admitted */
+ulint
+buf_vcache_reserve(
+	const page_id_t&	page_id);
+
+/** Copies an evicted page to its reserved slot. Called after the page
+left the page hash, with no buffer pool mutex held.
+@param[in]	slot	slot returned by buf_vcache_reserve()
+@param[in]	frame	page frame, not yet freed */
+void
+buf_vcache_fill(
+	ulint		slot,
+	const byte*	frame);
+
+/** Copies a page from the victim cache to a buffer pool frame and frees
+its slot. The read is counted in the frequency sketch either way.
+@param[in]	page_id	page being read
+@param[out]	dst	frame of the page
+@return true if the page was in the cache */
+bool
+buf_vcache_read(
+	const page_id_t&	page_id,
+	byte*			dst);
+
+/** Drops the image of a page that is written to its datafile or created
+in the buffer pool, it would be older than the datafile page.
+@param[in]	page_id	page */
+void
+buf_vcache_invalidate(
+	const page_id_t&	page_id);
+
+/** Drops the images of all the pages of a tablespace that is dropped,
+discarded or truncated, its id may be reused for other pages.
+@param[in]	space_id	tablespace id */
+void
+buf_vcache_invalidate_space(
+	ulint	space_id);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 /**********************************************************************//**
 Validates the LRU list.
@@ -184,6 +184,27 @@ ha_remove_all_nodes_to_page(
 	hash_table_t*	table,	/*!< in: hash table */
 	ulint		fold,	/*!< in: fold value */
 	const page_t*	page);	/*!< in: buffer page */
+#if defined (UNIV_AHI_EPOCH)
+/** Looks for an element without the latch of the hash table. The caller
+is in an epoch of the adaptive hash index, see btr_search_epoch_enter(),
+so that the nodes it reads are not reused.
+@param[in]	table	hash table
+@param[in]	fold	folded value of the searched data
+@return pointer to the data of the first node in the chain having the
+fold number, NULL if not found */
+UNIV_INLINE
+const rec_t*
+ha_search_and_get_data_lock_free(
+	hash_table_t*	table,
+	ulint		fold);
+
+/** Forget the retired and free nodes of a hash table, when its heap is
+emptied.
+@param[in,out]	table	hash table */
+void
+ha_forget_retired(
+	hash_table_t*	table);
+#endif /* UNIV_AHI_EPOCH */
 #if defined UNIV_AHI_DEBUG || defined UNIV_DEBUG
 /*************************************************************//**
 Validates a given range of the cells in hash table.
@@ -212,6 +233,12 @@ struct ha_node_t {
 	buf_block_t*	block;	/*!< buffer block containing the data, or NULL */
 #endif /* UNIV_AHI_DEBUG || UNIV_DEBUG */
 	const rec_t*	data;	/*!< pointer to the data */
+#if defined (UNIV_AHI_EPOCH)
+	ha_node_t*	retired_next;/*!< next node in the retired or free
+				list of the hash table */
+	ulint		retire_epoch;/*!< btr_search_epoch when the node
+				was removed from its chain */
+#endif /* UNIV_AHI_EPOCH */
 };
 
 #ifdef UNIV_DEBUG
@@ -34,6 +34,9 @@ Created 5/20/1997 Heikki Tuuri
 
 struct hash_table_t;
 struct hash_cell_t;
+#if defined (UNIV_AHI_EPOCH)
+struct ha_node_t;
+#endif /* UNIV_AHI_EPOCH */
 
 typedef void*	hash_node_t;
 
@@ -564,6 +567,15 @@ struct hash_table_t {
 					many of these heaps */
 #endif /* !UNIV_HOTBACKUP */
 	mem_heap_t*		heap;
+#if defined (UNIV_AHI_EPOCH)
+	ha_node_t*		retired;/*!< nodes removed from the chains of
+					the adaptive hash index, oldest first.
+					Lock-free readers may still be on them,
+					they are reused after a grace period */
+	ha_node_t*		retired_last;/*!< last node of retired */
+	ha_node_t*		free_nodes;/*!< retired nodes past their grace
+					period */
+#endif /* UNIV_AHI_EPOCH */
 #ifdef UNIV_DEBUG
 	ulint			magic_n;
 # define HASH_TABLE_MAGIC_N	76561114
@@ -987,6 +987,17 @@ struct lock_op_t{
 
 typedef ib_mutex_t LockMutex;
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/** A shard of the lock system, it latches a subset of the rec_hash cells
+or of the table lock queues */
+struct lock_sys_shard_t{
+	char		pad[CACHE_LINE_SIZE];	/*!< padding, one shard per
+						cache line */
+	LockMutex	mutex;			/*!< Mutex protecting the
+						locks of the shard */
+};
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /** The lock system struct */
 struct lock_sys_t{
 	char		pad1[CACHE_LINE_SIZE];	/*!< padding to prevent other
@@ -1001,6 +1012,24 @@ struct lock_sys_t{
 						lock */
 	hash_table_t*	prdt_page_hash;		/*!< hash table of the page
 						lock */
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	ulint		n_shards;		/*!< number of rec shards and
+						of table shards */
+	volatile ulint	n_rec_cells;		/*!< number of cells of the
+						three lock hash tables,
+						changed by lock_sys_resize()
+						under the exclusive latch. It
+						is read without a latch to
+						find the shard of a page, a
+						stale value is caught under
+						the shard latch */
+	lock_sys_shard_t* rec_shards;		/*!< rec_hash cell i is
+						latched by rec_shards[i %
+						n_shards] */
+	lock_sys_shard_t* table_shards;		/*!< the lock queue of a table
+						is latched by
+						table_shards[id % n_shards] */
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 	char		pad2[CACHE_LINE_SIZE];	/*!< Padding */
 	LockMutex	wait_mutex;		/*!< Mutex protecting the
@@ -1074,6 +1103,102 @@ lock_rec_trx_wait(
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/*********************************************************************//**
+Acquire the lock_sys->mutex and then every shard in order. The lock
+system is then latched exclusively, as lock_sys->mutex alone is without
+the shards. */
+void
+lock_sys_x_enter(void);
+
+/*********************************************************************//**
+Try to latch the lock system exclusively without waiting on
+lock_sys->mutex.
+@return 0 if latched, non-zero otherwise */
+ulint
+lock_sys_x_enter_nowait(void);
+
+/*********************************************************************//**
+Release the shards and the lock_sys->mutex. */
+void
+lock_sys_x_exit(void);
+
+/*********************************************************************//**
+Latch the shard of the rec_hash cell of a page.
+@return the latched shard */
+lock_sys_shard_t*
+lock_rec_shard_enter(
+/*=================*/
+	ulint	space,		/*!< in: space */
+	ulint	page_no);	/*!< in: page number */
+
+/*********************************************************************//**
+Latch the shard of the lock queue of a table.
+@return the latched shard */
+lock_sys_shard_t*
+lock_table_shard_enter(
+/*===================*/
+	const dict_table_t*	table);	/*!< in: table */
+
+/*********************************************************************//**
+Gets the shard of the rec_hash cell of a page.
+@return shard */
+UNIV_INLINE
+lock_sys_shard_t*
+lock_rec_shard_get(
+/*===============*/
+	ulint	space,		/*!< in: space */
+	ulint	page_no);	/*!< in: page number */
+
+/*********************************************************************//**
+Gets the shard of the lock queue of a table.
+@return shard */
+UNIV_INLINE
+lock_sys_shard_t*
+lock_table_shard_get(
+/*=================*/
+	const dict_table_t*	table);	/*!< in: table */
+
+/** Release a shard. */
+#define lock_sys_shard_exit(shard) do {		\
+	(shard)->mutex.exit();			\
+} while (0)
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+@return true if the thread latches the lock system or one of its shards */
+bool
+lock_sys_latched(void);
+#endif /* UNIV_DEBUG */
+
+/** Test if the lock system can be latched exclusively without waiting. */
+#define lock_mutex_enter_nowait() (lock_sys_x_enter_nowait())
+
+/** Test if the lock system is latched exclusively. */
+#define lock_mutex_own() (lock_sys->mutex.is_owned())
+
+/** Latch the lock system exclusively. */
+#define lock_mutex_enter() do {			\
+	lock_sys_x_enter();			\
+} while (0)
+
+/** Release the exclusive latch of the lock system. */
+#define lock_mutex_exit() do {			\
+	lock_sys_x_exit();			\
+} while (0)
+
+/** Test if the record locks of a page are latched, by the shard of the
+page or exclusively. */
+#define lock_rec_mutex_own(space, page_no)			\
+	(lock_mutex_own()					\
+	 || lock_rec_shard_get(space, page_no)->mutex.is_owned())
+
+/** Test if the table locks of a table are latched, by the shard of the
+table or exclusively. */
+#define lock_table_mutex_own(table)				\
+	(lock_mutex_own()					\
+	 || lock_table_shard_get(table)->mutex.is_owned())
+#else
 /** Test if lock_sys->mutex can be acquired without waiting. */
 #define lock_mutex_enter_nowait() 		\
 	(lock_sys->mutex.trylock(__FILE__, __LINE__))
@@ -1091,6 +1216,11 @@ extern lock_sys_t*	lock_sys;
 	lock_sys->mutex.exit();			\
 } while (0)
 
+#define lock_rec_mutex_own(space, page_no) lock_mutex_own()
+#define lock_table_mutex_own(table) lock_mutex_own()
+#define lock_sys_latched() lock_mutex_own()
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() (lock_sys->wait_mutex.is_owned())
 
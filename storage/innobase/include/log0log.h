@@ -61,6 +61,13 @@ step which modifies the database, is started */
 #define LOG_CHECKPOINT_FREE_PER_THREAD	(4 * UNIV_PAGE_SIZE)
 #define LOG_CHECKPOINT_EXTRA_FREE	(8 * UNIV_PAGE_SIZE)
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/* Number of (lsn, PPL time) samples kept to translate a log_sys lsn into
+the PPL time domain of the flush lists, and the log bytes between samples */
+#define LOG_HYBRID_N_SAMPLES		1024
+#define LOG_HYBRID_SAMPLE_BYTES		(1024 * 1024)
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 typedef ulint (*log_checksum_func_t)(const byte* log_block);
 
 /** Pointer to the log checksum calculation function. Protected with
@@ -140,6 +147,47 @@ Closes the log.
 lsn_t
 log_close(void);
 /*===========*/
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+/** A range of the log buffer reserved by log_reserve_concurrent(), the
+mtr copies its log records into it without holding the log mutex */
+struct log_copy_t {
+	lsn_t		start_lsn;	/*!< start lsn of the range */
+	lsn_t		end_lsn;	/*!< end lsn of the range */
+	lsn_t		lsn;		/*!< lsn of the copy position */
+	byte*		start_ptr;	/*!< start of the range in log_sys->buf */
+	byte*		ptr;		/*!< copy position in log_sys->buf */
+};
+
+/** Reserve the space of len bytes of log records in the log buffer. The
+caller holds the log mutex, the mutex is still held on return. The records
+are copied with log_copy_low() and log_copy_close() after the log mutex
+is released.
+@param[in]	len	length of the log records
+@param[out]	copy	the reserved range
+@return start lsn of the log records */
+lsn_t
+log_reserve_concurrent(
+	ulint		len,
+	log_copy_t*	copy);
+
+/** Copy a part of the log records into a range reserved by
+log_reserve_concurrent(). The log mutex is not needed.
+@param[in,out]	copy	the reserved range
+@param[in]	str	log records
+@param[in]	str_len	length of str */
+void
+log_copy_low(
+	log_copy_t*	copy,
+	const byte*	str,
+	ulint		str_len);
+
+/** Finish the copy into a range reserved by log_reserve_concurrent() and
+mark the range written for log_write_up_to().
+@param[in,out]	copy	the reserved range */
+void
+log_copy_close(
+	log_copy_t*	copy);
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 /************************************************************//**
 Gets the current lsn.
 @return current lsn */
@@ -215,6 +263,74 @@ void
 log_buffer_sync_in_background(
 /*==========================*/
 	bool	flush);	/*<! in: flush the logs to disk */
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+/** Write the log buffer to the log files and flush them up to a given lsn.
+With the NVM log buffer, log_write_up_to() returns as soon as the log is
+persistent in NVM; this is the path that really reaches ib_logfile, used
+by the spill thread, checkpoints and when the log buffer runs out of space.
+@param[in]	lsn	log sequence number that should be on disk */
+void
+log_spill_up_to(
+	lsn_t	lsn);
+
+/** Persist the log buffer bytes written since a given offset and publish
+the new buf_free in the NVM log buffer. The caller must own the log mutex.
+@param[in]	start_free	log_sys->buf_free before the write */
+void
+log_pmem_persist_write(
+	ulint	start_free);
+
+/** Move log_sys->buf onto the NVM log buffer, copying the part of the
+block in use, and reset the persistent layout of the NVM log buffer.
+@param[in]	spilled_lsn	lsn up to which the log files are known to be
+complete, LSN_MAX if the NVM copy must not be replayed at recovery */
+void
+log_pmem_buf_attach(
+	lsn_t	spilled_lsn);
+
+/** Write the log that reached the NVM log buffer but not the log files
+before a crash, so that recovery scans it like any other log. Called at
+recovery after the checkpoint has been read.
+@param[in]	group	log group */
+void
+log_pmem_spill_tail(
+	log_group_t*	group);
+
+/** The spill thread writes the NVM log buffer to the log files in the
+background, every innodb_pmem_log_spill_interval ms or when woken up.
+@param[in]	arg	a dummy parameter required by os_thread_create.
+@return this function does not return, calls os_thread_exit() */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(log_spill_thread)(
+	void*	arg);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Remember the PPL time at which log_sys reached an lsn, at most one
+sample every LOG_HYBRID_SAMPLE_BYTES. The caller must own the log mutex.
+@param[in]	lsn	end lsn of a mini-transaction */
+void
+log_hybrid_sample(
+	lsn_t	lsn);
+
+/** Translate a log_sys lsn into the PPL time domain: the flush lists hold
+both, and a page dirtied before log_sys reached lsn was dirtied before the
+returned time.
+@param[in]	lsn	log sequence number, or LSN_MAX
+@return PPL time (ut_time_us), or LSN_MAX */
+lsn_t
+log_hybrid_lsn_to_time(
+	lsn_t	lsn);
+
+/** Translate a PPL time back into the log_sys lsn domain: a system or undo
+page whose oldest_modification is below the returned lsn was dirtied before
+the time. This is the reverse of log_hybrid_lsn_to_time().
+@param[in]	time	PPL time (ut_time_us), or LSN_MAX
+@return log sequence number, or LSN_MAX */
+lsn_t
+log_hybrid_time_to_lsn(
+	lsn_t	time);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 /** Make a checkpoint. Note that this function does not flush dirty
 blocks from the buffer pool: it only checks what is lsn of the oldest
 modification in the pool, and writes information about the lsn in
@@ -706,6 +822,28 @@ struct log_t{
 					previous printout */
 	time_t		last_printout_time;/*!< when log_print was last time
 					called */
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	os_event_t	spill_event;	/*!< wakes up the spill thread */
+	bool		spill_thread_active;
+					/*!< true if the spill thread
+					is running */
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	volatile lsn_t*	recent_written;	/*!< end lsn of the copied ranges,
+					indexed by start lsn modulo the
+					window size; an entry is valid if it
+					is above recent_written_lsn */
+	ulint		recent_written_size;
+					/*!< window size in lsn, a range is
+					reserved only if it ends within the
+					window from recent_written_lsn */
+	lsn_t		recent_written_lsn;
+					/*!< the log is in the buffer up to
+					here, advanced under the log mutex */
+	lsn_t		recent_reserved_lsn;
+					/*!< end of the last range reserved
+					by log_reserve_concurrent() */
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 	/* @} */
 
 	/** Fields involved in checkpoints @{ */
@@ -755,6 +893,17 @@ struct log_t{
 					checkpoint write is running; a thread
 					should wait for this without owning
 					the log mutex */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	lsn_t		hybrid_lsn[LOG_HYBRID_N_SAMPLES];
+					/*!< ring of lsn samples, see
+					log_hybrid_sample() */
+	ulint		hybrid_time[LOG_HYBRID_N_SAMPLES];
+					/*!< PPL time of each sample */
+	ulint		hybrid_n_samples;
+					/*!< number of samples taken so
+					far, the ring holds the last
+					LOG_HYBRID_N_SAMPLES */
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 #endif /* !UNIV_HOTBACKUP */
 	byte*		checkpoint_buf_ptr;/* unaligned checkpoint header */
 	byte*		checkpoint_buf;	/*!< checkpoint header is read to this
@@ -291,6 +291,9 @@ typedef std::vector<recv_encryption_t, ut_allocator<recv_encryption_t> >
 struct recv_sys_t{
 #if defined (UNIV_TRACE_RECOVERY_TIME)
 	ulint		redo1_time;
+	ulint		analysis_time;	/*!< us to find the start point of
+					the log scan, checkpoint lookup or
+					pm_ppl_analysis() */
 #endif //UNIV_TRACE_RECOVERY_TIME
 
 #ifndef UNIV_HOTBACKUP
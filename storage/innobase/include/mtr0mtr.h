@@ -34,9 +34,15 @@ Created 11/26/1995 Heikki Tuuri
 #include "trx0types.h"
 #include "dyn0buf.h"
 
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/*11 bytes as original InnoDB + 2 bytes rec_len + 8 bytes rec_lsn
++ 8 bytes dep_lsn, the log_sys lsn the rec depends on*/
+#define MLOG_HEADER_SIZE (11 + 2 + 8 + 8)
+#define MLOG_PPL_META_SIZE (2 + 8 + 8)
+#elif defined (UNIV_PMEMOBJ_PART_PL)
 /*11 bytes as original InnoDB + 2 bytes rec_len + 8 bytes rec_lsn*/
 #define MLOG_HEADER_SIZE (11 + 2 + 8)
+#define MLOG_PPL_META_SIZE (2 + 8)
 #else
 #define MLOG_HEADER_SIZE 11
 #endif //UNIV_PMEMOBJ_PART_PL
@@ -195,6 +201,10 @@ struct mtr_t {
 		uint64_t* key_arr;
 		uint16_t* off_arr; //offset of the previous log rec
 		uint16_t* len_off_arr; //offset from the size_arr[i] to the "len" location in mlog_write_initial_log_record_low
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		bool*	  classic_arr; //true if the log rec goes to log_sys instead of PPL
+		lsn_t	  m_hybrid_dep_lsn; //log_sys lsn the PPL recs depend on
+#endif
 
 		bool	is_undo_page; //redo log for UNDO page
 		//we use a normal dynamic buffer
@@ -246,6 +256,12 @@ struct mtr_t {
 		/** Flush Observer */
 		FlushObserver*	m_flush_observer;
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+		/** NVM undo slot reserved for the undo page modified by
+		this mini-transaction without redo log, or ULINT_UNDEFINED */
+		ulint		m_undo_nvm_slot;
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 #ifdef UNIV_DEBUG
 		/** For checking corruption. */
 		ulint		m_magic_n;
@@ -300,6 +316,22 @@ struct mtr_t {
 	}
 
 #endif 
+#if defined (UNIV_PMEMOBJ_UNDO)
+	/** Note that the undo page modified by this mini-transaction is
+	persisted on an NVM slot at commit instead of being redo logged.
+	@param[in]	slot	reserved NVM undo slot */
+	void set_undo_nvm_slot(ulint slot)
+	{
+		ut_ad(m_impl.m_log_mode == MTR_LOG_NO_REDO);
+		m_impl.m_undo_nvm_slot = slot;
+	}
+
+	/** @return the reserved NVM undo slot, or ULINT_UNDEFINED */
+	ulint get_undo_nvm_slot() const
+	{
+		return(m_impl.m_undo_nvm_slot);
+	}
+#endif /* UNIV_PMEMOBJ_UNDO */
 	/** @return whether this is an asynchronous mini-transaction. */
 	bool is_async() const
 	{
@@ -705,6 +737,30 @@ struct mtr_t {
 		assert(i < m_impl.m_n_log_recs);
 		return(m_impl.len_off_arr[i]);
 	}
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/** Check if the redo log of a tablespace is written to log_sys
+	in the hybrid mode, other tablespaces are logged in PPL
+	@param[in]	space	tablespace id
+	@return true for the system, undo and temporary tablespaces */
+	static bool is_classic_space(ulint space);
+
+	void add_classic(bool is_classic){
+		m_impl.classic_arr[m_impl.m_n_log_recs] = is_classic;
+	}
+	bool is_classic_at(uint32_t i){
+		assert(i < m_impl.m_n_log_recs);
+		return(m_impl.classic_arr[i]);
+	}
+
+	/** Make the PPL recs of the mtr depend on a log_sys lsn, they are
+	not recovered unless log_sys is recovered up to it
+	@param[in]	lsn	log_sys end lsn of an mtr the changes depend on */
+	void add_hybrid_dep(lsn_t lsn){
+		if (lsn > m_impl.m_hybrid_dep_lsn) {
+			m_impl.m_hybrid_dep_lsn = lsn;
+		}
+	}
+#endif //UNIV_PMEMOBJ_PPL_HYBRID
 #if defined (UNIV_PMEMOBJ_VALID_MTR)	
 	void pmem_check_mtrlog(mtr_t* mtr);
 
@@ -30,14 +30,8 @@
 #define MAX_DPT_ENTRIES 8192
 #define MAX_TT_ENTRIES 8192
 
-//#define MAX_DPT_LINES 128 
-//#define MAX_DPT_LINES 8192 
-#define MAX_DPT_LINES 512 
-//#define MAX_DPT_ENTRIES_PER_LINE 64 //max number of DPT entries per hashed line
-#define MAX_DPT_ENTRIES_PER_LINE 1024 //max number of DPT entries per hashed line
-#define MAX_TX_PER_PAGE 256 //max number transaction could access on a page at the same time 
-//#define MAX_TX_PER_PAGE 64 
-//
+/*the per-tx DPT has srv_ptxl_dpt_n_lines lines, entries and page refs grow on demand*/
+#define PMEM_DPT_INIT_REFS 4
 
 #define PMEM_CPU_FREQ 2.2
 
@@ -52,6 +46,18 @@ static const size_t PMEM_MAX_LOG_BUF_SIZE = 1 * 1024 * PMEM_MB;
 static const size_t PMEM_PAGE_SIZE = 16*1024; //16KB
 static const size_t PMEM_MAX_DBW_PAGES= 128; // 2 * extent_size
 
+//state of a slot in the partitioned double write buffer
+static const uint64_t PMEM_DBW_SLOT_FREE = 0;
+static const uint64_t PMEM_DBW_SLOT_IN_FLIGHT = 1;
+
+//state of a slot in the NVM undo page area
+static const uint64_t PMEM_UNDO_SLOT_FREE = 0;
+static const uint64_t PMEM_UNDO_SLOT_VALID = 1;
+
+/*states of the warm restart area and of its slots*/
+static const uint64_t PMEM_WARM_EMPTY = 0;
+static const uint64_t PMEM_WARM_VALID = 1;
+
 //static const size_t PMEM_GROUP_PARTITION_TIME= 1000000;
 //static const size_t PMEM_GROUP_PARTITION_SIZE= 4196;
 
@@ -66,6 +72,45 @@ static const size_t PMEM_GROUP_PARTITION_SIZE= 512;
 
 //#define PMEM_LOG_BUF_HEADER_SIZE 4
 #define PMEM_LOG_BUF_HEADER_SIZE 8 /*4-byte real_len, 4-byte n_recs*/
+/*min lines per thread when the per-line DRAM structures are rebuilt at startup*/
+#define PMEM_PPL_INIT_MIN_LINES 64
+
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+/*Each rec in a logbuf is [len 2B][crc 4B][rec] and is followed by a 2-byte
+ * zero len, the recovery scan stops at the zero len or at the first bad crc*/
+#define PMEM_PPL_REC_CHECK_SIZE 6
+#define PMEM_PPL_REC_CHECK_RESERVE (PMEM_PPL_REC_CHECK_SIZE + 2)
+#else
+#define PMEM_PPL_REC_CHECK_SIZE 0
+#define PMEM_PPL_REC_CHECK_RESERVE 0
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+#define PMEM_NUMA_MAX_NODES 8
+#define PMEM_NUMA_MAX_CPUS 1024
+/*max free log bufs looked at for one on the node of the line*/
+#define PMEM_NUMA_FREE_BUF_SCAN 8
+/*the per-node pool file in each dir of innodb_pmem_numa_home_dirs*/
+#define PMEMOBJ_NUMA_FILE_NAME "pmemobjfile_node"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+/*Compact log rec encoding in PPL logbufs, flags on the type byte
+ * MLOG types are < 64 so the two high bits are free
+ * COMPACT: [type][space][page_no][lsn][len][body]
+ * COMPACT | SEEN_PAGE: [type][page idx 1B][lsn][len][body]
+ * lsn is 8-byte for the first rec in a logbuf, otherwise the compressed
+ * delta to the previous rec. len is the compressed body len and is omitted
+ * for dense types whose body parses itself (MLOG_nBYTES, page creates) */
+#define PMEM_PPL_REC_COMPACT 0x40
+#define PMEM_PPL_REC_SEEN_PAGE 0x80
+#define PMEM_PPL_REC_FLAGS (PMEM_PPL_REC_COMPACT | PMEM_PPL_REC_SEEN_PAGE)
+/*max distinct pages indexed per logbuf, the index is one byte*/
+#define PMEM_PPL_COMPACT_MAX_PAGES 255
+#define PMEM_PPL_COMPACT_HASH_SIZE 512
+/*type(1) + space(5) + page_no(5) + lsn(11) + len(5)*/
+#define PMEM_PPL_COMPACT_MAX_HDR 32
+#endif
 
 enum {
 	PMEM_READ = 1,
@@ -76,7 +121,10 @@ enum PMEM_OBJ_TYPES {
 	LOG_BUF_TYPE,
 	DBW_TYPE,
 	BUF_TYPE,
-	META_DATA_TYPE
+	META_DATA_TYPE,
+	UNDO_TYPE,
+	WARM_TYPE,
+	VCACHE_TYPE
 };
 
 //use in pm_ppl_write()
@@ -108,6 +156,9 @@ enum PMEM_PARSE_RESULT {
 	PMEM_PARSE_NEED = 1,
 	PMEM_PARSE_BLOCK_NOT_EXISTED = 2,
 	PMEM_PARSE_LSN_OLD = 3,
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	PMEM_PARSE_HYBRID_DEP = 4, //log_sys was not recovered up to its dep_lsn
+#endif
 };
 
 enum PMEM_LOG_BLOCK_STATE {
@@ -122,6 +173,12 @@ enum PMEM_TX_STATE {
     PMEM_TX_ACTIVE = 3,
 };
 
+/*innodb_ppl_log_mode*/
+enum PMEM_LOG_MODE {
+	PMEM_LOG_MODE_PAGE = 0, //per-page partitioned log
+	PMEM_LOG_MODE_TX = 1, //per-transaction log blocks
+};
+
 enum PMEM_LOG_TYPE {
 	PMEM_REDO_LOG = 1,
 	PMEM_UNDO_LOG = 2
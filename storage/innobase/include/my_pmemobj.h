@@ -80,6 +80,27 @@ typedef struct __pmem_dbw PMEM_DBW;
 struct __pmem_log_buf;
 typedef struct __pmem_log_buf PMEM_LOG_BUF;
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+struct __pmem_undo;
+typedef struct __pmem_undo PMEM_UNDO;
+
+struct __pmem_undo_slot_hdr;
+typedef struct __pmem_undo_slot_hdr PMEM_UNDO_SLOT_HDR;
+#endif /* UNIV_PMEMOBJ_UNDO */
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+struct __pmem_warm;
+typedef struct __pmem_warm PMEM_WARM;
+
+struct __pmem_warm_slot_hdr;
+typedef struct __pmem_warm_slot_hdr PMEM_WARM_SLOT_HDR;
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+struct __pmem_vcache;
+typedef struct __pmem_vcache PMEM_VCACHE;
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 #if defined (UNIV_PMEMOBJ_BUF)
 struct __pmem_buf_block_t;
 typedef struct __pmem_buf_block_t PMEM_BUF_BLOCK;
@@ -217,6 +238,38 @@ typedef struct __pmem_log_group PMEM_LOG_GROUP;
 struct __pmem_recv_line;
 typedef struct __pmem_recv_line PMEM_RECV_LINE;
 
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+struct __pmem_ppl_compact_dict;
+typedef struct __pmem_ppl_compact_dict PMEM_PPL_COMPACT_DICT;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+struct __pmem_recv_io_req;
+typedef struct __pmem_recv_io_req PMEM_RECV_IO_REQ;
+
+struct __pmem_recv_io_sched;
+typedef struct __pmem_recv_io_sched PMEM_RECV_IO_SCHED;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+struct __pmem_reclaim_notice;
+typedef struct __pmem_reclaim_notice PMEM_RECLAIM_NOTICE;
+
+struct __pmem_reclaim_cell;
+typedef struct __pmem_reclaim_cell PMEM_RECLAIM_CELL;
+
+struct __pmem_ppl_reclaimer;
+typedef struct __pmem_ppl_reclaimer PMEM_PPL_RECLAIMER;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+struct __pmem_ppl_magazine;
+typedef struct __pmem_ppl_magazine PMEM_PPL_MAGAZINE;
+
+struct __pmem_ppl_free_depot;
+typedef struct __pmem_ppl_free_depot PMEM_PPL_FREE_DEPOT;
+#endif
+
 struct __pmem_space_t;
 typedef struct __pmem_space_t PMEM_SPACE;
 
@@ -300,6 +353,16 @@ POBJ_LAYOUT_TOID(my_pmemobj, TOID(PMEM_SPACE));
 //
 #endif // UNIV_PMEMOBJ_PL
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+POBJ_LAYOUT_TOID(my_pmemobj, PMEM_UNDO);
+#endif /* UNIV_PMEMOBJ_UNDO */
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+POBJ_LAYOUT_TOID(my_pmemobj, PMEM_WARM);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+POBJ_LAYOUT_TOID(my_pmemobj, PMEM_VCACHE);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 POBJ_LAYOUT_END(my_pmemobj);
 
 
@@ -313,6 +376,15 @@ struct __pmem_wrapper {
 #if defined (UNIV_PMEMOBJ_BUF)
 	PMEM_BUF* pbuf;
 #endif
+#if defined (UNIV_PMEMOBJ_UNDO)
+	PMEM_UNDO* pundo;
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	PMEM_WARM* pwarm;
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	PMEM_VCACHE* pvcache;
+#endif
 #if defined (UNIV_PMEMOBJ_PL)
 	PMEM_TX_PART_LOG* ptxl;
 	PMEM_PAGE_PART_LOG* ppl;
@@ -323,6 +395,10 @@ struct __pmem_wrapper {
 #endif
 #if defined (UNIV_PMEM_SIM_LATENCY)
 	uint64_t PMEM_SIM_CPU_CYCLES; //used in simulate latency
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*per-node pools for the log buf data, NULL if the node uses pop*/
+	PMEMobjpool* node_pops[PMEM_NUMA_MAX_NODES];
 #endif
 	bool is_new;
 };
@@ -364,11 +440,12 @@ void pm_pop_free(PMEMobjpool* pop);
 
 /*Implement the PMEM log in the similar way with the PMEM_BUF
  *A sequential bytes are allocated in PMEM to avaoid allocate/deallocate overhead
+ *Each transaction appends its log recs on its own log block (or a chain
+ *of blocks), the dirty page table in DRAM tells when a block is reclaimable
  * */
 struct __pmem_tx_part_log {
 	/*metadata*/
 	uint64_t	size; //the total size for the partitioned log
-	TOID(PMEM_DPT)	dpt; //dirty page table
 
 	/*pmem address*/
 	PMEMoid		data; //log data
@@ -383,10 +460,20 @@ struct __pmem_tx_part_log {
 	uint64_t			n_blocks_per_bucket; //# load_factor, of log block per bucket
 	uint64_t			block_size; //log block size in bytes
 	
+	/*DRAM objects, rebuilt at each startup*/
+	PMEM_DPT*			dpt; //dirty page table
+	uint64_t			cur_lsn; //the last assigned LSN, CAS only
+	uint64_t			n_free_blocks;
+	os_event_t			free_block_event; //set when a block is reclaimed
+
+	/*blocks of the mtrs that have no transaction (purge, ibuf,
+	 * page allocation ...), one shared block per slot, a slot is picked
+	 * by the thread id and its block is switched by CAS*/
+	uint64_t			n_sys_slots;
+	uint64_t*			sys_bids;
 
 	/*Statistic info*/	
 	uint64_t	pmem_alloc_size;
-	uint64_t	pmem_dpt_size;
 	uint64_t	pmem_tx_log_size;
 
 	/*Debug*/
@@ -411,24 +498,25 @@ struct __pmem_tx_log_hashed_line {
  * One log block per transaction
  * Follow the implementation of PMEM_BUF_BLOCK
  * The REDO logs of a transactions are append on the log block
+ * A transaction that overflows its block continues on a new block, the
+ * blocks of a transaction are linked by prev_bid
  * */
 struct __pmem_tx_log_block {
 	PMEMrwlock		lock;
-	uint64_t				bid; //block id
-	uint64_t				tid; //transaction id
+	uint64_t				bid; //block id, 1-based, 0 means none
+	uint64_t				tid; //transaction id, 0 for a shared system block
 	uint64_t				pmemaddr; //the begin offset to the pmem data in PMEM_TX_PART_LOG
 	uint64_t				cur_off; //the current offset (0 - log block size) 
 	uint64_t				n_log_recs; //the current number of log records 
 	PMEM_LOG_BLOCK_STATE	state;
 
-	int32_t				count; //number of dirty pages caused by this transaction
+	uint64_t				firstLSN;
+	uint64_t				lastLSN;
+	uint64_t				prev_bid; //previous block of the same transaction
 
-	/*update this array first, then update the dirty page table*/
-	TOID_ARRAY(TOID(PMEM_PAGE_REF))			dp_array; //dirty page array consists of key of entry in dirty page table
-	uint64_t				n_dp_entries; 
-
-	//debug only
-	uint64_t				prev_tid; //transaction id
+	/*DRAM counter: number of DPT refs to this block, i.e. dirty pages
+	 * that have log recs on this block and are not flushed yet*/
+	int32_t				count;
 
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)
 	/*Statistic information */
@@ -463,41 +551,40 @@ struct __pmem_tx_log_block {
 };
 
 
-//Dirty Page Table Entry
+//Dirty Page Table Entry, refs grow on demand
+//a ref (PMEM_PAGE_REF) tells the page has log recs on block idx, the last one has LSN pageLSN
 struct __pmem_dpt_entry {
-	PMEMrwlock		lock; 
-	bool			is_free; //flag
 	uint64_t		key; //fold of page_id_t.fold() in InnoDB
-	int64_t		eid; //entry id in the DPT
-	int32_t		count; //number of current active transactions
-	uint64_t		pageLSN;
-
-	TOID(int64_t)	tx_idx_arr; //array of transaction index
-	uint16_t	    n_tx_idx; //array length
+	PMEM_PAGE_REF*	refs;
+	uint32_t		n_refs;
+	uint32_t		max_refs; //allocated length of refs
 
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)
-	uint64_t		n_reused; 
 	uint64_t		max_txref_size; 
 #endif
 };
+
+typedef std::unordered_map<uint64_t, PMEM_DPT_ENTRY*> DPT_MAP;
+
 // A DPT hashed line in the DPT
 struct __pmem_dpt_hashed_line {
 	PMEMrwlock		lock; 
 
 	uint64_t hashed_id;
 	uint64_t n_entries; // # of entries in line
-	TOID_ARRAY(TOID(PMEM_DPT_ENTRY)) arr;
+	DPT_MAP* map;
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)
-	uint64_t n_free; //number of free entry
-	uint64_t n_idle; //number of entries have count 0 and not free
+	uint64_t n_free; //number of entries removed
+	uint64_t n_idle; //not used
 #endif
 };
 
-/*Dirty Page Table*/
+/*Dirty Page Table, in DRAM
+ * The pages are flushed before the crash or recovered by REDO, so the
+ * table is rebuilt empty at startup*/
 struct __pmem_dpt {
 	uint64_t	n_buckets; 
-	uint64_t	n_entries_per_bucket;
-	TOID_ARRAY(TOID(PMEM_DPT_HASHED_LINE)) buckets;
+	PMEM_DPT_HASHED_LINE* buckets;
 };
 /////////////// Per-Page Logging ///////////////////
 
@@ -521,6 +608,12 @@ struct __pmem_page_part_log {
 	uint64_t			size; //the total size 
 	PMEMoid				data; //pointer to allocated nvm
 	byte*				p_align; //align
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*the log buf data is split in one region per node, data is not used*/
+	uint64_t			n_nodes; //fixed at alloc time
+	PMEMoid				node_data[PMEM_NUMA_MAX_NODES];
+	byte*				node_p_align[PMEM_NUMA_MAX_NODES]; //DRAM, align
+#endif
 
 	uint64_t						log_buf_size; //log block size in bytes
 	uint64_t						n_log_bufs;
@@ -542,7 +635,21 @@ struct __pmem_page_part_log {
 	/*Flusher*/	
 	os_event_t free_log_pool_event; //event for free_pool
 	PMEM_LOG_FLUSHER*	flusher;
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	PMEM_PPL_RECLAIMER*	reclaimer; /*resets log blocks and returns log bufs off the IO completion path*/
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	PMEM_PPL_FREE_DEPOT*	depot; /*the free log bufs in DRAM, free_pool is only the alloc-time list*/
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	ulint		n_pressured_lines; /*# of lines with pressure_pct >= srv_ppl_flush_pressure_pct*/
+#endif
 	TOID(PMEM_PAGE_LOG_FREE_POOL)	free_pool;
+#if defined (UNIV_PFS_RWLOCK)
+	/*DRAM, performance_schema instances of the free pool lock and ckpt_lock*/
+	PSI_rwlock*		free_pool_lock_psi;
+	PSI_rwlock*		ckpt_lock_psi;
+#endif
 	
 	/*RECOVERY*/
 	PMEM_RECV_LINE* recv_line; /*the global recv_line*/
@@ -552,14 +659,19 @@ struct __pmem_page_part_log {
 	uint16_t			n_redoing_lines; /*# lines are redoing*/
 	bool				is_redoing_done; /*true iff n_redoing_lines == 0*/
 	os_event_t redoing_done_event; //event for redoing
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	PMEM_RECV_IO_SCHED*	io_sched; /*page reads of all lines in REDO phase 2*/
+#endif
 
 	/*DRAM Log File*/	
 	uint64_t			log_file_size;
 	pfs_os_file_t		log_files[4096];
 	uint64_t			n_log_files_per_bucket;
-	PMEM_LOG_GROUP**	log_groups; //n_buckets groups
-	fil_node_t**		node_arr; // n_buckets fil_nodes
+	PMEM_LOG_GROUP**	log_groups; //n_buckets groups, NULL until the first IO of the line
+	fil_node_t**		node_arr; // n_buckets fil_nodes, set up with the group
 	fil_space_t*		log_space;
+	char*				log_dir; //prefix of the log file names
+	PMEMrwlock			log_open_lock; //set up of log_groups and node_arr
 	/*Statistic info*/	
 	//log area
 	uint64_t			pmem_alloc_size;
@@ -600,6 +712,11 @@ std::unordered_map<uint64_t, PMEM_PAGE_LOG_BLOCK*, std::hash<uint64_t>, std::equ
 struct __pmem_page_log_hashed_line {
 	/*general lock protect data in PART 1 and PART 3*/
 	PMEMrwlock		lock;
+#if defined (UNIV_PFS_RWLOCK)
+	/*DRAM, performance_schema instances of lock and meta_lock*/
+	PSI_rwlock*		lock_psi;
+	PSI_rwlock*		meta_lock_psi;
+#endif
 	
 	/*PART 1, writing log rec to logbuf*/
 	int hashed_id;
@@ -616,6 +733,10 @@ struct __pmem_page_log_hashed_line {
 	uint32_t		oldest_block_id;//offset of the oldest block(start_diskaddr + start_off)
 	uint64_t		ckpt_lsn;
 	bool			is_req_checkpoint;
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	/*DRAM, used log file space of this line in percent, see pm_ppl_update_line_pressure()*/
+	uint32_t		pressure_pct;
+#endif
 
 	/* recovery */
 	uint64_t		recv_diskaddr; //the diskaddr begin the recover, min of log blocks diskaddr
@@ -648,6 +769,11 @@ struct __pmem_page_log_hashed_line {
 	PMEM_RECV_LINE* recv_line;
 	bool			is_redoing;
 
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	/*DRAM, page index of the current logbuf, protected by lock*/
+	PMEM_PPL_COMPACT_DICT* compact_dict;
+#endif
+
 	/*Statistic info*/
 #if defined(UNIV_PMEMOBJ_PPL_STAT)
 	uint64_t log_write_lock_wait_time; //total time lock holding for copying log records to log buffer
@@ -673,6 +799,9 @@ struct __pmem_page_log_buf {
 	PMEMoid					self; //self reference
 
 	uint64_t				pmemaddr; //the begin offset to the pmem data in PMEM_PAGE_PART_LOG
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	uint32_t				node; //pmemaddr is an offset in the data region of this node
+#endif
 
 	uint64_t				id;
 	int64_t					hashed_id;
@@ -766,6 +895,10 @@ struct __pmem_recv_line {
 
 	recv_dblwr_t	dblwr;
 	encryption_list_t* encryption_list;
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	/*page index of the logbuf being parsed, reset for each logbuf*/
+	PMEM_PPL_COMPACT_DICT* compact_dict;
+#endif
 
 	/*statistic info*/
 	ulint		redo1_thread_id;
@@ -779,6 +912,55 @@ struct __pmem_recv_line {
 	ulint		redo2_elapse_time;
 };
 
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+/*
+ * Page index of one logbuf in the compact encoding
+ * The writer maps the key of a page to its index in the logbuf,
+ * the reader maps the index back to (space, page_no)
+ * Both sides assign indexes in the order pages first appear in the logbuf
+ * */
+struct __pmem_ppl_compact_dict {
+	uint64_t	buf_id; /*the logbuf this index is built for*/
+	bool		is_valid; /*false: the logbuf has recs written before the index, write full recs*/
+	uint32_t	n_pages;
+	uint64_t	last_lsn; /*rec_lsn of the last rec in the logbuf*/
+
+	uint16_t	slots[PMEM_PPL_COMPACT_HASH_SIZE]; /*open addressing, idx + 1, 0 is empty*/
+	uint64_t	keys[PMEM_PPL_COMPACT_MAX_PAGES];
+	ulint		spaces[PMEM_PPL_COMPACT_MAX_PAGES];
+	ulint		page_nos[PMEM_PPL_COMPACT_MAX_PAGES];
+};
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+/*
+ * A page read requested by a recv_line in REDO phase 2
+ * */
+struct __pmem_recv_io_req {
+	ulint			space;
+	ulint			page_no;
+	PMEM_RECV_LINE*	recv_line; /*the line that owns the page*/
+};
+
+/*
+ * Recovery read scheduler shared by all lines
+ * The hash spreads the pages of one extent over many lines, the scheduler
+ * collects the reads of all lines and issues them sorted by (space, page_no)
+ * so that neighbouring pages reach the AIO array together and are merged.
+ * The read completion applies the page with the line of its key as before.
+ * */
+struct __pmem_recv_io_sched {
+	PMEMrwlock			lock;
+	PMEM_RECV_IO_REQ*	reqs; /*pending requests*/
+	ulint				n_reqs;
+	ulint				max_reqs; /*batch size, srv_ppl_recv_read_batch*/
+
+	/*statistic info*/
+	ulint				n_batches;
+	ulint				n_issued;
+};
+#endif
+
 ////////////////     FLUSHER         /////////////////
 /*
  * FLUSHER - Handle async flus logs to disk
@@ -872,6 +1054,156 @@ DECLARE_THREAD(pm_log_flusher_worker)(
 		void* arg);
 ////////////////     END FLUSHER   /////////////////
 
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+////////////////    RECLAIMER   /////////////////
+/*
+ * A page flush or a finished log buf AIO posted to the reclaimer
+ * plogbuf == NULL: the page key is written up to pageLSN, reset its log block
+ * plogbuf != NULL: the log buf is on disk, return it to the free pool
+ * */
+struct __pmem_reclaim_notice {
+	uint64_t			key;
+	uint64_t			pageLSN;
+	uint64_t			hashed_id; /*line of key, to batch per line*/
+	PMEM_PAGE_LOG_BUF*	plogbuf;
+};
+
+/*A slot of the bounded queue, seq tells whether the slot is free or full*/
+struct __pmem_reclaim_cell {
+	volatile uint64_t	seq;
+	PMEM_RECLAIM_NOTICE	notice;
+};
+
+/*
+ * Lock-free bounded queue of notices, many producers (IO handler threads)
+ * one consumer (the reclaimer thread)
+ * A producer that finds the queue full does the work inline as before
+ * */
+struct __pmem_ppl_reclaimer {
+	PMEM_RECLAIM_CELL*	cells;
+	uint64_t			size; /*power of 2*/
+	uint64_t			mask;
+	uint64_t			batch; /*max notices per batch*/
+
+	/*producers and the consumer run on different cache lines*/
+	byte				pad1[CACHELINE_SIZE];
+	volatile uint64_t	enq_pos;
+	byte				pad2[CACHELINE_SIZE];
+	volatile uint64_t	deq_pos;
+	byte				pad3[CACHELINE_SIZE];
+
+	PMEMrwlock			consumer_lock; /*the thread and the drain at recv end/close*/
+	PMEM_RECLAIM_NOTICE* buf; /*the current batch, owned by the consumer*/
+
+	os_event_t			event; /*wake up the reclaimer*/
+	volatile ulint		n_workers;
+
+	/*statistic*/
+	uint64_t			n_batches;
+	uint64_t			n_reset_blocks;
+	uint64_t			n_skipped; /*the page got newer recs after the write*/
+	uint64_t			n_returned_bufs;
+	uint64_t			n_inline; /*queue full, done by the producer*/
+};
+
+PMEM_PPL_RECLAIMER*
+pm_ppl_reclaimer_init(
+		uint64_t			size,
+		uint64_t			batch);
+
+void
+pm_ppl_reclaimer_close(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl);
+
+bool
+pm_ppl_reclaimer_post(
+		PMEM_PPL_RECLAIMER*	reclaimer,
+		uint64_t			key,
+		uint64_t			pageLSN,
+		uint64_t			hashed_id,
+		PMEM_PAGE_LOG_BUF*	plogbuf);
+
+ulint
+pm_ppl_reclaimer_drain(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl);
+
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(pm_ppl_reclaimer_thread)(
+		void* arg);
+////////////////     END RECLAIMER   /////////////////
+#endif /* UNIV_PMEMOBJ_PPL_RECLAIMER */
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+////////////////    MAGAZINE   /////////////////
+/*
+ * A per-CPU stack of free log bufs, holds up to 2 * depot->batch bufs
+ * */
+struct __pmem_ppl_magazine {
+	PMEMrwlock			lock;
+	ulint				n;
+	PMEMoid*			bufs;
+	byte				pad[CACHELINE_SIZE];
+};
+
+/*
+ * The free log bufs of the PPL in DRAM
+ * Writers take a buf from the magazine of their CPU and the IO handlers put the
+ * finished ones in theirs, full and empty magazines exchange batch bufs with
+ * the shared stack. A buf is owned by a line iff it is on the chain of the
+ * line (tail_logbuf .. logbuf), the depot is rebuilt from the chains at startup
+ * */
+struct __pmem_ppl_free_depot {
+	PMEMrwlock			lock;
+	ulint				n; /*bufs in the shared stack*/
+	ulint				max_bufs;
+	PMEMoid*			bufs;
+
+	ulint				batch;
+	ulint				n_mags;
+	PMEM_PPL_MAGAZINE*	mags;
+
+	volatile ulint		n_waiters; /*writers waiting on free_log_pool_event*/
+
+	/*statistic*/
+	uint64_t			n_refills;
+	uint64_t			n_drains;
+	uint64_t			n_steals;
+	uint64_t			n_waits;
+};
+
+PMEM_PPL_FREE_DEPOT*
+pm_ppl_depot_init(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		ulint				batch);
+
+void
+pm_ppl_depot_close(
+		PMEM_PAGE_PART_LOG*	ppl);
+
+void
+pm_ppl_depot_reset_buf(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_PAGE_LOG_BUF*	plogbuf);
+
+TOID(PMEM_PAGE_LOG_BUF)
+pm_ppl_depot_get(
+		PMEMobjpool*				pop,
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline);
+
+void
+pm_ppl_depot_put(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_PAGE_LOG_BUF*	plogbuf);
+////////////////     END MAGAZINE   /////////////////
+#endif /* UNIV_PMEMOBJ_PPL_MAGAZINE */
+
 ////////////////    REDOER   /////////////////
 /*
  * Handle parallelism REDOing in recovery
@@ -968,6 +1300,10 @@ struct __pmem_tt_entry {
 
 struct __pmem_tt_hashed_line {
 	PMEMrwlock		lock;
+#if defined (UNIV_PFS_RWLOCK)
+	/*DRAM, one performance_schema instance for the entry locks of the line*/
+	PSI_rwlock*		entry_lock_psi;
+#endif
 
 	uint64_t		hashed_id;
 
@@ -1011,6 +1347,10 @@ struct __pmem_log_group {
 
 ////////////// NEW PARTITIONED LOG ////////////////////
 ////////// PER-TX LOGGING/////////////////////////
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+PMEM_TX_PART_LOG*
+pm_pop_get_ptxl(PMEMobjpool* pop);
+
 void
 pm_wrapper_tx_log_alloc_or_open(
 		PMEM_WRAPPER*	pmw,
@@ -1018,6 +1358,10 @@ pm_wrapper_tx_log_alloc_or_open(
 		uint64_t		n_blocks_per_bucket,
 		uint64_t		block_size);
 
+void
+pm_wrapper_tx_log_close(
+		PMEM_WRAPPER*	pmw);
+
 PMEM_TX_PART_LOG* alloc_pmem_tx_part_log(
 		PMEMobjpool*	pop,
 		uint64_t		n_buckets,
@@ -1031,35 +1375,36 @@ pm_tx_part_log_bucket_init(
 		uint64_t			n_blocks_per_bucket,
 		uint64_t			block_size); 
 
-void 
-__init_dpt(
-		PMEMobjpool*		pop,
-		PMEM_TX_PART_LOG*		ptxl,
-		uint64_t n,
-		uint64_t k);
+PMEM_DPT*
+pm_ptxl_dpt_init(
+		uint64_t			n_lines);
 
-/*Called when a mini-transaction write log record to log buffer in the traditional InnoDB*/
-int64_t
-pm_ptxl_write(
+void
+pm_ptxl_dpt_free(
+		PMEM_DPT*			pdpt);
+
+PMEM_TX_LOG_BLOCK*
+pm_ptxl_get_block_by_id(
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			bid);
+
+/*Called for each log rec of a mtr in the per-transaction mode, the
+ * counterpart of pm_ppl_write_rec()*/
+uint64_t
+pm_ptxl_write_rec(
 			PMEMobjpool*		pop,
-			PMEM_TX_PART_LOG*		ptxl,
-			uint64_t			tid,
+			PMEM_TX_PART_LOG*	ptxl,
+			trx_t*				trx,
+			uint64_t			key,
 			byte*				log_src,
-			uint64_t			size,
-			uint64_t			n_recs,
-			uint64_t*			key_arr,
-			uint64_t*			LSN_arr,
-			uint64_t*			size_arr,
-			uint64_t*			space_arr,
-			uint64_t*			page_arr,
-			int64_t			block_id);
+			uint32_t			rec_size);
 
 void
 pm_ptxl_commit(
 		PMEMobjpool*		pop,
-		PMEM_TX_PART_LOG*		ptxl,
-		uint64_t tid,
-		int64_t bid);
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			tid,
+		uint64_t			bid);
 void 
 pm_ptxl_on_flush_page(
 		PMEMobjpool*		pop,
@@ -1067,35 +1412,19 @@ pm_ptxl_on_flush_page(
 		uint64_t			key,
 		uint64_t			pageLSN);
 
-
-int64_t
-__update_dpt_entry_on_write_log(
-		PMEMobjpool*		pop,
-		PMEM_TX_PART_LOG*	ptxl,
-		uint64_t			tid,
-		uint64_t			key); 
-
-bool
-__update_dpt_entry_on_commit(
-		PMEMobjpool*		pop,
-		PMEM_DPT*			pdpt,
-		PMEM_PAGE_REF* pref);
-void 
-__reset_DPT_entry(PMEM_DPT_ENTRY* pe);
 void 
 __reset_tx_log_block(PMEM_TX_LOG_BLOCK* plog_block);
 
-bool
-__check_and_reclaim_tx_log_block(
-		PMEMobjpool*		pop,
-		PMEM_TX_PART_LOG*	ptxl,
-		int64_t			block_id);
-bool
-pm_ptxl_check_and_reset_dpt_entry(
+uint64_t
+pm_ptxl_get_max_lsn(
 		PMEMobjpool*		pop,
-		PMEM_DPT*			pdpt,
-		uint64_t			key);
+		PMEM_TX_PART_LOG*	ptxl);
 
+void
+pm_ptxl_reset_all(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl);
+#endif //UNIV_PMEMOBJ_TX_LOG
 
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)
 void 
@@ -1282,6 +1611,17 @@ pm_ppl_check_for_ckpt(
 			PMEM_PAGE_LOG_BUF*			plogbuf,
 			uint64_t					cur_lsn
 			);
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+void
+pm_ppl_update_line_pressure(
+			PMEM_PAGE_PART_LOG*			ppl,
+			PMEM_PAGE_LOG_HASHED_LINE*	pline,
+			uint64_t					cur_off);
+
+ulint
+pm_ppl_get_max_pressure(
+			PMEM_PAGE_PART_LOG*			ppl);
+#endif
 uint64_t
 pm_ppl_compute_ckpt_lsn(
 			PMEMobjpool*				pop,
@@ -1356,6 +1696,192 @@ __pm_write_log_buf(
 			PMEM_PAGE_LOG_BLOCK*		plog_block,
 			bool						is_first_write);
 
+/////////// performance_schema for PPL ///////////
+/*
+ * PMEMrwlocks bypass the rw_lock_t wrappers, the hot ones carry a DRAM
+ * PSI_rwlock* (NULL if not instrumented) passed to the pm_rwlock_*() macros
+ * Persists are accounted as I/O on the pool file: the flush is a write with
+ * the byte count, the drain is a sync
+ * */
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_RWLOCK)
+static inline PSI_rwlock*
+pm_rwlock_psi_init(
+			mysql_pfs_key_t			key,
+			PMEMrwlock*				lock)
+{
+	return(PSI_RWLOCK_CALL(init_rwlock)(key.m_value, lock));
+}
+
+static inline void
+pm_rwlock_psi_destroy(
+			PSI_rwlock*&			psi)
+{
+	if (psi != NULL) {
+		PSI_RWLOCK_CALL(destroy_rwlock)(psi);
+		psi = NULL;
+	}
+}
+
+static inline void
+pfs_pm_rwlock_wrlock(
+			PMEMobjpool*			pop,
+			PMEMrwlock*				lock,
+			PSI_rwlock*				psi,
+			const char*				file,
+			uint					line)
+{
+	PSI_rwlock_locker_state	state;
+	PSI_rwlock_locker*		locker = NULL;
+	int						ret;
+
+	if (psi != NULL) {
+		locker = PSI_RWLOCK_CALL(start_rwlock_wrwait)(
+				&state, psi, PSI_RWLOCK_WRITELOCK, file, line);
+	}
+
+	ret = pmemobj_rwlock_wrlock(pop, lock);
+
+	if (locker != NULL) {
+		PSI_RWLOCK_CALL(end_rwlock_wrwait)(locker, ret);
+	}
+}
+
+static inline void
+pfs_pm_rwlock_rdlock(
+			PMEMobjpool*			pop,
+			PMEMrwlock*				lock,
+			PSI_rwlock*				psi,
+			const char*				file,
+			uint					line)
+{
+	PSI_rwlock_locker_state	state;
+	PSI_rwlock_locker*		locker = NULL;
+	int						ret;
+
+	if (psi != NULL) {
+		locker = PSI_RWLOCK_CALL(start_rwlock_rdwait)(
+				&state, psi, PSI_RWLOCK_READLOCK, file, line);
+	}
+
+	ret = pmemobj_rwlock_rdlock(pop, lock);
+
+	if (locker != NULL) {
+		PSI_RWLOCK_CALL(end_rwlock_rdwait)(locker, ret);
+	}
+}
+
+static inline void
+pfs_pm_rwlock_unlock(
+			PMEMobjpool*			pop,
+			PMEMrwlock*				lock,
+			PSI_rwlock*				psi)
+{
+	if (psi != NULL) {
+		PSI_RWLOCK_CALL(unlock_rwlock)(psi);
+	}
+
+	pmemobj_rwlock_unlock(pop, lock);
+}
+
+#define pm_rwlock_wrlock(pop, lock, psi) \
+	pfs_pm_rwlock_wrlock(pop, lock, psi, __FILE__, __LINE__)
+#define pm_rwlock_rdlock(pop, lock, psi) \
+	pfs_pm_rwlock_rdlock(pop, lock, psi, __FILE__, __LINE__)
+#define pm_rwlock_unlock(pop, lock, psi) \
+	pfs_pm_rwlock_unlock(pop, lock, psi)
+#else /* UNIV_PMEMOBJ_PART_PL && UNIV_PFS_RWLOCK */
+#define pm_rwlock_wrlock(pop, lock, psi) pmemobj_rwlock_wrlock(pop, lock)
+#define pm_rwlock_rdlock(pop, lock, psi) pmemobj_rwlock_rdlock(pop, lock)
+#define pm_rwlock_unlock(pop, lock, psi) pmemobj_rwlock_unlock(pop, lock)
+#endif /* UNIV_PMEMOBJ_PART_PL && UNIV_PFS_RWLOCK */
+
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_IO)
+/*the pool file as seen by performance_schema, NULL if not instrumented*/
+extern PSI_file*	pm_ppl_persist_psi;
+
+void
+pm_ppl_pfs_open(
+			const char*				pool_name);
+
+void
+pm_ppl_pfs_close();
+
+static inline void
+pfs_pm_persist(
+			PMEMobjpool*			pop,
+			const void*				addr,
+			size_t					len,
+			const char*				file,
+			uint					line)
+{
+	PSI_file_locker_state	state;
+	PSI_file_locker*		locker = NULL;
+
+	if (pm_ppl_persist_psi != NULL) {
+		locker = PSI_FILE_CALL(get_thread_file_stream_locker)(
+				&state, pm_ppl_persist_psi, PSI_FILE_WRITE);
+	}
+
+	if (locker == NULL) {
+		pmemobj_persist(pop, addr, len);
+		return;
+	}
+
+	PSI_FILE_CALL(start_file_wait)(locker, len, file, line);
+	pmemobj_flush(pop, addr, len);
+	PSI_FILE_CALL(end_file_wait)(locker, len);
+
+	locker = PSI_FILE_CALL(get_thread_file_stream_locker)(
+			&state, pm_ppl_persist_psi, PSI_FILE_SYNC);
+	if (locker == NULL) {
+		pmemobj_drain(pop);
+		return;
+	}
+
+	PSI_FILE_CALL(start_file_wait)(locker, 0, file, line);
+	pmemobj_drain(pop);
+	PSI_FILE_CALL(end_file_wait)(locker, 0);
+}
+
+/*the copy is done with non-temporal stores, it is accounted as one write*/
+static inline void
+pfs_pm_memcpy_persist(
+			PMEMobjpool*			pop,
+			void*					dest,
+			const void*				src,
+			size_t					len,
+			const char*				file,
+			uint					line)
+{
+	PSI_file_locker_state	state;
+	PSI_file_locker*		locker = NULL;
+
+	if (pm_ppl_persist_psi != NULL) {
+		locker = PSI_FILE_CALL(get_thread_file_stream_locker)(
+				&state, pm_ppl_persist_psi, PSI_FILE_WRITE);
+	}
+
+	if (locker != NULL) {
+		PSI_FILE_CALL(start_file_wait)(locker, len, file, line);
+	}
+
+	pmemobj_memcpy_persist(pop, dest, src, len);
+
+	if (locker != NULL) {
+		PSI_FILE_CALL(end_file_wait)(locker, len);
+	}
+}
+
+#define pm_persist(pop, addr, len) \
+	pfs_pm_persist(pop, addr, len, __FILE__, __LINE__)
+#define pm_memcpy_persist(pop, dest, src, len) \
+	pfs_pm_memcpy_persist(pop, dest, src, len, __FILE__, __LINE__)
+#else /* UNIV_PMEMOBJ_PART_PL && UNIV_PFS_IO */
+#define pm_persist(pop, addr, len) pmemobj_persist(pop, addr, len)
+#define pm_memcpy_persist(pop, dest, src, len) \
+	pmemobj_memcpy_persist(pop, dest, src, len)
+#endif /* UNIV_PMEMOBJ_PART_PL && UNIV_PFS_IO */
+
 static inline void
 pm_write_log_rec_low(
 			PMEMobjpool*			pop,
@@ -1363,7 +1889,7 @@ pm_write_log_rec_low(
 			byte*					log_src,
 			uint64_t				size)
 {
-	pmemobj_memcpy_persist(
+	pm_memcpy_persist(
 			pop, 
 			log_des,
 			log_src,
@@ -1477,6 +2003,14 @@ pm_ppl_recovery(
 		PMEM_PAGE_PART_LOG*	ppl,
 		lsn_t flush_lsn);
 
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+ulint
+pm_ptxl_recv_parse(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_TX_PART_LOG*	ptxl);
+#endif //UNIV_PMEMOBJ_TX_LOG
+
 void 
 pm_ppl_analysis(
 		PMEMobjpool*		pop,
@@ -1501,6 +2035,7 @@ pm_ppl_parse_recs(
 		PMEM_PAGE_LOG_HASHED_LINE* pline,
 		byte* recv_buf,
 		uint64_t len,
+		uint64_t diskaddr,
 		uint64_t* n_skip1_recs,
 		uint64_t* n_skip2_recs,
 		uint64_t* n_need_recs
@@ -1523,6 +2058,59 @@ pm_ppl_recv_parse_log_rec(
 	bool*		is_need);
 
 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+uint32_t
+pm_ppl_rec_checksum(
+		const byte*	rec,
+		uint32_t	len,
+		uint64_t	hashed_id,
+		uint64_t	diskaddr);
+
+bool
+pm_ppl_rec_check(
+		const byte*	ptr,
+		const byte*	end_ptr,
+		uint64_t	hashed_id,
+		uint64_t	diskaddr,
+		uint32_t*	rec_len);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+void
+pm_ppl_compact_dict_reset(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		uint64_t				buf_id,
+		bool					is_valid);
+
+bool
+pm_ppl_compact_is_dense(
+		mlog_id_t	type);
+
+uint32_t
+pm_ppl_compact_encode_header(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		byte*					hdr,
+		mlog_id_t				type,
+		ulint					space,
+		ulint					page_no,
+		uint64_t				key,
+		uint64_t				rec_lsn,
+		uint32_t				body_len,
+		bool					is_first);
+
+byte*
+pm_ppl_compact_parse_header(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		byte*					ptr,
+		byte*					end_ptr,
+		bool					is_first,
+		mlog_id_t*				type,
+		ulint*					space,
+		ulint*					page_no,
+		uint64_t*				rec_lsn,
+		uint32_t*				body_len);
+#endif
+
 void 
 pm_ppl_recv_line_empty_hash(
 	PMEMobjpool*		pop,
@@ -1605,6 +2193,36 @@ pm_ppl_buf_read_recv_pages(
 		const ulint* page_nos,
 		ulint n_stored);
 
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+PMEM_RECV_IO_SCHED*
+pm_ppl_recv_io_sched_init(
+		ulint			max_reqs);
+
+void
+pm_ppl_recv_io_sched_close(
+		PMEM_RECV_IO_SCHED*	sched);
+
+void
+pm_ppl_recv_io_sched_add(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_RECV_LINE*		recv_line,
+		ulint				space,
+		ulint				page_no);
+
+void
+pm_ppl_recv_io_sched_flush(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl);
+
+void
+pm_ppl_buf_read_recv_sorted(
+		PMEMobjpool*			pop,
+		PMEM_PAGE_PART_LOG*		ppl,
+		const PMEM_RECV_IO_REQ*	reqs,
+		ulint					n_reqs);
+#endif //UNIV_PMEMOBJ_PPL_RECV_SCHED
+
 void
 pm_ppl_recv_apply_hashed_log_recs(
 		PMEMobjpool*		pop,
@@ -1760,6 +2378,51 @@ pm_ppl_get_line_from_key(
 		PMEM_PAGE_PART_LOG*			ppl,
 		uint64_t key);
 
+/*address of the data of a log buf*/
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+#define PMEM_LOG_BUF_DATA(ppl, plogbuf) \
+	((ppl)->node_p_align[(plogbuf)->node] + (plogbuf)->pmemaddr)
+#else
+#define PMEM_LOG_BUF_DATA(ppl, plogbuf) \
+	((ppl)->p_align + (plogbuf)->pmemaddr)
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+/////////////////////// NUMA ////////////////////////////
+void
+pm_numa_init();
+
+ulint
+pm_numa_n_nodes();
+
+ulint
+pm_numa_cur_node();
+
+ulint
+pm_numa_node_of_line(
+		uint64_t	hashed_id,
+		uint64_t	n_lines,
+		ulint		n_nodes);
+
+bool
+pm_numa_bind_thread(
+		ulint		node);
+
+ulint
+pm_numa_bind_next_thread();
+
+void
+pm_numa_open_pools(
+		PMEM_WRAPPER*	pmw,
+		ulint			n_nodes,
+		const uint64_t*	sizes);
+
+void
+pm_numa_close_pools(
+		PMEM_WRAPPER*	pmw);
+/////////////////////// END NUMA ////////////////////////////
+#endif /* UNIV_PMEMOBJ_PPL_NUMA */
+
 /////////////////////// LOG FILES ////////////////////////////
 
 // See srv0start.cc for implementation
@@ -1774,6 +2437,12 @@ void
 pm_close_and_free_log_files(
 		PMEM_PAGE_PART_LOG*	ppl);
 
+PMEM_LOG_GROUP*
+pm_ppl_get_log_group(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		uint64_t			hashed_id);
+
 PMEM_LOG_GROUP*
 pm_log_group_init(
 /*===========*/
@@ -1841,6 +2510,14 @@ struct __pmem_log_buf {
 					  normally. Whenever a log record is copy to log buffer, this flag is set to true
 	*/
 	uint64_t			last_tsec_buf_free; /*the buf_free updated in previous t seconds, update this value in srv_sync_log_buffer_in_background() */
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/*With spill, buf_free is the offset within the half in use (log_sys->buf),
+	 * the halves start at the OS_FILE_LOG_BLOCK_SIZE aligned address of data*/
+	uint64_t			half_size; /*log_sys->buf_size when the halves were laid out*/
+	uint64_t			cur_half; /*0 or 1, the half log_sys->buf points to*/
+	uint64_t			half_lsn[2]; /*block aligned lsn of the first byte in each half*/
+	uint64_t			spilled_lsn; /*log up to this lsn is written and flushed to ib_logfile, LSN_MAX if the NVM copy must not be replayed*/
+#endif
 };
 
 void* pm_wrapper_logbuf_get_logdata(PMEM_WRAPPER* pmw);
@@ -1877,6 +2554,13 @@ struct __pmem_dbw {
 	uint64_t s_first_free;
 	uint64_t b_first_free;
 	bool is_new;
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+	/*Partitioned DBW: the data area is an array of n_slots page slots,
+	 * the DRAM side splits them into per page-cleaner ranges*/
+	uint64_t n_slots; //total slots, fixed at allocation time
+	uint64_t slot_size; //bytes per slot (UNIV_PAGE_SIZE at allocation)
+	PMEMoid  slot_state; //uint64_t per slot, PMEM_DBW_SLOT_FREE or PMEM_DBW_SLOT_IN_FLIGHT
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
 };
 
 void* pm_wrapper_dbw_get_dbwdata(PMEM_WRAPPER* pmw);
@@ -1897,6 +2581,222 @@ ssize_t  pm_wrapper_dbw_io(PMEM_WRAPPER* pmw,
 							const uint64_t offset,
 							unsigned long int n);
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+int 
+pm_wrapper_dbw_part_alloc(
+		PMEM_WRAPPER*		pmw,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+PMEM_DBW*
+pm_pop_dbw_part_alloc(
+		PMEMobjpool*		pop,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+byte*
+pm_dbw_part_get_slot(
+		PMEM_DBW*		pdbw,
+		uint64_t		slot);
+
+bool
+pm_dbw_part_slot_in_flight(
+		PMEM_DBW*		pdbw,
+		uint64_t		slot);
+
+void
+pm_dbw_part_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_DBW*		pdbw,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		len);
+
+void
+pm_dbw_part_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_DBW*		pdbw,
+		uint64_t		slot);
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
+
+///////////// UNDO PAGES ON NVM //////////////////////////
+#if defined (UNIV_PMEMOBJ_UNDO)
+/*Header of a slot in the NVM undo page area
+ * A slot holds the latest image of an undo page written by a
+ * mini-transaction that generated no redo log*/
+struct __pmem_undo_slot_hdr {
+	uint64_t state; //PMEM_UNDO_SLOT_FREE or PMEM_UNDO_SLOT_VALID
+	uint64_t space;
+	uint64_t page_no;
+	uint64_t lsn; //end lsn of the mtr that wrote the image
+	uint64_t seq; //orders the images of a page written at the same lsn
+};
+
+struct __pmem_undo {
+	size_t size;
+	PMEM_OBJ_TYPES type;
+	bool is_new;
+	uint64_t n_slots; //fixed at allocation time
+	uint64_t slot_size; //bytes per slot (UNIV_PAGE_SIZE at allocation)
+	PMEMoid  data; //page images, n_slots + 1 pages for alignment
+	PMEMoid  hdr; //PMEM_UNDO_SLOT_HDR per slot
+};
+
+int
+pm_wrapper_undo_alloc_or_open(
+		PMEM_WRAPPER*		pmw,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+PMEM_UNDO* pm_pop_get_undo(PMEMobjpool* pop);
+
+PMEM_UNDO*
+pm_pop_undo_alloc(
+		PMEMobjpool*		pop,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+byte*
+pm_undo_get_slot(
+		PMEM_UNDO*		pundo,
+		uint64_t		slot);
+
+PMEM_UNDO_SLOT_HDR*
+pm_undo_get_slot_hdr(
+		PMEM_UNDO*		pundo,
+		uint64_t		slot);
+
+void
+pm_undo_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_UNDO*		pundo,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		space,
+		uint64_t		page_no,
+		uint64_t		lsn,
+		uint64_t		seq);
+
+void
+pm_undo_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_UNDO*		pundo,
+		uint64_t		slot);
+#endif /* UNIV_PMEMOBJ_UNDO */
+
+///////////// WARM RESTART FROM NVM //////////////////////////
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+/*Header of a slot in the warm restart area
+ * A slot holds the image of a clean buffer pool page at the last dump*/
+struct __pmem_warm_slot_hdr {
+	uint64_t state; //PMEM_WARM_EMPTY or PMEM_WARM_VALID
+	uint64_t space;
+	uint64_t page_no;
+};
+
+struct __pmem_warm {
+	size_t size;
+	PMEM_OBJ_TYPES type;
+	bool is_new;
+	uint64_t state; //PMEM_WARM_VALID from a dump until the next load
+	uint64_t n_slots; //fixed at allocation time
+	uint64_t slot_size; //bytes per slot (UNIV_PAGE_SIZE at allocation)
+	PMEMoid  data; //page images, n_slots + 1 pages for alignment
+	PMEMoid  hdr; //PMEM_WARM_SLOT_HDR per slot
+};
+
+int
+pm_wrapper_warm_alloc_or_open(
+		PMEM_WRAPPER*		pmw,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+PMEM_WARM* pm_pop_get_warm(PMEMobjpool* pop);
+
+PMEM_WARM*
+pm_pop_warm_alloc(
+		PMEMobjpool*		pop,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+byte*
+pm_warm_get_slot(
+		PMEM_WARM*		pwarm,
+		uint64_t		slot);
+
+PMEM_WARM_SLOT_HDR*
+pm_warm_get_slot_hdr(
+		PMEM_WARM*		pwarm,
+		uint64_t		slot);
+
+void
+pm_warm_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		space,
+		uint64_t		page_no);
+
+void
+pm_warm_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		slot);
+
+void
+pm_warm_set_state(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		state);
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+
+///////////// VICTIM CACHE ON NVM //////////////////////////
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+/*Page slots that hold clean pages evicted from the buffer pool
+ * The slots are a cache of the datafiles, their mapping is DRAM only and the
+ * area is reused empty on every start, so nothing is persisted per slot*/
+struct __pmem_vcache {
+	size_t size;
+	PMEM_OBJ_TYPES type;
+	bool is_new;
+	uint64_t n_slots; //fixed at allocation time
+	uint64_t slot_size; //bytes per slot (UNIV_PAGE_SIZE at allocation)
+	PMEMoid  data; //page images, n_slots + 1 pages for alignment
+};
+
+int
+pm_wrapper_vcache_alloc_or_open(
+		PMEM_WRAPPER*		pmw,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+PMEM_VCACHE* pm_pop_get_vcache(PMEMobjpool* pop);
+
+PMEM_VCACHE*
+pm_pop_vcache_alloc(
+		PMEMobjpool*		pop,
+		const uint64_t		n_slots,
+	   	const size_t		slot_size);
+
+byte*
+pm_vcache_get_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot);
+
+void
+pm_vcache_write_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot,
+		const byte*		src);
+
+void
+pm_vcache_read_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot,
+		byte*			dst);
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
+
 /////// PMEM BUF  //////////////////////
 #if defined (UNIV_PMEMOBJ_BUF)
 //This struct is used only for POBJ_LIST_INSERT_NEW_HEAD
@@ -1115,6 +1115,10 @@ os_file_close_func(os_file_t file);
 extern mysql_pfs_key_t	innodb_data_file_key;
 extern mysql_pfs_key_t	innodb_log_file_key;
 extern mysql_pfs_key_t	innodb_temp_file_key;
+#if defined (UNIV_PMEMOBJ_PART_PL)
+/* Persists of the per-page log on NVDIMM, see pm_persist() */
+extern mysql_pfs_key_t	pm_ppl_persist_file_key;
+#endif
 
 /* Following four macros are instumentations to register
 various file I/O operations with performance schema.
@@ -1836,6 +1840,18 @@ bool
 os_file_flush_func(
 	os_file_t	file);
 
+#if defined (UNIV_IO_URING)
+/** Flushes the write buffers of a set of files to the disk. The fsyncs are
+submitted together on an io_uring, a file whose fsync fails is flushed again
+with os_file_flush_func().
+@param[in]	files		handles of the files
+@param[in]	n		number of files */
+void
+os_file_flush_batch(
+	const os_file_t*	files,
+	ulint			n);
+#endif /* UNIV_IO_URING */
+
 /** Retrieves the last error number if an error occurs in a file io function.
 The number should be retrieved before any other OS calls (because they may
 overwrite the error number). If the number is not known to this program,
@@ -2060,6 +2076,24 @@ os_aio_wait_until_no_pending_writes();
 void
 os_aio_simulated_wake_handler_threads();
 
+#if defined (UNIV_IO_URING)
+/** Register memory ranges, the buffer pool chunks, as fixed buffers of the
+io_urings. The reads and writes of pages in these ranges skip the mapping
+of the user pages per request.
+@param[in]	bufs		start of each range
+@param[in]	lens		length of each range
+@param[in]	n		number of ranges */
+void
+os_aio_uring_register_buffers(
+	byte**		bufs,
+	const ulint*	lens,
+	ulint		n);
+
+/** Stop using the fixed buffers, called before the ranges are freed. */
+void
+os_aio_uring_unregister_buffers();
+#endif /* UNIV_IO_URING */
+
 /** This function can be called if one wants to post a batch of reads and
 prefers an i/o-handler thread to handle them all at once later. You must
 call os_aio_simulated_wake_handler_threads later to ensure the threads
@@ -120,6 +120,12 @@ private:
 	/** Active and closed views, the closed views will have the
 	creator trx id set to TRX_ID_MAX */
 	view_list_t		m_views;
+
+#if defined (UNIV_MVCC_CSN)
+	/** Protects m_free and m_views instead of trx_sys->mutex, a view
+	is opened without trx_sys->mutex */
+	mutable ib_mutex_t	m_mutex;
+#endif /* UNIV_MVCC_CSN */
 };
 
 #endif /* read0read_h */
@@ -178,12 +178,23 @@ public:
 
 		} else if (m_ids.empty()) {
 
+#if defined (UNIV_MVCC_CSN)
+			return(csn_visible(id));
+#else
 			return(true);
+#endif /* UNIV_MVCC_CSN */
 		}
 
 		const ids_t::value_type*	p = m_ids.data();
 
+#if defined (UNIV_MVCC_CSN)
+		/* m_ids is only the exception set of the creator ids
+		added by copy_complete() */
+		return(!std::binary_search(p, p + m_ids.size(), id)
+		       && csn_visible(id));
+#else
 		return(!std::binary_search(p, p + m_ids.size(), id));
+#endif /* UNIV_MVCC_CSN */
 	}
 
 	/**
@@ -270,6 +281,20 @@ private:
 	Complete the read view creation */
 	inline void complete();
 
+#if defined (UNIV_MVCC_CSN)
+	/**
+	Opens a read view on the last published CSN. No transaction id is
+	copied, the ids between the limits are resolved through the CSN map
+	of trx_sys. Caller must own MVCC::m_mutex.
+	@param id		Creator transaction id */
+	inline void prepare_csn(trx_id_t id);
+
+	/**
+	@param id		transaction id between the limits
+	@return true if id committed before the view was opened */
+	bool csn_visible(trx_id_t id) const;
+#endif /* UNIV_MVCC_CSN */
+
 	/**
 	Copy state from another view. Must call copy_complete() to finish.
 	@param other		view to copy from */
@@ -321,6 +346,12 @@ private:
 	/** AC-NL-RO transaction view that has been "closed". */
 	bool		m_closed;
 
+#if defined (UNIV_MVCC_CSN)
+	/** The view sees the transactions committed with a CSN up to
+	this value */
+	trx_id_t	m_csn;
+#endif /* UNIV_MVCC_CSN */
+
 	typedef UT_LIST_NODE_T(ReadView) node_t;
 
 	/** List of read views in trx_sys */
@@ -572,6 +572,23 @@ row_scan_index_for_mysql(
 	ulint*			n_rows)		/*!< out: number of entries
 						seen in the consistent read */
 	MY_ATTRIBUTE((warn_unused_result));
+#if defined (UNIV_PARALLEL_READ)
+/** Scans the clustered index for CHECK TABLE with the parallel reader.
+Does the checks of row_scan_index_for_mysql() within every key range and
+between the last entry of a range and the first record of the next one.
+@param[in]	prebuilt	prebuilt struct in MySQL handle
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads
+@param[out]	n_rows		number of entries seen in the consistent read
+@return DB_SUCCESS, DB_INTERRUPTED, DB_INDEX_CORRUPT or DB_DUPLICATE_KEY */
+dberr_t
+row_scan_index_parallel_for_mysql(
+	row_prebuilt_t*		prebuilt,
+	dict_index_t*		index,
+	ulint			n_threads,
+	ulint*			n_rows)
+	MY_ATTRIBUTE((warn_unused_result));
+#endif /* UNIV_PARALLEL_READ */
 /*********************************************************************//**
 Initialize this module */
 void
@@ -649,6 +666,14 @@ struct mysql_row_templ_t {
 #define MYSQL_FETCH_CACHE_SIZE		8
 /* After fetching this many rows, we start caching them in fetch_cache */
 #define MYSQL_FETCH_CACHE_THRESHOLD	4
+#if defined (UNIV_BATCHED_FETCH)
+/* The fetch cache starts at MYSQL_FETCH_CACHE_SIZE rows and doubles every
+time a fetch fills it, up to this many rows */
+#define MYSQL_FETCH_CACHE_MAX_SIZE	256
+/* Memory for the rows of the fetch cache, it has MYSQL_FETCH_CACHE_SIZE
+rows at least */
+#define MYSQL_FETCH_CACHE_MAX_BYTES	(256 * 1024)
+#endif /* UNIV_BATCHED_FETCH */
 
 #define ROW_PREBUILT_ALLOCATED	78540783
 #define ROW_PREBUILT_FREED	26423527
@@ -827,7 +852,11 @@ struct row_prebuilt_t {
 	ulint		n_rows_fetched;	/*!< number of rows fetched after
 					positioning the current cursor */
 	ulint		fetch_direction;/*!< ROW_SEL_NEXT or ROW_SEL_PREV */
+#if defined (UNIV_BATCHED_FETCH)
+	byte*		fetch_cache[MYSQL_FETCH_CACHE_MAX_SIZE];
+#else
 	byte*		fetch_cache[MYSQL_FETCH_CACHE_SIZE];
+#endif /* UNIV_BATCHED_FETCH */
 					/*!< a cache for fetched rows if we
 					fetch many rows from the same cursor:
 					it saves CPU time to fetch them in a
@@ -845,6 +874,22 @@ struct row_prebuilt_t {
 					fetched row in fetch_cache */
 	ulint		n_fetch_cached;	/*!< number of not yet fetched rows
 					in fetch_cache */
+#if defined (UNIV_BATCHED_FETCH)
+	ulint		fetch_cache_size;/*!< number of rows a fetch puts
+					in fetch_cache, reset to
+					MYSQL_FETCH_CACHE_SIZE when the cursor
+					is positioned and doubled up to
+					n_fetch_cache_max when it is filled */
+	ulint		n_fetch_cache_alloc;/*!< number of rows allocated in
+					fetch_cache, grown to fetch_cache_size
+					when the cache is empty */
+	ulint		n_fetch_cache_max;/*!< maximum of fetch_cache_size,
+					MYSQL_FETCH_CACHE_MAX_BYTES of rows */
+	bool		fetch_cache_short;/*!< true if the last fetch that
+					cached rows put fewer than
+					fetch_cache_size rows in fetch_cache:
+					it reached the end of the result */
+#endif /* UNIV_BATCHED_FETCH */
 	mem_heap_t*	blob_heap;	/*!< in SELECTS BLOB fields are copied
 					to this heap */
 	mem_heap_t*	old_vers_heap;	/*!< memory heap where a previous
@@ -0,0 +1,185 @@
+/*****************************************************************************
+
+Copyright (c) 2018, VLDB Lab - Sungkyunkwan University. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file include/row0pread.h
+Parallel read of a clustered index
+
+The index is split in key ranges at the upper levels of the B-tree. Scan
+threads take the ranges one at a time and read them in the read view of
+the transaction, every visible record is passed to a callback.
+*******************************************************/
+
+#ifndef row0pread_h
+#define row0pread_h
+
+#include "univ.i"
+
+#if defined (UNIV_PARALLEL_READ) || defined (UNIV_PARALLEL_INDEX_BUILD)
+#include "btr0pcur.h"
+#include "data0types.h"
+#include "dict0types.h"
+#include "mem0mem.h"
+#include "mtr0mtr.h"
+#include "trx0types.h"
+#include "rem0types.h"
+
+/* The key ranges and their cursor are shared by the parallel read and
+the parallel scan of row_merge_read_clustered_index_pll() */
+
+/** Cursor on a key range of the clustered index, the leaf pages are
+read in key order in the mini-transaction mtr */
+struct row_pread_cur_t {
+	dict_index_t*		index;		/*!< clustered index */
+	const dtuple_t*		high;		/*!< first key after the
+						range, NULL for the end of
+						the index */
+	volatile bool*		stop;		/*!< the scan stops at the
+						next page when *stop is set,
+						or NULL */
+	volatile ulint*		n_pages;	/*!< incremented for every
+						leaf page read, or NULL */
+	btr_pcur_t		pcur;		/*!< persistent cursor */
+	mtr_t			mtr;		/*!< mini-transaction of the
+						current leaf page */
+};
+
+/** Split the clustered index in key ranges with about the same number of
+leaf pages. The bounds are node pointers of the highest level that has
+at least n_ranges of them, or of level 1; at most n_ranges pages are
+read per level.
+@param[in]	index		clustered index
+@param[in]	n_ranges	wanted number of ranges
+@param[out]	bounds		first key of the ranges 1 to n - 1
+@param[in,out]	heap		memory heap for the bounds
+@return number of ranges, 1 if the index is a single leaf page */
+ulint
+row_pread_split(
+	dict_index_t*	index,
+	ulint		n_ranges,
+	dtuple_t**	bounds,
+	mem_heap_t*	heap);
+
+/** Open a cursor before the first record of a key range.
+@param[out]	cur		range cursor
+@param[in]	index		clustered index
+@param[in]	low		first key of the range, NULL for the start
+of the index
+@param[in]	high		first key after the range, NULL for the end
+of the index
+@param[in]	stop		stop flag, or NULL
+@param[in,out]	n_pages		leaf page counter, or NULL */
+void
+row_pread_cur_open(
+	row_pread_cur_t*	cur,
+	dict_index_t*		index,
+	const dtuple_t*		low,
+	const dtuple_t*		high,
+	volatile bool*		stop,
+	volatile ulint*		n_pages);
+
+/** Move a range cursor to the next record. At a page end the tree lock
+is released if it has waiters, as row_merge_read_clustered_index() does.
+@param[in,out]	cur		range cursor
+@param[in]	trx		transaction, checked for interruption
+@param[out]	offsets		rec_get_offsets() of the record
+@param[in,out]	heap		memory heap for offsets
+@param[out]	err		DB_SUCCESS or DB_INTERRUPTED
+@return the record, or NULL at the end of the range, when the scan was
+stopped or on error */
+const rec_t*
+row_pread_cur_next(
+	row_pread_cur_t*	cur,
+	trx_t*			trx,
+	ulint**			offsets,
+	mem_heap_t**		heap,
+	dberr_t*		err);
+
+/** Close a range cursor.
+@param[in,out]	cur		range cursor */
+void
+row_pread_cur_close(
+	row_pread_cur_t*	cur);
+#endif /* UNIV_PARALLEL_READ || UNIV_PARALLEL_INDEX_BUILD */
+
+#if defined (UNIV_PARALLEL_READ)
+
+/** Ranges per scan thread, more ranges than threads balance the ranges
+that have more pages or more old versions to build */
+#define ROW_PREAD_RANGES_PER_THREAD	4
+
+/** Record passed to the callback of a parallel read */
+struct row_pread_row_t {
+	ulint			thread_no;	/*!< scan thread, from 0 to
+						n_threads - 1 */
+	ulint			range_no;	/*!< key range of the record */
+	bool			first_in_range;	/*!< true for the first
+						record passed from the
+						range */
+	const dict_index_t*	index;		/*!< clustered index */
+	const rec_t*		rec;		/*!< record, or the version
+						of it in the read view */
+	const ulint*		offsets;	/*!< rec_get_offsets(rec) */
+};
+
+/** Callback of a parallel read. It is called by the scan threads
+concurrently, for the records of one range in key order. rec is valid
+until the callback returns.
+@param[in]	row	visible record
+@param[in,out]	arg	argument of row_pread_scan()
+@return DB_SUCCESS to go on, any other code stops all the threads and is
+returned by row_pread_scan() */
+typedef dberr_t (*row_pread_func_t)(
+	const row_pread_row_t*	row,
+	void*			arg);
+
+/** Read the clustered index with n_threads threads. The records that are
+not delete-marked in the read view of the transaction are passed to func,
+in READ UNCOMMITTED the latest versions are. The read view is assigned
+to the transaction if it has none. Only non-locking reads are done.
+@param[in]	trx		transaction
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads, 1 reads in the
+calling thread
+@param[in]	func		callback
+@param[in,out]	arg		argument of the callback
+@return DB_SUCCESS, DB_INTERRUPTED or the error returned by func */
+dberr_t
+row_pread_scan(
+	trx_t*			trx,
+	dict_index_t*		index,
+	ulint			n_threads,
+	row_pread_func_t	func,
+	void*			arg);
+
+/** Count the visible records of the clustered index with n_threads
+threads, see row_pread_scan().
+@param[in]	trx		transaction
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads
+@param[out]	n_rows		number of records in the read view
+@return DB_SUCCESS or DB_INTERRUPTED */
+dberr_t
+row_pread_count(
+	trx_t*			trx,
+	dict_index_t*		index,
+	ulint			n_threads,
+	ulint*			n_rows);
+#endif /* UNIV_PARALLEL_READ */
+
+#endif /* row0pread_h */
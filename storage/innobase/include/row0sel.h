@@ -240,6 +240,22 @@ row_search_mvcc(
 	ulint		direction)
 	MY_ATTRIBUTE((warn_unused_result));
 
+#if defined (UNIV_BATCHED_FETCH)
+/** Pop the rows of the fetch cache to a buffer of consecutive MySQL rows,
+for a batched read after a fetch that filled the cache.
+@param[out]	buf		first row to write
+@param[in]	stride		distance between two rows in buf
+@param[in]	max_rows	maximum number of rows to write
+@param[in,out]	prebuilt	prebuilt struct
+@return number of rows written */
+ulint
+row_sel_dequeue_cached_rows_for_mysql(
+	byte*		buf,
+	ulint		stride,
+	ulint		max_rows,
+	row_prebuilt_t*	prebuilt);
+#endif /* UNIV_BATCHED_FETCH */
+
 /********************************************************************//**
 Count rows in a R-Tree leaf level.
 @return DB_SUCCESS if successful */
@@ -135,6 +135,12 @@ struct srv_stats_t {
 
 	/** Number of rows inserted */
 	ulint_ctr_64_t		n_rows_inserted;
+
+#if defined (UNIV_BATCHED_FETCH)
+	/** Number of rows returned by a batched read after its first row,
+	from the fetch cache */
+	ulint_ctr_64_t		n_rows_read_batched;
+#endif /* UNIV_BATCHED_FETCH */
 };
 
 extern const char*	srv_main_thread_op_info;
@@ -271,6 +277,25 @@ extern const ulint	SRV_UNDO_TABLESPACE_SIZE_IN_PAGES;
 #if defined(UNIV_AIO_IMPROVE)
 extern ulong	srv_aio_n_slots_per_seg;
 #endif
+#if defined(UNIV_LOCK_SYS_SHARDED)
+extern ulong	srv_lock_sys_n_shards;
+#endif
+#if defined(UNIV_MVCC_CSN)
+extern ulong	srv_mvcc_csn_slots;
+#endif
+#if defined(UNIV_LOG_CONCURRENT_COPY)
+extern ulong	srv_log_recent_written_size;
+#endif
+#if defined(UNIV_IO_URING)
+extern my_bool	srv_use_io_uring;
+extern my_bool	srv_io_uring_poll;
+#endif
+#if defined(UNIV_PARALLEL_INDEX_BUILD)
+extern ulong	srv_parallel_index_build_threads;
+#endif
+#if defined(UNIV_PARALLEL_READ)
+extern ulong	srv_parallel_read_threads;
+#endif
 #if defined(UNIV_PMEMOBJ_BUF)
 extern ulong	srv_pmem_buf_bucket_size;
 #endif
@@ -291,6 +316,83 @@ extern double	srv_pmem_bloom_fpr;
 extern ulong	srv_pmem_sim_latency;
 #endif
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+extern ulong	srv_pmem_dbw_slots_per_part;
+#endif
+
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+extern ulong	srv_pmem_log_spill_interval;
+#endif
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+#if !defined (UNIV_PMEMOBJ_LOG) && !defined (UNIV_PMEMOBJ_DBW)
+#error "UNIV_PMEMOBJ_UNDO needs the PMEM pool of UNIV_PMEMOBJ_LOG or UNIV_PMEMOBJ_DBW"
+#endif
+#if defined (UNIV_PMEMOBJ_PL)
+#error "UNIV_PMEMOBJ_UNDO works with the classic mtr commit only"
+#endif
+extern ulong	srv_pmem_undo_slots;
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+#if !defined (UNIV_PMEMOBJ_LOG) && !defined (UNIV_PMEMOBJ_DBW) && !defined (UNIV_PMEMOBJ_BUF) && !defined (UNIV_PMEMOBJ_WAL) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_BUF_WARM needs the PMEM pool of another PMEMOBJ mode"
+#endif
+extern ulong	srv_pmem_warm_slots;
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+#if !defined (UNIV_PMEMOBJ_LOG) && !defined (UNIV_PMEMOBJ_DBW) && !defined (UNIV_PMEMOBJ_BUF) && !defined (UNIV_PMEMOBJ_WAL) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_BUF_VCACHE needs the PMEM pool of another PMEMOBJ mode"
+#endif
+extern ulong	srv_pmem_vcache_slots;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_COMPACT is an encoding of the UNIV_PMEMOBJ_PART_PL log"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_CHECKSUM checks the recs of the UNIV_PMEMOBJ_PART_PL logbufs"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_HYBRID splits the mtr log between log_sys and UNIV_PMEMOBJ_PART_PL"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID) && defined (UNIV_PMEMOBJ_PPL_COMPACT)
+#error "UNIV_PMEMOBJ_PPL_HYBRID keeps the dep_lsn of the full PPL recs, UNIV_PMEMOBJ_PPL_COMPACT does not encode it"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_RECV_SCHED schedules the page reads of UNIV_PMEMOBJ_PART_PL recovery"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_RECLAIMER reclaims the log blocks and log bufs of UNIV_PMEMOBJ_PART_PL"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_MAGAZINE caches the free log bufs of UNIV_PMEMOBJ_PART_PL"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH drives the page cleaner by the log space of UNIV_PMEMOBJ_PART_PL lines"
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA) && !defined (UNIV_PMEMOBJ_PART_PL)
+#error "UNIV_PMEMOBJ_PPL_NUMA places the log bufs and workers of UNIV_PMEMOBJ_PART_PL per NUMA node"
+#endif
+
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+#if !defined (UNIV_PMEMOBJ_PART_PL) || !defined (UNIV_PMEMOBJ_USE_TT) || !defined (UNIV_PMEMOBJ_PL)
+#error "UNIV_PMEMOBJ_TX_LOG needs UNIV_PMEMOBJ_PART_PL, UNIV_PMEMOBJ_PL and the mtr to trx link of UNIV_PMEMOBJ_USE_TT"
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID) || defined (UNIV_PMEMOBJ_PPL_COMPACT)
+#error "UNIV_PMEMOBJ_TX_LOG keeps full PPL recs of every tablespace in the transaction log blocks"
+#endif
+#endif
+
 #if defined(UNIV_PMEMOBJ_BUF) || defined (UNIV_PMEMOBJ_DBW) || defined (UNIV_PMEMOBJ_LOG) || defined(UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PART_PL)
 extern char*	srv_pmem_home_dir;
 extern ulong	srv_pmem_pool_size;
@@ -311,8 +413,32 @@ extern double	srv_ppl_ckpt_threshold;
 extern ulong	srv_ppl_log_flusher_wake_threshold;
 extern ulong	srv_ppl_n_log_flush_threads;
 extern ulong	srv_ppl_n_redoer_threads;
+extern ulong	srv_ppl_n_init_threads;
 extern ulong	srv_ppl_log_file_size;
 extern ulong	srv_ppl_log_files_per_bucket;
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+extern ulong	srv_ppl_recv_read_batch;
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+extern ulong	srv_ppl_log_mode;
+extern ulong	srv_ptxl_n_buckets;
+extern ulong	srv_ptxl_blocks_per_bucket;
+extern ulong	srv_ptxl_block_size;
+extern ulong	srv_ptxl_dpt_n_lines;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+extern ulong	srv_ppl_reclaim_queue_size;
+extern ulong	srv_ppl_reclaim_batch;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+extern ulong	srv_ppl_magazine_size;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+extern ulong	srv_ppl_flush_pressure_pct;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+extern char*	srv_pmem_numa_home_dirs;
+#endif
 
 #endif
 extern char*	srv_log_group_home_dir;
@@ -978,6 +1104,9 @@ struct export_var_t{
 	ulint innodb_rows_inserted;		/*!< srv_n_rows_inserted */
 	ulint innodb_rows_updated;		/*!< srv_n_rows_updated */
 	ulint innodb_rows_deleted;		/*!< srv_n_rows_deleted */
+#if defined (UNIV_BATCHED_FETCH)
+	ulint innodb_rows_read_batched;		/*!< srv_stats.n_rows_read_batched */
+#endif /* UNIV_BATCHED_FETCH */
 	ulint innodb_num_open_files;		/*!< fil_n_file_opened */
 	ulint innodb_truncated_status_writes;	/*!< srv_truncated_status_writes */
 	ulint innodb_available_undo_logs;       /*!< srv_available_undo_logs */
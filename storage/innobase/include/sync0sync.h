@@ -109,13 +109,19 @@ extern mysql_pfs_key_t	srv_monitor_file_mutex_key;
 extern mysql_pfs_key_t	sync_thread_mutex_key;
 # endif /* UNIV_DEBUG */
 extern mysql_pfs_key_t	buf_dblwr_mutex_key;
+extern mysql_pfs_key_t	buf_warm_mutex_key;
+extern mysql_pfs_key_t	buf_vcache_mutex_key;
 extern mysql_pfs_key_t	trx_undo_mutex_key;
+extern mysql_pfs_key_t	trx_undo_nvm_mutex_key;
 extern mysql_pfs_key_t	trx_mutex_key;
 extern mysql_pfs_key_t	trx_pool_mutex_key;
 extern mysql_pfs_key_t	trx_pool_manager_mutex_key;
 extern mysql_pfs_key_t	lock_mutex_key;
 extern mysql_pfs_key_t	lock_wait_mutex_key;
+extern mysql_pfs_key_t	lock_sys_shard_mutex_key;
 extern mysql_pfs_key_t	trx_sys_mutex_key;
+extern mysql_pfs_key_t	trx_sys_csn_mutex_key;
+extern mysql_pfs_key_t	mvcc_mutex_key;
 extern mysql_pfs_key_t	srv_sys_mutex_key;
 extern mysql_pfs_key_t	srv_threads_mutex_key;
 # ifndef PFS_SKIP_EVENT_MUTEX
@@ -151,6 +157,13 @@ extern	mysql_pfs_key_t	index_online_log_key;
 extern	mysql_pfs_key_t	dict_table_stats_key;
 extern  mysql_pfs_key_t trx_sys_rw_lock_key;
 extern  mysql_pfs_key_t hash_table_locks_key;
+#if defined (UNIV_PMEMOBJ_PART_PL)
+extern	mysql_pfs_key_t	pm_ppl_line_lock_key;
+extern	mysql_pfs_key_t	pm_ppl_line_meta_lock_key;
+extern	mysql_pfs_key_t	pm_ppl_free_pool_lock_key;
+extern	mysql_pfs_key_t	pm_ppl_ckpt_lock_key;
+extern	mysql_pfs_key_t	pm_ppl_tt_entry_lock_key;
+#endif
 #endif /* UNIV_PFS_RWLOCK */
 
 /* There are mutexes/rwlocks that we want to exclude from instrumentation
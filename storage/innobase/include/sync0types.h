@@ -246,11 +246,14 @@ enum latch_level_t {
 	SYNC_LOG_PM_REDOER,
 #endif
 	SYNC_PURGE_QUEUE,
+	SYNC_TRX_SYS_CSN,
+	SYNC_MVCC,
 	SYNC_TRX_SYS_HEADER,
 	SYNC_REC_LOCK,
 	SYNC_THREADS,
 	SYNC_TRX,
 	SYNC_TRX_SYS,
+	SYNC_LOCK_SYS_SHARD,
 	SYNC_LOCK_SYS,
 	SYNC_LOCK_WAIT_SYS,
 
@@ -367,13 +370,19 @@ enum latch_id_t {
 	LATCH_ID_SRV_MONITOR_FILE,
 	LATCH_ID_SYNC_THREAD,
 	LATCH_ID_BUF_DBLWR,
+	LATCH_ID_BUF_WARM,
+	LATCH_ID_BUF_VCACHE,
 	LATCH_ID_TRX_UNDO,
+	LATCH_ID_TRX_UNDO_NVM,
 	LATCH_ID_TRX_POOL,
 	LATCH_ID_TRX_POOL_MANAGER,
 	LATCH_ID_TRX,
 	LATCH_ID_LOCK_SYS,
 	LATCH_ID_LOCK_SYS_WAIT,
+	LATCH_ID_LOCK_SYS_SHARD,
 	LATCH_ID_TRX_SYS,
+	LATCH_ID_TRX_SYS_CSN,
+	LATCH_ID_MVCC,
 	LATCH_ID_SRV_SYS,
 	LATCH_ID_SRV_SYS_TASKS,
 	LATCH_ID_PAGE_ZIP_STAT_PER_INDEX,
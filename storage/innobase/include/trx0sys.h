@@ -165,6 +165,59 @@ UNIV_INLINE
 trx_id_t
 trx_sys_get_max_trx_id(void);
 /*========================*/
+#if defined (UNIV_MVCC_CSN)
+/*****************************************************************//**
+Registers a new read-write transaction id in the CSN map as active. The
+previous id of the slot is moved to trx_sys->csn_overflow if a view may
+still look it up. Caller must own trx_sys->mutex. */
+void
+trx_sys_csn_assign(
+/*===============*/
+	trx_id_t	id);	/*!< in: new read-write transaction id */
+/*****************************************************************//**
+Gives the next commit sequence number to a transaction and publishes
+it, the views opened from now on see the transaction. Caller must own
+trx_sys->mutex. */
+void
+trx_sys_csn_commit(
+/*===============*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Recomputes trx_sys->csn_up_limit_id and trx_sys->csn_low_limit_no after
+rw_trx_ids or the serialisation_list changed. Caller must own
+trx_sys->mutex. */
+void
+trx_sys_csn_set_limits(void);
+/*========================*/
+/*****************************************************************//**
+Looks up the commit sequence number of a transaction id.
+@return CSN, TRX_CSN_ACTIVE if not committed, 0 if committed before
+any open view */
+UNIV_INLINE
+trx_id_t
+trx_sys_csn_get(
+/*============*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Looks up a transaction id whose slot of the CSN map is reused.
+@return CSN, TRX_CSN_ACTIVE if not committed, 0 if committed before
+any open view */
+trx_id_t
+trx_sys_csn_get_overflow(
+/*=====================*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Sets the limits below which no view looks up a transaction id: an id
+smaller than drop_id or committed with a CSN not greater than drop_csn
+is visible to every open and future view. The overflow entries below
+them are freed. */
+void
+trx_sys_csn_set_drop_limits(
+/*========================*/
+	trx_id_t	drop_id,	/*!< in: smallest m_up_limit_id of
+					the views */
+	trx_id_t	drop_csn);	/*!< in: smallest CSN of the views */
+#endif /* UNIV_MVCC_CSN */
 
 #ifdef UNIV_DEBUG
 /* Flag to control TRX_RSEG_N_SLOTS behavior debugging. */
@@ -555,6 +608,28 @@ identifier is added to this 64-bit constant. */
 /* @} */
 
 #ifndef UNIV_HOTBACKUP
+#if defined (UNIV_MVCC_CSN)
+/** CSN of a transaction id that is not committed */
+#define TRX_CSN_ACTIVE	TRX_ID_MAX
+
+/** A slot of the CSN map. A writer sets id to TRX_ID_MAX while it
+changes the slot, readers retry until they read the same id twice. */
+struct trx_csn_slot_t {
+	volatile trx_id_t	id;	/*!< transaction id, 0 if unused */
+	volatile trx_id_t	csn;	/*!< its CSN or TRX_CSN_ACTIVE */
+};
+
+/** A transaction id whose slot was reused while a view could still
+look it up */
+struct trx_csn_overflow_t {
+	trx_id_t	id;		/*!< transaction id */
+	trx_id_t	csn;		/*!< its CSN or TRX_CSN_ACTIVE */
+};
+
+typedef std::vector<trx_csn_overflow_t, ut_allocator<trx_csn_overflow_t> >
+	trx_csn_overflow_list_t;
+#endif /* UNIV_MVCC_CSN */
+
 /** The transaction system central memory data structure. */
 struct trx_sys_t {
 
@@ -604,6 +679,45 @@ struct trx_sys_t {
 					committing in memory and releasing locks
 					to ensure right order of removal and
 					consistent snapshot. */
+#if defined (UNIV_MVCC_CSN)
+	char		pad_csn[64];	/*!< To avoid false sharing */
+	volatile trx_id_t
+			csn;		/*!< CSN of the last committed
+					read-write transaction. A view sees
+					the transactions with a CSN up to
+					the value read when it was opened.
+					Written under mutex after the CSN
+					is stored in the map, read without
+					mutex. */
+	volatile trx_id_t
+			csn_up_limit_id;/*!< All the transaction ids smaller
+					than this are committed: the
+					smallest id of rw_trx_ids, or
+					max_trx_id if it is empty */
+	volatile trx_id_t
+			csn_low_limit_no;/*!< trx_t::no of the first
+					transaction of serialisation_list,
+					TRX_ID_MAX if it is empty */
+	volatile trx_id_t
+			csn_drop_id;	/*!< see
+					trx_sys_csn_set_drop_limits(),
+					protected by mutex */
+	volatile trx_id_t
+			csn_drop_csn;	/*!< see
+					trx_sys_csn_set_drop_limits(),
+					protected by mutex */
+	trx_id_t	csn_start_id;	/*!< max_trx_id at startup, the ids
+					below it are not in the map unless
+					recovered active */
+	trx_csn_slot_t*	csn_map;	/*!< The CSN of a transaction id is in
+					slot id & csn_map_mask */
+	ulint		csn_map_mask;	/*!< number of slots - 1 */
+	ib_mutex_t	csn_overflow_mutex;
+					/*!< protects csn_overflow */
+	trx_csn_overflow_list_t
+			csn_overflow;	/*!< Ids moved out of the map, in
+					increasing id order */
+#endif /* UNIV_MVCC_CSN */
 
 	char		pad3[64];	/*!< To avoid false sharing */
 	trx_rseg_t*	rseg_array[TRX_SYS_N_RSEGS];
@@ -1094,6 +1094,13 @@ struct trx_t {
 	time_t		start_time;	/*!< time the state last time became
 					TRX_STATE_ACTIVE */
 	lsn_t		commit_lsn;	/*!< lsn at the time of the commit */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	lsn_t		hybrid_classic_lsn;
+					/*!< log_sys end lsn of the last
+					mtr that changed the undo log of the
+					transaction, see
+					trx_undo_report_row_operation() */
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	table_id_t	table_id;	/*!< Table to drop iff dict_operation
 					== TRX_DICT_OP_TABLE, or 0. */
 	/*------------------------------*/
@@ -370,6 +370,64 @@ bool
 trx_undo_truncate_tablespace(
 	undo::Truncate*	undo_trunc);
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+/** Opens or allocates the NVM undo page area and builds its DRAM
+bookkeeping. Called at startup before the redo log is scanned. */
+void
+trx_undo_nvm_init(void);
+
+/** Frees the DRAM bookkeeping of the NVM undo page area. */
+void
+trx_undo_nvm_free(void);
+
+/** Reserves an NVM slot for the undo page that a mini-transaction is
+about to modify. On success the mini-transaction generates no redo log and
+the page image is persisted on the slot at commit.
+@param[in,out]	mtr	mini-transaction, just started
+@return true if a slot was reserved, false if the redo log must be used */
+bool
+trx_undo_nvm_mtr_start(
+	mtr_t*	mtr);
+
+/** Returns an NVM slot that was reserved but not written.
+@param[in]	slot	slot returned by the reservation */
+void
+trx_undo_nvm_release(
+	ulint	slot);
+
+/** Persists the image of an undo page on its reserved NVM slot, the older
+image of the same page is freed once the new one is valid. Called at
+mini-transaction commit while the page is still X-latched.
+@param[in]	slot	reserved slot
+@param[in]	block	modified undo page
+@param[in]	lsn	end lsn of the mini-transaction */
+void
+trx_undo_nvm_write(
+	ulint			slot,
+	const buf_block_t*	block,
+	lsn_t			lsn);
+
+/** Frees the NVM slots whose page images are older than an lsn all pages
+below which were written to the datafiles and synced.
+@param[in]	lsn	lsn of the previous checkpoint */
+void
+trx_undo_nvm_checkpoint(
+	lsn_t	lsn);
+
+/** Lists the NVM slot of the newest image of each undo page. Called with
+log_sys->mutex held during the recovery, the images are written back by
+trx_undo_nvm_recover() once the mutex is released. */
+void
+trx_undo_nvm_recover_snapshot(void);
+
+/** Writes the images listed by trx_undo_nvm_recover_snapshot() back to the
+datafiles when the page on disk is older, then frees all slots. Called
+before the redo log is applied, the redo log after the images is applied
+on top. */
+void
+trx_undo_nvm_recover(void);
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 #endif /* !UNIV_HOTBACKUP */
 /***********************************************************//**
 Parses the redo log entry of an undo log page initialization.
@@ -38,6 +38,14 @@ IF(UNIX)
       LINK_LIBRARIES(aio)
     ENDIF()
 
+    # The io_uring backend of -DUNIV_IO_URING
+    CHECK_INCLUDE_FILES (liburing.h HAVE_LIBURING_H)
+    CHECK_LIBRARY_EXISTS(uring io_uring_queue_init "" HAVE_LIBURING)
+
+    IF(HAVE_LIBURING_H AND HAVE_LIBURING)
+      LINK_LIBRARIES(uring)
+    ENDIF()
+
   ELSEIF(CMAKE_SYSTEM_NAME STREQUAL "SunOS")
     ADD_DEFINITIONS("-DUNIV_SOLARIS")
   ENDIF()
@@ -66,6 +66,17 @@ static const ulint	TABLE_LOCK_CACHE = 8;
 /** Size in bytes, of the table lock instance */
 static const ulint	TABLE_LOCK_SIZE = sizeof(ib_lock_t);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/* The record locks of a table are spread over the rec shards */
+# define lock_table_n_rec_locks_inc(table)			\
+	os_atomic_increment_ulint(&(table)->n_rec_locks, 1)
+# define lock_table_n_rec_locks_dec(table)			\
+	os_atomic_decrement_ulint(&(table)->n_rec_locks, 1)
+#else
+# define lock_table_n_rec_locks_inc(table) (++(table)->n_rec_locks)
+# define lock_table_n_rec_locks_dec(table) ((table)->n_rec_locks--)
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /** Deadlock checker. */
 class DeadlockChecker {
 public:
@@ -453,6 +464,25 @@ lock_sys_create(
 	lock_sys->prdt_hash = hash_create(n_cells);
 	lock_sys->prdt_page_hash = hash_create(n_cells);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	lock_sys->n_shards = srv_lock_sys_n_shards;
+	lock_sys->n_rec_cells = hash_get_n_cells(lock_sys->rec_hash);
+
+	lock_sys->rec_shards = static_cast<lock_sys_shard_t*>(
+		ut_zalloc_nokey(lock_sys->n_shards
+				* sizeof(*lock_sys->rec_shards)));
+	lock_sys->table_shards = static_cast<lock_sys_shard_t*>(
+		ut_zalloc_nokey(lock_sys->n_shards
+				* sizeof(*lock_sys->table_shards)));
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_create(LATCH_ID_LOCK_SYS_SHARD,
+			     &lock_sys->rec_shards[i].mutex);
+		mutex_create(LATCH_ID_LOCK_SYS_SHARD,
+			     &lock_sys->table_shards[i].mutex);
+	}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	if (!srv_read_only_mode) {
 		lock_latest_err_file = os_file_create_tmpfile(NULL);
 		ut_a(lock_latest_err_file);
@@ -499,6 +529,11 @@ lock_sys_resize(
 		     lock_rec_lock_fold);
 	hash_table_free(old_hash);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	/* Every shard is latched, the pages move to their new shards */
+	lock_sys->n_rec_cells = hash_get_n_cells(lock_sys->rec_hash);
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	/* need to update block->lock_hash_val */
 	for (ulint i = 0; i < srv_buf_pool_instances; ++i) {
 		buf_pool_t*	buf_pool = buf_pool_from_array(i);
@@ -547,6 +582,16 @@ lock_sys_close(void)
 	mutex_destroy(&lock_sys->mutex);
 	mutex_destroy(&lock_sys->wait_mutex);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_destroy(&lock_sys->rec_shards[i].mutex);
+		mutex_destroy(&lock_sys->table_shards[i].mutex);
+	}
+
+	ut_free(lock_sys->rec_shards);
+	ut_free(lock_sys->table_shards);
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	srv_slot_t*	slot = lock_sys->waiting_threads;
 
 	for (ulint i = 0; i < OS_THREAD_MAX_N; i++, ++slot) {
@@ -560,6 +605,134 @@ lock_sys_close(void)
 	lock_sys = NULL;
 }
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/*********************************************************************//**
+Acquire the lock_sys->mutex and then every shard in order. The lock
+system is then latched exclusively, as lock_sys->mutex alone is without
+the shards. */
+void
+lock_sys_x_enter(void)
+/*==================*/
+{
+	mutex_enter(&lock_sys->mutex);
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_enter(&lock_sys->rec_shards[i].mutex);
+	}
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_enter(&lock_sys->table_shards[i].mutex);
+	}
+}
+
+/*********************************************************************//**
+Try to latch the lock system exclusively without waiting on
+lock_sys->mutex. The shards are held only for short times, they are
+waited for.
+@return 0 if latched, non-zero otherwise */
+ulint
+lock_sys_x_enter_nowait(void)
+/*=========================*/
+{
+	if (lock_sys->mutex.trylock(__FILE__, __LINE__)) {
+		return(1);
+	}
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_enter(&lock_sys->rec_shards[i].mutex);
+	}
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		mutex_enter(&lock_sys->table_shards[i].mutex);
+	}
+
+	return(0);
+}
+
+/*********************************************************************//**
+Release the shards and the lock_sys->mutex. */
+void
+lock_sys_x_exit(void)
+/*=================*/
+{
+	for (ulint i = lock_sys->n_shards; i > 0; i--) {
+		lock_sys->table_shards[i - 1].mutex.exit();
+	}
+
+	for (ulint i = lock_sys->n_shards; i > 0; i--) {
+		lock_sys->rec_shards[i - 1].mutex.exit();
+	}
+
+	lock_sys->mutex.exit();
+}
+
+/*********************************************************************//**
+Latch the shard of the rec_hash cell of a page. lock_sys_resize() may
+change lock_sys->n_rec_cells until the shard is latched, so the shard is
+looked up again under the latch, which excludes lock_sys_resize().
+@return the latched shard */
+lock_sys_shard_t*
+lock_rec_shard_enter(
+/*=================*/
+	ulint	space,		/*!< in: space */
+	ulint	page_no)	/*!< in: page number */
+{
+	ut_ad(!lock_mutex_own());
+
+	for (;;) {
+		lock_sys_shard_t*	shard = lock_rec_shard_get(
+			space, page_no);
+
+		mutex_enter(&shard->mutex);
+
+		if (shard == lock_rec_shard_get(space, page_no)) {
+			return(shard);
+		}
+
+		mutex_exit(&shard->mutex);
+	}
+}
+
+/*********************************************************************//**
+Latch the shard of the lock queue of a table.
+@return the latched shard */
+lock_sys_shard_t*
+lock_table_shard_enter(
+/*===================*/
+	const dict_table_t*	table)	/*!< in: table */
+{
+	lock_sys_shard_t*	shard = lock_table_shard_get(table);
+
+	ut_ad(!lock_mutex_own());
+
+	mutex_enter(&shard->mutex);
+
+	return(shard);
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+@return true if the thread latches the lock system or one of its shards */
+bool
+lock_sys_latched(void)
+/*==================*/
+{
+	if (lock_mutex_own()) {
+		return(true);
+	}
+
+	for (ulint i = 0; i < lock_sys->n_shards; i++) {
+		if (lock_sys->rec_shards[i].mutex.is_owned()
+		    || lock_sys->table_shards[i].mutex.is_owned()) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+#endif /* UNIV_DEBUG */
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /*********************************************************************//**
 Gets the size of a lock struct.
 @return size in bytes */
@@ -739,7 +912,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_latched());
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1108,7 +1281,7 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(block->page.id.space(), block->page.id.page_no()));
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1157,7 +1330,7 @@ lock_rec_other_has_expl_req(
 					are taken into account */
 {
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(block->page.id.space(), block->page.id.page_no()));
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 
 	/* Only GAP lock can be on SUPREMUM, and we are not looking for
@@ -1203,7 +1376,7 @@ lock_rec_other_has_conflicting(
 {
 	const lock_t*		lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(block->page.id.space(), block->page.id.page_no()));
 
 	bool	is_supremum = (heap_no == PAGE_HEAP_NO_SUPREMUM);
 
@@ -1431,7 +1604,7 @@ RecLock::lock_alloc(
 	const RecID&	rec_id,
 	ulint		size)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(rec_id.m_space_id, rec_id.m_page_no));
 
 	lock_t*	lock;
 
@@ -1495,13 +1668,13 @@ Add the lock to the record lock hash and the transaction's lock list
 void
 RecLock::lock_add(lock_t* lock, bool add_to_hash)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(m_rec_id.m_space_id, m_rec_id.m_page_no));
 	ut_ad(trx_mutex_own(lock->trx));
 
 	if (add_to_hash) {
 		ulint	key = m_rec_id.fold();
 
-		++lock->index->table->n_rec_locks;
+		lock_table_n_rec_locks_inc(lock->index->table);
 
 		HASH_INSERT(lock_t, hash, lock_hash_get(m_mode), key, lock);
 	}
@@ -1527,7 +1700,7 @@ RecLock::create(
 	bool	add_to_hash,
 	const	lock_prdt_t* prdt)
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(m_rec_id.m_space_id, m_rec_id.m_page_no));
 	ut_ad(owns_trx_mutex == trx_mutex_own(trx));
 
 	/* Create the explicit lock instance and initialise it. */
@@ -1765,7 +1938,7 @@ lock_rec_add_to_queue(
 					transaction mutex */
 {
 #ifdef UNIV_DEBUG
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(block->page.id.space(), block->page.id.page_no()));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index)
 	      || dict_index_get_online_status(index) != ONLINE_INDEX_CREATION);
@@ -1868,7 +2041,7 @@ lock_rec_lock_fast(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(block->page.id.space(), block->page.id.page_no()));
 	ut_ad(!srv_read_only_mode);
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
@@ -1895,8 +2068,17 @@ lock_rec_lock_fast(
 		if (!impl) {
 			RecLock	rec_lock(index, block, heap_no, mode);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+			/* An implicit to explicit conversion in another
+			shard may allocate from the trx lock heap at the
+			same time, the trx mutex serializes them. */
+			trx_mutex_enter(trx);
+			rec_lock.create(trx, true, true);
+			trx_mutex_exit(trx);
+#else
 			/* Note that we don't own the trx mutex. */
 			rec_lock.create(trx, false, true);
+#endif /* UNIV_LOCK_SYS_SHARDED */
 		}
 
 		status = LOCK_REC_SUCCESS_CREATED;
@@ -2066,6 +2248,96 @@ lock_rec_lock(
 	return(DB_ERROR);
 }
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/*********************************************************************//**
+Like lock_rec_lock() but the caller does not latch the lock system. The
+request is first served under the shard of the page only, this covers
+every request that is granted at once. A request that has to wait
+needs the deadlock check, which reads the queues of all the shards: it
+is retried from the start with the lock system latched exclusively.
+@return DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
+or DB_QUE_THR_SUSPENDED */
+static
+dberr_t
+lock_rec_lock_sharded(
+/*==================*/
+	bool			impl,	/*!< in: if true, no lock is set
+					if no wait is necessary: we
+					assume that the caller will
+					set an implicit lock */
+	ulint			mode,	/*!< in: lock mode: LOCK_X or
+					LOCK_S possibly ORed to either
+					LOCK_GAP or LOCK_REC_NOT_GAP */
+	const buf_block_t*	block,	/*!< in: buffer block containing
+					the record */
+	ulint			heap_no,/*!< in: heap number of record */
+	dict_index_t*		index,	/*!< in: index of record */
+	que_thr_t*		thr)	/*!< in: query thread */
+{
+	dberr_t			err;
+	bool			wait = false;
+	trx_t*			trx = thr_get_trx(thr);
+	lock_sys_shard_t*	shard;
+
+	ut_ad(!lock_mutex_own());
+
+	DBUG_EXECUTE_IF("innodb_report_deadlock", return(DB_DEADLOCK););
+
+	shard = lock_rec_shard_enter(block->page.id.space(),
+				     block->page.id.page_no());
+
+	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
+	case LOCK_REC_SUCCESS:
+		lock_sys_shard_exit(shard);
+		return(DB_SUCCESS);
+	case LOCK_REC_SUCCESS_CREATED:
+		lock_sys_shard_exit(shard);
+		return(DB_SUCCESS_LOCKED_REC);
+	case LOCK_REC_FAIL:
+		break;
+	}
+
+	/* lock_rec_lock_slow() without the wait */
+	trx_mutex_enter(trx);
+
+	if (lock_rec_has_expl(mode, block, heap_no, trx)) {
+
+		err = DB_SUCCESS;
+
+	} else if (lock_rec_other_has_conflicting(
+			   mode, block, heap_no, trx) != NULL) {
+
+		err = DB_LOCK_WAIT;
+		wait = true;
+
+	} else if (!impl) {
+
+		lock_rec_add_to_queue(
+			LOCK_REC | mode, block, heap_no, index, trx, true);
+
+		err = DB_SUCCESS_LOCKED_REC;
+	} else {
+		err = DB_SUCCESS;
+	}
+
+	trx_mutex_exit(trx);
+
+	lock_sys_shard_exit(shard);
+
+	if (wait) {
+		/* The queue may have changed once the shard is released,
+		lock_rec_lock() checks it again */
+		lock_mutex_enter();
+
+		err = lock_rec_lock(impl, mode, block, heap_no, index, thr);
+
+		lock_mutex_exit();
+	}
+
+	return(err);
+}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /*********************************************************************//**
 Checks if a waiting record lock request still has to wait in a queue.
 @return lock that is causing the wait */
@@ -2083,7 +2355,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_offset;
 	hash_table_t*	hash;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_latched());
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2122,7 +2394,7 @@ lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_latched());
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2306,7 +2578,7 @@ RecLock::lock_add_priority(
 	/* Add the lock to lock hash table. */
 	lock->hash = add_position->hash;
 	add_position->hash = lock;
-	++lock->index->table->n_rec_locks;
+	lock_table_n_rec_locks_inc(lock->index->table);
 
 	return(grant_lock);
 }
@@ -2443,7 +2715,7 @@ lock_rec_dequeue_from_page(
 	trx_lock_t*	trx_lock;
 	hash_table_t*	lock_hash;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_latched());
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 	/* We may or may not be holding in_lock->trx->mutex here. */
 
@@ -2453,7 +2725,7 @@ lock_rec_dequeue_from_page(
 	page_no = in_lock->un_member.rec_lock.page_no;
 
 	ut_ad(in_lock->index->table->n_rec_locks > 0);
-	in_lock->index->table->n_rec_locks--;
+	lock_table_n_rec_locks_dec(in_lock->index->table);
 
 	lock_hash = lock_hash_get(in_lock->type_mode);
 
@@ -2505,7 +2777,7 @@ lock_rec_discard(
 	page_no = in_lock->un_member.rec_lock.page_no;
 
 	ut_ad(in_lock->index->table->n_rec_locks > 0);
-	in_lock->index->table->n_rec_locks--;
+	lock_table_n_rec_locks_dec(in_lock->index->table);
 
 	HASH_DELETE(lock_t, hash, lock_hash_get(in_lock->type_mode),
 			    lock_rec_fold(space, page_no), in_lock);
@@ -3532,6 +3804,238 @@ lock_update_insert(
 		block, receiver_heap_no, donator_heap_no);
 }
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/*********************************************************************//**
+Latch the rec shards of two pages, in the order of the shards. See
+lock_rec_shard_enter(). */
+static
+void
+lock_rec_shard_enter_pair(
+/*======================*/
+	const buf_block_t*	block1,	/*!< in: first page */
+	const buf_block_t*	block2,	/*!< in: second page */
+	lock_sys_shard_t**	shard1,	/*!< out: shard of block1 */
+	lock_sys_shard_t**	shard2)	/*!< out: shard of block2 */
+{
+	ut_ad(!lock_mutex_own());
+
+	for (;;) {
+		lock_sys_shard_t*	s1 = lock_rec_shard_get(
+			block1->page.id.space(), block1->page.id.page_no());
+		lock_sys_shard_t*	s2 = lock_rec_shard_get(
+			block2->page.id.space(), block2->page.id.page_no());
+
+		if (s1 == s2) {
+			mutex_enter(&s1->mutex);
+		} else if (s1 < s2) {
+			mutex_enter(&s1->mutex);
+			mutex_enter(&s2->mutex);
+		} else {
+			mutex_enter(&s2->mutex);
+			mutex_enter(&s1->mutex);
+		}
+
+		*shard1 = lock_rec_shard_get(
+			block1->page.id.space(), block1->page.id.page_no());
+		*shard2 = lock_rec_shard_get(
+			block2->page.id.space(), block2->page.id.page_no());
+
+		if (*shard1 == s1 && *shard2 == s2) {
+			return;
+		}
+
+		if (s1 != s2) {
+			lock_sys_shard_exit(s2);
+		}
+
+		lock_sys_shard_exit(s1);
+	}
+}
+
+/*********************************************************************//**
+Check if a record has a waiting lock request. The waits are enqueued with
+the lock system latched exclusively, so the answer holds while the shard
+of the page is latched.
+@return true if a lock request waits on the record */
+static
+bool
+lock_rec_has_waiting(
+/*=================*/
+	const buf_block_t*	block,	/*!< in: buffer block */
+	ulint			heap_no)/*!< in: heap number of the record */
+{
+	for (const lock_t* lock = lock_rec_get_first(
+		     lock_sys->rec_hash, block, heap_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next_const(heap_no, lock)) {
+
+		if (lock_get_wait(lock)) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/*********************************************************************//**
+Like lock_rec_add_to_queue() for a granted lock of any transaction, with
+the shard of the page and the trx mutex latched. Nothing is added for a
+transaction that has committed: lock_release_sharded() changes its list
+of locks without the trx mutex, and its locks need not be moved or
+inherited any more. The trx mutex also covers trx->lock.n_rec_locks,
+which the other shards may change at the same time. */
+static
+void
+lock_rec_add_to_queue_sharded(
+/*==========================*/
+	ulint			type_mode,/*!< in: lock mode, wait, gap
+					etc. flags; type is ignored
+					and replaced by LOCK_REC */
+	const buf_block_t*	block,	/*!< in: buffer block containing
+					the record */
+	ulint			heap_no,/*!< in: heap number of the record */
+	dict_index_t*		index,	/*!< in: index of record */
+	trx_t*			trx)	/*!< in/out: transaction */
+{
+	ut_ad(!(type_mode & LOCK_WAIT));
+	ut_ad(trx_mutex_own(trx));
+
+	if (!trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)) {
+		lock_rec_add_to_queue(
+			type_mode, block, heap_no, index, trx, true);
+	}
+}
+
+/*********************************************************************//**
+lock_rec_move() with the shards of the two pages latched only.
+@return false if a lock request waits on the donating record, the caller
+must then latch the lock system exclusively */
+static
+bool
+lock_rec_move_sharded(
+/*==================*/
+	const buf_block_t*	receiver,	/*!< in: buffer block containing
+						the receiving record */
+	const buf_block_t*	donator,	/*!< in: buffer block containing
+						the donating record */
+	ulint			receiver_heap_no,/*!< in: heap_no of the record
+						which gets the locks */
+	ulint			donator_heap_no)/*!< in: heap_no of the record
+						which gives the locks */
+{
+	lock_sys_shard_t*	receiver_shard;
+	lock_sys_shard_t*	donator_shard;
+
+	lock_rec_shard_enter_pair(receiver, donator,
+				  &receiver_shard, &donator_shard);
+
+	bool	moved = !lock_rec_has_waiting(donator, donator_heap_no);
+
+	if (moved) {
+		ut_ad(lock_rec_get_first(
+			lock_sys->rec_hash, receiver, receiver_heap_no)
+		      == NULL);
+
+		for (lock_t* lock = lock_rec_get_first(
+			     lock_sys->rec_hash, donator, donator_heap_no);
+		     lock != NULL;
+		     lock = lock_rec_get_next(donator_heap_no, lock)) {
+
+			const ulint	type_mode = lock->type_mode;
+			trx_t*		trx = lock->trx;
+
+			trx_mutex_enter(trx);
+
+			/* The bit is reset first, as lock_rec_move_low()
+			does */
+			lock_rec_reset_nth_bit(lock, donator_heap_no);
+
+			lock_rec_add_to_queue_sharded(
+				type_mode, receiver, receiver_heap_no,
+				lock->index, trx);
+
+			trx_mutex_exit(trx);
+		}
+	}
+
+	if (donator_shard != receiver_shard) {
+		lock_sys_shard_exit(donator_shard);
+	}
+
+	lock_sys_shard_exit(receiver_shard);
+
+	return(moved);
+}
+
+/*********************************************************************//**
+lock_update_delete() with the shard of the page latched only.
+@return false if a lock request waits on the record or the page has
+predicate locks, the caller must then latch the lock system
+exclusively */
+static
+bool
+lock_update_delete_sharded(
+/*=======================*/
+	const buf_block_t*	block,		/*!< in: buffer block */
+	ulint			heap_no,	/*!< in: heap_no of the
+						removed record */
+	ulint			next_heap_no)	/*!< in: heap_no of the
+						next record */
+{
+	lock_sys_shard_t*	shard = lock_rec_shard_enter(
+		block->page.id.space(), block->page.id.page_no());
+
+	/* The predicate locks are not sharded, they are changed with
+	the lock system latched exclusively */
+	if (lock_rec_has_waiting(block, heap_no)
+	    || lock_rec_get_first_on_page(lock_sys->prdt_hash, block)
+	    || lock_rec_get_first_on_page(lock_sys->prdt_page_hash, block)) {
+
+		lock_sys_shard_exit(shard);
+
+		return(false);
+	}
+
+	/* lock_rec_inherit_to_gap(), then the bits of the granted locks
+	are reset as lock_rec_reset_and_release_wait() does */
+	for (lock_t* lock = lock_rec_get_first(
+		     lock_sys->rec_hash, block, heap_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next(heap_no, lock)) {
+
+		if (!lock_rec_get_insert_intention(lock)
+		    && !((srv_locks_unsafe_for_binlog
+			  || lock->trx->isolation_level
+			  <= TRX_ISO_READ_COMMITTED)
+			 && lock_get_mode(lock) ==
+			 (lock->trx->duplicates ? LOCK_S : LOCK_X))) {
+
+			trx_mutex_enter(lock->trx);
+
+			lock_rec_add_to_queue_sharded(
+				LOCK_REC | LOCK_GAP | lock_get_mode(lock),
+				block, next_heap_no, lock->index, lock->trx);
+
+			trx_mutex_exit(lock->trx);
+		}
+	}
+
+	for (lock_t* lock = lock_rec_get_first(
+		     lock_sys->rec_hash, block, heap_no);
+	     lock != NULL;
+	     lock = lock_rec_get_next(heap_no, lock)) {
+
+		trx_mutex_enter(lock->trx);
+		lock_rec_reset_nth_bit(lock, heap_no);
+		trx_mutex_exit(lock->trx);
+	}
+
+	lock_sys_shard_exit(shard);
+
+	return(true);
+}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /*************************************************************//**
 Updates the lock table when a record is removed. */
 void
@@ -3558,6 +4062,12 @@ lock_update_delete(
 								       FALSE));
 	}
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	if (lock_update_delete_sharded(block, heap_no, next_heap_no)) {
+		return;
+	}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	lock_mutex_enter();
 
 	/* Let the next record inherit the locks from rec, in gap mode */
@@ -3592,6 +4102,13 @@ lock_rec_store_on_page_infimum(
 
 	ut_ad(block->frame == page_align(rec));
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	if (lock_rec_move_sharded(block, block, PAGE_HEAP_NO_INFIMUM,
+				  heap_no)) {
+		return;
+	}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	lock_mutex_enter();
 
 	lock_rec_move(block, block, PAGE_HEAP_NO_INFIMUM, heap_no);
@@ -3616,6 +4133,13 @@ lock_rec_restore_from_page_infimum(
 {
 	ulint	heap_no = page_rec_get_heap_no(rec);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	if (lock_rec_move_sharded(block, donator, heap_no,
+				  PAGE_HEAP_NO_INFIMUM)) {
+		return;
+	}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	lock_mutex_enter();
 
 	lock_rec_move(block, donator, heap_no, PAGE_HEAP_NO_INFIMUM);
@@ -3650,7 +4174,7 @@ lock_table_create(
 	lock_t*		lock;
 
 	ut_ad(table && trx);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(table));
 	ut_ad(trx_mutex_own(trx));
 
 	check_trx_state(trx);
@@ -3713,7 +4237,7 @@ lock_table_pop_autoinc_locks(
 /*=========================*/
 	trx_t*	trx)	/*!< in/out: transaction that owns the AUTOINC locks */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_sys_latched());
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
 
 	/* Skip any gaps, gaps are NULL lock entries in the
@@ -3741,7 +4265,7 @@ lock_table_remove_autoinc_lock(
 	lock_t*	autoinc_lock;
 	lint	i = ib_vector_size(trx->autoinc_locks) - 1;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(lock->un_member.tab_lock.table));
 	ut_ad(lock_get_mode(lock) == LOCK_AUTO_INC);
 	ut_ad(lock_get_type_low(lock) & LOCK_TABLE);
 	ut_ad(!ib_vector_is_empty(trx->autoinc_locks));
@@ -3793,7 +4317,7 @@ lock_table_remove_low(
 	trx_t*		trx;
 	dict_table_t*	table;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(lock->un_member.tab_lock.table));
 
 	trx = lock->trx;
 	table = lock->un_member.tab_lock.table;
@@ -3933,7 +4457,7 @@ lock_table_other_has_incompatible(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(table));
 
 	for (lock = UT_LIST_GET_LAST(table->locks);
 	     lock != NULL;
@@ -4005,6 +4529,30 @@ lock_table(
 		trx_set_rw_mode(trx);
 	}
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	/* A lock that is granted at once needs the shard of the table
+	only, a wait is enqueued below with the lock system latched
+	exclusively for the deadlock check */
+	lock_sys_shard_t*	shard = lock_table_shard_enter(table);
+
+	wait_for = lock_table_other_has_incompatible(
+		trx, LOCK_WAIT, table, mode);
+
+	if (wait_for == NULL) {
+		trx_mutex_enter(trx);
+
+		lock_table_create(table, mode | flags, trx);
+
+		trx_mutex_exit(trx);
+
+		lock_sys_shard_exit(shard);
+
+		return(DB_SUCCESS);
+	}
+
+	lock_sys_shard_exit(shard);
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	lock_mutex_enter();
 
 	/* We have to check if the new lock is compatible with any locks
@@ -4075,7 +4623,7 @@ lock_table_has_to_wait_in_queue(
 	const dict_table_t*	table;
 	const lock_t*		lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(wait_lock->un_member.tab_lock.table));
 	ut_ad(lock_get_wait(wait_lock));
 
 	table = wait_lock->un_member.tab_lock.table;
@@ -4105,7 +4653,7 @@ lock_table_dequeue(
 			behind will get their lock requests granted, if
 			they are now qualified to it */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_table_mutex_own(in_lock->un_member.tab_lock.table));
 	ut_a(lock_get_type_low(in_lock) == LOCK_TABLE);
 
 	lock_t*	lock = UT_LIST_GET_NEXT(un_member.tab_lock.locks, in_lock);
@@ -4386,6 +4934,98 @@ lock_release(
 	}
 }
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+/*********************************************************************//**
+Releases the locks of a committed transaction shard by shard, and releases
+possible other transactions waiting because of these locks. No lock is
+added to trx any more, but the page operations that run with the lock
+system latched exclusively can still move or discard its record locks:
+the list of locks is read with a shard latched, any shard excludes them. */
+static
+void
+lock_release_sharded(
+/*=================*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+	lock_t*			lock;
+	lock_sys_shard_t*	held;
+	lock_sys_shard_t*	shard;
+	trx_id_t		max_trx_id = trx_sys_get_max_trx_id();
+
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
+	ut_ad(!trx->is_dd_trx);
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
+
+	if (UT_LIST_GET_LEN(trx->lock.trx_locks) == 0) {
+		return;
+	}
+
+	held = &lock_sys->table_shards[0];
+	mutex_enter(&held->mutex);
+
+	while ((lock = UT_LIST_GET_LAST(trx->lock.trx_locks)) != NULL) {
+
+		ut_d(lock_check_dict_lock(lock));
+
+		if (lock_get_type_low(lock) == LOCK_REC
+		    && (lock->type_mode & (LOCK_PREDICATE | LOCK_PRDT_PAGE))) {
+
+			/* The predicate hashes are not sharded, the rest
+			is released with the lock system latched */
+			lock_sys_shard_exit(held);
+
+			lock_mutex_enter();
+
+			lock_release(trx);
+
+			lock_mutex_exit();
+
+			return;
+		}
+
+		shard = (lock_get_type_low(lock) == LOCK_REC)
+			? lock_rec_shard_get(
+				lock->un_member.rec_lock.space,
+				lock->un_member.rec_lock.page_no)
+			: lock_table_shard_get(
+				lock->un_member.tab_lock.table);
+
+		if (shard != held) {
+			/* The lock may be moved once held is released,
+			read the list again under the new shard */
+			lock_sys_shard_exit(held);
+			held = shard;
+			mutex_enter(&held->mutex);
+			continue;
+		}
+
+		if (lock_get_type_low(lock) == LOCK_REC) {
+
+			lock_rec_dequeue_from_page(lock);
+		} else {
+			dict_table_t*	table;
+
+			table = lock->un_member.tab_lock.table;
+
+			if (lock_get_mode(lock) != LOCK_IS
+			    && trx->undo_no != 0) {
+
+				/* The trx may have modified the table. We
+				block the use of the MySQL query cache for
+				all currently active transactions. */
+
+				table->query_cache_inv_id = max_trx_id;
+			}
+
+			lock_table_dequeue(lock);
+		}
+	}
+
+	lock_sys_shard_exit(held);
+}
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 /* True if a lock mode is S or X */
 #define IS_LOCK_S_OR_X(lock) \
 	(lock_get_mode(lock) == LOCK_S \
@@ -5790,6 +6430,55 @@ lock_rec_insert_check_and_lock(
 	const rec_t*	next_rec = page_rec_get_next_const(rec);
 	ulint		heap_no = page_rec_get_heap_no(next_rec);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	/* The common cases, no lock on the successor or no conflicting
+	one, need the shard of the page only. A wait is enqueued below
+	with the lock system latched exclusively. */
+	lock_sys_shard_t*	shard = lock_rec_shard_enter(
+		block->page.id.space(), block->page.id.page_no());
+
+	lock = lock_rec_get_first(lock_sys->rec_hash, block, heap_no);
+
+	if (lock == NULL
+	    || dict_index_is_spatial(index)
+	    || lock_rec_other_has_conflicting(
+		    LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION,
+		    block, heap_no, trx) == NULL) {
+
+		lock_sys_shard_exit(shard);
+
+		if (lock == NULL) {
+			if (inherit_in && !dict_index_is_clust(index)) {
+				/* Update the page max trx id field */
+				page_update_max_trx_id(
+					block, buf_block_get_page_zip(block),
+					trx->id, mtr);
+			}
+
+			*inherit = FALSE;
+
+			return(DB_SUCCESS);
+		}
+
+		if (dict_index_is_spatial(index)) {
+			return(DB_SUCCESS);
+		}
+
+		*inherit = TRUE;
+
+		if (inherit_in && !dict_index_is_clust(index)) {
+			/* Update the page max trx id field */
+			page_update_max_trx_id(
+				block, buf_block_get_page_zip(block),
+				trx->id, mtr);
+		}
+
+		return(DB_SUCCESS);
+	}
+
+	lock_sys_shard_exit(shard);
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	lock_mutex_enter();
 	/* Because this code is invoked for a running transaction by
 	the thread that is serving the transaction, it is not necessary
@@ -5917,6 +6606,32 @@ lock_rec_convert_impl_to_expl_for_trx(
 
 	DEBUG_SYNC_C("before_lock_rec_convert_impl_to_expl_for_trx");
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	/* The state of trx becomes COMMITTED_IN_MEMORY under the trx mutex
+	only, and the trx itself may be adding a lock in another shard */
+	lock_sys_shard_t*	shard = lock_rec_shard_enter(
+		block->page.id.space(), block->page.id.page_no());
+
+	trx_mutex_enter(trx);
+
+	ut_ad(!trx_state_eq(trx, TRX_STATE_NOT_STARTED));
+
+	if (!trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)
+	    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP,
+				  block, heap_no, trx)) {
+
+		ulint	type_mode;
+
+		type_mode = (LOCK_REC | LOCK_X | LOCK_REC_NOT_GAP);
+
+		lock_rec_add_to_queue(
+			type_mode, block, heap_no, index, trx, true);
+	}
+
+	trx_mutex_exit(trx);
+
+	lock_sys_shard_exit(shard);
+#else
 	lock_mutex_enter();
 
 	ut_ad(!trx_state_eq(trx, TRX_STATE_NOT_STARTED));
@@ -5934,6 +6649,7 @@ lock_rec_convert_impl_to_expl_for_trx(
 	}
 
 	lock_mutex_exit();
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 	trx_release_reference(trx);
 
@@ -6030,16 +6746,23 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	err = lock_rec_lock_sharded(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
+				    block, heap_no, index, thr);
+
+	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+#else
+	lock_mutex_enter();
+
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	lock_mutex_exit();
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6091,16 +6814,23 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	err = lock_rec_lock_sharded(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
+				    block, heap_no, index, thr);
+
+	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+#else
+	lock_mutex_enter();
+
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
 			    block, heap_no, index, thr);
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	lock_mutex_exit();
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 #ifdef UNIV_DEBUG
 	{
@@ -6191,19 +6921,26 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	err = lock_rec_lock_sharded(FALSE, mode | gap_mode,
+				    block, heap_no, index, thr);
+
+	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+#else
+	lock_mutex_enter();
+
 	err = lock_rec_lock(FALSE, mode | gap_mode,
 			    block, heap_no, index, thr);
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	lock_mutex_exit();
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6264,18 +7001,25 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	err = lock_rec_lock_sharded(FALSE, mode | gap_mode,
+				    block, heap_no, index, thr);
+
+	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
+#else
+	lock_mutex_enter();
+
 	err = lock_rec_lock(FALSE, mode | gap_mode, block, heap_no, index, thr);
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
 	lock_mutex_exit();
+#endif /* UNIV_LOCK_SYS_SHARDED */
 
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
@@ -6709,6 +7453,15 @@ lock_trx_release_locks(
 
 	release_lock = (UT_LIST_GET_LEN(trx->lock.trx_locks) > 0);
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
+	is protected by the trx->mutex. The implicit to explicit
+	conversions test the state under it, after the transition no
+	lock is added to trx and lock_release_sharded() releases them
+	shard by shard. */
+	release_lock = false;
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	/* Don't take lock_sys mutex if trx didn't acquire any lock. */
 	if (release_lock) {
 
@@ -6739,9 +7492,11 @@ lock_trx_release_locks(
 
 	if (trx_is_referenced(trx)) {
 
+#if !defined (UNIV_LOCK_SYS_SHARDED)
 		ut_a(release_lock);
 
 		lock_mutex_exit();
+#endif /* !UNIV_LOCK_SYS_SHARDED */
 
 		while (trx_is_referenced(trx)) {
 
@@ -6756,11 +7511,13 @@ lock_trx_release_locks(
 			trx_mutex_enter(trx);
 		}
 
+#if !defined (UNIV_LOCK_SYS_SHARDED)
 		trx_mutex_exit(trx);
 
 		lock_mutex_enter();
 
 		trx_mutex_enter(trx);
+#endif /* !UNIV_LOCK_SYS_SHARDED */
 	}
 
 	ut_ad(!trx_is_referenced(trx));
@@ -6787,6 +7544,10 @@ lock_trx_release_locks(
 		lock_mutex_exit();
 	}
 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	lock_release_sharded(trx);
+#endif /* UNIV_LOCK_SYS_SHARDED */
+
 	trx->lock.n_rec_locks = 0;
 
 	/* We don't remove the locks one by one from the vector for
@@ -53,6 +53,9 @@ Created 12/9/1995 Heikki Tuuri
 #include "trx0sys.h"
 #include "trx0trx.h"
 #include "trx0roll.h"
+#if defined (UNIV_PMEMOBJ_UNDO)
+#include "trx0undo.h"
+#endif /* UNIV_PMEMOBJ_UNDO */
 #include "srv0mon.h"
 #include "sync0sync.h"
 #endif /* !UNIV_HOTBACKUP */
@@ -150,7 +153,12 @@ log_buf_pool_get_oldest_modification(void)
 
 	ut_ad(log_mutex_own());
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The pages of the user tablespaces carry PPL times */
+	lsn = buf_pool_get_oldest_classic_modification();
+#else
 	lsn = buf_pool_get_oldest_modification();
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	if (!lsn) {
 
@@ -161,6 +169,59 @@ log_buf_pool_get_oldest_modification(void)
 }
 #endif  /* !UNIV_HOTBACKUP */
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+/** Advance recent_written_lsn over the ranges whose copy is finished. */
+static
+void
+log_recent_written_advance()
+{
+	log_t*	log = log_sys;
+	lsn_t	lsn = log->recent_written_lsn;
+	lsn_t	end;
+
+	ut_ad(log_mutex_own());
+
+	while (lsn < log->recent_reserved_lsn) {
+		end = log->recent_written[lsn & (log->recent_written_size - 1)];
+
+		if (end <= lsn) {
+			/* Still copying, or a stale entry */
+			break;
+		}
+
+		lsn = end;
+	}
+
+	/* The log records up to lsn are read after the ends */
+	os_rmb;
+
+	log->recent_written_lsn = lsn;
+}
+
+/** Wait until every range reserved by log_reserve_concurrent() is copied.
+No range is reserved meanwhile, the caller holds the log mutex. */
+static
+void
+log_recent_written_wait()
+{
+	ut_ad(log_mutex_own());
+
+	for (ulint i = 0; ; i++) {
+		log_recent_written_advance();
+
+		if (log_sys->recent_written_lsn >= log_sys->recent_reserved_lsn) {
+			return;
+		}
+
+		if (i < srv_n_spin_wait_rounds) {
+			UT_RELAX_CPU();
+		} else {
+			os_thread_yield();
+		}
+	}
+}
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
 /** Extends the log buffer.
 @param[in]	len	requested minimum size in bytes */
 void
@@ -178,7 +239,11 @@ log_buffer_extend(
 		Needs to wait for. */
 		log_mutex_exit_all();
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+		log_spill_up_to(log_get_lsn());
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 		log_buffer_flush_to_disk();
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 
 		log_mutex_enter_all();
 
@@ -201,6 +266,19 @@ log_buffer_extend(
 
 	log_sys->is_extending = true;
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* The NVM halves are reallocated below, so the whole log including
+	the last block must be in the log files first. */
+	while (log_sys->flushed_to_disk_lsn < log_sys->lsn) {
+		lsn_t	lsn = log_sys->lsn;
+
+		log_mutex_exit_all();
+
+		log_spill_up_to(lsn);
+
+		log_mutex_enter_all();
+	}
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 	while (ut_calc_align_down(log_sys->buf_free,
 				  OS_FILE_LOG_BLOCK_SIZE)
 	       != ut_calc_align_down(log_sys->buf_next_to_write,
@@ -212,6 +290,12 @@ log_buffer_extend(
 
 		log_mutex_enter_all();
 	}
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	/* The last block may still be copied into */
+	log_recent_written_wait();
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 
 	move_start = ut_calc_align_down(
 		log_sys->buf_free,
@@ -224,7 +308,22 @@ log_buffer_extend(
 
 	log_sys->buf_free -= move_start;
 	log_sys->buf_next_to_write -= move_start;
-#if defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* reallocate log buffer */
+	srv_log_buffer_size = len / UNIV_PAGE_SIZE + 1;
+
+	log_sys->buf_size = LOG_BUFFER_SIZE;
+
+	/* log_pmem_buf_attach() restores the last block from tmp_buf into
+	the reallocated NVM buffer */
+	log_sys->buf_ptr = NULL;
+	log_sys->buf = tmp_buf;
+
+	log_pmem_buf_attach(log_sys->lsn - log_sys->buf_free);
+
+	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
+		- LOG_BUF_FLUSH_MARGIN;
+#elif defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	/* reallocate log buffer */
 	srv_log_buffer_size = len / UNIV_PAGE_SIZE + 1;
 	//do not free here, does it by our API
@@ -389,11 +488,13 @@ log_margin_checkpoint_age(
 	return;
 }
 #endif /* !UNIV_HOTBACKUP */
-/** Open the log for log_write_low. The log must be closed with log_close.
-@param[in]	len	length of the data to be written
-@return start lsn of the log record */
-lsn_t
-log_reserve_and_open(
+
+/** Wait until the log buffer has room for len bytes, the log mutex may be
+released meanwhile.
+@param[in]	len	length of the data to be written */
+static
+void
+log_reserve_wait(
 	ulint	len)
 {
 	ulint	len_upper_limit;
@@ -441,6 +542,23 @@ loop:
 		log_mutex_enter();
 		goto loop;
 	}
+}
+
+/** Open the log for log_write_low. The log must be closed with log_close.
+@param[in]	len	length of the data to be written
+@return start lsn of the log record */
+lsn_t
+log_reserve_and_open(
+	ulint	len)
+{
+	log_reserve_wait(len);
+
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	/* log_write_low() formats the blocks at buf_free, the ranges
+	reserved before must be copied first */
+	log_recent_written_wait();
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
 	return(log_sys->lsn);
 }
 
@@ -457,6 +575,9 @@ log_write_low(
 	ulint	len;
 	ulint	data_len;
 	byte*	log_block;
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	const ulint	start_free = log->buf_free;
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 
 	ut_ad(log_mutex_own());
 part_loop:
@@ -478,7 +599,10 @@ part_loop:
 			- LOG_BLOCK_TRL_SIZE;
 	}
 
-#if defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* Persisted once for the whole string in log_pmem_persist_write() */
+	ut_memcpy(log->buf + log->buf_free, str, len);
+#elif defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	//copy the trasaction's log records to persistent memory
 	//The mfence per copy version
 //TX_BEGIN(gb_pmw->pop) {
@@ -526,7 +650,9 @@ part_loop:
 	if (str_len > 0) {
 		goto part_loop;
 	}
-#if defined(UNIV_PMEMOBJ_LOG) || defined(UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	log_pmem_persist_write(start_free);
+#elif defined(UNIV_PMEMOBJ_LOG) || defined(UNIV_PMEMOBJ_WAL)
 	// update the lsn and buf_free
 	gb_pmw->plogbuf->lsn = log->lsn;
 	gb_pmw->plogbuf->buf_free = log->buf_free;	
@@ -534,39 +660,19 @@ part_loop:
 	srv_stats.log_write_requests.inc();
 }
 
-/************************************************************//**
-Closes the log.
-@return lsn */
-lsn_t
-log_close(void)
-/*===========*/
+/** Request a log flush or a checkpoint if the log buffer or the checkpoint
+age is too large after a log write.
+@param[in]	lsn	end lsn of the log write */
+static
+void
+log_close_check(
+	lsn_t	lsn)
 {
-	byte*		log_block;
-	ulint		first_rec_group;
 	lsn_t		oldest_lsn;
-	lsn_t		lsn;
 	log_t*		log	= log_sys;
 	lsn_t		checkpoint_age;
 
 	ut_ad(log_mutex_own());
-	ut_ad(!recv_no_log_write);
-
-	lsn = log->lsn;
-
-	log_block = static_cast<byte*>(
-		ut_align_down(
-			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
-
-	first_rec_group = log_block_get_first_rec_group(log_block);
-
-	if (first_rec_group == 0) {
-		/* We initialized a new log block which was not written
-		full by the current mtr: the next mtr log record group
-		will start within this block at the offset data_len */
-
-		log_block_set_first_rec_group(
-			log_block, log_block_get_data_len(log_block));
-	}
 
 	if (log->buf_free > log->max_buf_free) {
 
@@ -597,10 +703,15 @@ log_close(void)
 
 	if (checkpoint_age <= log->max_modified_age_sync) {
 
-		goto function_exit;
+		return;
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The pages of the user tablespaces carry PPL times */
+	oldest_lsn = buf_pool_get_oldest_classic_modification();
+#else
 	oldest_lsn = buf_pool_get_oldest_modification();
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	if (!oldest_lsn
 	    || lsn - oldest_lsn > log->max_modified_age_sync
@@ -608,11 +719,188 @@ log_close(void)
 
 		log->check_flush_or_checkpoint = true;
 	}
-function_exit:
+}
+
+/************************************************************//**
+Closes the log.
+@return lsn */
+lsn_t
+log_close(void)
+/*===========*/
+{
+	byte*		log_block;
+	ulint		first_rec_group;
+	lsn_t		lsn;
+	log_t*		log	= log_sys;
+
+	ut_ad(log_mutex_own());
+	ut_ad(!recv_no_log_write);
+
+	lsn = log->lsn;
+
+	log_block = static_cast<byte*>(
+		ut_align_down(
+			log->buf + log->buf_free, OS_FILE_LOG_BLOCK_SIZE));
+
+	first_rec_group = log_block_get_first_rec_group(log_block);
+
+	if (first_rec_group == 0) {
+		/* We initialized a new log block which was not written
+		full by the current mtr: the next mtr log record group
+		will start within this block at the offset data_len */
+
+		log_block_set_first_rec_group(
+			log_block, log_block_get_data_len(log_block));
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+		log_pmem_persist_write(log->buf_free);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+	}
+
+	log_close_check(lsn);
 
 	return(lsn);
 }
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+/** Reserve the space of len bytes of log records in the log buffer. The
+caller holds the log mutex, the mutex is still held on return. The records
+are copied with log_copy_low() and log_copy_close() after the log mutex
+is released.
+@param[in]	len	length of the log records
+@param[out]	copy	the reserved range
+@return start lsn of the log records */
+lsn_t
+log_reserve_concurrent(
+	ulint		len,
+	log_copy_t*	copy)
+{
+	log_t*	log = log_sys;
+	ulint	actual_len;
+
+	log_reserve_wait(len);
+
+	ut_ad(log_mutex_own());
+
+	if (log->recent_reserved_lsn != log->lsn) {
+		/* log_write_low() or the recovery moved the lsn, they do
+		so only when no copy is in flight */
+		ut_ad(log->recent_written_lsn == log->recent_reserved_lsn);
+
+		log->recent_written_lsn = log->recent_reserved_lsn = log->lsn;
+	}
+
+	actual_len = log_calculate_actual_len(len);
+
+	/* The ranges in flight must start at distinct entries of
+	recent_written, a range longer than the window waits for all */
+	while (log->recent_written_lsn < log->recent_reserved_lsn
+	       && log->lsn + actual_len - log->recent_written_lsn
+	       > log->recent_written_size) {
+		UT_RELAX_CPU();
+		log_recent_written_advance();
+	}
+
+	copy->start_lsn = copy->lsn = log->lsn;
+	copy->end_lsn = log->lsn + actual_len;
+	copy->start_ptr = copy->ptr = log->buf + log->buf_free;
+
+	log->lsn += actual_len;
+	log->buf_free += actual_len;
+	log->recent_reserved_lsn = log->lsn;
+
+	ut_ad(log->buf_free <= log->buf_size);
+
+	log_close_check(log->lsn);
+
+	return(copy->start_lsn);
+}
+
+/** Copy a part of the log records into a range reserved by
+log_reserve_concurrent(). The log mutex is not needed: only the data
+bytes of the range and the headers of the blocks started in it are
+written here, the block lengths are set by log_write_up_to().
+@param[in,out]	copy	the reserved range
+@param[in]	str	log records
+@param[in]	str_len	length of str */
+void
+log_copy_low(
+	log_copy_t*	copy,
+	const byte*	str,
+	ulint		str_len)
+{
+	ulint	offset;
+	ulint	len;
+	byte*	log_block;
+
+	while (str_len > 0) {
+		offset = ut_align_offset(copy->ptr, OS_FILE_LOG_BLOCK_SIZE);
+
+		len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE - offset;
+		if (str_len < len) {
+			len = str_len;
+		}
+
+		ut_memcpy(copy->ptr, str, len);
+
+		str += len;
+		str_len -= len;
+		copy->ptr += len;
+		copy->lsn += len;
+
+		if (offset + len
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* This block became full, the next block is
+			started in this range */
+			copy->ptr += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+			copy->lsn += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+
+			log_block = copy->ptr - LOG_BLOCK_HDR_SIZE;
+
+			log_block_set_hdr_no(
+				log_block,
+				log_block_convert_lsn_to_no(copy->lsn));
+			log_block_set_first_rec_group(log_block, 0);
+		}
+	}
+
+	ut_ad(copy->lsn <= copy->end_lsn);
+}
+
+/** Finish the copy into a range reserved by log_reserve_concurrent() and
+mark the range written for log_write_up_to().
+@param[in,out]	copy	the reserved range */
+void
+log_copy_close(
+	log_copy_t*	copy)
+{
+	log_t*	log = log_sys;
+	byte*	log_block;
+
+	ut_ad(copy->lsn == copy->end_lsn);
+
+	log_block = static_cast<byte*>(
+		ut_align_down(copy->ptr, OS_FILE_LOG_BLOCK_SIZE));
+
+	if (log_block != ut_align_down(copy->start_ptr,
+				       OS_FILE_LOG_BLOCK_SIZE)) {
+		/* We started this block, the next mtr log record group
+		starts within it at the end of the range */
+		log_block_set_first_rec_group(
+			log_block,
+			ut_align_offset(copy->ptr, OS_FILE_LOG_BLOCK_SIZE));
+	}
+
+	/* The range is read after its end is seen */
+	os_wmb;
+
+	log->recent_written[copy->start_lsn
+			    & (log->recent_written_size - 1)] = copy->end_lsn;
+
+	srv_stats.log_write_requests.inc();
+}
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
+
 /******************************************************//**
 Calculates the data capacity of a log group, when the log file headers are not
 included.
@@ -876,7 +1164,14 @@ log_init(void)
 	ut_a(LOG_BUFFER_SIZE >= 4 * UNIV_PAGE_SIZE);
 
 	log_sys->buf_size = LOG_BUFFER_SIZE;
-#if defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* Start on DRAM: the NVM log buffer may hold a tail that recovery
+	must write to the log files first. log_pmem_buf_attach() moves the
+	log buffer onto NVM, see the end of log_init() and
+	recv_recovery_from_checkpoint_start(). */
+	log_sys->buf_ptr = static_cast<byte*>(
+		ut_zalloc_nokey(log_sys->buf_size * 2 + OS_FILE_LOG_BLOCK_SIZE));
+#elif defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	//allocate the log buffer in persistent memory
 	if (!gb_pmw->plogbuf){
 		if ( pm_wrapper_logbuf_alloc(gb_pmw, 2 * LOG_BUFFER_SIZE + OS_FILE_LOG_BLOCK_SIZE)
@@ -924,6 +1219,19 @@ log_init(void)
 
 	os_event_set(log_sys->flush_event);
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	log_sys->spill_event = os_event_create(0);
+	log_sys->spill_thread_active = false;
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	log_sys->recent_written_size = ut_2_power_up(
+		srv_log_recent_written_size);
+	log_sys->recent_written = static_cast<lsn_t*>(
+		ut_zalloc_nokey(log_sys->recent_written_size * sizeof(lsn_t)));
+	/* recent_reserved_lsn != lsn: synced at the first reservation */
+	log_sys->recent_written_lsn = log_sys->recent_reserved_lsn = 0;
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
 	/*----------------------------*/
 
 	log_sys->last_checkpoint_lsn = log_sys->lsn;
@@ -945,7 +1253,13 @@ log_init(void)
 
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
-#if defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	if (gb_pmw->plogbuf == NULL) {
+		/* New pool: nothing to replay, but the log files are not
+		known to match the NVM copy until the first spill. */
+		log_pmem_buf_attach(LSN_MAX);
+	}
+#elif defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	//Update the lsn, buf_free in necessary
 	if(gb_pmw->plogbuf->lsn < log_sys->lsn)
 		gb_pmw->plogbuf->lsn = log_sys->lsn;
@@ -1239,7 +1553,7 @@ loop:
 
 	const ulint	page_no
 		= (ulint) (next_offset / univ_page_size.physical());
-#if defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if (defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)) && !defined (UNIV_PMEMOBJ_LOG_SPILL)
 	//We can write async when the log buffer is in PMEM
 	//We don't adjust group to group + 1 because we already handled that in log_io_complete
 	fil_io(IORequestLogWrite, false,
@@ -1270,6 +1584,260 @@ loop:
 	}
 }
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+/** true once log_sys->buf points to the NVM log buffer */
+static bool	log_pmem_attached = false;
+
+/** Persist the log buffer bytes written since a given offset and publish
+the new buf_free in the NVM log buffer. The caller must own the log mutex.
+@param[in]	start_free	log_sys->buf_free before the write */
+void
+log_pmem_persist_write(
+	ulint	start_free)
+{
+	ut_ad(log_mutex_own());
+
+	if (!log_pmem_attached) {
+		return;
+	}
+
+	PMEM_LOG_BUF*	plogbuf = gb_pmw->plogbuf;
+	const ulint	start = ut_calc_align_down(
+		start_free, OS_FILE_LOG_BLOCK_SIZE);
+	const ulint	end = ut_calc_align(
+		log_sys->buf_free, OS_FILE_LOG_BLOCK_SIZE);
+
+	/* The records and the block headers first, then the offset that
+	makes them part of the log at recovery */
+	pmemobj_persist(gb_pmw->pop, log_sys->buf + start, end - start);
+
+	plogbuf->lsn = log_sys->lsn;
+	plogbuf->buf_free = log_sys->buf_free;
+	pmemobj_persist(gb_pmw->pop, &plogbuf->buf_free,
+			sizeof(plogbuf->buf_free));
+}
+
+/** Record the switch of log_sys->buf to the other half in the NVM log
+buffer. Called by log_buffer_switch() after the last block is copied. */
+static
+void
+log_pmem_buf_switch()
+{
+	ut_ad(log_mutex_own());
+
+	if (!log_pmem_attached) {
+		return;
+	}
+
+	PMEM_LOG_BUF*	plogbuf = gb_pmw->plogbuf;
+	const ulint	half = log_sys->first_in_use ? 0 : 1;
+
+	pmemobj_persist(gb_pmw->pop, log_sys->buf, OS_FILE_LOG_BLOCK_SIZE);
+
+	plogbuf->half_lsn[half] = log_sys->lsn - log_sys->buf_free;
+	pmemobj_persist(gb_pmw->pop, &plogbuf->half_lsn[half],
+			sizeof(plogbuf->half_lsn[half]));
+
+	/* cur_half before buf_free: with a stale buf_free recovery only
+	writes stale blocks past the end of the log, which the log scan
+	rejects by their header number. The reverse order would drop the
+	half that is being written. */
+	plogbuf->cur_half = half;
+	pmemobj_persist(gb_pmw->pop, &plogbuf->cur_half,
+			sizeof(plogbuf->cur_half));
+
+	plogbuf->buf_free = log_sys->buf_free;
+	pmemobj_persist(gb_pmw->pop, &plogbuf->buf_free,
+			sizeof(plogbuf->buf_free));
+}
+
+/** Move log_sys->buf onto the NVM log buffer, copying the part of the
+block in use, and reset the persistent layout of the NVM log buffer.
+@param[in]	spilled_lsn	lsn up to which the log files are known to be
+complete, LSN_MAX if the NVM copy must not be replayed at recovery */
+void
+log_pmem_buf_attach(
+	lsn_t	spilled_lsn)
+{
+	const size_t	size = 2 * log_sys->buf_size + OS_FILE_LOG_BLOCK_SIZE;
+	const ulint	used = ut_calc_align(
+		log_sys->buf_free, OS_FILE_LOG_BLOCK_SIZE);
+	byte*		old_buf_ptr = log_sys->buf_ptr;
+	PMEM_LOG_BUF*	plogbuf;
+	byte*		data;
+	byte*		buf;
+
+	if (gb_pmw->plogbuf == NULL) {
+		if (pm_wrapper_logbuf_alloc(gb_pmw, size) == PMEM_ERROR) {
+			ib::fatal() << "Cannot allocate the NVM log buffer of "
+				<< size << " bytes";
+		}
+	} else {
+		/* Whatever the NVM log buffer holds is in the log files
+		already. Say so before the halves are overwritten. */
+		gb_pmw->plogbuf->spilled_lsn = LSN_MAX;
+		pmemobj_persist(gb_pmw->pop, &gb_pmw->plogbuf->spilled_lsn,
+				sizeof(gb_pmw->plogbuf->spilled_lsn));
+
+		if (gb_pmw->plogbuf->size != size
+		    && pm_wrapper_logbuf_realloc(gb_pmw, size)
+		    == PMEM_ERROR) {
+			ib::fatal() << "Cannot reallocate the NVM log buffer"
+				" to " << size << " bytes";
+		}
+	}
+
+	plogbuf = gb_pmw->plogbuf;
+	data = static_cast<byte*>(pm_wrapper_logbuf_get_logdata(gb_pmw));
+	buf = static_cast<byte*>(ut_align(data, OS_FILE_LOG_BLOCK_SIZE));
+
+	if (buf != log_sys->buf) {
+		pmemobj_memcpy_persist(gb_pmw->pop, buf, log_sys->buf, used);
+	} else {
+		pmemobj_persist(gb_pmw->pop, buf, used);
+	}
+
+	if (old_buf_ptr != data) {
+		ut_free(old_buf_ptr);
+	}
+
+	log_sys->buf_ptr = data;
+	log_sys->buf = buf;
+	log_sys->first_in_use = true;
+
+	plogbuf->size = size;
+	plogbuf->half_size = log_sys->buf_size;
+	plogbuf->cur_half = 0;
+	plogbuf->half_lsn[0] = log_sys->lsn - log_sys->buf_free;
+	plogbuf->half_lsn[1] = 0;
+	plogbuf->lsn = log_sys->lsn;
+	plogbuf->buf_free = log_sys->buf_free;
+	plogbuf->need_recv = true;
+	pmemobj_persist(gb_pmw->pop, plogbuf, sizeof(*plogbuf));
+
+	plogbuf->spilled_lsn = spilled_lsn;
+	pmemobj_persist(gb_pmw->pop, &plogbuf->spilled_lsn,
+			sizeof(plogbuf->spilled_lsn));
+
+	log_pmem_attached = true;
+}
+
+/** Write a block aligned lsn range of one half of the NVM log buffer to
+the log files, without going through log_sys->buf.
+@param[in]	group	log group
+@param[in]	half	start of the half in the NVM log buffer
+@param[in]	half_lsn	lsn of the first byte of the half
+@param[in]	start	first lsn to write, block aligned
+@param[in]	end	end lsn, block aligned */
+static
+void
+log_pmem_spill_range(
+	log_group_t*	group,
+	const byte*	half,
+	lsn_t		half_lsn,
+	lsn_t		start,
+	lsn_t		end)
+{
+	const ulint	chunk = 4 * UNIV_PAGE_SIZE;
+	byte*		buf_ptr = static_cast<byte*>(
+		ut_malloc_nokey(chunk + OS_FILE_LOG_BLOCK_SIZE));
+	byte*		buf = static_cast<byte*>(
+		ut_align(buf_ptr, OS_FILE_LOG_BLOCK_SIZE));
+
+	ut_ad(start >= half_lsn);
+	ut_ad(start % OS_FILE_LOG_BLOCK_SIZE == 0);
+	ut_ad(end % OS_FILE_LOG_BLOCK_SIZE == 0);
+
+	while (start < end) {
+		lsn_t	offset = log_group_calc_lsn_offset(start, group);
+		ulint	len = static_cast<ulint>(
+			ut_min(end - start, static_cast<lsn_t>(chunk)));
+
+		/* Do not cross a log file boundary */
+		len = static_cast<ulint>(ut_min(
+			static_cast<lsn_t>(len),
+			group->file_size - offset % group->file_size));
+
+		ut_memcpy(buf, half + (start - half_lsn), len);
+
+		for (ulint i = 0; i < len; i += OS_FILE_LOG_BLOCK_SIZE) {
+			log_block_store_checksum(buf + i);
+		}
+
+		fil_io(IORequestLogWrite, true,
+		       page_id_t(group->space_id,
+				 (ulint) (offset / univ_page_size.physical())),
+		       univ_page_size,
+		       (ulint) (offset % univ_page_size.physical()),
+		       len, buf, group);
+
+		start += len;
+	}
+
+	ut_free(buf_ptr);
+}
+
+/** Write the log that reached the NVM log buffer but not the log files
+before a crash, so that recovery scans it like any other log. Called at
+recovery after the checkpoint has been read.
+@param[in]	group	log group */
+void
+log_pmem_spill_tail(
+	log_group_t*	group)
+{
+	const PMEM_LOG_BUF*	plogbuf = gb_pmw->plogbuf;
+
+	ut_ad(log_mutex_own());
+
+	if (plogbuf == NULL || plogbuf->spilled_lsn == LSN_MAX) {
+		return;
+	}
+
+	const ulint	cur = static_cast<ulint>(plogbuf->cur_half);
+	const ulint	prev = 1 - cur;
+	const lsn_t	cur_lsn = plogbuf->half_lsn[cur];
+	const lsn_t	end = ut_uint64_align_up(
+		cur_lsn + plogbuf->buf_free, OS_FILE_LOG_BLOCK_SIZE);
+	lsn_t		start = ut_uint64_align_down(
+		plogbuf->spilled_lsn, OS_FILE_LOG_BLOCK_SIZE);
+
+	if (start >= end) {
+		return;
+	}
+
+	if (srv_read_only_mode) {
+		ib::warn() << "The NVM log buffer holds redo log from "
+			<< start << " to " << end << " that is not in the"
+			" log files. It is ignored in read-only mode.";
+		return;
+	}
+
+	ib::info() << "Writing redo log from " << start << " to " << end
+		<< " from the NVM log buffer to the log files";
+
+	const byte*	buf = static_cast<const byte*>(ut_align(
+		pm_wrapper_logbuf_get_logdata(gb_pmw),
+		OS_FILE_LOG_BLOCK_SIZE));
+
+	if (start < cur_lsn) {
+		/* The other half was being spilled when we crashed. Its
+		last block is older than the first block of the current
+		half, which is written next. */
+		start = ut_max(start, plogbuf->half_lsn[prev]);
+
+		log_pmem_spill_range(group, buf + prev * plogbuf->half_size,
+				     plogbuf->half_lsn[prev], start, cur_lsn);
+
+		start = cur_lsn;
+	}
+
+	log_pmem_spill_range(group, buf + cur * plogbuf->half_size,
+			     cur_lsn, start, end);
+
+	fil_flush(group->space_id);
+}
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
 /** Flush the log has been written to the log file. */
 static
 void
@@ -1288,6 +1856,15 @@ log_write_flush_to_disk_low()
 		log_sys->flushed_to_disk_lsn = log_sys->current_flush_lsn;
 	}
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	if (log_pmem_attached) {
+		/* The log half written before this flush may now be reused */
+		gb_pmw->plogbuf->spilled_lsn = log_sys->flushed_to_disk_lsn;
+		pmemobj_persist(gb_pmw->pop, &gb_pmw->plogbuf->spilled_lsn,
+				sizeof(gb_pmw->plogbuf->spilled_lsn));
+	}
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
 	log_sys->n_pending_flushes--;
 	MONITOR_DEC(MONITOR_PENDING_LOG_FLUSH);
 
@@ -1327,6 +1904,9 @@ log_buffer_switch()
 
 	log_sys->buf_free %= OS_FILE_LOG_BLOCK_SIZE;
 	log_sys->buf_next_to_write = log_sys->buf_free;
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	log_pmem_buf_switch();
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 }
 
 /** Ensure that the log has been written to the log file up to a given
@@ -1336,8 +1916,14 @@ wait and check if an already running write is covering the request.
 included in the redo log file write
 @param[in]	flush_to_disk	whether the written log should also
 be flushed to the file system */
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+static
+void
+log_write_up_to_low(
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 void
 log_write_up_to(
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 	lsn_t	lsn,
 	bool	flush_to_disk)
 {
@@ -1356,6 +1942,13 @@ log_write_up_to(
 		return;
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The callers pass log_sys lsns only: mtr_t::commit_lsn() is 0 for
+	a mtr logged in PPL only, and buf_flush_write_block_low() does not
+	force the log for the PPL time of a user page */
+	ut_ad(lsn == LSN_MAX || lsn <= log_sys->lsn);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 loop:
 	ut_ad(++loop_count < 128);
 
@@ -1370,7 +1963,7 @@ loop:
 		return;
 	}
 #endif
-#if defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
+#if (defined (UNIV_PMEMOBJ_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)) || defined (UNIV_SKIPLOG)
 //#if !defined (UNIV_TEST_PL)
 	//PL-NVM does not need this function
 	return;
@@ -1430,6 +2023,11 @@ loop:
 	}
 
 	log_mutex_enter();
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	/* The ranges reserved below log_sys->lsn must be in the buffer
+	before it is written and switched */
+	log_recent_written_wait();
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 	if (!flush_to_disk
 	    && log_sys->buf_free == log_sys->buf_next_to_write) {
 		/* Nothing to write and no flush to disk requested */
@@ -1471,6 +2069,23 @@ loop:
 
 	ut_ad(area_end - area_start > 0);
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	/* log_copy_low() does not set the block lengths: every block but
+	the last one is full */
+	for (ulint i = area_start; i < area_end; i += OS_FILE_LOG_BLOCK_SIZE) {
+		if (i + OS_FILE_LOG_BLOCK_SIZE < area_end) {
+			log_block_set_data_len(log_sys->buf + i,
+					       OS_FILE_LOG_BLOCK_SIZE);
+			log_block_set_checkpoint_no(
+				log_sys->buf + i,
+				log_sys->next_checkpoint_no);
+		} else {
+			log_block_set_data_len(log_sys->buf + i,
+					       end_offset - i);
+		}
+	}
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
 	log_block_set_flush_bit(log_sys->buf + area_start, TRUE);
 	log_block_set_checkpoint_no(
 		log_sys->buf + area_end - OS_FILE_LOG_BLOCK_SIZE,
@@ -1544,6 +2159,79 @@ loop:
 	}
 }
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+/** Ensure that the log up to a given lsn is durable. Once log_sys->buf is
+on NVM every log record is persistent when mtr_commit() returns, so there
+is nothing to wait for: only wake up the spill thread when the log buffer
+fills up.
+@param[in]	lsn		log sequence number that should be durable
+@param[in]	flush_to_disk	whether the log should also be flushed */
+void
+log_write_up_to(
+	lsn_t	lsn,
+	bool	flush_to_disk)
+{
+	if (!log_pmem_attached) {
+		log_write_up_to_low(lsn, flush_to_disk);
+		return;
+	}
+
+	if (log_sys->buf_free > log_sys->max_buf_free / 2) {
+		os_event_set(log_sys->spill_event);
+	}
+}
+
+/** Write the log buffer to the log files and flush them up to a given lsn.
+With the NVM log buffer, log_write_up_to() returns as soon as the log is
+persistent in NVM; this is the path that really reaches ib_logfile, used
+by the spill thread, checkpoints and when the log buffer runs out of space.
+Always flushing keeps a half of log_sys->buf from being reused before its
+content is on disk, see log_pmem_buf_switch().
+@param[in]	lsn	log sequence number that should be on disk */
+void
+log_spill_up_to(
+	lsn_t	lsn)
+{
+	log_write_up_to_low(lsn, true);
+}
+
+/** The spill thread writes the NVM log buffer to the log files in the
+background, every innodb_pmem_log_spill_interval ms or when woken up.
+@param[in]	arg	a dummy parameter required by os_thread_create.
+@return this function does not return, calls os_thread_exit() */
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(log_spill_thread)(
+	void*	arg MY_ATTRIBUTE((unused)))
+{
+	my_thread_init();
+
+	log_sys->spill_thread_active = true;
+
+	int64_t	sig_count = os_event_reset(log_sys->spill_event);
+
+	while (srv_shutdown_state == SRV_SHUTDOWN_NONE) {
+		os_event_wait_time_low(log_sys->spill_event,
+				       srv_pmem_log_spill_interval * 1000,
+				       sig_count);
+		sig_count = os_event_reset(log_sys->spill_event);
+
+		if (srv_shutdown_state != SRV_SHUTDOWN_NONE) {
+			break;
+		}
+
+		log_spill_up_to(log_get_lsn());
+	}
+
+	log_sys->spill_thread_active = false;
+
+	my_thread_end();
+	os_thread_exit();
+
+	OS_THREAD_DUMMY_RETURN;
+}
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
 /** write to the log file up to the last log entry.
 @param[in]	sync	whether we want the written log
 also to be flushed to disk. */
@@ -1581,7 +2269,11 @@ log_buffer_sync_in_background(
 
 	log_mutex_exit();
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	log_spill_up_to(lsn);
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 	log_write_up_to(lsn, flush);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 }
 
 /********************************************************************
@@ -1606,7 +2298,12 @@ log_flush_margin(void)
 	log_mutex_exit();
 
 	if (lsn) {
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+		/* Make room in the log buffer */
+		log_spill_up_to(lsn);
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 		log_write_up_to(lsn, false);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 	}
 }
 #ifndef UNIV_HOTBACKUP
@@ -1638,6 +2335,12 @@ log_preflush_pool_modified_pages(
 		recv_apply_hashed_log_recs(TRUE);
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The flush lists mix log_sys lsns and PPL times, a batch stops at
+	the first page of the list tail not older than the limit */
+	new_oldest = log_hybrid_lsn_to_time(new_oldest);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	if (new_oldest == LSN_MAX
 	    || !buf_page_cleaner_is_active
 	    || srv_is_being_started) {
@@ -1950,7 +2653,14 @@ log_checkpoint(
 	}
 #endif /* !_WIN32 */
 
-#if defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
+#if defined (UNIV_PMEMOBJ_UNDO)
+	/* The pages modified before the previous checkpoint were written
+	before it was taken and are synced now, their NVM undo images are
+	not needed anymore. */
+	trx_undo_nvm_checkpoint(log_sys->last_checkpoint_lsn);
+#endif /* UNIV_PMEMOBJ_UNDO */
+
+#if (defined (UNIV_PMEMOBJ_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)) || defined (UNIV_SKIPLOG)
 //#if defined (UNIV_PMEMOBJ_PL)
 	//printf("PL DEBUG ====> log_checkpoint()\n");
 	//hot fix bug: when start server recv_recovery_rollback_active() ->
@@ -2016,6 +2726,9 @@ log_checkpoint(
 	log_mutex_exit();
 #if defined (UNIV_PMEMOBJ_WAL)
 	//no flush log at checkpoint
+#elif defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* The checkpoint lsn must not be ahead of the log files */
+	log_spill_up_to(flush_lsn);
 #else //original
 	//tdnguyen test
 //	ulint t = ut_time_us(NULL);
@@ -2110,9 +2823,136 @@ pm_ppl_checkpoint(
 	pmemobj_rwlock_wrlock(pop, &ppl->ckpt_lock);
 	ppl->ckpt_lsn = new_oldest;
 	pmemobj_rwlock_unlock(pop, &ppl->ckpt_lock);
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* (6) The flush above also wrote the system and undo pages dirtied
+	before new_oldest, move the log_sys checkpoint with it so that
+	both logs restart recovery from the same point in time */
+	log_checkpoint(true, false);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 }
 #endif //UNIV_PMEMOBJ_PART_PL
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Remember the PPL time at which log_sys reached an lsn, at most one
+sample every LOG_HYBRID_SAMPLE_BYTES. The caller must own the log mutex.
+@param[in]	lsn	end lsn of a mini-transaction */
+void
+log_hybrid_sample(
+	lsn_t	lsn)
+{
+	ulint	n;
+	ulint	last;
+
+	ut_ad(log_mutex_own());
+
+	n = log_sys->hybrid_n_samples;
+
+	if (n > 0) {
+		last = (n - 1) % LOG_HYBRID_N_SAMPLES;
+
+		if (lsn < log_sys->hybrid_lsn[last]
+		    + LOG_HYBRID_SAMPLE_BYTES) {
+			return;
+		}
+	}
+
+	log_sys->hybrid_lsn[n % LOG_HYBRID_N_SAMPLES] = lsn;
+	log_sys->hybrid_time[n % LOG_HYBRID_N_SAMPLES] = ut_time_us(NULL);
+	log_sys->hybrid_n_samples = n + 1;
+}
+
+/** Translate a log_sys lsn into the PPL time domain: the flush lists hold
+both, and a page dirtied before log_sys reached lsn was dirtied before the
+returned time.
+@param[in]	lsn	log sequence number, or LSN_MAX
+@return PPL time (ut_time_us), or LSN_MAX */
+lsn_t
+log_hybrid_lsn_to_time(
+	lsn_t	lsn)
+{
+	ulint	n;
+	ulint	first;
+	ulint	i;
+	lsn_t	time;
+
+	if (lsn == LSN_MAX) {
+		return(LSN_MAX);
+	}
+
+	log_mutex_enter();
+
+	if (lsn > log_sys->lsn) {
+		/* Already a PPL time */
+		log_mutex_exit();
+		return(lsn);
+	}
+
+	n = log_sys->hybrid_n_samples;
+	first = n > LOG_HYBRID_N_SAMPLES ? n - LOG_HYBRID_N_SAMPLES : 0;
+
+	/* Samples are in lsn order, take the first one at or above lsn.
+	Older lsns map to the oldest sample, which is an upper bound too. */
+	time = ut_time_us(NULL);
+
+	for (i = first; i < n; i++) {
+		ulint	slot = i % LOG_HYBRID_N_SAMPLES;
+
+		if (log_sys->hybrid_lsn[slot] >= lsn) {
+			time = log_sys->hybrid_time[slot];
+			break;
+		}
+	}
+
+	log_mutex_exit();
+
+	return(time);
+}
+
+/** Translate a PPL time back into the log_sys lsn domain: a system or undo
+page whose oldest_modification is below the returned lsn was dirtied before
+the time. This is the reverse of log_hybrid_lsn_to_time().
+@param[in]	time	PPL time (ut_time_us), or LSN_MAX
+@return log sequence number, or LSN_MAX */
+lsn_t
+log_hybrid_time_to_lsn(
+	lsn_t	time)
+{
+	ulint	n;
+	ulint	first;
+	ulint	i;
+	lsn_t	lsn;
+
+	if (time == LSN_MAX) {
+		return(LSN_MAX);
+	}
+
+	log_mutex_enter();
+
+	n = log_sys->hybrid_n_samples;
+	first = n > LOG_HYBRID_N_SAMPLES ? n - LOG_HYBRID_N_SAMPLES : 0;
+
+	/* Samples are in time order, take the last one at or before the
+	time. After the newest sample, log_sys->lsn is an upper bound that
+	only adds the pages dirtied since; before the oldest sample nothing
+	is known to be older. */
+	lsn = n > 0 ? 0 : log_sys->lsn;
+
+	for (i = n; i > first; i--) {
+		ulint	slot = (i - 1) % LOG_HYBRID_N_SAMPLES;
+
+		if (log_sys->hybrid_time[slot] <= time) {
+			lsn = i == n ? log_sys->lsn : log_sys->hybrid_lsn[slot];
+			break;
+		}
+	}
+
+	log_mutex_exit();
+
+	return(lsn);
+}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 /** Make a checkpoint at or after a specified LSN.
 @param[in]	lsn		the log sequence number, or LSN_MAX
 for the latest LSN
@@ -2492,7 +3332,11 @@ loop:
 			to the data files, since at a startup InnoDB deduces
 			from the stamps if the previous shutdown was clean. */
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+			log_spill_up_to(log_get_lsn());
+#else /* UNIV_PMEMOBJ_LOG_SPILL */
 			log_buffer_flush_to_disk();
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 
 			/* Check that the background threads stay suspended */
 			thread_name = srv_any_background_threads_are_active();
@@ -2516,7 +3360,7 @@ loop:
 		return;
 	}
 
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 	//in PPL, we use our LSN
 	log_mutex_enter();
 	log_sys->lsn = pm_ppl_get_max_lsn(gb_pmw->pop, gb_pmw->ppl);
@@ -2743,7 +3587,13 @@ log_shutdown(void)
 /*==============*/
 {
 	log_group_close_all();
-#if defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	if (!log_pmem_attached) {
+		ut_free(log_sys->buf_ptr);
+	}
+	log_pmem_attached = false;
+	os_event_destroy(log_sys->spill_event);
+#elif defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	//The pmem free() is done later
 	//do nothing for log_sys->buf_ptr
 #else //original
@@ -2754,6 +3604,10 @@ log_shutdown(void)
 	ut_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	ut_free(const_cast<lsn_t*>(log_sys->recent_written));
+	log_sys->recent_written = NULL;
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 
 	os_event_destroy(log_sys->flush_event);
 
@@ -29,6 +29,7 @@ Created 9/20/1997 Heikki Tuuri
 #include <vector>
 #include <map>
 #include <string>
+#include <algorithm>
 
 #include "log0recv.h"
 
@@ -76,6 +77,20 @@ extern PMEM_WRAPPER* gb_pmw;
 static bool IS_GLOBAL_HASHTABLE = false;
 #endif
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** true once pm_ppl_recovery() runs, after the log_sys recovery of the
+system and undo tablespaces */
+static bool	recv_ppl_started = false;
+
+/** true if the log_sys recovery already processed the doublewrite buffer
+and started the recv writer thread */
+static bool	recv_ppl_classic_recovered = false;
+
+/** lsn up to which the log_sys recovery recovered the system and undo
+tablespaces, the PPL recs that depend on a later lsn are skipped */
+static lsn_t	recv_ppl_classic_lsn = 0;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 
 /** Log records are stored in the hash table in chunks at most of this size;
 this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
@@ -996,7 +1011,10 @@ recv_sys_init(
 		ut_malloc_nokey(RECV_PARSING_BUF_SIZE));
 	recv_sys->len = 0;
 	recv_sys->recovered_offset = 0;
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* the system and undo tablespaces are recovered from log_sys */
+	recv_sys->addr_hash = hash_create(available_memory / 512);
+#elif defined (UNIV_PMEMOBJ_PART_PL)
 	if (!gb_pmw->ppl->is_new){
 		//just create dummy addr_hash
 		recv_sys->addr_hash = hash_create(128);
@@ -1025,6 +1043,7 @@ recv_sys_init(
 #if defined (UNIV_TRACE_RECOVERY_TIME)
 	/*this variable only used for the original*/
 	recv_sys->redo1_time = 0;
+	recv_sys->analysis_time = 0;
 #endif
 	recv_max_page_lsn = 0;
 
@@ -1781,7 +1800,7 @@ recv_parse_or_apply_log_rec_body(
 		}
 #endif /* UNIV_HOTBACKUP */
 		if (end_ptr < ptr + 8) {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 			assert(0);
 #endif
 			return(NULL);
@@ -2388,11 +2407,25 @@ recv_recover_page_func(
 	buf_block_t*	block)	/*!< in/out: buffer block */
 {
 
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (!gb_pmw->ppl->is_new
+	    && !mtr_t::is_classic_space(block->page.id.space())) {
+		buf_page_t* bpage = (buf_page_t*) block;
+
+		PMEM_PAGE_LOG_HASHED_LINE* pline;
+
+		/* The log_sys recovery reads system and undo pages only */
+		ut_ad(recv_ppl_started);
+		if (!recv_ppl_started) {
+			return;
+		}
+#elif defined (UNIV_PMEMOBJ_PART_PL)
 	if (!gb_pmw->ppl->is_new){
 		buf_page_t* bpage = (buf_page_t*) block;
 
 		PMEM_PAGE_LOG_HASHED_LINE* pline;
+#endif
+#if defined (UNIV_PMEMOBJ_PART_PL)
 
 		pline = pm_ppl_get_line_from_key(
 				gb_pmw->pop, gb_pmw->ppl,
@@ -2712,7 +2745,13 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (recv_ppl_started){
+		/* apply the user tablespaces then the log_sys records of
+		the system and undo tablespaces below */
+		pm_ppl_recv_apply_hashed_log_recs(gb_pmw->pop, gb_pmw->ppl, allow_ibuf);
+	}
+#elif defined (UNIV_PMEMOBJ_PART_PL)
 	if (!gb_pmw->ppl->is_new){
 		return (pm_ppl_recv_apply_hashed_log_recs(gb_pmw->pop, gb_pmw->ppl, allow_ibuf) );
 	}
@@ -4146,6 +4185,10 @@ pm_ppl_recv_init(
 	PMEM_RECV_LINE* recv_line;
 
 	n = ppl->n_buckets;
+
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	ppl->io_sched = pm_ppl_recv_io_sched_init(srv_ppl_recv_read_batch);
+#endif
 	
 	if (IS_GLOBAL_HASHTABLE){
 		//A: allocate global recv_line
@@ -4224,6 +4267,9 @@ pm_ppl_recv_init(
 			recv_line->mlog_checkpoint_lsn = 0;
 
 			recv_line->encryption_list = NULL;
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+			recv_line->compact_dict = (PMEM_PPL_COMPACT_DICT*) malloc(sizeof(PMEM_PPL_COMPACT_DICT));
+#endif
 		} //end for
 	}
 }
@@ -4279,14 +4325,35 @@ pm_ppl_recv_end(
 				}
 
 				ut_free(recv_line->buf);
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+				free(recv_line->compact_dict);
+#endif
 				free(recv_line);
 				recv_line = NULL;
 			}
 		}
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	if (ppl->io_sched != NULL) {
+		pm_ppl_recv_io_sched_close(ppl->io_sched);
+		ppl->io_sched = NULL;
+	}
+#endif
+
 	//C: reset data structures in PPL
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	/*no reclaim batch runs while the lines are reset*/
+	while (pm_ppl_reclaimer_drain(pop, ppl) > 0) {}
+	pmemobj_rwlock_wrlock(pop, &ppl->reclaimer->consumer_lock);
+#endif
 	pm_ppl_reset_all(pop, ppl);
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	pmemobj_rwlock_unlock(pop, &ppl->reclaimer->consumer_lock);
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	pm_ptxl_reset_all(pop, gb_pmw->ptxl);
+#endif /* UNIV_PMEMOBJ_TX_LOG */
 }
 
 /*
@@ -4311,9 +4378,17 @@ pm_ppl_recovery(
 	//avail_mem = avail_mem / 512 / n;
     pm_ppl_recv_init(pop, ppl);
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* recv_recovery_from_checkpoint_start() already recovered the
+	system and undo tablespaces and created the flush rbt */
+	recv_ppl_classic_recovered = recv_needed_recovery;
+	recv_ppl_classic_lsn = log_sys->lsn;
+	recv_ppl_started = true;
+#else
 	/* Initialize red-black tree for fast insertions into the
 	flush_list during recovery process. */
 	buf_flush_init_flush_rbt();
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	recv_recovery_on = true;
 	log_mutex_enter();
@@ -4321,7 +4396,13 @@ pm_ppl_recovery(
 	/*Phase 1: Analysis and prepare data structure for recovery
      *pm_ppl_analysis() replace old codes until the first recv_group_scan_log_recs()
      * */
+#if defined (UNIV_TRACE_RECOVERY_TIME)
+	ulint t_analysis = ut_time_us(NULL);
+#endif
     pm_ppl_analysis(pop, ppl, &global_max_lsn);
+#if defined (UNIV_TRACE_RECOVERY_TIME)
+	recv_sys->analysis_time += ut_time_us(NULL) - t_analysis;
+#endif
     printf("\nPMEM_REC: ====    ANALYSIS FINISH ====== \n");
 
 	//end test
@@ -4331,13 +4412,32 @@ pm_ppl_recovery(
 		
 	max_recovered_lsn = pm_ppl_recv_get_max_recovered_lsn(
 		pop, ppl);	
+
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	/*the recs of the per-tx log blocks go to the same recv lines*/
+	{
+		lsn_t	ptxl_max_lsn = pm_ptxl_recv_parse(
+			pop, ppl, gb_pmw->ptxl);
+
+		if (recv_sys->found_corrupt_log) {
+			log_mutex_exit();
+			return(DB_ERROR);
+		}
+		if (ptxl_max_lsn > max_recovered_lsn) {
+			max_recovered_lsn = ptxl_max_lsn;
+		}
+	}
+#endif /* UNIV_PMEMOBJ_TX_LOG */
 	
 
     // all code related with checkpoint is removed because we don't use checkpoint
     
     //at the end of pm_ppl_redo, recv_sys->recovered_lsn is the last offset of the last line
 	
+#if !defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* in the hybrid mode log_sys->lsn stays in the log_sys domain */
 	log_sys->lsn = max_recovered_lsn;
+#endif
 
 	recv_needed_recovery = true;
 
@@ -4378,7 +4478,9 @@ pm_ppl_recovery(
 	}
 
 	
+#if !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 	srv_start_lsn = max_recovered_lsn;
+#endif
 
 	mutex_enter(&recv_sys->mutex);
 
@@ -4398,6 +4500,156 @@ pm_ppl_recovery(
 
 }
 
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+/*A log rec on a per-tx log block, sorted by LSN before it is hashed*/
+struct pm_ptxl_recv_rec_t {
+	uint64_t	lsn;
+	byte*		ptr;
+	uint32_t	len;
+
+	bool operator<(const pm_ptxl_recv_rec_t& other) const
+	{
+		return(lsn < other.lsn);
+	}
+};
+
+/*
+ * Parse the per-tx log blocks into the per-line recv hashtables of the PPL
+ * The recs of a page may be spread over many blocks, they are merged by
+ * LSN so each recv_addr keeps its recs in LSN order as the PPL parse does
+ * The recs that the page already has are skipped by the apply phase, it
+ * compares the rec LSN with the page LSN
+ * @param[in] pop
+ * @param[in] ppl
+ * @param[in] ptxl
+ * @return the max LSN of the parsed recs, 0 if none
+ * */
+ulint
+pm_ptxl_recv_parse(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_TX_PART_LOG*	ptxl)
+{
+	std::vector<pm_ptxl_recv_rec_t>	recs;
+	uint64_t			i;
+	uint64_t			n_blocks;
+	ulint				max_lsn = 0;
+
+	n_blocks = ptxl->n_buckets * ptxl->n_blocks_per_bucket;
+
+	/*(1) collect the recs of the non-free blocks*/
+	for (i = 0; i < n_blocks; i++) {
+		PMEM_TX_LOG_BLOCK* plog_block =
+			pm_ptxl_get_block_by_id(ptxl, i + 1);
+
+		if (plog_block->state == PMEM_FREE_LOG_BLOCK) {
+			continue;
+		}
+
+		byte* ptr = ptxl->p_align + plog_block->pmemaddr;
+		byte* end_ptr = ptr + plog_block->cur_off;
+
+		while (ptr < end_ptr) {
+			pm_ptxl_recv_rec_t	rec;
+			mlog_id_t	type;
+			ulint		space;
+			ulint		page_no;
+			byte*		new_ptr;
+
+			if (*ptr == MLOG_MULTI_REC_END
+			    || *ptr == MLOG_DUMMY_RECORD) {
+				ptr++;
+				continue;
+			}
+
+			new_ptr = mlog_parse_initial_log_record(
+				ptr, end_ptr, &type, &space, &page_no);
+			if (new_ptr == NULL) {
+				recv_sys->found_corrupt_log = true;
+				return(0);
+			}
+
+			rec.ptr = ptr;
+			rec.len = mach_read_from_2(new_ptr);
+			rec.lsn = mach_read_from_8(new_ptr + 2);
+
+			if (rec.len == 0 || ptr + rec.len > end_ptr) {
+				recv_sys->found_corrupt_log = true;
+				return(0);
+			}
+
+			recs.push_back(rec);
+			ptr += rec.len;
+		}
+	}
+
+	std::sort(recs.begin(), recs.end());
+
+	printf("PMEM_RECV: parse %zu recs from %zu per-tx log blocks\n",
+	       recs.size(), n_blocks - ptxl->n_free_blocks);
+
+	/*(2) parse the bodies and hash the page recs in LSN order*/
+	for (i = 0; i < recs.size(); i++) {
+		mlog_id_t	type;
+		ulint		space;
+		ulint		page_no;
+		ulint		key;
+		ulint		hashed;
+		byte*		body;
+		byte*		rec_end = recs[i].ptr + recs[i].len;
+		PMEM_RECV_LINE*	recv_line;
+
+		body = mlog_parse_initial_log_record(
+			recs[i].ptr, rec_end, &type, &space, &page_no);
+		body += 2 + 8;
+
+		if (recv_parse_or_apply_log_rec_body(
+			    type, body, rec_end, space, page_no, NULL, NULL)
+		    == NULL || recv_sys->found_corrupt_log) {
+			recv_report_corrupt_log(recs[i].ptr, type, space, page_no);
+			return(0);
+		}
+
+		max_lsn = recs[i].lsn;
+
+		switch (type) {
+		case MLOG_CHECKPOINT:
+		case MLOG_FILE_NAME:
+		case MLOG_FILE_DELETE:
+		case MLOG_FILE_CREATE2:
+		case MLOG_FILE_RENAME2:
+		case MLOG_INDEX_LOAD:
+		case MLOG_TRUNCATE:
+			/*handled by recv_parse_or_apply_log_rec_body()*/
+			continue;
+		default:
+			break;
+		}
+
+		PMEM_FOLD(key, space, page_no);
+		PMEM_LOG_HASH_KEY(hashed, key, ppl->n_buckets);
+
+		if (IS_GLOBAL_HASHTABLE) {
+			recv_line = ppl->recv_line;
+		} else {
+			recv_line = D_RW(D_RW(ppl->buckets)[hashed])->recv_line;
+		}
+
+		pm_ppl_recv_add_to_hash_table(
+			pop, ppl, recv_line,
+			type, space, page_no,
+			body, rec_end,
+			recs[i].lsn, recs[i].lsn + recs[i].len);
+
+		if (recv_line->recovered_lsn < recs[i].lsn) {
+			recv_line->recovered_lsn = recs[i].lsn;
+		}
+	}
+
+	return(max_lsn);
+}
+#endif /* UNIV_PMEMOBJ_TX_LOG */
+
 /*
  * (1) Compute the low-water mark recv_diskaddr and corresponding LSN for each lines
  *
@@ -4802,14 +5054,22 @@ read_log_file:
         ptr = recv_buf + PMEM_LOG_BUF_HEADER_SIZE;
 
         /* parse log recs in the recv_buf and insert log recs into the per-line hashtable */
-        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, &skip1_recs, &skip2_recs, &need_recs);
-
-		assert(parsed_recs == n_recs);
+        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, cur_addr, &skip1_recs, &skip2_recs, &need_recs);
 
         if (parsed_recs < 0){
             printf("PMEM_ERROR case A error after pm_ppl_parse_recs() \n");
             assert(0);
         }
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		if ((uint64_t) parsed_recs < n_recs) {
+			/*a full logbuf has no torn rec, the line ends at the bad one*/
+			printf("PMEM_WARN: case A line %zu stops at a bad rec checksum, parsed %zu of %u recs\n",
+					pline->hashed_id, (uint64_t) parsed_recs, n_recs);
+			return false;
+		}
+#else
+		assert(parsed_recs == n_recs);
+#endif
 #if defined (UNIV_PMEMOBJ_PART_PL_DEBUG)
 		total_parsed_recs += parsed_recs;
 		total_need_recs += need_recs;
@@ -4840,7 +5100,7 @@ read_log_nvm:
         /*case B: the flushing from logbuf to log file has not finished when the system crash
 		 * memcpy from flushing log buffer in NVDIMM to buf
 		 */
-        src = ppl->p_align + pcur_logbuf->pmemaddr;
+        src = PMEM_LOG_BUF_DATA(ppl, pcur_logbuf);
         scan_len = pcur_logbuf->size;
 
         memcpy(recv_buf, src, scan_len);
@@ -4856,9 +5116,7 @@ read_log_nvm:
         ptr = recv_buf + PMEM_LOG_BUF_HEADER_SIZE;
 
         /* parse log recs in the recv_buf and insert log recs into the per-line hashtable */
-        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, &skip1_recs, &skip2_recs, &need_recs);
-
-		assert(parsed_recs == n_recs);
+        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, cur_addr, &skip1_recs, &skip2_recs, &need_recs);
 
         if (parsed_recs < 0){
             printf("PMEM_ERROR case B error after pm_ppl_parse_recs() \n");
@@ -4866,6 +5124,16 @@ read_log_nvm:
 
             return true; 
         }
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		if ((uint64_t) parsed_recs < n_recs) {
+			/*a full logbuf has no torn rec, the line ends at the bad one*/
+			printf("PMEM_WARN: case B line %zu stops at a bad rec checksum, parsed %zu of %u recs\n",
+					pline->hashed_id, (uint64_t) parsed_recs, n_recs);
+			return false;
+		}
+#else
+		assert(parsed_recs == n_recs);
+#endif
 
 #if defined (UNIV_PMEMOBJ_PART_PL_DEBUG)
 		total_parsed_recs += parsed_recs;
@@ -4909,8 +5177,13 @@ read_log_nvm:
 	assert(cur_addr == plogbuf->diskaddr);
 
     if (plogbuf->cur_off > 0){
-        src = ppl->p_align + plogbuf->pmemaddr;
+        src = PMEM_LOG_BUF_DATA(ppl, plogbuf);
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		/*cur_off is not persisted at each write, the checksums find the last rec*/
+        scan_len = plogbuf->size;
+#else
         scan_len = plogbuf->cur_off;
+#endif
 
         memcpy(recv_buf, src, scan_len);
         actual_len = scan_len;
@@ -4919,9 +5192,7 @@ read_log_nvm:
         ptr = recv_buf + PMEM_LOG_BUF_HEADER_SIZE;
 
         /* parse log recs in the recv_buf and insert log recs into the per-line hashtable */
-        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, &skip1_recs, &skip2_recs, &need_recs);
-
-		assert(parsed_recs == n_recs);
+        parsed_recs = pm_ppl_parse_recs(pop, ppl, pline, ptr, actual_len - PMEM_LOG_BUF_HEADER_SIZE, cur_addr, &skip1_recs, &skip2_recs, &need_recs);
 
         if (parsed_recs < 0){
             printf("PMEM_ERROR case C error after pm_ppl_parse_recs() \n");
@@ -4929,6 +5200,15 @@ read_log_nvm:
 
             return true; 
         }
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		/*resume the writes right after the last good rec*/
+		plogbuf->cur_off = PMEM_LOG_BUF_HEADER_SIZE + recv_line->recovered_offset;
+		plogbuf->n_recs = parsed_recs;
+		pmemobj_persist(pop, &plogbuf->cur_off, sizeof(plogbuf->cur_off));
+		pmemobj_persist(pop, &plogbuf->n_recs, sizeof(plogbuf->n_recs));
+#else
+		assert(parsed_recs == n_recs);
+#endif
 
 #if defined (UNIV_PMEMOBJ_PART_PL_DEBUG)
 		total_parsed_recs += parsed_recs;
@@ -4967,8 +5247,10 @@ read_log_nvm:
  @param[in] pline
  @param[in] start_ptr pointer to the start of logbuf
  @param[in] parse_len number bytes should be parsed
+ @param[in] diskaddr disk address of the logbuf, the seed of the rec checksums
  @param[out] n_need_recs number of log recs need to add to hashtable after parsing
- @return: number of parsed recs
+ @return: number of parsed recs, with UNIV_PMEMOBJ_PPL_CHECKSUM the parse
+ stops cleanly at the first rec whose checksum does not match
  * */
 int64_t
 pm_ppl_parse_recs(
@@ -4977,6 +5259,7 @@ pm_ppl_parse_recs(
 		PMEM_PAGE_LOG_HASHED_LINE*  pline,
 		byte*                       start_ptr,
 		uint64_t                    parse_len,
+		uint64_t                    diskaddr,
 		uint64_t*					n_skip1_recs,
 		uint64_t*					n_skip2_recs,
 		uint64_t*					n_need_recs
@@ -4996,6 +5279,9 @@ pm_ppl_parse_recs(
 	uint64_t n_parsed_recs;
 
 	bool	is_need;
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+	uint32_t check_len;
+#endif
 
 	PMEM_RECV_LINE* recv_line = pline->recv_line;
 	store_t		store = STORE_YES;
@@ -5005,6 +5291,11 @@ pm_ppl_parse_recs(
     cur_off = 0;
 	recv_line->recovered_offset = cur_off;
 
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	/*the page index of compact recs is rebuilt for each logbuf*/
+	pm_ppl_compact_dict_reset(recv_line->compact_dict, 0, true);
+#endif
+
 	n_parsed_recs = 0;
 	*n_need_recs = 0;
 	*n_skip1_recs = *n_skip2_recs = 0;
@@ -5019,6 +5310,13 @@ loop:
     }
 	is_need = false;
 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+	if (!pm_ppl_rec_check(ptr, end_ptr, pline->hashed_id, diskaddr, &check_len)) {
+		return n_parsed_recs; //the end of recs, a torn or a stale rec
+	}
+	ptr += PMEM_PPL_REC_CHECK_SIZE;
+#endif
+
 	
 	//parse a log rec from ptr, return rec len
 	len = pm_ppl_recv_parse_log_rec(
@@ -5033,6 +5331,9 @@ loop:
 			*n_skip1_recs = *n_skip1_recs + 1;
 			break;
 		case PMEM_PARSE_LSN_OLD:
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		case PMEM_PARSE_HYBRID_DEP:
+#endif
 			*n_skip2_recs = *n_skip2_recs + 1;
 			break;
 		case PMEM_PARSE_NEED:
@@ -5042,6 +5343,16 @@ loop:
 	}
 #endif
 	
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	if (len == 0 && recv_line->found_corrupt_log) {
+		/*a compact rec that does not parse is torn, it ends the line
+		as a rec failing pm_ppl_rec_check() does*/
+		recv_line->found_corrupt_log = recv_sys->found_corrupt_log;
+		recv_line->found_corrupt_fs = recv_sys->found_corrupt_fs;
+		return n_parsed_recs;
+	}
+#endif /* UNIV_PMEMOBJ_PPL_COMPACT */
+
 	recv_line->found_corrupt_log = recv_sys->found_corrupt_log;
 	recv_line->found_corrupt_fs = recv_sys->found_corrupt_fs;
 	
@@ -5063,9 +5374,12 @@ loop:
 		return -1;
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+	assert(len == check_len);
+#endif
 	//update
 	n_parsed_recs++;
-	cur_off += len;
+	cur_off += len + PMEM_PPL_REC_CHECK_SIZE;
 	recv_line->recovered_offset = cur_off;
 
 	
@@ -5217,6 +5531,47 @@ pm_ppl_recv_parse_log_rec(
 	
 	//(2) Parse the log header to get space, page_no
 		
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	if (*ptr & PMEM_PPL_REC_COMPACT) {
+		uint32_t body_len;
+
+		new_ptr = pm_ppl_compact_parse_header(
+				recv_line->compact_dict, ptr, end_ptr,
+				(recv_line->recovered_offset == 0),
+				type, space, page_no, rec_lsn, &body_len);
+		if (new_ptr == NULL) {
+			/*torn header, the caller ends the line*/
+			recv_line->found_corrupt_log = true;
+			return(0);
+		}
+
+		if (body_len == UINT32_MAX) {
+			/*dense rec has no len, parse the body to get it*/
+			byte* rec_end = recv_parse_or_apply_log_rec_body(
+					*type, new_ptr, end_ptr, *space, *page_no, NULL, NULL);
+			if (rec_end == NULL) {
+				/*torn body, the caller ends the line*/
+				recv_line->found_corrupt_log = true;
+				return(0);
+			}
+			rec_len = rec_end - ptr;
+		} else {
+			rec_len = (new_ptr - ptr) + body_len;
+		}
+	} else {
+		/*full rec, written when the logbuf was not indexed*/
+		new_ptr = mlog_parse_initial_log_record(ptr, end_ptr, type, space, page_no);
+
+		rec_len = mach_read_from_2(new_ptr);
+		assert(rec_len > 0);
+		new_ptr += 2;
+
+		*rec_lsn = mach_read_from_8(new_ptr);
+		new_ptr += 8;
+
+		recv_line->compact_dict->last_lsn = *rec_lsn;
+	}
+#else
 	//get the header of the log record, the return pointer should point to "rec_len"
 	new_ptr = mlog_parse_initial_log_record(ptr, end_ptr, type, space, page_no);
 	
@@ -5226,6 +5581,11 @@ pm_ppl_recv_parse_log_rec(
 
 	*rec_lsn = mach_read_from_8(new_ptr);
 	new_ptr += 8;
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	lsn_t	dep_lsn = mach_read_from_8(new_ptr);
+	new_ptr += 8;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+#endif /* UNIV_PMEMOBJ_PPL_COMPACT */
 	
 	*body = new_ptr;
 
@@ -5284,6 +5644,17 @@ pm_ppl_recv_parse_log_rec(
 		plog_block->first_rec_found = true;	
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The undo or ibuf log_sys recs the change depends on were lost.
+	The dep_lsn of the recs of a page never decreases until the page
+	is flushed, which forces log_sys up to it, so the skipped recs are
+	the last ones of the page and the page on disk has none of them. */
+	if (dep_lsn > recv_ppl_classic_lsn) {
+		*parse_res = PMEM_PARSE_HYBRID_DEP;
+		return rec_len;
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/* (4) Parse the body as original InnoDB */
 	if (UNIV_UNLIKELY(!new_ptr)) {
 		assert(0);
@@ -5650,6 +6021,14 @@ pm_ppl_recv_init_crash_recovery_spaces(
 			<< " was not found at '" << i->second.name
 			<< "', but there were no modifications either.";
 	}
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	if (recv_ppl_classic_recovered) {
+		/* recv_init_crash_recovery_spaces() of the log_sys
+		recovery processed the doublewrite buffer and started the
+		recv writer thread */
+		return(DB_SUCCESS);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 #if defined (UNIV_PMEMOBJ_BUF)
 	//We don't need the torn page correction process, skip this 
 #else //original
@@ -5996,6 +6375,162 @@ pm_ppl_recv_recover_page_func(
 	pmemobj_rwlock_unlock(pop, &recv_line->lock);	
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+/*
+ * Allocate the shared recovery read scheduler
+ * @param[in] max_reqs	number of requests buffered before a batch is issued
+ * */
+PMEM_RECV_IO_SCHED*
+pm_ppl_recv_io_sched_init(
+		ulint		max_reqs)
+{
+	PMEM_RECV_IO_SCHED* sched;
+
+	sched = (PMEM_RECV_IO_SCHED*) calloc(1, sizeof(PMEM_RECV_IO_SCHED));
+
+	sched->reqs = (PMEM_RECV_IO_REQ*) calloc(
+			max_reqs, sizeof(PMEM_RECV_IO_REQ));
+	sched->n_reqs = 0;
+	sched->max_reqs = max_reqs;
+	sched->n_batches = 0;
+	sched->n_issued = 0;
+
+	return sched;
+}
+
+void
+pm_ppl_recv_io_sched_close(
+		PMEM_RECV_IO_SCHED*	sched)
+{
+	printf("PMEM_RECV: read scheduler issued %zu page reads in %zu batches\n",
+			sched->n_issued, sched->n_batches);
+
+	ut_a(sched->n_reqs == 0);
+
+	free(sched->reqs);
+	free(sched);
+}
+
+static
+bool
+pm_ppl_recv_io_req_less(
+		const PMEM_RECV_IO_REQ&	a,
+		const PMEM_RECV_IO_REQ&	b)
+{
+	if (a.space != b.space) {
+		return(a.space < b.space);
+	}
+	return(a.page_no < b.page_no);
+}
+
+/*
+ * Sort a batch by (space, page_no) and submit it
+ * The caller owns reqs, the scheduler lock is not held
+ * */
+static
+void
+pm_ppl_recv_io_sched_issue(
+		PMEMobjpool*			pop,
+		PMEM_PAGE_PART_LOG*		ppl,
+		PMEM_RECV_IO_REQ*		reqs,
+		ulint					n_reqs)
+{
+	std::sort(reqs, reqs + n_reqs, pm_ppl_recv_io_req_less);
+
+	pm_ppl_buf_read_recv_sorted(pop, ppl, reqs, n_reqs);
+}
+
+/*
+ * Take the pending requests out of the scheduler
+ * Return a ut_malloc'ed copy (the caller frees it) or NULL when empty
+ * The caller holds sched->lock
+ * */
+static
+PMEM_RECV_IO_REQ*
+pm_ppl_recv_io_sched_detach(
+		PMEM_RECV_IO_SCHED*		sched,
+		ulint*					n_reqs)
+{
+	PMEM_RECV_IO_REQ* batch;
+
+	*n_reqs = sched->n_reqs;
+
+	if (sched->n_reqs == 0) {
+		return NULL;
+	}
+
+	batch = static_cast<PMEM_RECV_IO_REQ*>(
+			ut_malloc_nokey(sched->n_reqs * sizeof(PMEM_RECV_IO_REQ)));
+	memcpy(batch, sched->reqs, sched->n_reqs * sizeof(PMEM_RECV_IO_REQ));
+
+	sched->n_batches++;
+	sched->n_issued += sched->n_reqs;
+	sched->n_reqs = 0;
+
+	return batch;
+}
+
+/*
+ * Queue a page read of a recv_line
+ * The page must be marked RECV_BEING_READ by the caller
+ * A full queue is sorted and issued by the calling thread
+ * */
+void
+pm_ppl_recv_io_sched_add(
+		PMEMobjpool*			pop,
+		PMEM_PAGE_PART_LOG*		ppl,
+		PMEM_RECV_LINE*			recv_line,
+		ulint					space,
+		ulint					page_no)
+{
+	PMEM_RECV_IO_SCHED*	sched = ppl->io_sched;
+	PMEM_RECV_IO_REQ*	batch = NULL;
+	ulint				n_reqs = 0;
+
+	pmemobj_rwlock_wrlock(pop, &sched->lock);
+
+	sched->reqs[sched->n_reqs].space = space;
+	sched->reqs[sched->n_reqs].page_no = page_no;
+	sched->reqs[sched->n_reqs].recv_line = recv_line;
+	sched->n_reqs++;
+
+	if (sched->n_reqs == sched->max_reqs) {
+		batch = pm_ppl_recv_io_sched_detach(sched, &n_reqs);
+	}
+
+	pmemobj_rwlock_unlock(pop, &sched->lock);
+
+	if (batch != NULL) {
+		pm_ppl_recv_io_sched_issue(pop, ppl, batch, n_reqs);
+		ut_free(batch);
+	}
+}
+
+/*
+ * Issue the requests left in the scheduler
+ * Called when a line finishes its scan and before waiting for the AIO
+ * threads, otherwise a partial batch would never be read
+ * */
+void
+pm_ppl_recv_io_sched_flush(
+		PMEMobjpool*			pop,
+		PMEM_PAGE_PART_LOG*		ppl)
+{
+	PMEM_RECV_IO_SCHED*	sched = ppl->io_sched;
+	PMEM_RECV_IO_REQ*	batch;
+	ulint				n_reqs;
+
+	pmemobj_rwlock_wrlock(pop, &sched->lock);
+	batch = pm_ppl_recv_io_sched_detach(sched, &n_reqs);
+	pmemobj_rwlock_unlock(pop, &sched->lock);
+
+	if (batch != NULL) {
+		pm_ppl_recv_io_sched_issue(pop, ppl, batch, n_reqs);
+		ut_free(batch);
+	}
+}
+#endif //UNIV_PMEMOBJ_PPL_RECV_SCHED
+
 /*
  * Simulate recv_read_in_area()
  * read pages near the input page
@@ -6043,7 +6578,16 @@ pm_ppl_recv_read_in_area(
 		}
 	}
 
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	/*leave the reads to the shared scheduler, it merges them with the
+	 * reads of the other lines*/
+	for (ulint j = 0; j < n; j++) {
+		pm_ppl_recv_io_sched_add(pop, ppl, recv_line,
+				page_id.space(), page_nos[j]);
+	}
+#else
 	pm_ppl_buf_read_recv_pages(pop, ppl, recv_line, FALSE, page_id.space(), page_nos, n);
+#endif
 
 	return(n);
 }
@@ -6206,6 +6750,9 @@ pm_ppl_recv_apply_hashed_log_recs(
 #endif
 
 		pm_ppl_recv_apply_hashed_line(pop, ppl, NULL, recv_line->is_ibuf_avail);
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+		pm_ppl_recv_io_sched_flush(pop, ppl);
+#endif
 
 		return;
 		//end test use global hashtable
@@ -6242,6 +6789,9 @@ pm_ppl_recv_apply_hashed_log_recs(
 			printf("===>done Applying line %zu n_cell %zu\n", pline->hashed_id, pline->recv_line->n_addrs);
 #endif
 		}
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+		pm_ppl_recv_io_sched_flush(pop, ppl);
+#endif
 		printf("\nPMEM_RECV: ===== wait for all AIO threads finish REDOing...\n");
 		while (ppl->n_redoing_lines > 0){
 			os_event_wait(ppl->redoing_done_event);
@@ -6310,6 +6860,10 @@ pm_ppl_recv_apply_hashed_log_recs(
         os_event_wait(redoer->is_log_all_finished);
     }
 
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+    /*the redoers flush at the end of each line, this catches the rest*/
+    pm_ppl_recv_io_sched_flush(pop, ppl);
+#endif
     //(4) wait for all AIO threads finish REDOing
     printf("\nPMEM_RECV: ===== wait for all AIO threads finish REDOing...\n");
     while (ppl->n_redoing_lines > 0){
@@ -6581,6 +7135,10 @@ pm_ppl_recv_apply_hashed_line(
 
 	}//end outer for 
 	//printf("End apply log recs for pline %zu \n", pline->hashed_id);
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+	/*issue the tail of the queue, a line may be the last one to scan*/
+	pm_ppl_recv_io_sched_flush(pop, ppl);
+#endif
 	/* SMALL OPTIMIZATION
 	 * This REDOER thread has not wait for recv_line->n_addrs == 0 to do post-processing anymore. 
 	 * The last IO thread response for post-processing
@@ -6646,6 +7204,9 @@ recv_recovery_from_checkpoint_start(
 
 	recv_recovery_on = true;
 
+#if defined (UNIV_TRACE_RECOVERY_TIME)
+	ulint t_analysis = ut_time_us(NULL);
+#endif
 	log_mutex_enter();
 
 	/* Look for the latest checkpoint from any of the log groups */
@@ -6735,6 +7296,15 @@ recv_recovery_from_checkpoint_start(
 		return(DB_ERROR);
 	}
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* The log tail that was persistent only in the NVM log buffer
+	goes to the log files first, the scan below then sees it */
+	log_pmem_spill_tail(group);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
+#if defined (UNIV_TRACE_RECOVERY_TIME)
+	recv_sys->analysis_time += ut_time_us(NULL) - t_analysis;
+#endif
 	/** Scan the redo log from checkpoint lsn and redo log to
 	the hash table. */
 	rescan = recv_group_scan_log_recs(group, &contiguous_lsn, false);
@@ -6806,6 +7376,16 @@ recv_recovery_from_checkpoint_start(
 			return(err);
 		}
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+		/* After the doublewrite buffer repaired the torn pages and
+		before the rescan applies any redo log. The page I/O is
+		done without log_sys->mutex. */
+		trx_undo_nvm_recover_snapshot();
+		log_mutex_exit();
+		trx_undo_nvm_recover();
+		log_mutex_enter();
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 		if (rescan) {
 			//tdnguyen test
 			printf("====> NEED RESCAN, contigous_lsn %zu\n", contiguous_lsn);
@@ -6821,6 +7401,12 @@ recv_recovery_from_checkpoint_start(
 		}
 	} else {
 		ut_ad(!rescan || recv_sys->n_addrs == 0);
+#if defined (UNIV_PMEMOBJ_UNDO)
+		trx_undo_nvm_recover_snapshot();
+		log_mutex_exit();
+		trx_undo_nvm_recover();
+		log_mutex_enter();
+#endif /* UNIV_PMEMOBJ_UNDO */
 	}
 
 	/* We currently have only one log group */
@@ -6878,7 +7464,11 @@ recv_recovery_from_checkpoint_start(
 
 	log_sys->next_checkpoint_no = checkpoint_no + 1;
 
-#if defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* The log files are complete up to the start of the last block,
+	which log_sys->buf holds together with the MLOG_CHECKPOINT above */
+	log_pmem_buf_attach(log_sys->lsn - log_sys->buf_free);
+#elif defined(UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL)
 	if (	gb_pmw->plogbuf->buf_free > log_sys->buf_free &&
 			gb_pmw->plogbuf->lsn > log_sys->lsn ) {
 		uint64_t len = gb_pmw->plogbuf->buf_free - log_sys->buf_free;
@@ -7076,6 +7666,12 @@ recv_reset_logs(
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	/* The old NVM log tail belongs to the old log files; the first
+	spill in log_make_checkpoint_at() below validates the new one */
+	log_pmem_buf_attach(LSN_MAX);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
 
@@ -574,7 +574,7 @@ mlog_parse_index(
 
 	if (comp) {
 		if (end_ptr < ptr + 4) {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 			assert(0);
 #endif
 			return(NULL);
@@ -585,7 +585,7 @@ mlog_parse_index(
 		ptr += 2;
 		ut_ad(n_uniq <= n);
 		if (end_ptr < ptr + n * 2) {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 			assert(0);
 #endif
 			return(NULL);
@@ -48,6 +48,10 @@ extern volatile int64 gb_n_write_log;
 #include "my_pmemobj.h"
 extern PMEM_WRAPPER* gb_pmw; 
 #endif /* UNIV_PMEMOBJ_PART_PL */
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+#include "trx0undo.h"
+#endif /* UNIV_PMEMOBJ_UNDO */
 /** Iterate over a memo block in reverse. */
 template <typename Functor>
 struct Iterate {
@@ -341,8 +345,25 @@ struct ReleaseBlocks {
 		m_start_lsn(start_lsn),
 		m_flush_observer(observer)
 	{
-		/* Do nothing */
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		m_classic_start_lsn = m_classic_end_lsn = 0;
+		m_hybrid_dep_lsn = 0;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+	}
+
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/** Set the log_sys lsn range used for the system and undo pages,
+	the other pages get the PPL range of the constructor.
+	@param[in]	start_lsn	log_sys start lsn, 0 if none
+	@param[in]	end_lsn		log_sys end lsn, 0 if none
+	@param[in]	dep_lsn		log_sys lsn the PPL recs depend on */
+	void set_classic_lsn(lsn_t start_lsn, lsn_t end_lsn, lsn_t dep_lsn)
+	{
+		m_classic_start_lsn = start_lsn;
+		m_classic_end_lsn = end_lsn;
+		m_hybrid_dep_lsn = dep_lsn;
 	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	/** Add the modified page to the buffer flush list. */
 	void add_dirty_page_to_flush_list(mtr_memo_slot_t* slot) const
@@ -354,6 +375,31 @@ struct ReleaseBlocks {
 
 		block = reinterpret_cast<buf_block_t*>(slot->object);
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		if (mtr_t::is_classic_space(block->page.id.space())) {
+			lsn_t	start_lsn = m_classic_start_lsn;
+			lsn_t	end_lsn = m_classic_end_lsn;
+
+			if (end_lsn == 0) {
+				/* Latched but not logged by this mtr,
+				keep the page in the log_sys domain */
+				os_rmb;
+				start_lsn = end_lsn = log_sys->lsn;
+			}
+
+			buf_flush_note_modification(block, start_lsn,
+						    end_lsn, m_flush_observer);
+			return;
+		}
+
+		/* The page must not reach the disk before log_sys is flushed
+		up to the lsn its PPL recs depend on, see
+		buf_flush_write_block_low(). Covered by the page latch. */
+		if (m_hybrid_dep_lsn > block->page.hybrid_dep_lsn) {
+			block->page.hybrid_dep_lsn = m_hybrid_dep_lsn;
+		}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 //#if defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
 #if defined (UNIV_SKIPLOG)
 		//simulate buf_flush_note_modification()
@@ -439,10 +485,111 @@ struct ReleaseBlocks {
 	/** Mini-transaction REDO end LSN */
 	lsn_t		m_start_lsn;
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/** log_sys start LSN of the system and undo pages */
+	lsn_t		m_classic_start_lsn;
+
+	/** log_sys end LSN of the system and undo pages */
+	lsn_t		m_classic_end_lsn;
+
+	/** log_sys LSN the PPL recs of the other pages depend on */
+	lsn_t		m_hybrid_dep_lsn;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/** Flush observer */
 	FlushObserver*	m_flush_observer;
 };
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Find the largest log_sys lsn the pages modified by the
+mini-transaction depend on. */
+struct FindHybridDep {
+	/** Constructor
+	@param[in]	lsn	log_sys lsn the mini-transaction depends on */
+	explicit FindHybridDep(lsn_t lsn)
+		:
+		m_lsn(lsn)
+	{
+		/* Do nothing */
+	}
+
+	/** @return true always. */
+	bool operator()(mtr_memo_slot_t* slot)
+	{
+		if (slot->object != NULL
+		    && (slot->type == MTR_MEMO_PAGE_X_FIX
+			|| slot->type == MTR_MEMO_PAGE_SX_FIX)) {
+
+			const buf_block_t*	block;
+
+			block = reinterpret_cast<const buf_block_t*>(
+				slot->object);
+
+			/* 0 for the system and undo pages */
+			if (block->page.hybrid_dep_lsn > m_lsn) {
+				m_lsn = block->page.hybrid_dep_lsn;
+			}
+		}
+
+		return(true);
+	}
+
+	/** log_sys lsn the PPL recs of the mini-transaction depend on */
+	lsn_t		m_lsn;
+};
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+/** Persist the undo page modified without redo log on its NVM slot. */
+struct WriteUndoNvm {
+	/** Constructor
+	@param[in]	slot	reserved NVM undo slot
+	@param[in]	end_lsn	end lsn of the mini-transaction */
+	WriteUndoNvm(ulint slot, lsn_t end_lsn)
+		:
+		m_slot(slot),
+		m_end_lsn(end_lsn),
+		m_block(NULL)
+	{
+		/* Do nothing */
+	}
+
+	/** @return true always. */
+	bool operator()(mtr_memo_slot_t* slot)
+	{
+		if (slot->object != NULL
+		    && (slot->type == MTR_MEMO_PAGE_X_FIX
+			|| slot->type == MTR_MEMO_PAGE_SX_FIX)) {
+
+			buf_block_t*	block;
+
+			block = reinterpret_cast<buf_block_t*>(slot->object);
+
+			if (block != m_block) {
+				/* The mini-transaction latches the
+				undo page only, see
+				trx_undo_report_row_operation(). */
+				ut_a(m_block == NULL);
+
+				trx_undo_nvm_write(m_slot, block, m_end_lsn);
+				m_block = block;
+			}
+		}
+
+		return(true);
+	}
+
+	/** NVM undo slot */
+	ulint			m_slot;
+
+	/** Mini-transaction end LSN */
+	lsn_t			m_end_lsn;
+
+	/** The page written on the slot */
+	const buf_block_t*	m_block;
+};
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 class mtr_t::Command {
 public:
 	/** Constructor.
@@ -459,6 +606,10 @@ public:
 	{
 		m_impl = &mtr->m_impl;
 		m_sync = mtr->m_sync;
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		m_classic_start_lsn = m_classic_end_lsn = 0;
+		m_hybrid_dep_lsn = 0;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	}
 
 	/** Destructor */
@@ -474,6 +625,12 @@ public:
 	/** Release the blocks used in this mini-transaction. */
 	void release_blocks();
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+	/** Persist the undo page modified without redo log on the NVM slot
+	of the mini-transaction. */
+	void write_undo_nvm();
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 	/** Release the latches acquired by the mini-transaction. */
 	void release_latches();
 
@@ -492,6 +649,30 @@ private:
 	@return number of bytes to write in finish_write() */
 	ulint prepare_write();
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/** Copy the log records of the system and undo tablespaces from the
+	PPL buffer of the mtr to m_log, in the log_sys format.
+	@return number of bytes to write in finish_write(), 0 if none */
+	ulint prepare_classic_write();
+
+	/** Add the log records of the user tablespaces to PPL, tagged
+	with m_hybrid_dep_lsn, and set the PPL lsn range of the mtr. */
+	void write_ppl_recs();
+
+	/** log_sys start lsn of the classic log records, 0 if none */
+	lsn_t			m_classic_start_lsn;
+
+	/** log_sys end lsn of the classic log records, 0 if none */
+	lsn_t			m_classic_end_lsn;
+
+	/** log_sys lsn the PPL log records depend on: the end lsn of the
+	classic log records of this mtr, of the undo log records of the
+	changes, see btr_cur_ins_lock_and_undo(), and of the earlier mtrs
+	on the same pages. 0 if none. PPL recovery skips the PPL log
+	records whose dependency was not recovered by log_sys. */
+	lsn_t			m_hybrid_dep_lsn;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	/** true if it is a sync mini-transaction. */
 	bool			m_sync;
 
@@ -534,6 +715,24 @@ struct mtr_write_log_t {
 	}
 };
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+/** Copy the block contents into a reserved range of the REDO log buffer */
+struct mtr_copy_log_t {
+	explicit mtr_copy_log_t(log_copy_t* copy) : m_copy(copy) {}
+
+	/** Copy a block into the reserved range.
+	@return whether the copy should continue */
+	bool operator()(const mtr_buf_t::block_t* block) const
+	{
+		log_copy_low(m_copy, block->begin(), block->used());
+		return(true);
+	}
+
+	/** The reserved range */
+	log_copy_t*	m_copy;
+};
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
 /** Append records to the system-wide redo log buffer.
 @param[in]	log	redo log records */
 void
@@ -594,6 +793,9 @@ mtr_t::start(bool sync, bool read_only)
 	m_impl.m_undo_space = NULL;
 	m_impl.m_sys_space = NULL;
 	m_impl.m_flush_observer = NULL;
+#if defined (UNIV_PMEMOBJ_UNDO)
+	m_impl.m_undo_nvm_slot = ULINT_UNDEFINED;
+#endif /* UNIV_PMEMOBJ_UNDO */
 #if defined (UNIV_PMEMOBJ_PL)
 
 #if defined(UNIV_PMEMOBJ_USE_TT)
@@ -604,6 +806,10 @@ mtr_t::start(bool sync, bool read_only)
 	m_impl.LSN_arr = (uint64_t*) calloc(512, sizeof(uint64_t));
 	m_impl.off_arr = (uint16_t*) calloc(512, sizeof(uint16_t));
 	m_impl.len_off_arr = (uint16_t*) calloc(512, sizeof(uint16_t));
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	m_impl.classic_arr = (bool*) calloc(512, sizeof(bool));
+	m_impl.m_hybrid_dep_lsn = 0;
+#endif
 #if defined (UNIV_PMEMOBJ_VALID_MTR)	
 	m_impl.space_arr = (uint64_t*) calloc(512, sizeof(uint64_t));
 	m_impl.page_arr = (uint64_t*) calloc(512, sizeof(uint64_t));
@@ -657,6 +863,9 @@ mtr_t::Command::release_resources()
 	free(m_impl->LSN_arr);
 	free(m_impl->off_arr);
 	free(m_impl->len_off_arr);
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	free(m_impl->classic_arr);
+#endif
 	free(m_impl->buf);
 #if defined (UNIV_PMEMOBJ_VALID_MTR)	
 	free(m_impl->space_arr);
@@ -694,6 +903,11 @@ mtr_t::commit()
 
 		cmd.execute();
 	} else {
+#if defined (UNIV_PMEMOBJ_UNDO)
+		if (m_impl.m_undo_nvm_slot != ULINT_UNDEFINED) {
+			trx_undo_nvm_release(m_impl.m_undo_nvm_slot);
+		}
+#endif /* UNIV_PMEMOBJ_UNDO */
 		cmd.release_all();
 		cmd.release_resources();
 	}
@@ -1078,11 +1292,32 @@ void
 mtr_t::Command::release_blocks()
 {
 	ReleaseBlocks release(m_start_lsn, m_end_lsn, m_impl->m_flush_observer);
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	release.set_classic_lsn(m_classic_start_lsn, m_classic_end_lsn,
+				m_hybrid_dep_lsn);
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	Iterate<ReleaseBlocks> iterator(release);
 
 	m_impl->m_memo.for_each_block_in_reverse(iterator);
 }
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+/** Persist the undo page of this mini-transaction on its NVM slot,
+the page must still be latched */
+void
+mtr_t::Command::write_undo_nvm()
+{
+	WriteUndoNvm		write(m_impl->m_undo_nvm_slot, m_end_lsn);
+	Iterate<WriteUndoNvm>	iterator(write);
+
+	m_impl->m_memo.for_each_block_in_reverse(iterator);
+
+	if (write.m_block == NULL) {
+		trx_undo_nvm_release(m_impl->m_undo_nvm_slot);
+	}
+}
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 /** Write the redo log record, add dirty pages to the flush list and release
 the resources. */
 #if defined (UNIV_PMEMOBJ_PL) || defined (UNIV_SKIPLOG)
@@ -1159,6 +1394,10 @@ mtr_t::pmem_check_mtrlog(mtr_t* mtr)
 		temp_ptr += 2;
 		//skip the rec_lsn
 		temp_ptr += 8;
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		//skip the dep_lsn
+		temp_ptr += 8;
+#endif
 		
 		if ( (temp_ptr - ptr) == parsed_len){
 			/*empty body rec*/
@@ -1214,9 +1453,120 @@ uint64_t mtr_t::add_rec_to_ppl(
 	   	byte*		log_src,
 	   	uint32_t	rec_size)
 {
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	if (srv_ppl_log_mode == PMEM_LOG_MODE_TX) {
+		return pm_ptxl_write_rec(gb_pmw->pop, gb_pmw->ptxl,
+				m_impl.m_parent_trx, key, log_src, rec_size);
+	}
+#endif /* UNIV_PMEMOBJ_TX_LOG */
 	return pm_ppl_write_rec(gb_pmw->pop, gb_pmw, gb_pmw->ppl, key, log_src, rec_size);
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+/** Check if the redo log of a tablespace is written to log_sys
+in the hybrid mode, other tablespaces are logged in PPL
+@param[in]	space	tablespace id
+@return true for the system, undo and temporary tablespaces */
+bool
+mtr_t::is_classic_space(ulint space)
+{
+	return(is_predefined_tablespace(space));
+}
+
+/** Copy the log records of the system and undo tablespaces from the
+PPL buffer of the mtr to m_log, in the log_sys format.
+@return number of bytes to write in finish_write(), 0 if none */
+ulint
+mtr_t::Command::prepare_classic_write()
+{
+	mtr_t*		mtr = m_impl->m_mtr;
+	byte*		begin_ptr = mtr->get_buf();
+	ulint		n_recs = m_impl->m_n_log_recs;
+	ulint		n_classic = 0;
+	ulint		len;
+
+	ut_ad(m_impl->m_log.size() == 0);
+
+	for (ulint i = 0; i < n_recs; i++) {
+		if (!mtr->is_classic_at(i)) {
+			continue;
+		}
+
+		ulint	off = mtr->get_off_at(i);
+		ulint	len_off = mtr->get_len_off_at(i);
+		ulint	end = (i + 1 < n_recs)
+			? mtr->get_off_at(i + 1) : mtr->get_cur_off();
+
+		/* type, space and page_no */
+		m_impl->m_log.push(begin_ptr + off, len_off - off);
+		/* skip the rec_len, rec_lsn and dep_lsn of PPL */
+		m_impl->m_log.push(begin_ptr + len_off + MLOG_PPL_META_SIZE,
+				   end - len_off - MLOG_PPL_META_SIZE);
+		n_classic++;
+	}
+
+	if (n_classic == 0) {
+		return(0);
+	}
+
+	if (n_classic == 1) {
+		/* Flag the single log record as the
+		only record in this mini-transaction. */
+		*m_impl->m_log.front()->begin() |= MLOG_SINGLE_REC_FLAG;
+	} else {
+		*m_impl->m_log.push<byte*>(1) = MLOG_MULTI_REC_END;
+	}
+
+	len = m_impl->m_log.size();
+
+	if (len > log_sys->buf_size / 2) {
+		log_buffer_extend((len + 1) * 2);
+	}
+
+	return(len);
+}
+
+/** Add the log records of the user tablespaces to PPL, tagged with
+m_hybrid_dep_lsn, and set the PPL lsn range of the mtr. */
+void
+mtr_t::Command::write_ppl_recs()
+{
+	mtr_t*		mtr = m_impl->m_mtr;
+	byte*		begin_ptr = mtr->get_buf();
+	ulint		n_recs = m_impl->m_n_log_recs;
+
+	m_start_lsn = m_end_lsn = 0;
+
+	for (ulint i = 0; i < n_recs; i++) {
+		if (mtr->is_classic_at(i)) {
+			continue;
+		}
+
+		ulint	off = mtr->get_off_at(i);
+		ulint	len_off = mtr->get_len_off_at(i);
+		ulint	end = (i + 1 < n_recs)
+			? mtr->get_off_at(i + 1) : mtr->get_cur_off();
+		lsn_t	rec_lsn;
+
+		/* dep_lsn, after the 2-byte rec_len and 8-byte rec_lsn */
+		mach_write_to_8(begin_ptr + len_off + 2 + 8, m_hybrid_dep_lsn);
+
+		rec_lsn = mtr->add_rec_to_ppl(
+			mtr->get_key_at(i), begin_ptr + off, end - off);
+		mtr->add_LSN_at(rec_lsn, i);
+
+		if (m_start_lsn == 0) {
+			m_start_lsn = rec_lsn;
+		}
+		m_end_lsn = rec_lsn;
+	}
+
+	if (m_end_lsn == 0) {
+		m_end_lsn = m_start_lsn = ut_time_us(NULL);
+	}
+}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 void
 mtr_t::Command::execute()
 {
@@ -1327,6 +1677,10 @@ mtr_t::Command::execute()
 
 	prev_key = mtr->get_key_at(n_recs - 1);	
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* the recs are written in (3b) */
+	mtr->add_LSN_at(0, n_recs - 1);
+#else
 	m_end_lsn = mtr->add_rec_to_ppl(prev_key, begin_ptr + prev_off, rec_size);
 	mtr->add_LSN_at(m_end_lsn, n_recs - 1);
 	
@@ -1337,17 +1691,83 @@ mtr_t::Command::execute()
 			space->max_lsn = m_end_lsn;
 		}
 	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 	// end new DAL
 #if defined (UNIV_PMEMOBJ_VALID_MTR)	
 	//(3) Check, remove this section in run mode
 	mtr->pmem_check_mtrlog(mtr);
 #endif		
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	//(3b) the system and undo recs go to log_sys as in the original
+	//commit, the user recs go to PPL tagged with the log_sys lsn they
+	//depend on
+	{
+		FindHybridDep		find(m_impl->m_hybrid_dep_lsn);
+		Iterate<FindHybridDep>	iterator(find);
+
+		m_impl->m_memo.for_each_block_in_reverse(iterator);
+
+		m_hybrid_dep_lsn = find.m_lsn;
+	}
+
+	len = prepare_classic_write();
+
+	if (len > 0) {
+		log_mutex_enter();
+
+		/* check and attempt a checkpoint if exceeding capacity */
+		log_margin_checkpoint_age(len);
+
+		finish_write(len);
+
+		m_classic_start_lsn = m_start_lsn;
+		m_classic_end_lsn = m_end_lsn;
+
+		log_hybrid_sample(m_classic_end_lsn);
+
+		/* A mixed mtr, e.g. an ibuf merge, is atomic: its PPL recs
+		are not recovered unless log_sys is recovered up to its
+		classic end lsn, and they are persistent before log_sys
+		can write its classic recs, which needs log_sys->mutex. */
+		if (m_classic_end_lsn > m_hybrid_dep_lsn) {
+			m_hybrid_dep_lsn = m_classic_end_lsn;
+		}
+
+		write_ppl_recs();
+	} else {
+		write_ppl_recs();
+	}
+
+	if (was_clean) {
+		space->max_lsn = m_end_lsn;
+	}
+
+	/* keep the log_sys pages in lsn order in the flush list */
+	if (m_impl->m_made_dirty) {
+		log_flush_order_mutex_enter();
+	}
+
+	if (len > 0) {
+		log_mutex_exit();
+	}
+
+	goto skip_flush_order;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 skip_prepare:
 	//(4) add the block to the flush list 
 	if (m_impl->m_made_dirty) {
 		log_flush_order_mutex_enter();
 	}
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+skip_flush_order:
+	/* the commit is durable once log_sys reaches the classic end lsn,
+	the PPL recs are already persistent. The commit lsn is always a
+	log_sys lsn, 0 if the mtr wrote nothing to log_sys, so that the
+	callers of log_write_up_to() never pass a PPL time. */
+	m_impl->m_mtr->m_commit_lsn = m_classic_end_lsn;
+#else
 	m_impl->m_mtr->m_commit_lsn = m_end_lsn;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	//update pageLSN in release_blocks()
 	release_blocks();
@@ -1654,9 +2074,22 @@ mtr_t::Command::execute()
 #endif
 	ut_ad(m_impl->m_log_mode != MTR_LOG_NONE);
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	log_copy_t	copy;
+
+	copy.start_ptr = NULL;
+
+	if (const ulint len = prepare_write()) {
+		/* Only the lsn range is claimed under the log mutex, the
+		records are copied after the dirty pages are added */
+		m_start_lsn = log_reserve_concurrent(len, &copy);
+		m_end_lsn = copy.end_lsn;
+	}
+#else
 	if (const ulint len = prepare_write()) {
 		finish_write(len);
 	}
+#endif /* UNIV_LOG_CONCURRENT_COPY */
 
 	if (m_impl->m_made_dirty) {
 		log_flush_order_mutex_enter();
@@ -1675,6 +2108,24 @@ mtr_t::Command::execute()
 		log_flush_order_mutex_exit();
 	}
 
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	/* The pages are still latched: they are flushed, and the log is
+	written, only after log_copy_close() */
+	if (copy.start_ptr != NULL) {
+		mtr_copy_log_t	copy_log(&copy);
+
+		m_impl->m_log.for_each_block(copy_log);
+
+		log_copy_close(&copy);
+	}
+#endif /* UNIV_LOG_CONCURRENT_COPY */
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+	if (m_impl->m_undo_nvm_slot != ULINT_UNDEFINED) {
+		write_undo_nvm();
+	}
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 	release_latches();
 
 	release_resources();
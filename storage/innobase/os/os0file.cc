@@ -75,6 +75,17 @@ static int64_t n_writes = 10;
 #include <libaio.h>
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined (UNIV_IO_URING)
+#ifndef LINUX_NATIVE_AIO
+#error "UNIV_IO_URING replaces the kernel interface of the Linux native AIO path"
+#endif /* !LINUX_NATIVE_AIO */
+#if defined (UNIV_PMEMOBJ_BUF)
+#error "UNIV_IO_URING cannot be combined with UNIV_PMEMOBJ_BUF, which replaces the AIO path of the data pages"
+#endif /* UNIV_PMEMOBJ_BUF */
+#include <liburing.h>
+#include <algorithm>
+#endif /* UNIV_IO_URING */
+
 #ifdef HAVE_FALLOC_PUNCH_HOLE_AND_KEEP_SIZE
 # include <fcntl.h>
 # include <linux/falloc.h>
@@ -223,6 +234,9 @@ the completed IO request and calls completion routine on it.
 mysql_pfs_key_t  innodb_data_file_key;
 mysql_pfs_key_t  innodb_log_file_key;
 mysql_pfs_key_t  innodb_temp_file_key;
+#if defined (UNIV_PMEMOBJ_PART_PL)
+mysql_pfs_key_t  pm_ppl_persist_file_key;
+#endif
 #endif /* UNIV_PFS_IO */
 
 /** The asynchronous I/O context */
@@ -487,6 +501,64 @@ dberr_t pm_process_batch(
 		MY_ATTRIBUTE((warn_unused_result));
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined (UNIV_IO_URING)
+	/** Queue an AIO request on the io_uring of its segment, the caller
+	owns the mutex.
+	@param[in,out]	slot	an already reserved slot */
+	void uring_queue(Slot* slot);
+
+	/** Submit the requests queued on the io_uring of a segment, the
+	caller owns the mutex.
+	@param[in]	segment	local segment */
+	void uring_submit(ulint segment);
+
+	/** Queue an AIO request on the io_uring of its segment.
+	@param[in,out]	slot	an already reserved slot
+	@param[in]	submit	true to submit it now, false to leave it
+				for the next os_aio_simulated_wake_handler_threads()
+	@return true on success. */
+	bool uring_dispatch(Slot* slot, bool submit);
+
+	/** Submit the requests queued on the io_urings of every array, the
+	end of a read-ahead or flush batch */
+	static void uring_submit_all();
+
+	/** Accessor for the io_uring of a segment
+	@param[in]	segment	local segment
+	@return the io_uring of the segment */
+	struct io_uring* uring(ulint segment)
+		MY_ATTRIBUTE((warn_unused_result))
+	{
+		ut_ad(segment < m_n_rings);
+
+		return(&m_rings[segment]);
+	}
+
+	/** @return true if the completions of this array are polled */
+	bool is_uring_poll() const
+	{
+		return(m_uring_poll);
+	}
+
+	/** Register memory ranges as the fixed buffers of every io_uring.
+	@param[in]	bufs	start of each range
+	@param[in]	lens	length of each range
+	@param[in]	n	number of ranges */
+	static void uring_register_buffers(
+		byte**		bufs,
+		const ulint*	lens,
+		ulint		n);
+
+	/** Stop using the fixed buffers and unregister them */
+	static void uring_unregister_buffers();
+
+	/** Checks if the kernel and liburing support the io_uring backend:
+	the completion wait must not use the submission queue.
+	@return true if supported, false otherwise. */
+	static bool is_io_uring_supported()
+		MY_ATTRIBUTE((warn_unused_result));
+#endif /* UNIV_IO_URING */
+
 #ifdef WIN_ASYNC_IO
 	/** Wakes up all async i/o threads in the array in Windows async I/O at
 	shutdown. */
@@ -680,6 +752,21 @@ private:
 		MY_ATTRIBUTE((warn_unused_result));
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined (UNIV_IO_URING)
+	/** Initialise one io_uring per segment
+	@return DB_SUCCESS or error code */
+	dberr_t init_io_uring()
+		MY_ATTRIBUTE((warn_unused_result));
+
+	/** Register the fixed buffers on the io_urings of this array
+	@param[in]	iovs	the ranges
+	@param[in]	n	number of ranges */
+	void uring_register(const struct iovec* iovs, ulint n);
+
+	/** Stop using the fixed buffers of this array */
+	void uring_unregister();
+#endif /* UNIV_IO_URING */
+
 private:
 	typedef std::vector<Slot> Slots;
 
@@ -728,6 +815,23 @@ private:
 	IOEvents		m_events;
 #endif /* LINUX_NATIV_AIO */
 
+#if defined (UNIV_IO_URING)
+	/** One io_uring per segment. The submission queue is protected
+	by m_mutex, the completion queue is read by the i/o handler
+	thread of the segment only. */
+	struct io_uring*	m_rings;
+
+	/** Number of initialized io_urings */
+	ulint			m_n_rings;
+
+	/** true if the completions are polled (IORING_SETUP_IOPOLL) */
+	bool			m_uring_poll;
+
+	/** true if the reads and writes may use the fixed buffers,
+	changed under m_mutex */
+	bool			m_uring_fixed;
+#endif /* UNIV_IO_URING */
+
 	/** The aio arrays for non-ibuf i/o and ibuf i/o, as well as
 	sync AIO. These are NULL when the module has not yet been
 	initialized. */
@@ -793,6 +897,54 @@ static const ulint	OS_AIO_IO_SETUP_RETRY_SLEEP = 500000UL;
 static const int	OS_AIO_IO_SETUP_RETRY_ATTEMPTS = 5;
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined (UNIV_IO_URING)
+/** Maximum number of fsyncs submitted at once by os_file_flush_batch() */
+static const ulint	OS_FILE_FLUSH_BATCH = 64;
+
+/** The fixed buffers registered on the io_urings, sorted by address.
+The position of a range is its buffer index in the io_urings. */
+static std::vector<struct iovec>	os_uring_bufs;
+
+/** Find the fixed buffer containing a memory range
+@param[in]	ptr	start of the range
+@param[in]	len	length of the range
+@return buffer index, -1 if the range is not in a fixed buffer */
+static
+int
+os_uring_buf_index(
+	const byte*	ptr,
+	ulint		len)
+{
+	ulint	low = 0;
+	ulint	high = os_uring_bufs.size();
+
+	/* The first buffer starting after ptr */
+	while (low < high) {
+		ulint	mid = (low + high) / 2;
+
+		if (static_cast<const byte*>(os_uring_bufs[mid].iov_base)
+		    <= ptr) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low == 0) {
+		return(-1);
+	}
+
+	const struct iovec&	iov = os_uring_bufs[low - 1];
+
+	if (ptr + len
+	    > static_cast<const byte*>(iov.iov_base) + iov.iov_len) {
+		return(-1);
+	}
+
+	return(static_cast<int>(low - 1));
+}
+#endif /* UNIV_IO_URING */
+
 /** Array of events used in simulated AIO */
 static os_event_t*	os_aio_segment_wait_events = NULL;
 
@@ -2384,6 +2536,12 @@ private:
 	The IO-thread also exits in this function. It checks server status at
 	each wakeup and that is why we use timed wait in io_getevents(). */
 	void collect();
+
+#if defined (UNIV_IO_URING)
+	/** collect() on the io_uring of the segment, waits on the
+	completion queue with a timeout instead of io_getevents() */
+	void collect_uring();
+#endif /* UNIV_IO_URING */
 #if defined (UNIV_PMEMOBJ_BUF)
 	bool is_write_thread();
 #endif
@@ -2438,6 +2596,15 @@ LinuxAIOHandler::resubmit(Slot* slot)
 	slot->n_bytes = 0;
 	slot->io_already_done = false;
 
+#if defined (UNIV_IO_URING)
+	if (srv_use_io_uring) {
+		m_array->uring_queue(slot);
+		m_array->uring_submit(m_segment);
+
+		return(DB_SUCCESS);
+	}
+#endif /* UNIV_IO_URING */
+
 	struct iocb*	iocb = &slot->control;
 	if (slot->type.is_read()) {
 		io_prep_pread(
@@ -2572,6 +2739,14 @@ LinuxAIOHandler::collect()
 	ut_ad(m_n_slots > 0);
 	ut_ad(m_array != NULL);
 	ut_ad(m_segment < m_array->get_n_segments());
+
+#if defined (UNIV_IO_URING)
+	if (srv_use_io_uring) {
+		collect_uring();
+		return;
+	}
+#endif /* UNIV_IO_URING */
+
 	/* Which io_context we are going to use. */
 	io_context*	io_ctx = m_array->io_ctx(m_segment);
 
@@ -2828,6 +3003,12 @@ AIO::linux_dispatch(Slot* slot)
 	ut_a(slot->is_reserved);
 	ut_ad(slot->type.validate());
 
+#if defined (UNIV_IO_URING)
+	if (srv_use_io_uring) {
+		return(uring_dispatch(slot, slot->type.is_wake()));
+	}
+#endif /* UNIV_IO_URING */
+
 	/* Find out what we are going to work with.
 	The iocb struct is directly in the slot.
 	The io_context is one per segment. */
@@ -2849,6 +3030,497 @@ AIO::linux_dispatch(Slot* slot)
 	return(ret == 1);
 }
 
+#if defined (UNIV_IO_URING)
+/** collect() on the io_uring of the segment. The io-thread waits on the
+completion queue with a timeout, io_uring_wait_cqe_timeout() does not
+touch the submission queue when the kernel has IORING_FEAT_EXT_ARG, the
+dispatchers keep filling it under the array mutex meanwhile. */
+void
+LinuxAIOHandler::collect_uring()
+{
+	struct io_uring*	ring = m_array->uring(m_segment);
+
+	/* Starting point of the m_segment we will be working on. */
+	ulint	start_pos = m_segment * m_n_slots;
+
+	/* End point. */
+	ulint	end_pos = start_pos + m_n_slots;
+
+	for (;;) {
+		/* Requests queued with DO_NOT_WAKE are submitted at the end
+		of their batch, do it here if the batch is late. */
+		m_array->acquire();
+
+		if (io_uring_sq_ready(ring) > 0) {
+			m_array->uring_submit(m_segment);
+		}
+
+		m_array->release();
+
+		struct __kernel_timespec	timeout;
+
+		timeout.tv_sec = 0;
+		timeout.tv_nsec = OS_AIO_REAP_TIMEOUT;
+
+		struct io_uring_cqe*	cqe;
+		unsigned		head;
+		unsigned		n_done = 0;
+
+		int	ret = io_uring_wait_cqe_timeout(ring, &cqe, &timeout);
+
+		if (ret == 0) {
+			io_uring_for_each_cqe(ring, head, cqe) {
+
+				Slot*	slot = reinterpret_cast<Slot*>(
+					io_uring_cqe_get_data(cqe));
+
+				/* Some sanity checks. */
+				ut_a(slot != NULL);
+				ut_a(slot->is_reserved);
+
+				/* We are not scribbling previous segment. */
+				ut_a(slot->pos >= start_pos);
+
+				/* We have not overstepped to next segment. */
+				ut_a(slot->pos < end_pos);
+
+				ssize_t	res = cqe->res;
+
+				if (res == -EOPNOTSUPP
+				    && m_array->is_uring_poll()) {
+					/* A file without O_DIRECT cannot be
+					polled, do the IO synchronously. */
+					res = slot->type.is_read()
+						? pread(slot->file.m_file,
+							slot->ptr, slot->len,
+							slot->offset)
+						: pwrite(slot->file.m_file,
+							 slot->ptr, slot->len,
+							 slot->offset);
+
+					if (res < 0) {
+						res = -errno;
+					}
+				}
+
+				/* We never compress/decompress the first
+				page */
+
+				if (slot->offset > 0
+				    && !slot->skip_punch_hole
+				    && slot->type.is_compression_enabled()
+				    && !slot->type.is_log()
+				    && slot->type.is_write()
+				    && slot->type.is_compressed()
+				    && slot->type.punch_hole()) {
+
+					slot->err = AIOHandler::io_complete(
+						slot);
+				} else {
+					slot->err = DB_SUCCESS;
+				}
+
+				/* Mark this request as completed. The error
+				handling will be done in the calling
+				function. */
+				m_array->acquire();
+
+				if (res < 0) {
+					slot->ret = static_cast<int>(res);
+					slot->n_bytes = 0;
+				} else {
+					slot->ret = 0;
+					slot->n_bytes = res;
+				}
+
+				slot->io_already_done = true;
+
+				m_array->release();
+
+				++n_done;
+			}
+
+			io_uring_cq_advance(ring, n_done);
+		}
+
+		if (srv_shutdown_state == SRV_SHUTDOWN_EXIT_THREADS
+		    || !buf_page_cleaner_is_active
+		    || n_done > 0) {
+
+			break;
+		}
+
+		switch (ret) {
+		case -ETIME:
+			/* No completed request! Go back and check again. */
+
+		case -EAGAIN:
+		case -EINTR:
+		case 0:
+			continue;
+		}
+
+		/* All other errors should cause a trap for now. */
+		ib::fatal()
+			<< "Unexpected ret_code[" << ret
+			<< "] from io_uring_wait_cqe_timeout()!";
+
+		break;
+	}
+}
+
+/** Queue an AIO request on the io_uring of its segment, the caller
+owns the mutex.
+@param[in,out]	slot	an already reserved slot */
+void
+AIO::uring_queue(Slot* slot)
+{
+	ut_ad(is_mutex_owned());
+
+	ulint			segment;
+	struct io_uring_sqe*	sqe;
+
+	segment = (slot->pos * m_n_segments) / m_slots.size();
+
+	/* The queue has room for all the slots of the segment, it is
+	never full unless an earlier submit was cut short. */
+	while ((sqe = io_uring_get_sqe(uring(segment))) == NULL) {
+		uring_submit(segment);
+	}
+
+	int	index = -1;
+
+	if (m_uring_fixed) {
+		index = os_uring_buf_index(slot->ptr, slot->len);
+	}
+
+	unsigned	len = static_cast<unsigned>(slot->len);
+	__u64		offset = static_cast<__u64>(slot->offset);
+
+	if (slot->type.is_read()) {
+
+		if (index >= 0) {
+			io_uring_prep_read_fixed(
+				sqe, slot->file.m_file, slot->ptr, len,
+				offset, index);
+		} else {
+			io_uring_prep_read(
+				sqe, slot->file.m_file, slot->ptr, len,
+				offset);
+		}
+	} else {
+
+		ut_a(slot->type.is_write());
+
+		if (index >= 0) {
+			io_uring_prep_write_fixed(
+				sqe, slot->file.m_file, slot->ptr, len,
+				offset, index);
+		} else {
+			io_uring_prep_write(
+				sqe, slot->file.m_file, slot->ptr, len,
+				offset);
+		}
+	}
+
+	io_uring_sqe_set_data(sqe, slot);
+
+	slot->n_bytes = 0;
+	slot->ret = 0;
+}
+
+/** Submit the requests queued on the io_uring of a segment, the caller
+owns the mutex.
+@param[in]	segment	local segment */
+void
+AIO::uring_submit(ulint segment)
+{
+	ut_ad(is_mutex_owned());
+
+	for (;;) {
+		int	ret = io_uring_submit(uring(segment));
+
+		if (ret >= 0) {
+			return;
+		}
+
+		/* The completion queue is twice the size of the submission
+		queue, the kernel can only run short of memory here. */
+		switch (ret) {
+		case -EAGAIN:
+		case -EINTR:
+			os_thread_yield();
+			continue;
+		}
+
+		ib::fatal()
+			<< "Unexpected ret_code[" << ret
+			<< "] from io_uring_submit()!";
+	}
+}
+
+/** Queue an AIO request on the io_uring of its segment.
+@param[in,out]	slot	an already reserved slot
+@param[in]	submit	true to submit it now, false to leave it
+			for the next os_aio_simulated_wake_handler_threads()
+@return true on success. */
+bool
+AIO::uring_dispatch(Slot* slot, bool submit)
+{
+	acquire();
+
+	uring_queue(slot);
+
+	if (submit) {
+		uring_submit((slot->pos * m_n_segments) / m_slots.size());
+	}
+
+	release();
+
+	return(true);
+}
+
+/** Submit the requests queued on the io_urings of every array, the
+end of a read-ahead or flush batch */
+void
+AIO::uring_submit_all()
+{
+	AIO*	arrays[] = { s_reads, s_writes, s_ibuf, s_log };
+
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+
+		AIO*	array = arrays[i];
+
+		if (array == NULL) {
+			continue;
+		}
+
+		array->acquire();
+
+		for (ulint j = 0; j < array->m_n_rings; ++j) {
+
+			if (io_uring_sq_ready(&array->m_rings[j]) > 0) {
+				array->uring_submit(j);
+			}
+		}
+
+		array->release();
+	}
+}
+
+/** Initialise one io_uring per segment
+@return DB_SUCCESS or error code */
+dberr_t
+AIO::init_io_uring()
+{
+	ut_a(m_rings == NULL);
+
+	m_rings = static_cast<struct io_uring*>(
+		ut_zalloc_nokey(m_n_segments * sizeof(*m_rings)));
+
+	if (m_rings == NULL) {
+		return(DB_OUT_OF_MEMORY);
+	}
+
+	unsigned	entries = static_cast<unsigned>(slots_per_segment());
+
+	for (ulint i = 0; i < m_n_segments; ++i) {
+
+		struct io_uring_params	params;
+
+		memset(&params, 0x0, sizeof(params));
+
+		if (m_uring_poll) {
+			params.flags |= IORING_SETUP_IOPOLL;
+		}
+
+		int	ret = io_uring_queue_init_params(
+			entries, &m_rings[i], &params);
+
+		if (ret < 0) {
+			ib::error()
+				<< "io_uring_queue_init() returned following"
+				" error[" << ret << "]";
+
+			return(DB_IO_ERROR);
+		}
+
+		++m_n_rings;
+	}
+
+	return(DB_SUCCESS);
+}
+
+/** Checks if the kernel and liburing support the io_uring backend:
+the completion wait must not use the submission queue.
+@return true if supported, false otherwise. */
+bool
+AIO::is_io_uring_supported()
+{
+	struct io_uring		ring;
+	struct io_uring_params	params;
+
+	memset(&params, 0x0, sizeof(params));
+
+	int	ret = io_uring_queue_init_params(1, &ring, &params);
+
+	if (ret < 0) {
+		ib::warn()
+			<< "io_uring_queue_init() returned following"
+			" error[" << ret << "]";
+
+		return(false);
+	}
+
+	io_uring_queue_exit(&ring);
+
+	if (!(params.features & IORING_FEAT_EXT_ARG)) {
+		ib::warn()
+			<< "The io_uring of this kernel cannot wait for"
+			" completions with a timeout (IORING_FEAT_EXT_ARG,"
+			" Linux 5.11)";
+
+		return(false);
+	}
+
+	return(true);
+}
+
+/** Order the fixed buffers by address */
+static
+bool
+os_uring_buf_less(
+	const struct iovec&	a,
+	const struct iovec&	b)
+{
+	return(a.iov_base < b.iov_base);
+}
+
+/** Register the fixed buffers on the io_urings of this array
+@param[in]	iovs	the ranges
+@param[in]	n	number of ranges */
+void
+AIO::uring_register(const struct iovec* iovs, ulint n)
+{
+	for (ulint i = 0; i < m_n_rings; ++i) {
+
+		int	ret = io_uring_register_buffers(
+			&m_rings[i], iovs, static_cast<unsigned>(n));
+
+		if (ret < 0) {
+			ib::warn()
+				<< "io_uring_register_buffers() returned"
+				" following error[" << ret << "], the buffer"
+				" pool frames are read and written without"
+				" fixed buffers";
+
+			for (ulint j = 0; j < i; ++j) {
+				io_uring_unregister_buffers(&m_rings[j]);
+			}
+
+			return;
+		}
+	}
+
+	acquire();
+	m_uring_fixed = true;
+	release();
+}
+
+/** Stop using the fixed buffers of this array */
+void
+AIO::uring_unregister()
+{
+	acquire();
+
+	bool	fixed = m_uring_fixed;
+
+	m_uring_fixed = false;
+
+	if (fixed) {
+		/* A queued request prepared with a fixed buffer index
+		would fail with -EFAULT once the buffers are unregistered,
+		hand all of them to the kernel first. The requests queued
+		from now on use no fixed buffer. */
+		for (ulint i = 0; i < m_n_rings; ++i) {
+
+			while (io_uring_sq_ready(&m_rings[i]) > 0) {
+				uring_submit(i);
+			}
+		}
+	}
+
+	release();
+
+	if (!fixed) {
+		return;
+	}
+
+	/* The kernel keeps the buffers of the requests in flight until
+	they complete. */
+	for (ulint i = 0; i < m_n_rings; ++i) {
+		io_uring_unregister_buffers(&m_rings[i]);
+	}
+}
+
+/** Register memory ranges as the fixed buffers of every io_uring.
+@param[in]	bufs	start of each range
+@param[in]	lens	length of each range
+@param[in]	n	number of ranges */
+void
+AIO::uring_register_buffers(
+	byte**		bufs,
+	const ulint*	lens,
+	ulint		n)
+{
+	uring_unregister_buffers();
+
+	for (ulint i = 0; i < n; ++i) {
+		struct iovec	iov;
+
+		iov.iov_base = bufs[i];
+		iov.iov_len = lens[i];
+
+		os_uring_bufs.push_back(iov);
+	}
+
+	if (os_uring_bufs.empty()) {
+		return;
+	}
+
+	std::sort(os_uring_bufs.begin(), os_uring_bufs.end(),
+		  os_uring_buf_less);
+
+	/* The log and the doublewrite buffer are not in the buffer
+	pool, only the page arrays use the fixed buffers. */
+	AIO*	arrays[] = { s_reads, s_writes, s_ibuf };
+
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+
+		if (arrays[i] != NULL) {
+			arrays[i]->uring_register(
+				&os_uring_bufs[0], os_uring_bufs.size());
+		}
+	}
+}
+
+/** Stop using the fixed buffers and unregister them */
+void
+AIO::uring_unregister_buffers()
+{
+	AIO*	arrays[] = { s_reads, s_writes, s_ibuf };
+
+	for (ulint i = 0; i < UT_ARR_SIZE(arrays); ++i) {
+
+		if (arrays[i] != NULL) {
+			arrays[i]->uring_unregister();
+		}
+	}
+
+	os_uring_bufs.clear();
+}
+#endif /* UNIV_IO_URING */
+
 /** Creates an io_context for native linux AIO.
 @param[in]	max_events	number of events
 @param[out]	io_ctx		io_ctx to initialize.
@@ -3264,6 +3936,31 @@ os_file_status_posix(
 	return(true);
 }
 
+/** Handle a failed fsync, errno tells the error.
+@return true if the error can be ignored */
+static
+bool
+os_file_flush_failed()
+{
+	/* Since Linux returns EINVAL if the 'file' is actually a raw device,
+	we choose to ignore that error if we are using raw disks */
+
+	if (srv_start_raw_disk_in_use && errno == EINVAL) {
+
+		return(true);
+	}
+
+	ib::error() << "The OS said file flush did not succeed";
+
+	os_file_handle_error(NULL, "flush");
+
+	/* It is a fatal error if a file flush does not succeed, because then
+	the database can get corrupt on disk */
+	ut_error;
+
+	return(false);
+}
+
 /** NOTE! Use the corresponding macro os_file_flush(), not directly this
 function!
 Flushes the write buffers of a given file to the disk.
@@ -3281,24 +3978,110 @@ os_file_flush_func(
 		return(true);
 	}
 
-	/* Since Linux returns EINVAL if the 'file' is actually a raw device,
-	we choose to ignore that error if we are using raw disks */
+	return(os_file_flush_failed());
+}
 
-	if (srv_start_raw_disk_in_use && errno == EINVAL) {
+#if defined (UNIV_IO_URING)
+/** Flushes the write buffers of a set of files to the disk. The fsyncs are
+submitted together on an io_uring, a failed fsync is handled as in
+os_file_flush_func().
+@param[in]	files		handles of the files
+@param[in]	n		number of files */
+void
+os_file_flush_batch(
+	const os_file_t*	files,
+	ulint			n)
+{
+	struct io_uring	ring;
 
-		return(true);
+	if (!srv_use_io_uring
+	    || n < 2
+	    || io_uring_queue_init(
+		    static_cast<unsigned>(ut_min(n, OS_FILE_FLUSH_BATCH)),
+		    &ring, 0) < 0) {
+
+		for (ulint i = 0; i < n; ++i) {
+			os_file_flush_func(files[i]);
+		}
+
+		return;
 	}
 
-	ib::error() << "The OS said file flush did not succeed";
+	for (ulint first = 0; first < n; first += OS_FILE_FLUSH_BATCH) {
 
-	os_file_handle_error(NULL, "flush");
+		ulint	count = ut_min(n - first, OS_FILE_FLUSH_BATCH);
 
-	/* It is a fatal error if a file flush does not succeed, because then
-	the database can get corrupt on disk */
-	ut_error;
+		for (ulint i = 0; i < count; ++i) {
 
-	return(false);
+			struct io_uring_sqe*	sqe = io_uring_get_sqe(&ring);
+
+			ut_a(sqe != NULL);
+
+			io_uring_prep_fsync(sqe, files[first + i], 0);
+
+			io_uring_sqe_set_data(
+				sqe, reinterpret_cast<void*>(first + i));
+		}
+
+		os_n_fsyncs += count;
+
+		int	ret;
+
+		do {
+			ret = io_uring_submit_and_wait(
+				&ring, static_cast<unsigned>(count));
+		} while (ret == -EINTR || ret == -EAGAIN);
+
+		ulint	n_done = 0;
+
+		/* Collect what has completed. A failed fsync is not
+		retried, the dirty pages it should have persisted may
+		already be dropped by the kernel. A failed submit is
+		redone synchronously. */
+		while (ret >= 0 && n_done < count) {
+
+			struct io_uring_cqe*	cqe;
+
+			ret = io_uring_wait_cqe(&ring, &cqe);
+
+			if (ret == -EINTR) {
+				ret = 0;
+				continue;
+			}
+
+			if (ret < 0) {
+				break;
+			}
+
+			ulint	i = reinterpret_cast<ulint>(
+				io_uring_cqe_get_data(cqe));
+
+			if (cqe->res < 0) {
+				ut_ad(i < n);
+				errno = -cqe->res;
+				os_file_flush_failed();
+			}
+
+			io_uring_cqe_seen(&ring, cqe);
+
+			++n_done;
+		}
+
+		if (ret < 0) {
+			/* The ring is unusable, flush the rest one by
+			one. The requests of this round may still be in
+			flight, a second fsync of a file is harmless. */
+			for (ulint i = first; i < n; ++i) {
+				os_file_flush_func(files[i]);
+			}
+
+			break;
+		}
+	}
+
+	io_uring_queue_exit(&ring);
 }
+#endif /* UNIV_IO_URING */
 
 /** NOTE! Use the corresponding macro os_file_create_simple(), not directly
 this function!
@@ -6448,12 +7231,26 @@ AIO::AIO(
 # elif defined(_WIN32)
 	,m_handles()
 # endif /* LINUX_NATIVE_AIO */
+# if defined (UNIV_IO_URING)
+	,m_rings(),
+	m_n_rings(),
+	m_uring_poll(),
+	m_uring_fixed()
+# endif /* UNIV_IO_URING */
 {
 	ut_a(n > 0);
 	ut_a(m_n_segments > 0);
 
 	mutex_create(id, &m_mutex);
 
+#if defined (UNIV_IO_URING)
+	/* Only the tablespace files are opened with O_DIRECT */
+	m_uring_poll = srv_io_uring_poll
+		&& (id == LATCH_ID_OS_AIO_READ_MUTEX
+		    || id == LATCH_ID_OS_AIO_WRITE_MUTEX
+		    || id == LATCH_ID_OS_AIO_IBUF_MUTEX);
+#endif /* UNIV_IO_URING */
+
 	m_not_full = os_event_create("aio_not_full");
 	m_is_empty = os_event_create("aio_is_empty");
 
@@ -6574,6 +7371,17 @@ AIO::init()
 #endif /* _WIN32 */
 
 	if (srv_use_native_aio) {
+#if defined (UNIV_IO_URING)
+		if (srv_use_io_uring) {
+			dberr_t	err = init_io_uring();
+
+			if (err != DB_SUCCESS) {
+				return(err);
+			}
+
+			return(init_slots());
+		}
+#endif /* UNIV_IO_URING */
 #ifdef LINUX_NATIVE_AIO
 		dberr_t	err = init_linux_native_aio();
 
@@ -6649,6 +7457,14 @@ AIO::~AIO()
 	free(m_seg_wrapper_arr);
 #endif
 
+#if defined (UNIV_IO_URING)
+	for (ulint i = 0; i < m_n_rings; ++i) {
+		io_uring_queue_exit(&m_rings[i]);
+	}
+
+	ut_free(m_rings);
+#endif /* UNIV_IO_URING */
+
 #if defined(LINUX_NATIVE_AIO)
 	if (srv_use_native_aio) {
 		m_events.clear();
@@ -6688,6 +7504,35 @@ AIO::start(
 	}
 #endif /* LINUX_NATIVE_AIO */
 
+#if defined (UNIV_IO_URING)
+	if (!srv_use_native_aio) {
+
+		srv_use_io_uring = FALSE;
+
+	} else if (srv_use_io_uring && !is_io_uring_supported()) {
+
+		ib::warn() << "io_uring disabled, using Linux Native AIO.";
+
+		srv_use_io_uring = FALSE;
+	}
+
+	if (srv_use_io_uring
+	    && srv_io_uring_poll
+	    && srv_unix_file_flush_method != SRV_UNIX_O_DIRECT
+	    && srv_unix_file_flush_method != SRV_UNIX_O_DIRECT_NO_FSYNC) {
+
+		ib::warn() << "innodb_io_uring_poll needs"
+			" innodb_flush_method = O_DIRECT or"
+			" O_DIRECT_NO_FSYNC, io_uring polling disabled.";
+
+		srv_io_uring_poll = FALSE;
+	}
+
+	if (!srv_use_io_uring) {
+		srv_io_uring_poll = FALSE;
+	}
+#endif /* UNIV_IO_URING */
+
 	srv_reset_io_thread_op_info();
 
 	s_reads = create(
@@ -7117,6 +7962,15 @@ AIO::reserve_slot(
 			os_aio_simulated_wake_handler_threads();
 		}
 
+#if defined (UNIV_IO_URING)
+		if (srv_use_io_uring) {
+			/* The array may be full of the requests our
+			batch has not submitted yet */
+
+			uring_submit_all();
+		}
+#endif /* UNIV_IO_URING */
+
 		os_event_wait(m_not_full);
 	}
 
@@ -7548,6 +8402,14 @@ os_aio_simulated_wake_handler_threads()
 	if (srv_use_native_aio) {
 		/* We do not use simulated aio: do nothing */
 
+#if defined (UNIV_IO_URING)
+		/* except submitting the requests queued on the
+		io_urings by a batch */
+		if (srv_use_io_uring) {
+			AIO::uring_submit_all();
+		}
+#endif /* UNIV_IO_URING */
+
 		return;
 	}
 
@@ -7558,6 +8420,35 @@ os_aio_simulated_wake_handler_threads()
 	}
 }
 
+#if defined (UNIV_IO_URING)
+/** Register memory ranges, the buffer pool chunks, as the fixed buffers
+of the io_urings of the page arrays. Reads and writes of a page inside a
+range then skip the page pinning of the kernel.
+@param[in]	bufs	start of each range
+@param[in]	lens	length of each range
+@param[in]	n	number of ranges */
+void
+os_aio_uring_register_buffers(
+	byte**		bufs,
+	const ulint*	lens,
+	ulint		n)
+{
+	if (srv_use_io_uring) {
+		AIO::uring_register_buffers(bufs, lens, n);
+	}
+}
+
+/** Stop using the fixed buffers registered by
+os_aio_uring_register_buffers(), before the ranges are freed. */
+void
+os_aio_uring_unregister_buffers()
+{
+	if (srv_use_io_uring) {
+		AIO::uring_unregister_buffers();
+	}
+}
+#endif /* UNIV_IO_URING */
+
 /** Select the IO slot array
 @param[in]	type		Type of IO, READ or WRITE
 @param[in]	read_only	true if running in read-only mode
@@ -2276,7 +2276,7 @@ page_parse_copy_rec_list_to_created_page(
 	page_zip_des_t*	page_zip;
 
 	if (ptr + 4 > end_ptr) {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 		assert(0);
 #endif
 		return(NULL);
@@ -2288,7 +2288,7 @@ page_parse_copy_rec_list_to_created_page(
 	rec_end = ptr + log_data_len;
 
 	if (rec_end > end_ptr) {
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PART_PL) && !defined (UNIV_PMEMOBJ_PPL_HYBRID)
 		assert(0);
 #endif
 		return(NULL);
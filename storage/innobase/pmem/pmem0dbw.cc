@@ -112,3 +112,122 @@ PMEM_DBW* pm_pop_dbw_alloc(PMEMobjpool* pop, const size_t size) {
 	pmemobj_persist(pop, pdbw, sizeof(*pdbw));
 	return pdbw;
 } 
+
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+int pm_wrapper_dbw_part_alloc(
+		PMEM_WRAPPER*	pmw,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+	assert(pmw);
+
+	pmw->pdbw = pm_pop_dbw_part_alloc(pmw->pop, n_slots, slot_size);
+	if (!pmw->pdbw)
+		return PMEM_ERROR;
+	else
+		return PMEM_SUCCESS;
+}
+/*
+ * Allocate the partitioned double write buffer in persistent memory
+ * The data area is n_slots page slots plus one page for alignment
+ * Each slot has a persistent state word, a slot is IN_FLIGHT from the time its
+ * page image is persisted until the datafile write is synced
+ * */
+PMEM_DBW* pm_pop_dbw_part_alloc(
+		PMEMobjpool*	pop,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+
+	TOID(PMEM_DBW) dbw; 
+
+	POBJ_ZNEW(pop, &dbw, PMEM_DBW);
+
+	PMEM_DBW *pdbw = D_RW(dbw);
+
+	pdbw->size = (n_slots + 1) * slot_size;
+	pdbw->type = DBW_TYPE;
+	pdbw->is_new = true;
+	pdbw->n_slots = n_slots;
+	pdbw->slot_size = slot_size;
+
+	pdbw->data = pm_pop_alloc_bytes(pop, pdbw->size);
+	if (OID_IS_NULL(pdbw->data)){
+		return NULL;
+	}
+
+	pdbw->slot_state = pm_pop_alloc_bytes(pop, n_slots * sizeof(uint64_t));
+	if (OID_IS_NULL(pdbw->slot_state)){
+		return NULL;
+	}
+	pmemobj_memset_persist(pop, pmemobj_direct(pdbw->slot_state),
+			0, n_slots * sizeof(uint64_t));
+	
+	pmemobj_persist(pop, pdbw, sizeof(*pdbw));
+	return pdbw;
+}
+
+/*Get the address of a slot in the partitioned double write buffer
+ * slots are aligned to slot_size*/
+byte*
+pm_dbw_part_get_slot(
+		PMEM_DBW*		pdbw,
+		uint64_t		slot) {
+	byte* p;
+
+	assert(slot < pdbw->n_slots);
+
+	p = static_cast<byte*>(pmemobj_direct(pdbw->data));
+	p = static_cast<byte*>(ut_align(p, pdbw->slot_size));
+
+	return (p + slot * pdbw->slot_size);
+}
+
+bool
+pm_dbw_part_slot_in_flight(
+		PMEM_DBW*		pdbw,
+		uint64_t		slot) {
+	uint64_t* state = static_cast<uint64_t*>(
+			pmemobj_direct(pdbw->slot_state));
+
+	return (state[slot] == PMEM_DBW_SLOT_IN_FLIGHT);
+}
+
+/*Persist a page image on a slot then mark the slot in flight
+ * The page must be durable before its state word, otherwise recovery may
+ * read a torn copy
+ * len may be smaller than slot_size (compressed page), the rest is zero-filled
+ * */
+void
+pm_dbw_part_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_DBW*		pdbw,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		len) {
+	byte*		p = pm_dbw_part_get_slot(pdbw, slot);
+	uint64_t*	state = static_cast<uint64_t*>(
+			pmemobj_direct(pdbw->slot_state));
+
+	assert(len <= pdbw->slot_size);
+
+	pmemobj_memcpy_persist(pop, p, src, len);
+	if (len < pdbw->slot_size) {
+		pmemobj_memset_persist(pop, p + len, 0x0, pdbw->slot_size - len);
+	}
+
+	state[slot] = PMEM_DBW_SLOT_IN_FLIGHT;
+	pmemobj_persist(pop, &state[slot], sizeof(uint64_t));
+}
+
+/*Mark a slot free, called when the datafile write of the slot's page is synced*/
+void
+pm_dbw_part_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_DBW*		pdbw,
+		uint64_t		slot) {
+	uint64_t*	state = static_cast<uint64_t*>(
+			pmemobj_direct(pdbw->slot_state));
+
+	state[slot] = PMEM_DBW_SLOT_FREE;
+	pmemobj_persist(pop, &state[slot], sizeof(uint64_t));
+}
+#endif /* UNIV_PMEMOBJ_DBW_PARTITION */
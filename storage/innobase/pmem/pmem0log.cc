@@ -15,9 +15,14 @@
 #include <assert.h>
 #include <wchar.h>
 #include <unistd.h> //for access()
+#include <algorithm> //for std::sort()
+#include <vector>
+#include <sched.h> //for sched_getcpu()
 
 #include "mtr0log.h" //for mlog_parse_initial_log_record()
+#include "ut0crc32.h" //for ut_crc32()
 #include "dyn0buf.h" // for mtr_buf_t
+#include "sync0sync.h" //for the performance_schema keys
 
 #include "my_pmem_common.h"
 #include "my_pmemobj.h"
@@ -72,8 +77,10 @@ static bool USE_BIT_ARRAY = true;
 //static bool USE_BIT_ARRAY = false;
 static uint64_t BIT_BLOCK_SIZE = sizeof(long long);
 
+#if !defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
 /*call pmemobj_persist() at every log record write*/
 static bool PERSIST_AT_WRITE = true;
+#endif
 
 #endif //UNIV_PMEMOBJ_PL
 //////////////// NEW PMEM PARTITION LOG /////////////
@@ -96,6 +103,196 @@ pm_pop_get_ppl (PMEMobjpool* pop)
 	return ppl;	
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+/*
+ * Split the log buf data of a new PPL in one region per node
+ * The log buf of line i goes to the node of the line, the free log bufs are
+ * spread round-robin so that a full line can take a free one on its node
+ * A region is in the pool of its node if innodb_pmem_numa_home_dirs has one,
+ * otherwise in pmw->pop
+ * */
+static void
+__pm_ppl_numa_place_log_bufs(
+		PMEM_WRAPPER*			pmw,
+		PMEM_PAGE_PART_LOG*		ppl)
+{
+	PMEMobjpool*	pop = pmw->pop;
+	PMEMobjpool*	node_pop;
+	uint64_t		node_size[PMEM_NUMA_MAX_NODES];
+	uint64_t		i, j;
+	ulint			node;
+	ulint			n_nodes;
+	byte*			p;
+
+	PMEM_PAGE_LOG_HASHED_LINE*	pline;
+	PMEM_PAGE_LOG_BUF*			plogbuf;
+	TOID(PMEM_PAGE_LOG_BUF)		logbuf;
+
+	n_nodes = ut_min(pm_numa_n_nodes(), (ulint) PMEM_NUMA_MAX_NODES);
+	ppl->n_nodes = n_nodes;
+	memset(node_size, 0, sizeof(node_size));
+
+	for (i = 0; i < ppl->n_buckets; i++) {
+		pline = D_RW(D_RW(ppl->buckets)[i]);
+		plogbuf = D_RW(pline->logbuf);
+
+		node = pm_numa_node_of_line(i, ppl->n_buckets, n_nodes);
+		plogbuf->node = node;
+		plogbuf->pmemaddr = node_size[node];
+		node_size[node] += ppl->log_buf_size;
+		pmemobj_persist(pop, plogbuf, sizeof(*plogbuf));
+	}
+
+	j = 0;
+	POBJ_LIST_FOREACH(logbuf, &D_RW(ppl->free_pool)->head, list_entries) {
+		plogbuf = D_RW(logbuf);
+
+		node = j++ % n_nodes;
+		plogbuf->node = node;
+		plogbuf->pmemaddr = node_size[node];
+		node_size[node] += ppl->log_buf_size;
+		pmemobj_persist(pop, plogbuf, sizeof(*plogbuf));
+	}
+
+	pm_numa_open_pools(pmw, n_nodes, node_size);
+
+	for (node = 0; node < n_nodes; node++) {
+		node_pop = (pmw->node_pops[node] != NULL) ? pmw->node_pops[node] : pop;
+
+		/*one more log buf for the alignment*/
+		ppl->node_data[node] = pm_pop_alloc_bytes(node_pop,
+				node_size[node] + ppl->log_buf_size);
+		if (OID_IS_NULL(ppl->node_data[node])){
+			printf("PMEMOBJ_ERROR: cannot allocate the log data of NUMA node %zu\n", node);
+			exit(0);
+		}
+		ppl->pmem_alloc_size += node_size[node] + ppl->log_buf_size;
+
+		p = static_cast<byte*> (pmemobj_direct(ppl->node_data[node]));
+		ppl->node_p_align[node] = static_cast<byte*> (ut_align(p, ppl->log_buf_size));
+	}
+
+	/*the node 0 region stands for the whole data in the printouts*/
+	ppl->p_align = ppl->node_p_align[0];
+
+	pmemobj_persist(pop, ppl, sizeof(*ppl));
+}
+
+/*
+ * Map the per-node log data regions of a reused PPL
+ * The layout keeps the number of nodes it was allocated with
+ * */
+static void
+__pm_ppl_numa_open_regions(
+		PMEM_WRAPPER*			pmw,
+		PMEM_PAGE_PART_LOG*		ppl)
+{
+	ulint	node;
+	byte*	p;
+
+	if (ppl->n_nodes != pm_numa_n_nodes()) {
+		printf("PMEM_WARN: the PPL log data is laid out on %zu NUMA nodes, the server has %zu\n",
+				ppl->n_nodes, pm_numa_n_nodes());
+	}
+
+	pm_numa_open_pools(pmw, ppl->n_nodes, NULL);
+
+	for (node = 0; node < ppl->n_nodes; node++) {
+		p = static_cast<byte*> (pmemobj_direct(ppl->node_data[node]));
+		if (p == NULL) {
+			printf("PMEMOBJ_ERROR: the log data of NUMA node %zu is not mapped, check innodb_pmem_numa_home_dirs\n", node);
+			assert(0);
+		}
+		ppl->node_p_align[node] = static_cast<byte*> (ut_align(p, ppl->log_buf_size));
+	}
+	ppl->p_align = ppl->node_p_align[0];
+}
+
+#if !defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+/*
+ * Pick a free log buf on the node of the line, among the first
+ * PMEM_NUMA_FREE_BUF_SCAN ones, otherwise the head
+ * The caller holds pfreepool->lock
+ * */
+static TOID(PMEM_PAGE_LOG_BUF)
+__pm_ppl_numa_pick_free_buf(
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_FREE_POOL*	pfreepool,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline)
+{
+	TOID(PMEM_PAGE_LOG_BUF) logbuf;
+	ulint	node;
+	ulint	n = 0;
+
+	if (ppl->n_nodes <= 1) {
+		return POBJ_LIST_FIRST (&pfreepool->head);
+	}
+
+	node = pm_numa_node_of_line(pline->hashed_id, ppl->n_buckets, ppl->n_nodes);
+
+	POBJ_LIST_FOREACH(logbuf, &pfreepool->head, list_entries) {
+		if (D_RO(logbuf)->node == node) {
+			return logbuf;
+		}
+		if (++n >= PMEM_NUMA_FREE_BUF_SCAN) {
+			break;
+		}
+	}
+
+	return POBJ_LIST_FIRST (&pfreepool->head);
+}
+#endif /* !UNIV_PMEMOBJ_PPL_MAGAZINE */
+#endif /* UNIV_PMEMOBJ_PPL_NUMA */
+
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_IO)
+PSI_file*	pm_ppl_persist_psi = NULL;
+
+/*
+ * Register the pool file with performance_schema, the persists of the
+ * per-page log are accounted on it, see pm_persist()
+ * The pool is never opened with the mysql_file API, the open wait is empty
+ * */
+void
+pm_ppl_pfs_open(
+		const char*		pool_name)
+{
+	PSI_file_locker_state	state;
+	PSI_file_locker*		locker;
+
+	locker = PSI_FILE_CALL(get_thread_file_name_locker)(
+			&state, pm_ppl_persist_file_key.m_value,
+			PSI_FILE_STREAM_OPEN, pool_name, &pm_ppl_persist_psi);
+	if (locker == NULL) {
+		return;
+	}
+
+	PSI_FILE_CALL(start_file_open_wait)(locker, __FILE__, __LINE__);
+	pm_ppl_persist_psi = PSI_FILE_CALL(end_file_open_wait)(
+			locker, &pm_ppl_persist_psi);
+}
+
+void
+pm_ppl_pfs_close()
+{
+	PSI_file_locker_state	state;
+	PSI_file_locker*		locker;
+
+	if (pm_ppl_persist_psi == NULL) {
+		return;
+	}
+
+	locker = PSI_FILE_CALL(get_thread_file_stream_locker)(
+			&state, pm_ppl_persist_psi, PSI_FILE_STREAM_CLOSE);
+	pm_ppl_persist_psi = NULL;
+	if (locker == NULL) {
+		return;
+	}
+
+	PSI_FILE_CALL(start_file_close_wait)(locker, __FILE__, __LINE__);
+	PSI_FILE_CALL(end_file_close_wait)(locker, 0);
+}
+#endif /* UNIV_PMEMOBJ_PART_PL && UNIV_PFS_IO */
+
 /*
  * Allocate part page log and its components
  * Read config variable from my.cnf 
@@ -154,6 +351,9 @@ pm_wrapper_page_log_alloc_or_open(
 			printf("PMEMOBJ_ERROR: error when allocate buffer in pm_wrapper_page_log_alloc_or_open()\n");
 			exit(0);
 		}
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+		__pm_ppl_numa_place_log_bufs(pmw, pmw->ppl);
+#endif
 		printf("\n=================================\n Footprint of PAGE part-log:\n");
 		printf("Log area %zu x %zu (B) = \t\t %f (MB) \n", n_log_bufs, PMEM_LOG_BUF_SIZE, (n_log_bufs * PMEM_LOG_BUF_SIZE * 1.0)/(1024*1024) );
 		printf("PAGE-Log metadata: %zu x %zu = \t %f (MB)\n", PMEM_N_LOG_BUCKETS, PMEM_N_BLOCKS_PER_BUCKET, (pmw->ppl->pmem_page_log_size * 1.0)/(1024*1024));
@@ -175,10 +375,14 @@ pm_wrapper_page_log_alloc_or_open(
 		//Case 2: Reused a buffer in PMEM
 		printf("!!!!!!! [PMEMOBJ_INFO]: the server restart from a crash but the per-page log buffers are persist\n");
 		//We need to re-align the p_align
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+		__pm_ppl_numa_open_regions(pmw, pmw->ppl);
+#else
 		byte* p;
 		p = static_cast<byte*> (pmemobj_direct(pmw->ppl->data));
 		assert(p);
 		pmw->ppl->p_align = static_cast<byte*> (ut_align(p, PMEM_LOG_BUF_SIZE));
+#endif
 
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)
 		//print the hashed line to check
@@ -189,17 +393,25 @@ pm_wrapper_page_log_alloc_or_open(
 	/* Part 2: DRAM structures*/	
 
 	// In any case (new alloc or reused) we need to allocate below objects
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_IO)
+	pm_ppl_pfs_open(pmw->name);
+#endif
 	
 	/*init the per-line std::map */
 	pm_ppl_init_in_mem(pmw->pop, pmw->ppl);
 
 	/* defined in my_pmemobj.h, implement in buf0flu.cc */
 	pmw->ppl->flusher = pm_log_flusher_init(PMEM_N_LOG_FLUSH_THREADS, FLUSHER_LOG_BUF);
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	pmw->ppl->reclaimer = pm_ppl_reclaimer_init(
+			srv_ppl_reclaim_queue_size, srv_ppl_reclaim_batch);
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	pmw->ppl->depot = pm_ppl_depot_init(pmw->pop, pmw->ppl, srv_ppl_magazine_size);
+#endif
 
 	pmw->ppl->free_log_pool_event = os_event_create("pm_free_log_pool_event");
 	pmw->ppl->redoing_done_event = os_event_create("pm_is_redoing_done_event");
-	
-	pm_page_part_log_hash_create(pmw->pop, pmw->ppl);
 
 	pmw->ppl->deb_file = fopen("part_log_debug.txt","a");
 }
@@ -210,6 +422,13 @@ pm_wrapper_page_log_close(
 {
 	PMEM_PAGE_PART_LOG* ppl = pmw->ppl;
 	
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	/*the pending notices need the per-line maps*/
+	pm_ppl_reclaimer_close(pmw->pop, ppl);
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	pm_ppl_depot_close(ppl);
+#endif
 	//Free resource allocated in DRAM
 	pm_ppl_free_in_mem(pmw->pop, pmw->ppl);
 
@@ -220,6 +439,9 @@ pm_wrapper_page_log_close(
 	pm_page_part_log_hash_free(pmw->pop, pmw->ppl);
 
 	pm_close_and_free_log_files(pmw->ppl);	
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_IO)
+	pm_ppl_pfs_close();
+#endif
 
 #if defined (UNIV_PMEMOBJ_PART_PL_STAT)	
 //	__print_page_log_hashed_lines(debug_ptxl_file, pmw->ppl);
@@ -290,6 +512,9 @@ pm_page_part_log_bucket_reset(
 		pline->ckpt_lsn = 0;
 		pline->oldest_block_id = UINT32_MAX;
 		pline->is_req_checkpoint = false;
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+		pm_ppl_update_line_pressure(ppl, pline, 0);
+#endif
 		
 		// (4) logbuf
 		
@@ -298,7 +523,27 @@ pm_page_part_log_bucket_reset(
 		plogbuf->state = PMEM_LOG_BUF_FREE;
 		plogbuf->cur_off = PMEM_LOG_BUF_HEADER_SIZE;
 		plogbuf->n_recs = 0;
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		/*diskaddr restarts from 0, end the recs of the previous run*/
+		pmemobj_memset_persist(pop,
+				PMEM_LOG_BUF_DATA(ppl, plogbuf) + PMEM_LOG_BUF_HEADER_SIZE, 0, 2);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+		/*the in-flush bufs of the line are replayed, give them back*/
+		TOID(PMEM_PAGE_LOG_BUF) old_buf;
+		TOID_ASSIGN(old_buf, (pline->tail_logbuf).oid);
+		TOID_ASSIGN(pline->tail_logbuf, (pline->logbuf).oid);
+		pm_persist(pop, &pline->tail_logbuf, sizeof(pline->tail_logbuf));
 
+		while (!TOID_IS_NULL(old_buf) && !TOID_EQUALS(old_buf, pline->logbuf)) {
+			PMEM_PAGE_LOG_BUF* pold = D_RW(old_buf);
+			TOID_ASSIGN(old_buf, (pold->next).oid);
+
+			pm_ppl_depot_reset_buf(pop, ppl, pold);
+			pm_ppl_depot_put(pop, ppl, pold);
+		}
+#endif
 		TOID_ASSIGN(plogbuf->next, OID_NULL);
 		TOID_ASSIGN(plogbuf->prev, OID_NULL);
 		TOID_ASSIGN(pline->tail_logbuf, (pline->logbuf).oid);
@@ -414,6 +659,12 @@ PMEM_PAGE_PART_LOG* alloc_pmem_page_part_log(
 	//	space->space_no = UINT32_MAX;
 	//}
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*the data is allocated per node in __pm_ppl_numa_place_log_bufs()*/
+	(void) p;
+	ppl->data = OID_NULL;
+	ppl->p_align = NULL;
+#else
 	ppl->data = pm_pop_alloc_bytes(pop, align_size);
 	
 	ppl->pmem_alloc_size += align_size;
@@ -428,6 +679,7 @@ PMEM_PAGE_PART_LOG* alloc_pmem_page_part_log(
 	if (OID_IS_NULL(ppl->data)){
 		return NULL;
 	}
+#endif /* UNIV_PMEMOBJ_PPL_NUMA */
 	
 	log_buf_id = 0;
 	log_buf_offset = 0;
@@ -873,10 +1125,83 @@ void __realloc_TT_entry(
 	}
 }
 
+/*The lines [begin, end) rebuilt by one init thread*/
+struct pm_ppl_init_range_t {
+	PMEM_PAGE_PART_LOG*	ppl;
+	uint64_t			begin;
+	uint64_t			end;
+};
+
+/*
+ * Init the in-mem data structures of the lines [begin, end)
+ * Lines are independent, this runs in parallel on disjoint ranges
+ * */
+static void
+__pm_ppl_init_lines_in_mem(
+		PMEM_PAGE_PART_LOG*		ppl,
+		uint64_t				begin,
+		uint64_t				end)
+{
+	uint64_t i;
+	PMEM_PAGE_LOG_HASHED_LINE* pline;
+	char sbuf[256];
+
+	for (i = begin; i < end; i++){
+		pline = D_RW(D_RW(ppl->buckets)[i]);
+		
+		pline->is_flushing = false;		
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+		pline->pressure_pct = 0;
+#endif
+		/*Note that each pline must have distinct os event*/
+		sprintf(sbuf,"pm_line_log_flush_event%zu", i);
+		pline->log_flush_event = os_event_create(sbuf);
+
+		/*the map, a line never has more than max_blocks keys so it is never rehashed*/
+		pline->key_map = new KEY_MAP();
+		pline->key_map->reserve(pline->max_blocks);
+		pline->offset_map = new OFFSET_MAP();
+
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_RWLOCK)
+		pline->lock_psi = pm_rwlock_psi_init(
+				pm_ppl_line_lock_key, &pline->lock);
+		pline->meta_lock_psi = pm_rwlock_psi_init(
+				pm_ppl_line_meta_lock_key, &pline->meta_lock);
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+		/*the current logbuf may have recs from the last run, they are not in the index*/
+		pline->compact_dict = (PMEM_PPL_COMPACT_DICT*) malloc(sizeof(PMEM_PPL_COMPACT_DICT));
+		pm_ppl_compact_dict_reset(pline->compact_dict, UINT64_MAX, false);
+#endif
+	}
+}
+
+extern "C"
+os_thread_ret_t
+DECLARE_THREAD(pm_ppl_init_in_mem_worker)(
+		void* arg)
+{
+	pm_ppl_init_range_t* range = static_cast<pm_ppl_init_range_t*>(arg);
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*first touch the maps on the node of the lines*/
+	pm_numa_bind_thread(pm_numa_node_of_line(
+				range->begin, range->ppl->n_buckets, range->ppl->n_nodes));
+#endif
+	__pm_ppl_init_lines_in_mem(range->ppl, range->begin, range->end);
+
+	os_thread_exit(false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*
  * Init in-mem data structures and variables 
  * Used for either new PPL or reused
  * Called from pm_wrapper_page_log_alloc_or_open()
+ * The lines are split in srv_ppl_n_init_threads contiguous ranges, the
+ * caller rebuilds the first one
  * */
 void 
 pm_ppl_init_in_mem(
@@ -884,28 +1209,65 @@ pm_ppl_init_in_mem(
 		PMEM_PAGE_PART_LOG*		ppl)
 {
 	uint64_t n, i;
-	PMEM_PAGE_LOG_HASHED_LINE* pline;
-	char sbuf[256];
+	uint64_t n_threads;
+	uint64_t lines_per_thread;
+	pm_ppl_init_range_t* ranges;
+	os_thread_id_t* thread_ids;
 
 	ppl->ckpt_lsn = 0;	
 	ppl->max_oldest_lsn = 0;
 	ppl->min_oldest_lsn = ULONG_MAX;
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	ppl->n_pressured_lines = 0;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_RWLOCK)
+	ppl->free_pool_lock_psi = pm_rwlock_psi_init(
+			pm_ppl_free_pool_lock_key, &D_RW(ppl->free_pool)->lock);
+	ppl->ckpt_lock_psi = pm_rwlock_psi_init(
+			pm_ppl_ckpt_lock_key, &ppl->ckpt_lock);
+
+	/*TT lines are few, the entries of a line share the instance*/
+	PMEM_TT* ptt = D_RW(ppl->tt);
+	for (i = 0; i < ptt->n_buckets; i++) {
+		PMEM_TT_HASHED_LINE* ptt_line = D_RW(D_RW(ptt->buckets)[i]);
+		ptt_line->entry_lock_psi = pm_rwlock_psi_init(
+				pm_ppl_tt_entry_lock_key, &ptt_line->lock);
+	}
+	D_RW(ptt->spec_bucket)->entry_lock_psi = pm_rwlock_psi_init(
+			pm_ppl_tt_entry_lock_key, &D_RW(ptt->spec_bucket)->lock);
+#endif
 
 	n = ppl->n_buckets;	
+
+	n_threads = ut_min((uint64_t) srv_ppl_n_init_threads,
+			(n - 1) / PMEM_PPL_INIT_MIN_LINES + 1);
+	lines_per_thread = (n - 1) / n_threads + 1;
+
+	ranges = static_cast<pm_ppl_init_range_t*>(
+			malloc(n_threads * sizeof(pm_ppl_init_range_t)));
+	thread_ids = static_cast<os_thread_id_t*>(
+			malloc(n_threads * sizeof(os_thread_id_t)));
+
+	for (i = 0; i < n_threads; i++) {
+		ranges[i].ppl = ppl;
+		ranges[i].begin = ut_min(i * lines_per_thread, n);
+		ranges[i].end = ut_min((i + 1) * lines_per_thread, n);
+	}
+
 	/*per-line in-mem data structures*/
-	for (i = 0; i < n; i++){
-		pline = D_RW(D_RW(ppl->buckets)[i]);
-		
-		pline->is_flushing = false;		
-		/*Note that each pline must have distinct os event*/
-		sprintf(sbuf,"pm_line_log_flush_event%zu", i);
-		pline->log_flush_event = os_event_create(sbuf);
+	for (i = 1; i < n_threads; i++) {
+		os_thread_create(pm_ppl_init_in_mem_worker, &ranges[i], &thread_ids[i]);
+	}
 
-		/*the map*/
-		//pline->offset_map = new std::map<uint64_t, uint32_t>();
-		pline->key_map = new KEY_MAP();
-		pline->offset_map = new OFFSET_MAP();
+	__pm_ppl_init_lines_in_mem(ppl, ranges[0].begin, ranges[0].end);
+
+	for (i = 1; i < n_threads; i++) {
+		os_thread_join(thread_ids[i]);
 	}
+
+	free(ranges);
+	free(thread_ids);
 }
 
 /*Free allocated in-mem data structures*/
@@ -925,18 +1287,40 @@ pm_ppl_free_in_mem(
 		/*os events*/
 		os_event_destroy(pline->log_flush_event);
 
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_RWLOCK)
+		pm_rwlock_psi_destroy(pline->lock_psi);
+		pm_rwlock_psi_destroy(pline->meta_lock_psi);
+#endif
+
 		/*the map*/
-		//free(pline->offset_map);
 		if (pline->key_map != nullptr) {
-			free(pline->key_map);
+			delete pline->key_map;
 			pline->key_map = nullptr;
 		}
 		
 		if (pline->offset_map != nullptr) {
-			free(pline->offset_map);
+			delete pline->offset_map;
 			pline->offset_map = nullptr;
 		}
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+		if (pline->compact_dict != NULL) {
+			free(pline->compact_dict);
+			pline->compact_dict = NULL;
+		}
+#endif
+	}
+
+#if defined (UNIV_PMEMOBJ_PART_PL) && defined (UNIV_PFS_RWLOCK)
+	pm_rwlock_psi_destroy(ppl->free_pool_lock_psi);
+	pm_rwlock_psi_destroy(ppl->ckpt_lock_psi);
+
+	PMEM_TT* ptt = D_RW(ppl->tt);
+	for (i = 0; i < ptt->n_buckets; i++) {
+		pm_rwlock_psi_destroy(
+				D_RW(D_RW(ptt->buckets)[i])->entry_lock_psi);
 	}
+	pm_rwlock_psi_destroy(D_RW(ptt->spec_bucket)->entry_lock_psi);
+#endif
 }
 
 void 
@@ -1170,7 +1554,7 @@ pm_ppl_add_space(
 	uint16_t i;
 	PMEM_SPACE* pm_space;
 	
-	pmemobj_rwlock_wrlock(pop, &ppl->ckpt_lock);
+	pm_rwlock_wrlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
 
 	for (i = 0; i < ppl->n_spaces; i++){
 		pm_space = D_RW(D_RW(ppl->space_arr)[i]);
@@ -1178,13 +1562,13 @@ pm_ppl_add_space(
 		if (pm_space->space_no == space_no ||
 				strstr(pm_space->name, name)){
 			/*exist space*/
-			pmemobj_rwlock_unlock(pop, &ppl->ckpt_lock);
+			pm_rwlock_unlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
 			return;
 		}
 	}
 	/*Add new*/
 	if (ppl->n_spaces == PMEM_N_SPACES){
-		pmemobj_rwlock_unlock(pop, &ppl->ckpt_lock);
+		pm_rwlock_unlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
 		printf("PMEM_ERROR: we reach the maximum number of spaces %zu!!! \n", PMEM_N_SPACES);
 		assert(0);
 	}
@@ -1197,7 +1581,7 @@ pm_ppl_add_space(
 	ppl->n_spaces++;
 	
 	printf("===> pm_ppl_add_space() name %s id %u\n", name, space_no);
-	pmemobj_rwlock_unlock(pop, &ppl->ckpt_lock);
+	pm_rwlock_unlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
 }
 /////////////// HASH TABLE ///////////////////
 /* Init hash table for each line in PPL
@@ -1218,6 +1602,7 @@ pm_page_part_log_hash_create(
 		pline = D_RW(D_RW(ppl->buckets)[i]);
 		//pline->addr_hash = hash_create(k);
 		pline->key_map = new KEY_MAP();
+		pline->key_map->reserve(pline->max_blocks);
 		pline->offset_map = new OFFSET_MAP();
 	}
 }
@@ -1234,12 +1619,12 @@ pm_page_part_log_hash_free(
 		pline = D_RW(D_RW(ppl->buckets)[i]);
 		//hash_table_free(pline->addr_hash);
 		if (pline->key_map != nullptr) {
-			pline->key_map->clear();
-			free (pline->key_map);
+			delete pline->key_map;
+			pline->key_map = nullptr;
 		}
 		if (pline->offset_map != nullptr) {
-			pline->offset_map->clear();
-			free (pline->offset_map);
+			delete pline->offset_map;
+			pline->offset_map = nullptr;
 		}
 	}
 }
@@ -1547,87 +1932,494 @@ pm_ppl_parse_entry_id(
 	ptr += 4;
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
 /*
- * Write a log rec to PPL
- * Called from mtr::execute()
- * Directly use __pm_write_log_buf as the old version
- * @param[in] pop
- * @param[in] ppl
- * @param[in] key
- * @param[in] log_src
- * @param[in] rec_size - rec size
+ * Reset the page index for a new logbuf
+ * @param[in] dict
+ * @param[in] buf_id - id of the logbuf
+ * @param[in] is_valid - false if the logbuf already has recs that are not indexed
  * */
-//void
-uint64_t
-pm_ppl_write_rec(
-			PMEMobjpool*		pop,
-			PMEM_WRAPPER*		pmw,
-			PMEM_PAGE_PART_LOG*	ppl,
-			uint64_t			key,
-			byte*				log_src,
-			uint32_t			rec_size)
+void
+pm_ppl_compact_dict_reset(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		uint64_t				buf_id,
+		bool					is_valid)
 {
-	uint32_t					n;
-	PMEM_PAGE_LOG_HASHED_LINE*	pline;
-	PMEM_PAGE_LOG_FREE_POOL*	pfreepool;
+	dict->buf_id = buf_id;
+	dict->is_valid = is_valid;
+	dict->n_pages = 0;
+	dict->last_lsn = 0;
+	memset(dict->slots, 0, sizeof(dict->slots));
+}
 
-	TOID(PMEM_PAGE_LOG_BUF)		logbuf;
-	PMEM_PAGE_LOG_BUF*			plogbuf;
+/*
+ * Dense types have a body that recv_parse_or_apply_log_rec_body() can
+ * parse without the page, so the compact rec does not store the body len
+ * */
+bool
+pm_ppl_compact_is_dense(
+		mlog_id_t	type)
+{
+	switch (type) {
+	case MLOG_1BYTE:
+	case MLOG_2BYTES:
+	case MLOG_4BYTES:
+	case MLOG_8BYTES:
+	case MLOG_PAGE_CREATE:
+	case MLOG_COMP_PAGE_CREATE:
+	case MLOG_PAGE_CREATE_RTREE:
+	case MLOG_COMP_PAGE_CREATE_RTREE:
+	case MLOG_UNDO_ERASE_END:
+	case MLOG_IBUF_BITMAP_INIT:
+	case MLOG_INIT_FILE_PAGE2:
+		return true;
+	default:
+		return false;
+	}
+}
 
-	PMEM_PAGE_LOG_BLOCK*		plog_block;
-	//plog_hash_t*				item;
+/*Find the index of key in the page index, add it if there is room
+ * @return index, or -1 if the page is not indexed*/
+static int
+pm_ppl_compact_dict_lookup(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		uint64_t				key,
+		ulint					space,
+		ulint					page_no,
+		bool*					is_seen)
+{
+	ulint	slot = (key ^ (key >> 20)) & (PMEM_PPL_COMPACT_HASH_SIZE - 1);
+	uint32_t idx;
 
-	ulint hashed;
-	byte* log_des;
-	byte* temp;
-	
-	mlog_id_t type;
-	ulint space, page_no;
-	uint16_t check_size;
-	
-	uint64_t rec_lsn;
-	uint64_t write_off;
-	uint64_t old_off;
-	
-#if defined(UNIV_PMEMOBJ_PPL_STAT)
-	uint64_t start_time, end_time;
-	uint64_t t1, t2;
-#endif	
+	*is_seen = false;
 
-#if defined (UNIV_PMEM_SIM_LATENCY)
-	uint64_t start_cycle, end_cycle;
-#endif
+	while (dict->slots[slot] != 0) {
+		idx = dict->slots[slot] - 1;
+		if (dict->keys[idx] == key) {
+			*is_seen = true;
+			return idx;
+		}
+		slot = (slot + 1) & (PMEM_PPL_COMPACT_HASH_SIZE - 1);
+	}
 
+	if (dict->n_pages >= PMEM_PPL_COMPACT_MAX_PAGES) {
+		return -1;
+	}
 
-	assert(rec_size > 0);
+	idx = dict->n_pages++;
+	dict->keys[idx] = key;
+	dict->spaces[idx] = space;
+	dict->page_nos[idx] = page_no;
+	dict->slots[slot] = idx + 1;
 
-	temp = mlog_parse_initial_log_record(
-			log_src, log_src + rec_size, &type, &space, &page_no);
-	check_size = mach_read_from_2(temp);
+	return idx;
+}
 
-	assert (check_size == rec_size);
-	assert (type < MLOG_BIGGEST_TYPE);
-	temp += 2;
-	
-	/*The last bucket is reserved for space 0*/	
-	n = ppl->n_buckets;
+/*
+ * Build the compact header of a log rec
+ * The caller holds pline->lock, the dict is updated as the rec is written
+ * @param[in] dict - page index of the current logbuf
+ * @param[out] hdr - at least PMEM_PPL_COMPACT_MAX_HDR bytes
+ * @param[in] rec_lsn - must not be smaller than dict->last_lsn
+ * @param[in] is_first - true if this is the first rec of the logbuf
+ * @return header len
+ * */
+uint32_t
+pm_ppl_compact_encode_header(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		byte*					hdr,
+		mlog_id_t				type,
+		ulint					space,
+		ulint					page_no,
+		uint64_t				key,
+		uint64_t				rec_lsn,
+		uint32_t				body_len,
+		bool					is_first)
+{
+	byte*	ptr = hdr;
+	bool	is_seen;
+	int		idx;
 
-	PMEM_LOG_HASH_KEY(hashed, key, n);
+	idx = pm_ppl_compact_dict_lookup(dict, key, space, page_no, &is_seen);
 
-	assert(hashed < n);
+	if (is_seen) {
+		*ptr++ = type | PMEM_PPL_REC_COMPACT | PMEM_PPL_REC_SEEN_PAGE;
+		*ptr++ = (byte) idx;
+	} else {
+		*ptr++ = type | PMEM_PPL_REC_COMPACT;
+		ptr += mach_write_compressed(ptr, space);
+		ptr += mach_write_compressed(ptr, page_no);
+	}
 
-retry:
-	pline = D_RW(D_RW(ppl->buckets)[hashed]);
-	TOID_ASSIGN(logbuf, (pline->logbuf).oid);
-	plogbuf = D_RW(pline->logbuf);
-	
-#if defined(UNIV_PMEMOBJ_PPL_STAT)
-	start_time = ut_time_us(NULL);
-#endif	
-	/*WARNING this lock may become bottle neck*/
-	pmemobj_rwlock_wrlock(pop, &pline->lock);
+	if (is_first) {
+		mach_write_to_8(ptr, rec_lsn);
+		ptr += 8;
+	} else {
+		assert(rec_lsn >= dict->last_lsn);
+		ptr += mach_u64_write_much_compressed(ptr, rec_lsn - dict->last_lsn);
+	}
+	dict->last_lsn = rec_lsn;
 
-#if defined(UNIV_PMEMOBJ_PPL_STAT)
+	if (!pm_ppl_compact_is_dense(type)) {
+		ptr += mach_write_compressed(ptr, body_len);
+	}
+
+	assert(ptr - hdr <= PMEM_PPL_COMPACT_MAX_HDR);
+	return (ptr - hdr);
+}
+
+/*
+ * Parse the compact header of a log rec, the reverse of pm_ppl_compact_encode_header()
+ * @param[in] dict - page index of the logbuf being parsed
+ * @param[in] is_first - true if this is the first rec of the logbuf
+ * @param[out] body_len - UINT32_MAX for dense types
+ * @return pointer to the body, NULL if the header is incomplete or corrupted
+ * */
+byte*
+pm_ppl_compact_parse_header(
+		PMEM_PPL_COMPACT_DICT*	dict,
+		byte*					ptr,
+		byte*					end_ptr,
+		bool					is_first,
+		mlog_id_t*				type,
+		ulint*					space,
+		ulint*					page_no,
+		uint64_t*				rec_lsn,
+		uint32_t*				body_len)
+{
+	const byte*	p = ptr;
+	byte		flags;
+	uint32_t	idx;
+	bool		is_seen;
+
+	flags = *p & PMEM_PPL_REC_FLAGS;
+	assert(flags & PMEM_PPL_REC_COMPACT);
+	*type = (mlog_id_t)(*p & ~PMEM_PPL_REC_FLAGS);
+	p++;
+
+	if (flags & PMEM_PPL_REC_SEEN_PAGE) {
+		if (p >= end_ptr) {
+			return NULL;
+		}
+		idx = *p++;
+		if (idx >= dict->n_pages) {
+			return NULL;
+		}
+		*space = dict->spaces[idx];
+		*page_no = dict->page_nos[idx];
+	} else {
+		*space = mach_parse_compressed(&p, end_ptr);
+		if (p == NULL) {
+			return NULL;
+		}
+		*page_no = mach_parse_compressed(&p, end_ptr);
+		if (p == NULL) {
+			return NULL;
+		}
+		uint64_t key;
+		PMEM_FOLD(key, *space, *page_no);
+		pm_ppl_compact_dict_lookup(dict, key, *space, *page_no, &is_seen);
+		if (is_seen) {
+			/*the writer never repeats an indexed page in full form*/
+			return NULL;
+		}
+	}
+
+	if (is_first) {
+		if (p + 8 > end_ptr) {
+			return NULL;
+		}
+		*rec_lsn = mach_read_from_8(p);
+		p += 8;
+	} else {
+		if (p >= end_ptr) {
+			return NULL;
+		}
+		*rec_lsn = dict->last_lsn + mach_read_next_much_compressed(&p);
+	}
+	dict->last_lsn = *rec_lsn;
+
+	if (pm_ppl_compact_is_dense(*type)) {
+		*body_len = UINT32_MAX;
+	} else {
+		*body_len = mach_parse_compressed(&p, end_ptr);
+		if (p == NULL) {
+			return NULL;
+		}
+	}
+
+	return const_cast<byte*>(p);
+}
+
+/*
+ * Copy a log rec to the logbuf in the compact encoding
+ * Fall back to the full rec if the logbuf has recs that are not in the page index
+ * (written before the server restart)
+ * The caller holds pline->lock
+ * @param[in] lsn_ptr - the 8-byte rec_lsn slot in log_src
+ * @param[out] rec_lsn
+ * @return number of bytes written on the logbuf
+ * */
+static uint32_t
+pm_ppl_write_compact_rec(
+			PMEMobjpool*				pop,
+			PMEM_PAGE_LOG_HASHED_LINE*	pline,
+			PMEM_PAGE_LOG_BUF*			plogbuf,
+			byte*						log_des,
+			byte*						log_src,
+			uint32_t					rec_size,
+			byte*						lsn_ptr,
+			mlog_id_t					type,
+			ulint						space,
+			ulint						page_no,
+			uint64_t					key,
+			uint64_t*					rec_lsn)
+{
+	PMEM_PPL_COMPACT_DICT*	dict = pline->compact_dict;
+	byte		hdr[PMEM_PPL_COMPACT_MAX_HDR];
+	byte*		body;
+	uint32_t	body_len;
+	uint32_t	hdr_len;
+	bool		is_first = (plogbuf->n_recs == 0);
+
+	if (is_first) {
+		pm_ppl_compact_dict_reset(dict, plogbuf->id, true);
+	} else if (dict->buf_id != plogbuf->id) {
+		pm_ppl_compact_dict_reset(dict, plogbuf->id, false);
+	}
+
+	/*keep rec_lsn monotonic in the logbuf so that the delta is unsigned*/
+	*rec_lsn = ut_time_us(NULL);
+	if (!is_first && *rec_lsn < dict->last_lsn) {
+		*rec_lsn = dict->last_lsn;
+	}
+
+	if (!dict->is_valid) {
+		mach_write_to_8(lsn_ptr, *rec_lsn);
+		/*the high bits of the type byte mark compact recs*/
+		*log_src &= ~MLOG_SINGLE_REC_FLAG;
+		pm_write_log_rec_low(pop, log_des, log_src, rec_size);
+		dict->last_lsn = *rec_lsn;
+		return rec_size;
+	}
+
+	body = lsn_ptr + 8;
+	body_len = rec_size - (body - log_src);
+
+	hdr_len = pm_ppl_compact_encode_header(dict, hdr, type, space, page_no,
+			key, *rec_lsn, body_len, is_first);
+
+	pm_write_log_rec_low(pop, log_des, hdr, hdr_len);
+	if (body_len > 0) {
+		pm_write_log_rec_low(pop, log_des + hdr_len, body, body_len);
+	}
+
+	return (hdr_len + body_len);
+}
+#endif /* UNIV_PMEMOBJ_PPL_COMPACT */
+
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+/*
+ * Checksum of a log rec in a logbuf
+ * ut_crc32 of the rec, seeded with the line and the disk address of the
+ * logbuf so that the stale recs of an earlier use of the logbuf never pass
+ * @param[in] rec - the rec, without the check prefix
+ * @param[in] len - rec len
+ * @param[in] hashed_id - the line of the logbuf
+ * @param[in] diskaddr - disk address of the logbuf
+ * */
+uint32_t
+pm_ppl_rec_checksum(
+		const byte*	rec,
+		uint32_t	len,
+		uint64_t	hashed_id,
+		uint64_t	diskaddr)
+{
+	byte	seed[16];
+
+	mach_write_to_8(seed, hashed_id);
+	mach_write_to_8(seed + 8, diskaddr);
+
+	return (ut_crc32(rec, len) ^ ut_crc32(seed, sizeof(seed)));
+}
+
+/*
+ * Check the prefix of the rec at ptr
+ * @param[out] rec_len - len of the rec after the prefix
+ * @return true if the whole rec is in [ptr, end_ptr) and its crc matches,
+ * false at the end of the recs or at a torn or stale rec
+ * */
+bool
+pm_ppl_rec_check(
+		const byte*	ptr,
+		const byte*	end_ptr,
+		uint64_t	hashed_id,
+		uint64_t	diskaddr,
+		uint32_t*	rec_len)
+{
+	uint32_t len;
+
+	if (ptr + PMEM_PPL_REC_CHECK_SIZE > end_ptr) {
+		return false;
+	}
+
+	len = mach_read_from_2(ptr);
+	if (len == 0 || ptr + PMEM_PPL_REC_CHECK_SIZE + len > end_ptr) {
+		return false;
+	}
+
+	if (mach_read_from_4(ptr + 2) != pm_ppl_rec_checksum(
+				ptr + PMEM_PPL_REC_CHECK_SIZE, len, hashed_id, diskaddr)) {
+		return false;
+	}
+
+	*rec_len = len;
+	return true;
+}
+
+/*
+ * Copy a log rec to the logbuf behind its check prefix
+ * The crc is taken on log_src, still hot in cache, right before the copy, then
+ * the prefix, the rec and the terminating zero len go out in one persist
+ * @param[in] log_des - start of the prefix on the logbuf
+ * */
+static inline void
+pm_ppl_write_checked_rec(
+			PMEMobjpool*	pop,
+			byte*			log_des,
+			byte*			log_src,
+			uint32_t		rec_size,
+			uint64_t		hashed_id,
+			uint64_t		diskaddr)
+{
+	mach_write_to_2(log_des, rec_size);
+	mach_write_to_4(log_des + 2,
+			pm_ppl_rec_checksum(log_src, rec_size, hashed_id, diskaddr));
+	memcpy(log_des + PMEM_PPL_REC_CHECK_SIZE, log_src, rec_size);
+	mach_write_to_2(log_des + PMEM_PPL_REC_CHECK_SIZE + rec_size, 0);
+
+	pm_persist(pop, log_des, rec_size + PMEM_PPL_REC_CHECK_RESERVE);
+}
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+/*
+ * Write the check prefix and the terminating zero len of a rec that is
+ * already on the logbuf (the compact encoding is built on the logbuf)
+ * */
+static inline void
+pm_ppl_seal_rec(
+			PMEMobjpool*	pop,
+			byte*			log_des,
+			uint32_t		write_size,
+			uint64_t		hashed_id,
+			uint64_t		diskaddr)
+{
+	byte* rec = log_des + PMEM_PPL_REC_CHECK_SIZE;
+
+	mach_write_to_2(rec + write_size, 0);
+	mach_write_to_2(log_des, write_size);
+	mach_write_to_4(log_des + 2,
+			pm_ppl_rec_checksum(rec, write_size, hashed_id, diskaddr));
+
+	pm_persist(pop, log_des, PMEM_PPL_REC_CHECK_SIZE);
+	pm_persist(pop, rec + write_size, 2);
+}
+#endif /* UNIV_PMEMOBJ_PPL_COMPACT */
+#endif /* UNIV_PMEMOBJ_PPL_CHECKSUM */
+
+/*
+ * Write a log rec to PPL
+ * Called from mtr::execute()
+ * Directly use __pm_write_log_buf as the old version
+ * @param[in] pop
+ * @param[in] ppl
+ * @param[in] key
+ * @param[in] log_src
+ * @param[in] rec_size - rec size
+ * */
+//void
+uint64_t
+pm_ppl_write_rec(
+			PMEMobjpool*		pop,
+			PMEM_WRAPPER*		pmw,
+			PMEM_PAGE_PART_LOG*	ppl,
+			uint64_t			key,
+			byte*				log_src,
+			uint32_t			rec_size)
+{
+	uint32_t					n;
+	PMEM_PAGE_LOG_HASHED_LINE*	pline;
+#if !defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	PMEM_PAGE_LOG_FREE_POOL*	pfreepool;
+#endif
+
+	TOID(PMEM_PAGE_LOG_BUF)		logbuf;
+	PMEM_PAGE_LOG_BUF*			plogbuf;
+
+	PMEM_PAGE_LOG_BLOCK*		plog_block;
+	//plog_hash_t*				item;
+
+	ulint hashed;
+	byte* log_des;
+	byte* temp;
+	
+	mlog_id_t type;
+	ulint space, page_no;
+	uint16_t check_size;
+	
+	uint64_t rec_lsn;
+	uint64_t write_off;
+	uint64_t old_off;
+	uint32_t write_size;
+	uint32_t max_size;
+	
+#if defined(UNIV_PMEMOBJ_PPL_STAT)
+	uint64_t start_time, end_time;
+	uint64_t t1, t2;
+#endif	
+
+#if defined (UNIV_PMEM_SIM_LATENCY)
+	uint64_t start_cycle, end_cycle;
+#endif
+
+
+	assert(rec_size > 0);
+
+	temp = mlog_parse_initial_log_record(
+			log_src, log_src + rec_size, &type, &space, &page_no);
+	check_size = mach_read_from_2(temp);
+
+	assert (check_size == rec_size);
+	assert (type < MLOG_BIGGEST_TYPE);
+	temp += 2;
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+	/*a compact rec is at most one byte longer than the full rec*/
+	max_size = rec_size + 1;
+#else
+	max_size = rec_size;
+#endif
+	max_size += PMEM_PPL_REC_CHECK_RESERVE;
+	
+	/*The last bucket is reserved for space 0*/	
+	n = ppl->n_buckets;
+
+	PMEM_LOG_HASH_KEY(hashed, key, n);
+
+	assert(hashed < n);
+
+retry:
+	pline = D_RW(D_RW(ppl->buckets)[hashed]);
+	TOID_ASSIGN(logbuf, (pline->logbuf).oid);
+	plogbuf = D_RW(pline->logbuf);
+	
+#if defined(UNIV_PMEMOBJ_PPL_STAT)
+	start_time = ut_time_us(NULL);
+#endif	
+	/*WARNING this lock may become bottle neck*/
+	pm_rwlock_wrlock(pop, &pline->lock, pline->lock_psi);
+
+#if defined(UNIV_PMEMOBJ_PPL_STAT)
 	end_time = ut_time_us(NULL);
 	pline->log_write_lock_wait_time += (end_time - start_time);
 	pline->n_log_write++;
@@ -1638,7 +2430,7 @@ retry:
 	if (pline->is_flushing ||
 		plogbuf->state == PMEM_LOG_BUF_IN_FLUSH)
 	{
-		pmemobj_rwlock_unlock(pop, &pline->lock);
+		pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 		
 		/*wait for a logbuf available*/
 		os_event_wait(pline->log_flush_event);
@@ -1649,24 +2441,32 @@ retry:
 	////////////////////////////////////////////
 	// (1) Handle full log buf (if any)
 	// /////////////////////////////////////////
-	if (plogbuf->cur_off + rec_size > plogbuf->size) {
+	if (plogbuf->cur_off + max_size > plogbuf->size) {
 		pline->is_flushing = true;
 		os_event_reset(pline->log_flush_event);
 
-get_free_buf:
-		// (1.1) Get a free log buf
 #if defined(UNIV_PMEMOBJ_PPL_STAT)
 	t1 = ut_time_us(NULL);
 #endif	
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+		// (1.1) Get a free log buf from the magazine of this CPU
+		TOID(PMEM_PAGE_LOG_BUF) free_buf = pm_ppl_depot_get(pop, ppl, pline);
+#else
+get_free_buf:
+		// (1.1) Get a free log buf
 		pfreepool = D_RW(ppl->free_pool);
-		pmemobj_rwlock_wrlock(pop, &pfreepool->lock);
+		pm_rwlock_wrlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
 
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+		TOID(PMEM_PAGE_LOG_BUF) free_buf = __pm_ppl_numa_pick_free_buf(ppl, pfreepool, pline);
+#else
 		TOID(PMEM_PAGE_LOG_BUF) free_buf = POBJ_LIST_FIRST (&pfreepool->head);
+#endif
 		if (pfreepool->cur_free_bufs == 0 || 
 				TOID_IS_NULL(free_buf)){
 			//no empty free logbuf, wait for an available one
-			pmemobj_rwlock_unlock(pop, &pfreepool->lock);
+			pm_rwlock_unlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
 			os_event_wait(ppl->free_log_pool_event);
 			goto get_free_buf;
 		}
@@ -1674,7 +2474,8 @@ get_free_buf:
 		pfreepool->cur_free_bufs--;
 		
 		os_event_reset(ppl->free_log_pool_event);
-		pmemobj_rwlock_unlock(pop, &pfreepool->lock);
+		pm_rwlock_unlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
+#endif /* UNIV_PMEMOBJ_PPL_MAGAZINE */
 
 		assert(D_RW(free_buf)->cur_off == PMEM_LOG_BUF_HEADER_SIZE);
 		assert(D_RW(free_buf)->n_recs == 0);
@@ -1701,22 +2502,38 @@ get_free_buf:
 		//move the diskaddr on the line ahead, the written size should be aligned with 512B for DIRECT_IO works
 		pline->diskaddr += plogbuf->size;
 #if defined (UNIV_PMEMOBJ_PERSIST)
-		pmemobj_persist(pop, &pline->diskaddr, sizeof(pline->diskaddr));
+		pm_persist(pop, &pline->diskaddr, sizeof(pline->diskaddr));
 #endif
 
 		// (1.4) write log rec on new buf
 		D_RW(free_buf)->hashed_id = pline->hashed_id; 
 		
-		log_des = ppl->p_align + D_RW(free_buf)->pmemaddr + D_RW(free_buf)->cur_off;
-
+		log_des = PMEM_LOG_BUF_DATA(ppl, D_RW(free_buf)) + D_RW(free_buf)->cur_off;
+
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+		write_size = pm_ppl_write_compact_rec(pop, pline, D_RW(free_buf),
+				log_des + PMEM_PPL_REC_CHECK_SIZE, log_src, rec_size, temp,
+				type, space, page_no, key, &rec_lsn);
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		pm_ppl_seal_rec(pop, log_des, write_size,
+				pline->hashed_id, pline->diskaddr);
+#endif
+#else
 		/*assign LSN right before write rec*/
 		rec_lsn = ut_time_us(NULL);	
 		mach_write_to_8(temp, rec_lsn);
 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		pm_ppl_write_checked_rec(pop, log_des, log_src, rec_size,
+				pline->hashed_id, pline->diskaddr);
+#else
 		pm_write_log_rec_low(pop,
 				log_des,
 				log_src,
 				rec_size);
+#endif
+		write_size = rec_size;
+#endif
 		D_RW(free_buf)->n_recs++;
 
 		D_RW(free_buf)->state = PMEM_LOG_BUF_IN_USED;
@@ -1724,13 +2541,13 @@ get_free_buf:
 
 		/*IMPORTANT: always update offset after updating plog_block*/
 		old_off = D_RW(free_buf)->cur_off;
-		D_RW(free_buf)->cur_off += rec_size;
+		D_RW(free_buf)->cur_off += write_size + PMEM_PPL_REC_CHECK_SIZE;
 		
 #if defined (UNIV_PMEM_SIM_LATENCY)
 		PMEM_DELAY(start_cycle, end_cycle, 11 * pmw->PMEM_SIM_CPU_CYCLES); 
 #endif
 		// (1.5) write the header. This header is needed when recovery,
-		byte* header = ppl->p_align + plogbuf->pmemaddr + 0;
+		byte* header = PMEM_LOG_BUF_DATA(ppl, plogbuf) + 0;
 		byte* ptr = header;
 		mach_write_to_4(ptr, plogbuf->cur_off);
 		ptr += 4;
@@ -1753,10 +2570,14 @@ get_free_buf:
 		/*we update metadata on plogblock and flushing logbuf in non-critical section*/
 
 		/*(2) Get the plogblock*/	
-		pmemobj_rwlock_wrlock(pop, &pline->meta_lock);
+		pm_rwlock_wrlock(pop, &pline->meta_lock, pline->meta_lock_psi);
 		//item = pm_ppl_hash_check_and_add(pop, ppl, pline, key); 
 		plog_block = pm_ppl_hash_check_and_add(pop, ppl, pline, key);	
-		pmemobj_rwlock_unlock(pop, &pline->meta_lock);
+#if !defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+		/*with the reclaimer, hold meta_lock until lastLSN is set, the
+		 * reclaimer resets a block only if lastLSN <= the flushed pageLSN*/
+		pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 
 		//assert(item->block_off < pline->max_blocks);
 
@@ -1772,15 +2593,15 @@ get_free_buf:
 			plog_block->start_diskaddr = pline->diskaddr;
 			plog_block->firstLSN = rec_lsn;
 
-			plog_block->first_rec_size = rec_size;
+			plog_block->first_rec_size = write_size;
 			plog_block->first_rec_type = type;
 
 #if defined (UNIV_PMEMOBJ_PERSIST)
-			pmemobj_persist(pop, &plog_block->start_off, sizeof(plog_block->start_off));
-			pmemobj_persist(pop, &plog_block->start_diskaddr, sizeof(plog_block->start_diskaddr));
-			pmemobj_persist(pop, &plog_block->firstLSN, sizeof(plog_block->firstLSN));
-			pmemobj_persist(pop, &plog_block->first_rec_size, sizeof(plog_block->first_rec_size));
-			pmemobj_persist(pop, &plog_block->first_rec_type, sizeof(plog_block->first_rec_type));
+			pm_persist(pop, &plog_block->start_off, sizeof(plog_block->start_off));
+			pm_persist(pop, &plog_block->start_diskaddr, sizeof(plog_block->start_diskaddr));
+			pm_persist(pop, &plog_block->firstLSN, sizeof(plog_block->firstLSN));
+			pm_persist(pop, &plog_block->first_rec_size, sizeof(plog_block->first_rec_size));
+			pm_persist(pop, &plog_block->first_rec_type, sizeof(plog_block->first_rec_type));
 #endif
 
 #if defined (UNIV_PMEM_SIM_LATENCY)
@@ -1791,7 +2612,7 @@ get_free_buf:
 				//pline->oldest_block_id = item->block_off;
 				pline->oldest_block_id = plog_block->id;
 #if defined (UNIV_PMEMOBJ_PERSIST)
-				pmemobj_persist(pop, &pline->oldest_block_id, sizeof(pline->oldest_block_id));
+				pm_persist(pop, &pline->oldest_block_id, sizeof(pline->oldest_block_id));
 #endif
 
 #if defined (UNIV_PMEM_SIM_LATENCY)
@@ -1806,20 +2627,23 @@ get_free_buf:
 
 		}
 		plog_block->lastLSN = rec_lsn;
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+		pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 #if defined (UNIV_PMEM_SIM_LATENCY)
 		PMEM_DELAY(start_cycle, end_cycle, pmw->PMEM_SIM_CPU_CYCLES); 
 #endif
 
 		/*persist the plogblock*/
 #if defined (UNIV_PMEMOBJ_PERSIST)
-		pmemobj_persist(pop, D_RW(free_buf), sizeof(PMEM_PAGE_LOG_BUF));
-		pmemobj_persist(pop, plogbuf, sizeof(PMEM_PAGE_LOG_BUF));
+		pm_persist(pop, D_RW(free_buf), sizeof(PMEM_PAGE_LOG_BUF));
+		pm_persist(pop, plogbuf, sizeof(PMEM_PAGE_LOG_BUF));
 #endif
 
 		// (1.6) assign a pointer in the flusher to the full log buf, this function return immediately 
 		pm_log_buf_assign_flusher(ppl, plogbuf);
 
-		pmemobj_rwlock_unlock(pop, &pline->lock);
+		pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 		/* end critical section */
 		//pmemobj_rwlock_unlock(pop, &pline->lock);
 		return rec_lsn;
@@ -1827,12 +2651,28 @@ get_free_buf:
 	else {
 		/*regular case, remember that this thread is holding the general lock now*/
 
-		log_des = ppl->p_align + plogbuf->pmemaddr + plogbuf->cur_off;
+		log_des = PMEM_LOG_BUF_DATA(ppl, plogbuf) + plogbuf->cur_off;
+#if defined (UNIV_PMEMOBJ_PPL_COMPACT)
+		write_size = pm_ppl_write_compact_rec(pop, pline, plogbuf,
+				log_des + PMEM_PPL_REC_CHECK_SIZE, log_src, rec_size, temp,
+				type, space, page_no, key, &rec_lsn);
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		pm_ppl_seal_rec(pop, log_des, write_size,
+				pline->hashed_id, pline->diskaddr);
+#endif
+#else
 		/*assign LSN right before write rec*/
 		rec_lsn = ut_time_us(NULL);	
 		mach_write_to_8(temp, rec_lsn);
 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		pm_ppl_write_checked_rec(pop, log_des, log_src, rec_size,
+				pline->hashed_id, pline->diskaddr);
+#else
 		pm_write_log_rec_low(pop, log_des, log_src, rec_size);
+#endif
+		write_size = rec_size;
+#endif
 
 		plogbuf->n_recs++;
 		if (plogbuf->cur_off == PMEM_LOG_BUF_HEADER_SIZE)		  {
@@ -1841,10 +2681,13 @@ get_free_buf:
 		}
 
 		old_off = plogbuf->cur_off;
-		plogbuf->cur_off += rec_size;
+		plogbuf->cur_off += write_size + PMEM_PPL_REC_CHECK_SIZE;
+#if !defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+		/*with the checksums, recovery finds the end of the recs itself*/
 		if (PERSIST_AT_WRITE){
-			pmemobj_persist(pop, &plogbuf->cur_off, sizeof(plogbuf->cur_off));
+			pm_persist(pop, &plogbuf->cur_off, sizeof(plogbuf->cur_off));
 		}
+#endif
 
 #if defined (UNIV_PMEM_SIM_LATENCY)
 		PMEM_DELAY(start_cycle, end_cycle, 5 * pmw->PMEM_SIM_CPU_CYCLES); 
@@ -1853,15 +2696,20 @@ get_free_buf:
 			/*comment this line to disable checkpoint (for debugging)*/
 			pm_ppl_check_for_ckpt(pop, ppl, pline, plogbuf, rec_lsn);
 		}
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+		pm_ppl_update_line_pressure(ppl, pline, pline->diskaddr + plogbuf->cur_off);
+#endif
 		/*early realease the general lock*/
-		pmemobj_rwlock_unlock(pop, &pline->lock);
+		pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 
 		/*(2) Get the plogblock*/	
 		//test unblock
-		pmemobj_rwlock_wrlock(pop, &pline->meta_lock);
+		pm_rwlock_wrlock(pop, &pline->meta_lock, pline->meta_lock_psi);
 		//item = pm_ppl_hash_check_and_add(pop, ppl, pline, key); 
 		plog_block = pm_ppl_hash_check_and_add(pop, ppl, pline, key);
-		pmemobj_rwlock_unlock(pop, &pline->meta_lock);
+#if !defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+		pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 
 		//assert(item->block_off < pline->max_blocks);
 
@@ -1879,15 +2727,15 @@ get_free_buf:
 			plog_block->start_diskaddr = pline->diskaddr;
 			plog_block->firstLSN = rec_lsn;
 
-			plog_block->first_rec_size = rec_size;
+			plog_block->first_rec_size = write_size;
 			plog_block->first_rec_type = type;
 
 #if defined (UNIV_PMEMOBJ_PERSIST)
-			pmemobj_persist(pop, &plog_block->start_off, sizeof(plog_block->start_off));
-			pmemobj_persist(pop, &plog_block->start_diskaddr, sizeof(plog_block->start_diskaddr));
-			pmemobj_persist(pop, &plog_block->firstLSN, sizeof(plog_block->firstLSN));
-			pmemobj_persist(pop, &plog_block->first_rec_size, sizeof(plog_block->first_rec_size));
-			pmemobj_persist(pop, &plog_block->first_rec_type, sizeof(plog_block->first_rec_type));
+			pm_persist(pop, &plog_block->start_off, sizeof(plog_block->start_off));
+			pm_persist(pop, &plog_block->start_diskaddr, sizeof(plog_block->start_diskaddr));
+			pm_persist(pop, &plog_block->firstLSN, sizeof(plog_block->firstLSN));
+			pm_persist(pop, &plog_block->first_rec_size, sizeof(plog_block->first_rec_size));
+			pm_persist(pop, &plog_block->first_rec_type, sizeof(plog_block->first_rec_type));
 #endif
 
 #if defined (UNIV_PMEM_SIM_LATENCY)
@@ -1898,7 +2746,7 @@ get_free_buf:
 				//pline->oldest_block_id = item->block_off;
 				pline->oldest_block_id = plog_block->id;
 #if defined (UNIV_PMEMOBJ_PERSIST)
-				pmemobj_persist(pop, &pline->oldest_block_id, sizeof(pline->oldest_block_id));
+				pm_persist(pop, &pline->oldest_block_id, sizeof(pline->oldest_block_id));
 #endif
 #if defined (UNIV_PMEM_SIM_LATENCY)
 				PMEM_DELAY(start_cycle, end_cycle, pmw->PMEM_SIM_CPU_CYCLES); 
@@ -1908,14 +2756,21 @@ get_free_buf:
 			/*insert the pair (offset, bid) into the set*/
 			write_off = plog_block->start_diskaddr + plog_block->start_off;
 
-			pmemobj_rwlock_wrlock(pop, &pline->meta_lock);
+#if !defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+			pm_rwlock_wrlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 			//pline->offset_map->insert( std::make_pair(write_off, item->block_off));
 			pline->offset_map->insert( std::make_pair(write_off, plog_block));
-			pmemobj_rwlock_unlock(pop, &pline->meta_lock);
+#if !defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+			pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 
 		}
 
 		plog_block->lastLSN = rec_lsn;
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+		pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+#endif
 #if defined (UNIV_PMEM_SIM_LATENCY)
 		PMEM_DELAY(start_cycle, end_cycle, pmw->PMEM_SIM_CPU_CYCLES); 
 #endif
@@ -1988,16 +2843,95 @@ pm_ppl_check_for_ckpt(
 		//pline->ckpt_lsn = cur_lsn - delta ;
 		
 		//update the global checkpoint lsn	
-		pmemobj_rwlock_wrlock(pop, &ppl->ckpt_lock);
+		pm_rwlock_wrlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
 		if (ppl->max_oldest_lsn < pline->ckpt_lsn){
 			ppl->max_oldest_lsn = pline->ckpt_lsn;
 			//pmemobj_persist(pop, &ppl->max_oldest_lsn, sizeof(ppl->max_oldest_lsn));
 		}
 
 		//printf("SET is_req_checkpoint to true pline %zu \n", pline->hashed_id);
-		pmemobj_rwlock_unlock(pop, &ppl->ckpt_lock);
+		pm_rwlock_unlock(pop, &ppl->ckpt_lock, ppl->ckpt_lock_psi);
+	}
+}
+
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+/*
+ * Recompute the log space pressure of a line: the distance from its oldest
+ * block to the current write offset, in percent of the log file size
+ * Called under pline->lock on write and under pline->meta_lock on reset,
+ * so the value is only a hint for the page cleaner
+ * ppl->n_pressured_lines counts the lines at or above srv_ppl_flush_pressure_pct
+ * @param[in] ppl
+ * @param[in] pline
+ * @param[in] cur_off	current write offset of the line (diskaddr + cur_off of the logbuf)
+ * */
+void
+pm_ppl_update_line_pressure(
+			PMEM_PAGE_PART_LOG*			ppl,
+			PMEM_PAGE_LOG_HASHED_LINE*	pline,
+			uint64_t					cur_off)
+{
+	uint64_t oldest_off;
+	uint64_t age;
+	uint32_t old_pct;
+	uint32_t new_pct;
+	uint32_t threshold = (uint32_t) srv_ppl_flush_pressure_pct;
+
+	PMEM_PAGE_LOG_BLOCK*	plog_block_oldest;
+
+	new_pct = 0;
+	if (pline->oldest_block_id != UINT32_MAX){
+		plog_block_oldest = D_RW(D_RW(pline->arr)[pline->oldest_block_id]);
+		oldest_off = plog_block_oldest->start_diskaddr + plog_block_oldest->start_off;
+
+		if (cur_off > oldest_off){
+			age = cur_off - oldest_off;
+			new_pct = (uint32_t) ut_min((uint64_t) 100,
+					(age * 100) / (PMEM_LOG_FILE_SIZE * UNIV_PAGE_SIZE));
+		}
+	}
+
+	do {
+		old_pct = pline->pressure_pct;
+		if (old_pct == new_pct){
+			return;
+		}
+	} while (!__sync_bool_compare_and_swap(&pline->pressure_pct, old_pct, new_pct));
+
+	if (old_pct < threshold && new_pct >= threshold){
+		__sync_fetch_and_add(&ppl->n_pressured_lines, 1);
+	}
+	else if (old_pct >= threshold && new_pct < threshold){
+		__sync_fetch_and_sub(&ppl->n_pressured_lines, 1);
+	}
+}
+
+/*
+ * Get the highest log space pressure over all lines, in percent
+ * Return 0 without scanning when no line is pressured
+ * */
+ulint
+pm_ppl_get_max_pressure(
+			PMEM_PAGE_PART_LOG*			ppl)
+{
+	uint64_t i;
+	ulint max_pct = 0;
+	PMEM_PAGE_LOG_HASHED_LINE* pline;
+
+	if (ppl->n_pressured_lines == 0){
+		return 0;
+	}
+
+	for (i = 0; i < ppl->n_buckets; i++){
+		pline = D_RW(D_RW(ppl->buckets)[i]);
+		if (pline->pressure_pct > max_pct){
+			max_pct = pline->pressure_pct;
+		}
 	}
+
+	return max_pct;
 }
+#endif /* UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH */
 
 /*
  * Write REDO log records from mtr's heap to PMEM in partitioned-log   
@@ -2076,7 +3010,7 @@ pm_ppl_write(
 
 		pline = D_RW(ptt->spec_bucket);
 
-		pmemobj_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock);
+		pm_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock, pline->entry_lock_psi);
 
 		TOID_ASSIGN (entry, (D_RW(pline->arr)[local_id]).oid);
 		pe = D_RW(entry);
@@ -2115,7 +3049,7 @@ pm_ppl_write(
 				pe,
 				false);
 		}
-		pmemobj_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock);
+		pm_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock, pline->entry_lock_psi);
 		return ret;
 	} //end special case
 	else if (type == PMEM_EID_NEW) 
@@ -2139,7 +3073,7 @@ retry:
 		//a reallocate may come here
 		for (; i < pline->max_entries; i++)
 		{
-			pmemobj_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[i])->lock);
+			pm_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[i])->lock, pline->entry_lock_psi);
 			TOID_ASSIGN (entry, (D_RW(pline->arr)[i]).oid);
 			pe = D_RW(entry);
 			if (pe->state == PMEM_TX_FREE){
@@ -2169,11 +3103,11 @@ retry:
 						true);
 
 				//handle update log
-				pmemobj_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[i])->lock);
+				pm_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[i])->lock, pline->entry_lock_psi);
 	//printf("END case A add log for tid %zu at entry %zu n_recs %zu ret %zu \n", tid,  entry_id, n_recs, ret);
 				return ret;
 			}	
-			pmemobj_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[i])->lock);
+			pm_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[i])->lock, pline->entry_lock_psi);
 			//jump a litte far to avoid contention
 			//i = (i + JUMP_STEP) % pline->n_entries;
 			//try again
@@ -2202,7 +3136,7 @@ retry:
 		assert(pline);
 		
 		//pmemobj_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[bucket_id])->lock);
-		pmemobj_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock);
+		pm_rwlock_wrlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock, pline->entry_lock_psi);
 		TOID_ASSIGN (entry, (D_RW(pline->arr)[local_id]).oid);
 		pe = D_RW(entry);
 
@@ -2223,7 +3157,7 @@ retry:
 				pe,
 				false);
 
-		pmemobj_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock);
+		pm_rwlock_unlock(pop, &D_RW(D_RW(pline->arr)[local_id])->lock, pline->entry_lock_psi);
 
 	//printf("END case B add log for tid %zu at entry %zu n_recs %zu bucket_id %zu local_id %zu \n", tid,  entry_id, n_recs, bucket_id, local_id);
 		return ret;
@@ -2694,7 +3628,7 @@ __pm_write_log_buf(
 retry:
 
 	pline = D_RW(D_RW(ppl->buckets)[hashed_id]);	
-	pmemobj_rwlock_wrlock(pop, &pline->lock);
+	pm_rwlock_wrlock(pop, &pline->lock, pline->lock_psi);
 	
 #if defined(UNIV_PMEMOBJ_PPL_STAT)
 	end_time = ut_time_us(NULL);
@@ -2705,7 +3639,7 @@ retry:
 		
 	plogbuf = D_RW(pline->logbuf);
 	if (plogbuf->state == PMEM_LOG_BUF_IN_FLUSH){
-		pmemobj_rwlock_unlock(pop, &pline->lock);
+		pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 		goto retry;
 	}	
 	////////////////////////////////////////////	
@@ -2742,7 +3676,7 @@ get_free_buf:
 #if defined(UNIV_PMEMOBJ_PPL_STAT)
 	start_time = ut_time_us(NULL);
 #endif	
-		pmemobj_rwlock_wrlock(pop, &pfreepool->lock);
+		pm_rwlock_wrlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
 
 #if defined(UNIV_PMEMOBJ_PPL_STAT)
 	end_time = ut_time_us(NULL);
@@ -2750,11 +3684,15 @@ get_free_buf:
 	pline->n_log_flush++;
 
 #endif	
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+		TOID(PMEM_PAGE_LOG_BUF) free_buf = __pm_ppl_numa_pick_free_buf(ppl, pfreepool, pline);
+#else
 		TOID(PMEM_PAGE_LOG_BUF) free_buf = POBJ_LIST_FIRST (&pfreepool->head);
+#endif
 		if (pfreepool->cur_free_bufs == 0 || 
 				TOID_IS_NULL(free_buf)){
 
-			pmemobj_rwlock_unlock(pop, &pfreepool->lock);
+			pm_rwlock_unlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
 			os_event_wait(ppl->free_log_pool_event);
 			goto get_free_buf;
 		}
@@ -2762,7 +3700,7 @@ get_free_buf:
 		pfreepool->cur_free_bufs--;
 		
 		os_event_reset(ppl->free_log_pool_event);
-		pmemobj_rwlock_unlock(pop, &pfreepool->lock);
+		pm_rwlock_unlock(pop, &pfreepool->lock, ppl->free_pool_lock_psi);
 		
 		// (1.2) switch the free log buf with the full log buf
 
@@ -2783,7 +3721,7 @@ get_free_buf:
 		pline->diskaddr += plogbuf->size;
 
 		// (1.3)write log rec on new buf
-		log_des = ppl->p_align + D_RW(free_buf)->pmemaddr + D_RW(free_buf)->cur_off;
+		log_des = PMEM_LOG_BUF_DATA(ppl, D_RW(free_buf)) + D_RW(free_buf)->cur_off;
 
 		if (is_first_write){
 			//Note that we save the offset and diskaddr for the first write of this block
@@ -2804,7 +3742,7 @@ get_free_buf:
 		D_RW(free_buf)->state = PMEM_LOG_BUF_IN_USED;
 
 		// (1.4) write acutal log buffer's size to the header
-		byte* header = ppl->p_align + plogbuf->pmemaddr + 0;
+		byte* header = PMEM_LOG_BUF_DATA(ppl, plogbuf) + 0;
 		mach_write_to_4(header, plogbuf->cur_off);
 		//fill zero the un-used len
 		uint64_t dif_len = plogbuf->size - plogbuf->cur_off;
@@ -2827,7 +3765,7 @@ get_free_buf:
 		assert(plog_block->lastLSN <= *rec_lsn);
 		plog_block->lastLSN = *rec_lsn;
 
-		log_des = ppl->p_align + plogbuf->pmemaddr + plogbuf->cur_off;
+		log_des = PMEM_LOG_BUF_DATA(ppl, plogbuf) + plogbuf->cur_off;
 
 		pm_write_log_rec_low(pop,
 				log_des,
@@ -2839,7 +3777,7 @@ get_free_buf:
 		}
 		plogbuf->cur_off += rec_size;
 	}
-	pmemobj_rwlock_unlock(pop, &pline->lock);
+	pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 
 }
 
@@ -2953,12 +3891,16 @@ pm_handle_finished_log_buf(
 		fil_node_t*				node,
 		PMEM_PAGE_LOG_BUF*		plogbuf)
 {
-	TOID(PMEM_PAGE_LOG_BUF) logbuf;
 	PMEM_PAGE_LOG_HASHED_LINE* pline;
+#if !defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	TOID(PMEM_PAGE_LOG_BUF) logbuf;
 	PMEM_PAGE_LOG_FREE_POOL* pfree_pool;
+#endif
 
 	assert(plogbuf);
+#if !defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
 	TOID_ASSIGN(logbuf, plogbuf->self);
+#endif
 	
 	if (plogbuf->state == PMEM_LOG_BUF_FREE){
 		/*this logbuf has already reset*/
@@ -2987,20 +3929,27 @@ pm_handle_finished_log_buf(
 		pline = D_RW(D_RW(ppl->buckets)[plogbuf->hashed_id]);
 		assert(pline);
 
-		pmemobj_rwlock_wrlock(pop, &pline->lock);
+		pm_rwlock_wrlock(pop, &pline->lock, pline->lock_psi);
 		TOID_ASSIGN(pline->tail_logbuf, (plogbuf->next).oid);
 		TOID_ASSIGN(next->prev, OID_NULL);
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+		/*off the chain before it is free, see pm_ppl_depot_init()*/
+		pm_persist(pop, &pline->tail_logbuf, sizeof(pline->tail_logbuf));
+#endif
 
 		//update the persistent addr
 		pline->write_diskaddr = plogbuf->diskaddr + plogbuf->size;
 
-		pmemobj_rwlock_unlock(pop, &pline->lock);
+		pm_rwlock_unlock(pop, &pline->lock, pline->lock_psi);
 		
 	} else {
 		// the rare case
 		printf("===> PMEM_INFO rare case of finishing AIO logbuf_id %zu prev_id %zu next_id %zu. This may cause log holes when recover\n", plogbuf->id, prev->id, next->id);
 		TOID_ASSIGN(prev->next, (plogbuf->next).oid);
 		TOID_ASSIGN(next->prev, (plogbuf->prev).oid);
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+		pm_persist(pop, &prev->next, sizeof(prev->next));
+#endif
 		//we don't update persistent addr
 	}
 	/* (3) reset the log buf */
@@ -3012,15 +3961,34 @@ pm_handle_finished_log_buf(
 	plogbuf->n_recs = 0;
 	plogbuf->hashed_id = -1;
 	plogbuf->diskaddr = 123; //dummy offset 
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+	/*the next line using this logbuf must not see the old recs*/
+	pmemobj_memset_persist(pop,
+			PMEM_LOG_BUF_DATA(ppl, plogbuf) + PMEM_LOG_BUF_HEADER_SIZE, 0, 2);
+#endif
 
 	TOID_ASSIGN(plogbuf->next, OID_NULL);
 	TOID_ASSIGN(plogbuf->prev, OID_NULL);
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	pm_persist(pop, plogbuf, sizeof(*plogbuf));
+#endif
 
 	//reset the ref in line
 
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	/*the reclaimer returns the finished bufs to the free pool in bulk*/
+	if (pm_ppl_reclaimer_post(ppl->reclaimer, 0, 0, 0, plogbuf)) {
+		return;
+	}
+	ppl->reclaimer->n_inline++;
+#endif
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	pm_ppl_depot_put(pop, ppl, plogbuf);
+#else
 	//put back to the free pool
 	pfree_pool = D_RW(ppl->free_pool);
-	pmemobj_rwlock_wrlock(pop, &pfree_pool->lock);
+	pm_rwlock_wrlock(pop, &pfree_pool->lock, ppl->free_pool_lock_psi);
 
 	POBJ_LIST_INSERT_TAIL(pop, &pfree_pool->head, logbuf, list_entries);
 	pfree_pool->cur_free_bufs++;
@@ -3028,7 +3996,8 @@ pm_handle_finished_log_buf(
 	//wakeup who is waitting for free_pool available
 	os_event_set(ppl->free_log_pool_event);
 
-	pmemobj_rwlock_unlock(pop, &pfree_pool->lock);
+	pm_rwlock_unlock(pop, &pfree_pool->lock, ppl->free_pool_lock_psi);
+#endif /* UNIV_PMEMOBJ_PPL_MAGAZINE */
 }
 
 /*
@@ -3109,7 +4078,7 @@ __pm_write_log_rec_low(
 			uint64_t				size)
 {
 
-	pmemobj_memcpy_persist(
+	pm_memcpy_persist(
 			pop, 
 			log_des,
 			log_src,
@@ -3187,7 +4156,7 @@ pm_ppl_commit(
 	pe = D_RW(entry);
 	assert(pe->tid == tid);
 
-	pmemobj_rwlock_wrlock(pop, &pe->lock);
+	pm_rwlock_wrlock(pop, &pe->lock, pline->entry_lock_psi);
 	
 	//(2) for each pageref in the entry	
 	for (i = 0; i < pe->max_dp_entries; i++) 
@@ -3212,7 +4181,7 @@ pm_ppl_commit(
 
 	__reset_TT_entry(pop, ppl, pe);
 	
-	pmemobj_rwlock_unlock(pop, &pe->lock);
+	pm_rwlock_unlock(pop, &pe->lock, pline->entry_lock_psi);
 	return;
 }
 
@@ -3374,11 +4343,70 @@ pm_ppl_set_flush_state(
 	}
 }
 /*
- * Called when the buffer pool flush page to PB-NVM
- *
- * key (in): the fold of space_id and page_no
- * pageLSN (in): pageLSN in the header of the flushed page
- * */
+ * Update pline->oldest_block_id after the oldest block is reset
+ * The caller holds pline->meta_lock
+ * @param[in] ppl
+ * @param[in] pline
+ * @param[in] write_off - the write offset of the reset oldest block
+ * */
+static void
+__pm_ppl_update_oldest_on_reset(
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline,
+		uint64_t					write_off)
+{
+	uint64_t min_off;
+
+	if (pline->offset_map->size() > 0){
+		/*need to update*/
+		auto it = pline->offset_map->begin();
+
+		PMEM_PAGE_LOG_BLOCK* pmin_log_block = it->second;
+		assert(pmin_log_block);
+
+		min_off = pmin_log_block->start_diskaddr + pmin_log_block->start_off;
+		
+		if (min_off <= write_off){
+			printf("===> PMEM_ERROR in pm_ppl_flush_page, second smallest (%zu + %zu = %zu) must larger than the smallest write_off %zu\n",
+					pmin_log_block->start_diskaddr,
+					pmin_log_block->start_off,
+					pmin_log_block->start_diskaddr + pmin_log_block->start_off,
+					write_off);
+			assert(pmin_log_block->start_diskaddr + pmin_log_block->start_off > write_off);
+		}
+
+		/*consider whether reset the checkpoint flag*/
+		if (pline->is_req_checkpoint){
+			/*The checkpoint request condition*/
+			if (pmin_log_block->firstLSN > pline->ckpt_lsn){
+				pline->is_req_checkpoint = false;
+			}
+		}
+
+		/*update the oldest_block_id for this pline*/
+		pline->oldest_block_id = pmin_log_block->id;
+	}
+	else {
+		/*this flusing block is the last one in the pline
+		 **/
+		pline->oldest_block_id = ULONG_MAX;	
+		pline->is_req_checkpoint = false;
+	}
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+	/*the writer may switch the logbuf meanwhile, the pressure is a hint*/
+	pm_ppl_update_line_pressure(ppl, pline,
+			pline->diskaddr + D_RO(pline->logbuf)->cur_off);
+#else
+	(void) ppl;
+#endif
+}
+
+/*
+ * Called when the buffer pool flush page to PB-NVM
+ *
+ * key (in): the fold of space_id and page_no
+ * pageLSN (in): pageLSN in the header of the flushed page
+ * */
 void 
 pm_ppl_flush_page(
 		PMEMobjpool*		pop,
@@ -3399,7 +4427,6 @@ pm_ppl_flush_page(
 	
 	uint64_t write_off;
 	uint64_t block_id;
-	uint64_t min_off;
 
 	//plog_hash_t* item;
 
@@ -3416,6 +4443,14 @@ pm_ppl_flush_page(
 
 	assert (hashed < n);
 
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	/*defer the reset to the reclaimer, do it inline if the queue is full*/
+	if (pm_ppl_reclaimer_post(ppl->reclaimer, key, pageLSN, hashed, NULL)) {
+		return;
+	}
+	ppl->reclaimer->n_inline++;
+#endif
+
 	TOID_ASSIGN(line, (D_RW(ppl->buckets)[hashed]).oid);
 	pline = D_RW(line);
 	assert(pline);
@@ -3428,7 +4463,7 @@ pm_ppl_flush_page(
 	if (key_it != pline->key_map->end()){
 		plog_block = key_it->second;
 
-		pmemobj_rwlock_wrlock(pop, &pline->meta_lock);
+		pm_rwlock_wrlock(pop, &pline->meta_lock, pline->meta_lock_psi);
 		pmemobj_rwlock_wrlock(pop, &plog_block->lock);
 
 		/*save the write_off before reseting*/	
@@ -3441,7 +4476,7 @@ pm_ppl_flush_page(
 		//pmemobj_rwlock_unlock(pop, &plog_block->lock);
 
 #if defined (UNIV_PMEMOBJ_PERSIST)
-		pmemobj_persist(pop, plog_block, sizeof(PMEM_PAGE_LOG_BLOCK));
+		pm_persist(pop, plog_block, sizeof(PMEM_PAGE_LOG_BLOCK));
 #endif
 
 #if defined (UNIV_PMEM_SIM_LATENCY)
@@ -3472,44 +4507,10 @@ pm_ppl_flush_page(
 		 * */
 		if (block_id == pline->oldest_block_id)
 		{
-			if (pline->offset_map->size() > 0){
-				/*need to update*/
-				auto it = pline->offset_map->begin();
-
-				PMEM_PAGE_LOG_BLOCK* pmin_log_block = it->second;
-				assert(pmin_log_block);
-
-				min_off = pmin_log_block->start_diskaddr + pmin_log_block->start_off;
-				
-				if (min_off <= write_off){
-					printf("===> PMEM_ERROR in pm_ppl_flush_page, second smallest (%zu + %zu = %zu) must larger than the smallest write_off %zu\n",
-							pmin_log_block->start_diskaddr,
-							pmin_log_block->start_off,
-							pmin_log_block->start_diskaddr + pmin_log_block->start_off,
-							write_off);
-					assert(pmin_log_block->start_diskaddr + pmin_log_block->start_off > write_off);
-				}
-
-				/*consider whether reset the checkpoint flag*/
-				if (pline->is_req_checkpoint){
-					/*The checkpoint request condition*/
-					if (pmin_log_block->firstLSN > pline->ckpt_lsn){
-						pline->is_req_checkpoint = false;
-					}
-				}
-
-				/*update the oldest_block_id for this pline*/
-				pline->oldest_block_id = pmin_log_block->id;
-			}
-			else {
-				/*this flusing block is the last one in the pline
-				 **/
-				pline->oldest_block_id = ULONG_MAX;	
-				pline->is_req_checkpoint = false;
-			}
+			__pm_ppl_update_oldest_on_reset(ppl, pline, write_off);
 		}
 
-		pmemobj_rwlock_unlock(pop, &pline->meta_lock);
+		pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
 
 	} //end if 
 	else {
@@ -3536,6 +4537,628 @@ pm_ppl_flush_page(
 	return;
 }
 
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+/////////////////// RECLAIMER ////////////////////
+/*
+ * Allocate the reclaimer queue
+ * @param[in] size - number of slots, rounded up to a power of 2
+ * @param[in] batch - max notices per batch
+ * */
+PMEM_PPL_RECLAIMER*
+pm_ppl_reclaimer_init(
+		uint64_t			size,
+		uint64_t			batch)
+{
+	uint64_t i;
+	PMEM_PPL_RECLAIMER* reclaimer;
+
+	reclaimer = static_cast<PMEM_PPL_RECLAIMER*> (
+			calloc(1, sizeof(PMEM_PPL_RECLAIMER)));
+
+	reclaimer->size = 1;
+	while (reclaimer->size < size) {
+		reclaimer->size <<= 1;
+	}
+	reclaimer->mask = reclaimer->size - 1;
+	reclaimer->batch = batch;
+
+	reclaimer->cells = static_cast<PMEM_RECLAIM_CELL*> (
+			calloc(reclaimer->size, sizeof(PMEM_RECLAIM_CELL)));
+	for (i = 0; i < reclaimer->size; i++) {
+		reclaimer->cells[i].seq = i;
+	}
+	reclaimer->buf = static_cast<PMEM_RECLAIM_NOTICE*> (
+			calloc(batch, sizeof(PMEM_RECLAIM_NOTICE)));
+
+	reclaimer->enq_pos = 0;
+	reclaimer->deq_pos = 0;
+	reclaimer->n_workers = 0;
+	reclaimer->event = os_event_create("pm_ppl_reclaimer_event");
+
+	return reclaimer;
+}
+
+/*
+ * Wait for the reclaimer thread to exit, process what is left and free
+ * */
+void
+pm_ppl_reclaimer_close(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl)
+{
+	PMEM_PPL_RECLAIMER* reclaimer = ppl->reclaimer;
+
+	if (reclaimer == NULL) {
+		return;
+	}
+
+	os_event_set(reclaimer->event);
+	while (reclaimer->n_workers > 0) {
+		os_thread_sleep(10000);
+	}
+
+	while (pm_ppl_reclaimer_drain(pop, ppl) > 0) {}
+
+	printf("PMEM_INFO: PPL reclaimer batches %zu reset blocks %zu skipped %zu returned bufs %zu inline %zu\n",
+			reclaimer->n_batches,
+			reclaimer->n_reset_blocks,
+			reclaimer->n_skipped,
+			reclaimer->n_returned_bufs,
+			reclaimer->n_inline);
+
+	os_event_destroy(reclaimer->event);
+	free(reclaimer->buf);
+	free(reclaimer->cells);
+	free(reclaimer);
+	ppl->reclaimer = NULL;
+}
+
+/*
+ * Post a notice, called from the IO completion path
+ * A slot is claimed by CAS on enq_pos, then published by its seq
+ * @return false if the queue is full, the caller does the work inline
+ * */
+bool
+pm_ppl_reclaimer_post(
+		PMEM_PPL_RECLAIMER*	reclaimer,
+		uint64_t			key,
+		uint64_t			pageLSN,
+		uint64_t			hashed_id,
+		PMEM_PAGE_LOG_BUF*	plogbuf)
+{
+	PMEM_RECLAIM_CELL*	cell;
+	uint64_t			pos;
+	uint64_t			seq;
+	int64_t				dif;
+
+	if (reclaimer->n_workers == 0) {
+		/*not started yet or already exited*/
+		return false;
+	}
+
+	pos = reclaimer->enq_pos;
+	for (;;) {
+		cell = &reclaimer->cells[pos & reclaimer->mask];
+		seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+		dif = (int64_t) seq - (int64_t) pos;
+
+		if (dif == 0) {
+			if (__sync_bool_compare_and_swap(
+						&reclaimer->enq_pos, pos, pos + 1)) {
+				break;
+			}
+			pos = reclaimer->enq_pos;
+		} else if (dif < 0) {
+			/*full*/
+			return false;
+		} else {
+			pos = reclaimer->enq_pos;
+		}
+	}
+
+	cell->notice.key = key;
+	cell->notice.pageLSN = pageLSN;
+	cell->notice.hashed_id = hashed_id;
+	cell->notice.plogbuf = plogbuf;
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+	/*a writer may wait for a free log buf, otherwise wake up per batch*/
+	if (plogbuf != NULL ||
+			pos + 1 - reclaimer->deq_pos >= reclaimer->batch) {
+		os_event_set(reclaimer->event);
+	}
+	return true;
+}
+
+/*Sort the page notices by line, the log buf notices go last*/
+static bool
+__pm_reclaim_notice_less(
+		const PMEM_RECLAIM_NOTICE&	a,
+		const PMEM_RECLAIM_NOTICE&	b)
+{
+	if ((a.plogbuf == NULL) != (b.plogbuf == NULL)) {
+		return (a.plogbuf == NULL);
+	}
+	return (a.hashed_id < b.hashed_id);
+}
+
+/*
+ * Reset the log blocks of the flushed pages of a line under one
+ * meta_lock hold
+ * A block that got a rec newer than the flushed pageLSN is kept, the
+ * next flush of the page resets it
+ * */
+static void
+__pm_ppl_reclaim_line(
+		PMEMobjpool*				pop,
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline,
+		PMEM_RECLAIM_NOTICE*		notices,
+		ulint						n)
+{
+	PMEM_PPL_RECLAIMER*		reclaimer = ppl->reclaimer;
+	PMEM_PAGE_LOG_BLOCK*	plog_block;
+	uint64_t				write_off;
+	uint64_t				oldest_off = 0;
+	bool					is_oldest_reset = false;
+	ulint					i;
+
+	pm_rwlock_wrlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+
+	for (i = 0; i < n; i++) {
+		auto key_it = pline->key_map->find(notices[i].key);
+
+		if (key_it == pline->key_map->end()) {
+			continue;
+		}
+		plog_block = key_it->second;
+
+		pmemobj_rwlock_wrlock(pop, &plog_block->lock);
+
+		if (plog_block->lastLSN > notices[i].pageLSN) {
+			pmemobj_rwlock_unlock(pop, &plog_block->lock);
+			reclaimer->n_skipped++;
+			continue;
+		}
+
+		write_off = plog_block->start_diskaddr + plog_block->start_off;
+		if (plog_block->id == pline->oldest_block_id) {
+			is_oldest_reset = true;
+			oldest_off = write_off;
+		}
+
+		__reset_page_log_block(plog_block);
+#if defined (UNIV_PMEMOBJ_PERSIST)
+		pm_persist(pop, plog_block, sizeof(PMEM_PAGE_LOG_BLOCK));
+#endif
+		pline->key_map->erase(key_it);
+
+		auto offset_it = pline->offset_map->find(write_off);
+		if (offset_it != pline->offset_map->end()){
+			pline->offset_map->erase(offset_it);
+		}
+		else {
+			printf("==> logical error write_off %zu is not existed in offset_map of pline %zu\n", write_off, pline->hashed_id);
+			assert(0);
+		}
+
+		pmemobj_rwlock_unlock(pop, &plog_block->lock);
+		reclaimer->n_reset_blocks++;
+	}
+
+	if (is_oldest_reset) {
+		__pm_ppl_update_oldest_on_reset(ppl, pline, oldest_off);
+	}
+
+	pm_rwlock_unlock(pop, &pline->meta_lock, pline->meta_lock_psi);
+}
+
+/*
+ * Take up to batch notices from the queue and process them
+ * (1) page notices: per line, see __pm_ppl_reclaim_line()
+ * (2) log buf notices: one insert pass on the free pool, one signal
+ * @return number of processed notices
+ * */
+ulint
+pm_ppl_reclaimer_drain(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl)
+{
+	PMEM_PPL_RECLAIMER*			reclaimer = ppl->reclaimer;
+	PMEM_RECLAIM_NOTICE*		buf = reclaimer->buf;
+	PMEM_RECLAIM_CELL*			cell;
+#if !defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	PMEM_PAGE_LOG_FREE_POOL*	pfree_pool;
+	TOID(PMEM_PAGE_LOG_BUF)		logbuf;
+#endif
+	uint64_t					pos;
+	ulint						n, i, start;
+
+	pmemobj_rwlock_wrlock(pop, &reclaimer->consumer_lock);
+
+	/*(0) dequeue, single consumer*/
+	n = 0;
+	pos = reclaimer->deq_pos;
+	while (n < reclaimer->batch) {
+		cell = &reclaimer->cells[pos & reclaimer->mask];
+		if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+			break;
+		}
+		buf[n++] = cell->notice;
+		__atomic_store_n(&cell->seq, pos + reclaimer->size,
+				__ATOMIC_RELEASE);
+		pos++;
+	}
+	reclaimer->deq_pos = pos;
+
+	if (n == 0) {
+		pmemobj_rwlock_unlock(pop, &reclaimer->consumer_lock);
+		return 0;
+	}
+
+	std::sort(buf, buf + n, __pm_reclaim_notice_less);
+
+	/*(1) page notices, per line*/
+	i = 0;
+	while (i < n && buf[i].plogbuf == NULL) {
+		start = i;
+		while (i < n && buf[i].plogbuf == NULL &&
+				buf[i].hashed_id == buf[start].hashed_id) {
+			i++;
+		}
+		__pm_ppl_reclaim_line(pop, ppl,
+				D_RW(D_RW(ppl->buckets)[buf[start].hashed_id]),
+				buf + start, i - start);
+	}
+
+	/*(2) log bufs, already reset by pm_handle_finished_log_buf()*/
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+	for (; i < n; i++) {
+		pm_ppl_depot_put(pop, ppl, buf[i].plogbuf);
+		reclaimer->n_returned_bufs++;
+	}
+#else
+	if (i < n) {
+		pfree_pool = D_RW(ppl->free_pool);
+		pm_rwlock_wrlock(pop, &pfree_pool->lock, ppl->free_pool_lock_psi);
+		for (; i < n; i++) {
+			TOID_ASSIGN(logbuf, buf[i].plogbuf->self);
+			POBJ_LIST_INSERT_TAIL(pop, &pfree_pool->head, logbuf, list_entries);
+			pfree_pool->cur_free_bufs++;
+			reclaimer->n_returned_bufs++;
+		}
+		os_event_set(ppl->free_log_pool_event);
+		pm_rwlock_unlock(pop, &pfree_pool->lock, ppl->free_pool_lock_psi);
+	}
+#endif /* UNIV_PMEMOBJ_PPL_MAGAZINE */
+
+	reclaimer->n_batches++;
+	pmemobj_rwlock_unlock(pop, &reclaimer->consumer_lock);
+
+	return n;
+}
+#endif /* UNIV_PMEMOBJ_PPL_RECLAIMER */
+
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+/*
+ * Return a log buf that no line owns to the free state
+ * */
+void
+pm_ppl_depot_reset_buf(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_PAGE_LOG_BUF*	plogbuf)
+{
+	plogbuf->state = PMEM_LOG_BUF_FREE;
+	plogbuf->cur_off = PMEM_LOG_BUF_HEADER_SIZE;
+	plogbuf->n_recs = 0;
+	plogbuf->hashed_id = -1;
+	TOID_ASSIGN(plogbuf->next, OID_NULL);
+	TOID_ASSIGN(plogbuf->prev, OID_NULL);
+	pm_persist(pop, plogbuf, sizeof(*plogbuf));
+#if defined (UNIV_PMEMOBJ_PPL_CHECKSUM)
+	pmemobj_memset_persist(pop,
+			PMEM_LOG_BUF_DATA(ppl, plogbuf) + PMEM_LOG_BUF_HEADER_SIZE, 0, 2);
+#endif
+}
+
+/*
+ * Build the depot from the log bufs that no line owns
+ * A line owns its current logbuf and the bufs on its chain from tail_logbuf
+ * that still carry its hashed_id, so a buf taken from the depot but not yet
+ * linked at the crash, or a finished buf still on a stale chain, comes back
+ * @param[in] batch - bufs moved at once between a magazine and the depot
+ * */
+PMEM_PPL_FREE_DEPOT*
+pm_ppl_depot_init(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		ulint				batch)
+{
+	PMEM_PPL_FREE_DEPOT*		depot;
+	PMEM_PAGE_LOG_HASHED_LINE*	pline;
+	TOID(PMEM_PAGE_LOG_BUF)		logbuf;
+	PMEM_PAGE_LOG_BUF*			plogbuf;
+	uint64_t					i, n_total, n_steps;
+	ulint						n_reset = 0;
+	long						n_cpus;
+
+	n_total = ppl->n_buckets + D_RO(ppl->free_pool)->max_bufs;
+	std::vector<bool> owned(n_total, false);
+
+	/*(1) the chains of the lines*/
+	for (i = 0; i < ppl->n_buckets; i++) {
+		pline = D_RW(D_RW(ppl->buckets)[i]);
+
+		owned[D_RO(pline->logbuf)->id] = true;
+
+		TOID_ASSIGN(logbuf, (pline->tail_logbuf).oid);
+		for (n_steps = 0; !TOID_IS_NULL(logbuf) && n_steps < n_total; n_steps++) {
+			if (TOID_EQUALS(logbuf, pline->logbuf)) {
+				break;
+			}
+			plogbuf = D_RW(logbuf);
+			if (plogbuf->hashed_id != (int64_t) pline->hashed_id ||
+				plogbuf->state == PMEM_LOG_BUF_FREE) {
+				break;
+			}
+			owned[plogbuf->id] = true;
+			TOID_ASSIGN(logbuf, (plogbuf->next).oid);
+		}
+	}
+
+	depot = static_cast<PMEM_PPL_FREE_DEPOT*> (
+			calloc(1, sizeof(PMEM_PPL_FREE_DEPOT)));
+	depot->max_bufs = n_total;
+	depot->bufs = static_cast<PMEMoid*> (calloc(n_total, sizeof(PMEMoid)));
+	depot->batch = batch;
+
+	n_cpus = sysconf(_SC_NPROCESSORS_CONF);
+	depot->n_mags = (n_cpus > 0) ? n_cpus : 1;
+	depot->mags = static_cast<PMEM_PPL_MAGAZINE*> (
+			calloc(depot->n_mags, sizeof(PMEM_PPL_MAGAZINE)));
+	for (i = 0; i < depot->n_mags; i++) {
+		depot->mags[i].bufs = static_cast<PMEMoid*> (
+				calloc(2 * batch, sizeof(PMEMoid)));
+	}
+
+	/*(2) any other buf is free*/
+	POBJ_FOREACH_TYPE(pop, logbuf) {
+		plogbuf = D_RW(logbuf);
+		assert(plogbuf->id < n_total);
+
+		if (owned[plogbuf->id]) {
+			continue;
+		}
+		if (plogbuf->state != PMEM_LOG_BUF_FREE) {
+			pm_ppl_depot_reset_buf(pop, ppl, plogbuf);
+			n_reset++;
+		}
+		depot->bufs[depot->n++] = logbuf.oid;
+	}
+
+	printf("PMEMOBJ_INFO: PPL depot has %zu free log bufs (%zu reset), %zu magazines of %zu bufs\n",
+			depot->n, n_reset, depot->n_mags, 2 * batch);
+
+	return depot;
+}
+
+void
+pm_ppl_depot_close(
+		PMEM_PAGE_PART_LOG*	ppl)
+{
+	PMEM_PPL_FREE_DEPOT* depot = ppl->depot;
+	ulint i;
+
+	if (depot == NULL) {
+		return;
+	}
+
+	printf("PMEM_INFO: PPL depot refills %zu drains %zu steals %zu waits %zu\n",
+			depot->n_refills,
+			depot->n_drains,
+			depot->n_steals,
+			depot->n_waits);
+
+	for (i = 0; i < depot->n_mags; i++) {
+		free(depot->mags[i].bufs);
+	}
+	free(depot->mags);
+	free(depot->bufs);
+	free(depot);
+	ppl->depot = NULL;
+}
+
+/*the magazine of the CPU the caller is running on*/
+static inline PMEM_PPL_MAGAZINE*
+__pm_ppl_cur_magazine(
+		PMEM_PPL_FREE_DEPOT*	depot)
+{
+	int cpu = sched_getcpu();
+
+	if (cpu < 0) {
+		cpu = 0;
+	}
+	return &depot->mags[cpu % depot->n_mags];
+}
+
+/*
+ * Pop a buf from a magazine, on the NUMA node of the line if one of the top
+ * PMEM_NUMA_FREE_BUF_SCAN bufs is
+ * The caller holds mag->lock
+ * @return false if the magazine is empty
+ * */
+static bool
+__pm_ppl_magazine_pop(
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PPL_MAGAZINE*			mag,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline,
+		PMEMoid*					oid)
+{
+	ulint i;
+
+	if (mag->n == 0) {
+		return false;
+	}
+	i = mag->n - 1;
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	if (ppl->n_nodes > 1) {
+		ulint node = pm_numa_node_of_line(pline->hashed_id,
+				ppl->n_buckets, ppl->n_nodes);
+		ulint j;
+
+		for (j = 0; j < PMEM_NUMA_FREE_BUF_SCAN && j < mag->n; j++) {
+			PMEM_PAGE_LOG_BUF* p = static_cast<PMEM_PAGE_LOG_BUF*> (
+					pmemobj_direct(mag->bufs[mag->n - 1 - j]));
+			if (p->node == node) {
+				i = mag->n - 1 - j;
+				break;
+			}
+		}
+	}
+#endif
+
+	*oid = mag->bufs[i];
+	mag->bufs[i] = mag->bufs[mag->n - 1];
+	mag->n--;
+
+	return true;
+}
+
+/*
+ * Take a buf from the magazine of this CPU, refill it from the depot when it
+ * is empty, steal from the other magazines when the depot is empty too
+ * @return false if there is no free buf
+ * */
+static bool
+__pm_ppl_depot_take(
+		PMEMobjpool*				pop,
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline,
+		PMEMoid*					oid)
+{
+	PMEM_PPL_FREE_DEPOT*	depot = ppl->depot;
+	PMEM_PPL_MAGAZINE*		mag = __pm_ppl_cur_magazine(depot);
+	PMEM_PPL_MAGAZINE*		other;
+	ulint					k, i;
+	bool					found;
+
+	pmemobj_rwlock_wrlock(pop, &mag->lock);
+	if (mag->n == 0) {
+		pmemobj_rwlock_wrlock(pop, &depot->lock);
+		k = ut_min(depot->batch, depot->n);
+		depot->n -= k;
+		memcpy(mag->bufs, depot->bufs + depot->n, k * sizeof(PMEMoid));
+		if (k > 0) {
+			depot->n_refills++;
+		}
+		pmemobj_rwlock_unlock(pop, &depot->lock);
+		mag->n = k;
+	}
+	found = __pm_ppl_magazine_pop(ppl, mag, pline, oid);
+	pmemobj_rwlock_unlock(pop, &mag->lock);
+
+	if (found) {
+		return true;
+	}
+
+	/*the free bufs are in the magazines of the other CPUs*/
+	for (i = 0; i < depot->n_mags; i++) {
+		other = &depot->mags[i];
+		if (other == mag || other->n == 0) {
+			continue;
+		}
+		pmemobj_rwlock_wrlock(pop, &other->lock);
+		found = __pm_ppl_magazine_pop(ppl, other, pline, oid);
+		pmemobj_rwlock_unlock(pop, &other->lock);
+		if (found) {
+			__sync_fetch_and_add(&depot->n_steals, 1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Get a free log buf for pline, wait for a finished flush if there is none
+ * The buf is marked as owned by the line before the caller links it
+ * The caller holds pline->lock
+ * */
+TOID(PMEM_PAGE_LOG_BUF)
+pm_ppl_depot_get(
+		PMEMobjpool*				pop,
+		PMEM_PAGE_PART_LOG*			ppl,
+		PMEM_PAGE_LOG_HASHED_LINE*	pline)
+{
+	PMEM_PPL_FREE_DEPOT*	depot = ppl->depot;
+	TOID(PMEM_PAGE_LOG_BUF)	logbuf;
+	PMEMoid					oid;
+	int64_t					sig_count;
+
+	while (!__pm_ppl_depot_take(pop, ppl, pline, &oid)) {
+		/*register before the last check, a put after it sees the waiter*/
+		__sync_fetch_and_add(&depot->n_waiters, 1);
+		sig_count = os_event_reset(ppl->free_log_pool_event);
+
+		if (__pm_ppl_depot_take(pop, ppl, pline, &oid)) {
+			__sync_fetch_and_sub(&depot->n_waiters, 1);
+			break;
+		}
+
+		__sync_fetch_and_add(&depot->n_waits, 1);
+		os_event_wait_low(ppl->free_log_pool_event, sig_count);
+		__sync_fetch_and_sub(&depot->n_waiters, 1);
+	}
+
+	TOID_ASSIGN(logbuf, oid);
+	D_RW(logbuf)->hashed_id = pline->hashed_id;
+	D_RW(logbuf)->state = PMEM_LOG_BUF_IN_USED;
+	pm_persist(pop, &D_RW(logbuf)->hashed_id, sizeof(int64_t));
+	pm_persist(pop, &D_RW(logbuf)->state, sizeof(PMEM_LOG_BUF_STATE));
+
+	return logbuf;
+}
+
+/*
+ * Put a reset log buf in the magazine of this CPU, a full magazine gives its
+ * older half to the depot
+ * */
+void
+pm_ppl_depot_put(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		PMEM_PAGE_LOG_BUF*	plogbuf)
+{
+	PMEM_PPL_FREE_DEPOT*	depot = ppl->depot;
+	PMEM_PPL_MAGAZINE*		mag = __pm_ppl_cur_magazine(depot);
+	ulint					batch = depot->batch;
+
+	assert(plogbuf->state == PMEM_LOG_BUF_FREE);
+
+	pmemobj_rwlock_wrlock(pop, &mag->lock);
+	if (mag->n == 2 * batch) {
+		pmemobj_rwlock_wrlock(pop, &depot->lock);
+		assert(depot->n + batch <= depot->max_bufs);
+		memcpy(depot->bufs + depot->n, mag->bufs, batch * sizeof(PMEMoid));
+		depot->n += batch;
+		depot->n_drains++;
+		pmemobj_rwlock_unlock(pop, &depot->lock);
+
+		memmove(mag->bufs, mag->bufs + batch, batch * sizeof(PMEMoid));
+		mag->n = batch;
+	}
+	mag->bufs[mag->n++] = plogbuf->self;
+	pmemobj_rwlock_unlock(pop, &mag->lock);
+
+	__sync_synchronize();
+	if (depot->n_waiters > 0) {
+		os_event_set(ppl->free_log_pool_event);
+	}
+}
+#endif /* UNIV_PMEMOBJ_PPL_MAGAZINE */
+
 /*
  * Update the oldest_block_off in pline
  * Called in pm_ppl_flush_page()
@@ -3754,30 +5377,22 @@ __print_DPT(
 		PMEM_DPT*			pdpt,
 		FILE* f)
 {
-	uint32_t n, k, i, j;
+	uint32_t i;
 	uint64_t total_free_entries = 0;
-	uint64_t total_idle_entries = 0;
 	uint64_t line_max_txref = 0;
 	uint64_t all_max_txref = 0;
 
-	TOID(PMEM_DPT_HASHED_LINE) line;
 	PMEM_DPT_HASHED_LINE* pline;
-
-	TOID(PMEM_DPT_ENTRY) e;
 	PMEM_DPT_ENTRY* pe;
-
-	n = pdpt->n_buckets;
-	k = pdpt->n_entries_per_bucket;
+	DPT_MAP::iterator it;
 
 	fprintf(f, "\n============ Print Idle Entries in DPT ======= \n"); 
-	//printf("\n============ Print Idle Entries in DPT ======= \n"); 
 	for (i = 0; i < pdpt->n_buckets; i++) {
-		pline = D_RW(D_RW(pdpt->buckets)[i]);
-		fprintf(f, "DPT line %zu n_free %zu n_idle %zu load factor %zu\n", pline->hashed_id, pline->n_free, pline->n_idle, pline->n_entries);
-		//printf("line %zu n_free %zu n_idle %zu load factor %zu\n", pline->hashed_id, pline->n_free, pline->n_idle, pline->n_entries);
+		pline = &pdpt->buckets[i];
+		fprintf(f, "DPT line %zu n_free %zu load factor %zu\n", pline->hashed_id, pline->n_free, pline->n_entries);
 		total_free_entries += pline->n_free;
-		for (j = 0; j < pline->n_entries; j ++){
-			pe =  D_RW(D_RW(pline->arr)[j]);
+		for (it = pline->map->begin(); it != pline->map->end(); ++it){
+			pe = it->second;
 			assert(pe != NULL);
 			if (line_max_txref < pe->max_txref_size)
 				line_max_txref = pe->max_txref_size;
@@ -3790,9 +5405,7 @@ __print_DPT(
 	}
 	fprintf(f, "Total free entries in DPT:\t%zu\n", total_free_entries);
 	fprintf(f, "max txref size in DPT:\t%zu\n", all_max_txref);
-	//printf("Total free entries in DPT:\t%zu\n", total_free_entries);
 	fprintf(f, "============ End Idle Entries in DPT ======= \n"); 
-	//printf("============ End Idle Entries in DPT ======= \n"); 
 }
 
 /*print number of active transaction in the TT*/
@@ -0,0 +1,278 @@
+/*
+ * Author; Trong-Dat Nguyen
+ * NUMA placement of the per-page partitioned log
+ * Using libpmemobj
+ * Copyright (c) 2018 VLDB Lab - Sungkyunkwan University
+ * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <stdint.h> //for uint64_t
+#include <assert.h>
+#include <unistd.h> //for access()
+#include <sched.h> //for sched_getcpu()
+#include <pthread.h> //for pthread_setaffinity_np()
+
+#include "univ.i"
+#include "srv0srv.h"
+#include "my_pmem_common.h"
+#include "my_pmemobj.h"
+
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+
+/*The topology is read once from sysfs, it also shows the fake nodes of numa=fake=N*/
+#define PMEM_NUMA_SYSFS_NODE "/sys/devices/system/node/node%lu/cpulist"
+
+static ulint		pm_numa_nodes = 1;
+static cpu_set_t	pm_numa_node_cpus[PMEM_NUMA_MAX_NODES];
+static uint8_t		pm_numa_cpu_node[PMEM_NUMA_MAX_CPUS];
+static ulint		pm_numa_next_node = 0;
+
+/*
+ * Parse a cpulist ("0-3,8,10-11") and add the cpus to the set of the node
+ * @return number of cpus of the node
+ * */
+static ulint
+__pm_numa_parse_cpulist(
+		const char*	list,
+		ulint		node)
+{
+	const char*	p = list;
+	char*		end;
+	ulint		n = 0;
+	long		first;
+	long		last;
+
+	while (*p != '\0' && *p != '\n') {
+		first = strtol(p, &end, 10);
+		if (end == p) {
+			break;
+		}
+		last = first;
+		p = end;
+
+		if (*p == '-') {
+			last = strtol(p + 1, &end, 10);
+			p = end;
+		}
+
+		for (long cpu = first; cpu <= last && cpu < PMEM_NUMA_MAX_CPUS; cpu++) {
+			CPU_SET(cpu, &pm_numa_node_cpus[node]);
+			pm_numa_cpu_node[cpu] = (uint8_t) node;
+			n++;
+		}
+
+		if (*p == ',') {
+			p++;
+		}
+	}
+
+	return n;
+}
+
+/*
+ * Read the NUMA nodes and their cpus
+ * Nodes are taken from node0 up to the first one missing or without cpu,
+ * otherwise (no sysfs, one node) we run as a single node
+ * */
+void
+pm_numa_init()
+{
+	char	path[256];
+	char	buf[4096];
+	FILE*	f;
+	ulint	node;
+
+	memset(pm_numa_cpu_node, 0, sizeof(pm_numa_cpu_node));
+
+	for (node = 0; node < PMEM_NUMA_MAX_NODES; node++) {
+		CPU_ZERO(&pm_numa_node_cpus[node]);
+
+		sprintf(path, PMEM_NUMA_SYSFS_NODE, node);
+		f = fopen(path, "r");
+		if (f == NULL) {
+			break;
+		}
+
+		if (fgets(buf, sizeof(buf), f) == NULL
+			|| __pm_numa_parse_cpulist(buf, node) == 0) {
+			fclose(f);
+			break;
+		}
+		fclose(f);
+	}
+
+	pm_numa_nodes = (node > 0) ? node : 1;
+
+	printf("PMEMOBJ_INFO: NUMA %zu node(s)\n", pm_numa_nodes);
+}
+
+ulint
+pm_numa_n_nodes()
+{
+	return pm_numa_nodes;
+}
+
+/*the node of the cpu the caller is running on*/
+ulint
+pm_numa_cur_node()
+{
+	int cpu;
+
+	if (pm_numa_nodes <= 1) {
+		return 0;
+	}
+
+	cpu = sched_getcpu();
+	if (cpu < 0 || cpu >= PMEM_NUMA_MAX_CPUS) {
+		return 0;
+	}
+
+	return pm_numa_cpu_node[cpu];
+}
+
+/*
+ * Lines are split in n_nodes contiguous ranges, line i is on node
+ * i * n_nodes / n_lines
+ * */
+ulint
+pm_numa_node_of_line(
+		uint64_t	hashed_id,
+		uint64_t	n_lines,
+		ulint		n_nodes)
+{
+	if (n_nodes <= 1) {
+		return 0;
+	}
+
+	return (ulint) ((hashed_id * n_nodes) / n_lines);
+}
+
+/*
+ * Restrict the calling thread to the cpus of a node
+ * @return true if the thread is bound
+ * */
+bool
+pm_numa_bind_thread(
+		ulint		node)
+{
+	int ret;
+
+	if (pm_numa_nodes <= 1) {
+		return false;
+	}
+
+	ret = pthread_setaffinity_np(pthread_self(),
+			sizeof(cpu_set_t), &pm_numa_node_cpus[node % pm_numa_nodes]);
+	if (ret != 0) {
+		printf("PMEM_WARN: cannot bind thread to NUMA node %zu, error %d\n", node, ret);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Bind the calling worker to the nodes round-robin
+ * @return the node of the worker
+ * */
+ulint
+pm_numa_bind_next_thread()
+{
+	ulint node;
+
+	if (pm_numa_nodes <= 1) {
+		return 0;
+	}
+
+	node = __sync_fetch_and_add(&pm_numa_next_node, 1) % pm_numa_nodes;
+	pm_numa_bind_thread(node);
+
+	return node;
+}
+
+/*
+ * Open the per-node pools listed in srv_pmem_numa_home_dirs (';' separated,
+ * one dir per node, in node order). A node without dir keeps its data in
+ * pmw->pop
+ * @param[in] pmw
+ * @param[in] n_nodes	number of nodes of the layout
+ * @param[in] sizes		bytes needed on each node to create a pool, NULL to
+ * open the existing pools only
+ * */
+void
+pm_numa_open_pools(
+		PMEM_WRAPPER*	pmw,
+		ulint			n_nodes,
+		const uint64_t*	sizes)
+{
+	char	path[PMEM_MAX_FILE_NAME_LENGTH];
+	char*	dirs;
+	char*	dir;
+	char*	saveptr;
+	ulint	node;
+	size_t	pool_size;
+
+	for (node = 0; node < PMEM_NUMA_MAX_NODES; node++) {
+		pmw->node_pops[node] = NULL;
+	}
+
+	if (n_nodes <= 1 || srv_pmem_numa_home_dirs == NULL
+		|| srv_pmem_numa_home_dirs[0] == '\0') {
+		return;
+	}
+
+	dirs = strdup(srv_pmem_numa_home_dirs);
+
+	for (node = 0, dir = strtok_r(dirs, ";", &saveptr);
+		 node < n_nodes && dir != NULL;
+		 node++, dir = strtok_r(NULL, ";", &saveptr)) {
+
+		snprintf(path, sizeof(path), "%s/%s", dir, PMEMOBJ_NUMA_FILE_NAME);
+
+		if (file_exists(path) != 0) {
+			if (sizes == NULL) {
+				printf("PMEMOBJ_ERROR: the NUMA pool %s of node %zu is missing\n", path, node);
+				assert(0);
+			}
+			/*the region, one log buf for alignment and the pool metadata*/
+			pool_size = sizes[node] + 64 * 1024 * 1024;
+			if (pool_size < PMEMOBJ_MIN_POOL) {
+				pool_size = PMEMOBJ_MIN_POOL;
+			}
+			pmw->node_pops[node] = pmemobj_create(path,
+					POBJ_LAYOUT_NAME(my_pmemobj),
+					pool_size, S_IWRITE | S_IREAD);
+		}
+		else {
+			pmw->node_pops[node] = pmemobj_open(path,
+					POBJ_LAYOUT_NAME(my_pmemobj));
+		}
+
+		if (pmw->node_pops[node] == NULL) {
+			printf("PMEMOBJ_ERROR: failed to create or open the NUMA pool %s: %s\n",
+					path, pmemobj_errormsg());
+			assert(0);
+		}
+		printf("PMEMOBJ_INFO: NUMA node %zu uses pool %s\n", node, path);
+	}
+
+	free(dirs);
+}
+
+void
+pm_numa_close_pools(
+		PMEM_WRAPPER*	pmw)
+{
+	ulint node;
+
+	for (node = 0; node < PMEM_NUMA_MAX_NODES; node++) {
+		if (pmw->node_pops[node] != NULL) {
+			pmemobj_close(pmw->node_pops[node]);
+			pmw->node_pops[node] = NULL;
+		}
+	}
+}
+#endif /* UNIV_PMEMOBJ_PPL_NUMA */
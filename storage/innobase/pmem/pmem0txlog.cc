@@ -0,0 +1,879 @@
+/*
+ * Author; Trong-Dat Nguyen
+ * MySQL Per-Transaction Partitioned Log with NVDIMM
+ * Using libpmemobj
+ * Copyright (c) 2018 VLDB Lab - Sungkyunkwan University
+ * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <stdint.h> //for uint64_t
+#include <assert.h>
+
+#include "mtr0log.h"
+#include "trx0purge.h" //for purge_sys
+#include "my_pmem_common.h"
+#include "my_pmemobj.h"
+
+#include "os0file.h"
+
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+
+/*wait time (us) for a reclaimed block before the next scan*/
+#define PMEM_TX_LOG_WAIT_US 100000
+/*number of shared blocks for the mtrs without transaction*/
+#define PMEM_TX_LOG_N_SYS_SLOTS 64
+
+static PMEM_TX_LOG_BLOCK*
+__ptxl_get_free_block(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			tid,
+		uint64_t			prev_bid);
+
+static void
+__ptxl_free_block(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		PMEM_TX_LOG_BLOCK*	plog_block);
+
+static void
+__ptxl_check_and_reclaim(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		PMEM_TX_LOG_BLOCK*	plog_block);
+
+PMEM_TX_PART_LOG* pm_pop_get_ptxl(PMEMobjpool* pop) {
+	TOID(PMEM_TX_PART_LOG) log;
+	//get the first object in pmem has type PMEM_TX_PART_LOG
+	log = POBJ_FIRST(pop, PMEM_TX_PART_LOG);
+
+	if (TOID_IS_NULL(log)) {
+		return NULL;
+	}
+	else {
+		PMEM_TX_PART_LOG *ptxl = D_RW(log);
+		if(!ptxl) {
+			printf("PMEMOBJ_ERROR: message: %s\n",  pmemobj_errormsg() );
+			return NULL;
+		}
+		return ptxl;
+	}
+}
+
+/*Open the per-transaction log of the pool, allocate it if it does not exist
+ * The geometry is fixed at allocation time, the DRAM parts (DPT, LSN
+ * counter, free block counter) are rebuilt on every open
+ * */
+void
+pm_wrapper_tx_log_alloc_or_open(
+		PMEM_WRAPPER*	pmw,
+		uint64_t		n_buckets,
+		uint64_t		n_blocks_per_bucket,
+		uint64_t		block_size) {
+
+	PMEM_TX_PART_LOG*	ptxl;
+	uint64_t			i, n, k;
+	uint64_t			now;
+
+	if (!pmw->ptxl) {
+		pmw->ptxl = alloc_pmem_tx_part_log(pmw->pop,
+				n_buckets,
+				n_blocks_per_bucket,
+				block_size);
+
+		if (pmw->ptxl == NULL){
+			printf("PMEMOBJ_ERROR: error when allocate per-tx log in pm_wrapper_tx_log_alloc_or_open()\n");
+			exit(0);
+		}
+
+		pmw->ptxl->is_new = true;
+
+		pm_tx_part_log_bucket_init(pmw->pop,
+				pmw->ptxl,
+				n_buckets,
+				n_blocks_per_bucket,
+				block_size);
+
+		printf("\n=================================\n Footprint of PER-TX log:\n");
+		printf("Log area %zu x %zu blocks x %zu B = %f (MB)\n",
+				n_buckets, n_blocks_per_bucket, block_size,
+				(pmw->ptxl->pmem_tx_log_size * 1.0)/(1024*1024));
+		printf("Total allocated %f (MB)\n",
+				(pmw->ptxl->pmem_alloc_size * 1.0)/(1024*1024));
+		printf(" =================================\n");
+	}
+	else {
+		pmw->ptxl->is_new = false;
+		/*the pool may be mapped at a different address*/
+		byte* p = static_cast<byte*> (pmemobj_direct(pmw->ptxl->data));
+		pmw->ptxl->p_align = static_cast<byte*> (
+				ut_align(p, pmw->ptxl->block_size));
+
+		printf("PMEMOBJ_INFO: open per-tx log %zu x %zu blocks\n",
+				pmw->ptxl->n_buckets, pmw->ptxl->n_blocks_per_bucket);
+	}
+
+	ptxl = pmw->ptxl;
+	n = ptxl->n_buckets;
+	k = ptxl->n_blocks_per_bucket;
+
+	/*DRAM parts*/
+	ptxl->dpt = pm_ptxl_dpt_init(srv_ptxl_dpt_n_lines);
+	ptxl->free_block_event = os_event_create("ptxl_free_block_event");
+
+	ptxl->n_sys_slots = PMEM_TX_LOG_N_SYS_SLOTS;
+	ptxl->sys_bids = (uint64_t*) calloc(
+			ptxl->n_sys_slots, sizeof(uint64_t));
+
+	/*LSNs are unique across restarts*/
+	now = ut_time_us(NULL);
+	ptxl->cur_lsn = pm_ptxl_get_max_lsn(pmw->pop, ptxl);
+	if (ptxl->cur_lsn < now) {
+		ptxl->cur_lsn = now;
+	}
+
+	/*blocks left by the previous run are freed after recovery*/
+	ptxl->n_free_blocks = 0;
+	for (i = 0; i < n * k; i++) {
+		PMEM_TX_LOG_BLOCK* plog_block =
+			pm_ptxl_get_block_by_id(ptxl, i + 1);
+		plog_block->count = 0;
+		if (plog_block->state == PMEM_FREE_LOG_BLOCK) {
+			ptxl->n_free_blocks++;
+		}
+	}
+}
+
+/*Free the DRAM parts, the log itself stays in the pool*/
+void
+pm_wrapper_tx_log_close(
+		PMEM_WRAPPER*	pmw) {
+
+	PMEM_TX_PART_LOG* ptxl = pmw->ptxl;
+
+	if (ptxl == NULL) {
+		return;
+	}
+
+	if (ptxl->dpt != NULL) {
+		pm_ptxl_dpt_free(ptxl->dpt);
+		ptxl->dpt = NULL;
+	}
+	if (ptxl->sys_bids != NULL) {
+		free(ptxl->sys_bids);
+		ptxl->sys_bids = NULL;
+	}
+	if (ptxl->free_block_event != NULL) {
+		os_event_destroy(ptxl->free_block_event);
+	}
+}
+
+/*
+ * Allocate the per-tx log in persistent memory
+ * The data area is n x k blocks plus one block for alignment
+ * */
+PMEM_TX_PART_LOG* alloc_pmem_tx_part_log(
+		PMEMobjpool*	pop,
+		uint64_t		n_buckets,
+		uint64_t		n_blocks_per_bucket,
+		uint64_t		block_size) {
+
+	TOID(PMEM_TX_PART_LOG) ptxl;
+	uint64_t log_size;
+	byte* p;
+
+	log_size = n_buckets * n_blocks_per_bucket * block_size;
+
+	POBJ_ZNEW(pop, &ptxl, PMEM_TX_PART_LOG);
+	PMEM_TX_PART_LOG* ptxl_ptr = D_RW(ptxl);
+
+	ptxl_ptr->pmem_alloc_size = sizeof(PMEM_TX_PART_LOG);
+
+	ptxl_ptr->data = pm_pop_alloc_bytes(pop, log_size + block_size);
+	if (OID_IS_NULL(ptxl_ptr->data)){
+		return NULL;
+	}
+	ptxl_ptr->size = log_size;
+	ptxl_ptr->pmem_tx_log_size = log_size;
+	ptxl_ptr->pmem_alloc_size += log_size + block_size;
+
+	p = static_cast<byte*> (pmemobj_direct(ptxl_ptr->data));
+	ptxl_ptr->p_align = static_cast<byte*> (ut_align(p, block_size));
+
+	ptxl_ptr->dpt = NULL;
+	ptxl_ptr->sys_bids = NULL;
+	ptxl_ptr->free_block_event = NULL;
+
+	pmemobj_persist(pop, ptxl_ptr, sizeof(*ptxl_ptr));
+	return ptxl_ptr;
+}
+
+/*
+ * Allocate the n hashed lines, each has k log blocks
+ * Block (i, j) has id i * k + j + 1 and owns the bytes
+ * [(i * k + j) * block_size, (i * k + j + 1) * block_size) of the data area
+ * */
+void
+pm_tx_part_log_bucket_init(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			n_buckets,
+		uint64_t			n_blocks_per_bucket,
+		uint64_t			block_size) {
+
+	uint64_t i, j, n, k;
+	uint64_t offset;
+
+	PMEM_TX_LOG_HASHED_LINE *pline;
+	PMEM_TX_LOG_BLOCK*	plog_block;
+
+	n = n_buckets;
+	k = n_blocks_per_bucket;
+
+	ptxl->n_buckets = n;
+	ptxl->n_blocks_per_bucket = k;
+	ptxl->block_size = block_size;
+
+	POBJ_ALLOC(pop,
+			&ptxl->buckets,
+			TOID(PMEM_TX_LOG_HASHED_LINE),
+			sizeof(TOID(PMEM_TX_LOG_HASHED_LINE)) * n,
+			NULL,
+			NULL);
+	ptxl->pmem_alloc_size += sizeof(TOID(PMEM_TX_LOG_HASHED_LINE)) * n;
+
+	if (TOID_IS_NULL(ptxl->buckets)) {
+		fprintf(stderr, "POBJ_ALLOC\n");
+	}
+
+	offset = 0;
+	for (i = 0; i < n; i++) {
+		POBJ_ZNEW(pop,
+				&D_RW(ptxl->buckets)[i],
+				PMEM_TX_LOG_HASHED_LINE);
+		ptxl->pmem_alloc_size += sizeof(PMEM_TX_LOG_HASHED_LINE);
+
+		if (TOID_IS_NULL(D_RW(ptxl->buckets)[i])) {
+			fprintf(stderr, "POBJ_ZNEW\n");
+		}
+		pline = D_RW(D_RW(ptxl->buckets)[i]);
+
+		pline->hashed_id = i;
+		pline->n_blocks = k;
+		pline->cur_block_id = 0;
+
+		POBJ_ALLOC(pop,
+				&pline->arr,
+				TOID(PMEM_TX_LOG_BLOCK),
+				sizeof(TOID(PMEM_TX_LOG_BLOCK)) * k,
+				NULL,
+				NULL);
+		ptxl->pmem_alloc_size += sizeof(TOID(PMEM_TX_LOG_BLOCK)) * k;
+
+		for (j = 0; j < k; j++) {
+			POBJ_ZNEW(pop,
+					&D_RW(pline->arr)[j],
+					PMEM_TX_LOG_BLOCK);
+			if (TOID_IS_NULL(D_RW(pline->arr)[j])) {
+				fprintf(stderr, "POBJ_ZNEW\n");
+			}
+			ptxl->pmem_alloc_size += sizeof(PMEM_TX_LOG_BLOCK);
+
+			plog_block = D_RW(D_RW(pline->arr)[j]);
+
+			plog_block->bid = i * k + j + 1;
+			plog_block->pmemaddr = offset;
+			offset += block_size;
+
+			__reset_tx_log_block(plog_block);
+			pmemobj_persist(pop, plog_block, sizeof(*plog_block));
+		}
+		pmemobj_persist(pop, pline, sizeof(*pline));
+	}
+	pmemobj_persist(pop, ptxl, sizeof(*ptxl));
+}
+
+/*Reset the block to free, the caller persists it*/
+void
+__reset_tx_log_block(PMEM_TX_LOG_BLOCK* plog_block) {
+	plog_block->tid = 0;
+	plog_block->cur_off = 0;
+	plog_block->n_log_recs = 0;
+	plog_block->firstLSN = 0;
+	plog_block->lastLSN = 0;
+	plog_block->prev_bid = 0;
+	plog_block->count = 0;
+	plog_block->state = PMEM_FREE_LOG_BLOCK;
+}
+
+PMEM_TX_LOG_BLOCK*
+pm_ptxl_get_block_by_id(
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			bid) {
+	uint64_t i, j;
+	PMEM_TX_LOG_HASHED_LINE* pline;
+
+	assert(bid > 0);
+	i = (bid - 1) / ptxl->n_blocks_per_bucket;
+	j = (bid - 1) % ptxl->n_blocks_per_bucket;
+	assert(i < ptxl->n_buckets);
+
+	pline = D_RW(D_RW(ptxl->buckets)[i]);
+	return D_RW(D_RW(pline->arr)[j]);
+}
+
+/*The largest LSN on the non-free blocks, 0 if all blocks are free*/
+uint64_t
+pm_ptxl_get_max_lsn(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl) {
+	uint64_t i;
+	uint64_t max_lsn = 0;
+
+	for (i = 0; i < ptxl->n_buckets * ptxl->n_blocks_per_bucket; i++) {
+		PMEM_TX_LOG_BLOCK* plog_block =
+			pm_ptxl_get_block_by_id(ptxl, i + 1);
+
+		if (plog_block->state != PMEM_FREE_LOG_BLOCK &&
+			plog_block->lastLSN > max_lsn) {
+			max_lsn = plog_block->lastLSN;
+		}
+	}
+	return max_lsn;
+}
+
+/*Free all blocks, called when recovery is done and the recovered pages
+ * are durable*/
+void
+pm_ptxl_reset_all(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl) {
+	uint64_t i;
+
+	for (i = 0; i < ptxl->n_buckets * ptxl->n_blocks_per_bucket; i++) {
+		PMEM_TX_LOG_BLOCK* plog_block =
+			pm_ptxl_get_block_by_id(ptxl, i + 1);
+
+		if (plog_block->state != PMEM_FREE_LOG_BLOCK) {
+			__reset_tx_log_block(plog_block);
+			pmemobj_persist(pop, plog_block, sizeof(*plog_block));
+		}
+	}
+	for (i = 0; i < ptxl->n_sys_slots; i++) {
+		ptxl->sys_bids[i] = 0;
+	}
+	ptxl->n_free_blocks = ptxl->n_buckets * ptxl->n_blocks_per_bucket;
+}
+
+/////////////// DIRTY PAGE TABLE ///////////////////
+
+PMEM_DPT*
+pm_ptxl_dpt_init(
+		uint64_t			n_lines) {
+	uint64_t i;
+	PMEM_DPT* pdpt;
+
+	pdpt = (PMEM_DPT*) malloc(sizeof(PMEM_DPT));
+	pdpt->n_buckets = n_lines;
+	pdpt->buckets = (PMEM_DPT_HASHED_LINE*) calloc(
+			n_lines, sizeof(PMEM_DPT_HASHED_LINE));
+
+	for (i = 0; i < n_lines; i++) {
+		PMEM_DPT_HASHED_LINE* pline = &pdpt->buckets[i];
+		pline->hashed_id = i;
+		pline->n_entries = 0;
+		pline->map = new DPT_MAP();
+	}
+	return pdpt;
+}
+
+void
+pm_ptxl_dpt_free(
+		PMEM_DPT*			pdpt) {
+	uint64_t i;
+
+	for (i = 0; i < pdpt->n_buckets; i++) {
+		PMEM_DPT_HASHED_LINE* pline = &pdpt->buckets[i];
+		DPT_MAP::iterator it;
+
+		for (it = pline->map->begin(); it != pline->map->end(); ++it) {
+			free(it->second->refs);
+			free(it->second);
+		}
+		delete pline->map;
+	}
+	free(pdpt->buckets);
+	free(pdpt);
+}
+
+/*Record that page key has a log rec with LSN lsn on block plog_block
+ * Called with the block lock held so the block can not be reclaimed before
+ * the ref is visible
+ * */
+static void
+__ptxl_dpt_add_ref(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			key,
+		PMEM_TX_LOG_BLOCK*	plog_block,
+		uint64_t			lsn) {
+
+	PMEM_DPT*				pdpt = ptxl->dpt;
+	PMEM_DPT_HASHED_LINE*	pline;
+	PMEM_DPT_ENTRY*			pe;
+	DPT_MAP::iterator		it;
+	uint32_t				i;
+
+	pline = &pdpt->buckets[key % pdpt->n_buckets];
+
+	pmemobj_rwlock_wrlock(pop, &pline->lock);
+
+	it = pline->map->find(key);
+	if (it == pline->map->end()) {
+		pe = (PMEM_DPT_ENTRY*) calloc(1, sizeof(PMEM_DPT_ENTRY));
+		pe->key = key;
+		pe->max_refs = PMEM_DPT_INIT_REFS;
+		pe->refs = (PMEM_PAGE_REF*) malloc(
+				pe->max_refs * sizeof(PMEM_PAGE_REF));
+		pe->n_refs = 0;
+		(*pline->map)[key] = pe;
+		pline->n_entries++;
+	} else {
+		pe = it->second;
+	}
+
+	for (i = 0; i < pe->n_refs; i++) {
+		if (pe->refs[i].idx == plog_block->bid) {
+			pe->refs[i].pageLSN = lsn;
+			pmemobj_rwlock_unlock(pop, &pline->lock);
+			return;
+		}
+	}
+
+	if (pe->n_refs == pe->max_refs) {
+		pe->max_refs *= 2;
+		pe->refs = (PMEM_PAGE_REF*) realloc(pe->refs,
+				pe->max_refs * sizeof(PMEM_PAGE_REF));
+	}
+	pe->refs[pe->n_refs].key = key;
+	pe->refs[pe->n_refs].idx = plog_block->bid;
+	pe->refs[pe->n_refs].pageLSN = lsn;
+	pe->n_refs++;
+
+#if defined (UNIV_PMEMOBJ_PART_PL_STAT)
+	if (pe->n_refs > pe->max_txref_size) {
+		pe->max_txref_size = pe->n_refs;
+	}
+#endif
+
+	__sync_fetch_and_add(&plog_block->count, 1);
+
+	pmemobj_rwlock_unlock(pop, &pline->lock);
+}
+
+/*
+ * Called when a page is written to disk
+ * Release the refs of the page whose LSNs are covered by the written
+ * pageLSN, reclaim the committed blocks that have no ref left
+ * */
+void
+pm_ptxl_on_flush_page(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			key,
+		uint64_t			pageLSN) {
+
+	PMEM_DPT*				pdpt = ptxl->dpt;
+	PMEM_DPT_HASHED_LINE*	pline;
+	PMEM_DPT_ENTRY*			pe;
+	DPT_MAP::iterator		it;
+	uint32_t				i, n_keep, n_released;
+	PMEM_TX_LOG_BLOCK*		released[PMEM_DPT_INIT_REFS * 4];
+	PMEM_TX_LOG_BLOCK*		plog_block;
+
+	pline = &pdpt->buckets[key % pdpt->n_buckets];
+
+retry:
+	n_released = 0;
+	pmemobj_rwlock_wrlock(pop, &pline->lock);
+
+	it = pline->map->find(key);
+	if (it == pline->map->end()) {
+		pmemobj_rwlock_unlock(pop, &pline->lock);
+		return;
+	}
+	pe = it->second;
+
+	n_keep = 0;
+	for (i = 0; i < pe->n_refs; i++) {
+		if (pe->refs[i].pageLSN <= pageLSN &&
+			n_released < PMEM_DPT_INIT_REFS * 4) {
+			plog_block = pm_ptxl_get_block_by_id(ptxl, pe->refs[i].idx);
+			if (__sync_sub_and_fetch(&plog_block->count, 1) == 0) {
+				released[n_released++] = plog_block;
+			}
+		} else {
+			pe->refs[n_keep++] = pe->refs[i];
+		}
+	}
+	pe->n_refs = n_keep;
+
+	if (pe->n_refs == 0) {
+		pline->map->erase(it);
+		pline->n_entries--;
+		free(pe->refs);
+		free(pe);
+#if defined (UNIV_PMEMOBJ_PART_PL_STAT)
+		pline->n_free++;
+#endif
+	}
+
+	pmemobj_rwlock_unlock(pop, &pline->lock);
+
+	/*reclaim out of the DPT line lock, the block lock is taken first on
+	 * the write path*/
+	for (i = 0; i < n_released; i++) {
+		__ptxl_check_and_reclaim(pop, ptxl, released[i]);
+	}
+
+	if (n_released == PMEM_DPT_INIT_REFS * 4) {
+		/*the release buffer was full, there may be more refs*/
+		goto retry;
+	}
+}
+
+/////////////// LOG BLOCKS ///////////////////
+
+/*Assign the next LSN, the wall clock in us like the per-page log
+ * but strictly increasing so two recs never share an LSN*/
+static inline uint64_t
+__ptxl_assign_lsn(
+		PMEM_TX_PART_LOG*	ptxl) {
+	uint64_t	old_lsn;
+	uint64_t	new_lsn;
+	uint64_t	now = ut_time_us(NULL);
+
+	do {
+		old_lsn = ptxl->cur_lsn;
+		new_lsn = (now > old_lsn) ? now : old_lsn + 1;
+	} while (!__sync_bool_compare_and_swap(&ptxl->cur_lsn, old_lsn, new_lsn));
+
+	return new_lsn;
+}
+
+/*Ask the page cleaner to write the pages that pin the oldest committed
+ * block, the flushes reclaim blocks through pm_ptxl_on_flush_page()*/
+static void
+__ptxl_request_reclaim(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl) {
+	uint64_t i;
+	uint64_t min_lsn = ULONG_MAX;
+
+	for (i = 0; i < ptxl->n_buckets * ptxl->n_blocks_per_bucket; i++) {
+		PMEM_TX_LOG_BLOCK* plog_block =
+			pm_ptxl_get_block_by_id(ptxl, i + 1);
+
+		if (plog_block->state == PMEM_COMMIT_LOG_BLOCK &&
+			plog_block->lastLSN < min_lsn) {
+			min_lsn = plog_block->lastLSN;
+		}
+	}
+
+	if (min_lsn == ULONG_MAX) {
+		/*only active blocks, flush everything up to now*/
+		min_lsn = ptxl->cur_lsn;
+	}
+	pm_ppl_buf_flush_request_force(min_lsn + 1);
+}
+
+/*Get a free block for transaction tid, start from the line of tid and
+ * follow the round-robin fashion of PMEM_BUF, wait for the page cleaner
+ * when the log is full
+ * */
+static PMEM_TX_LOG_BLOCK*
+__ptxl_get_free_block(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			tid,
+		uint64_t			prev_bid) {
+
+	uint64_t n = ptxl->n_buckets;
+	uint64_t k = ptxl->n_blocks_per_bucket;
+	uint64_t start;
+	uint64_t i, j, c;
+	uint64_t n_waits = 0;
+	int64_t sig_count;
+
+	PMEM_TX_LOG_HASHED_LINE*	pline;
+	PMEM_TX_LOG_BLOCK*			plog_block;
+
+	start = (tid != 0) ? tid % n : ((uint64_t) os_thread_get_curr_id()) % n;
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	/*the block is free to choose, start on the lines of the local node
+	 * (i * n_nodes / n == node), the scan then goes on to the other nodes*/
+	{
+		uint64_t nn = pm_numa_n_nodes();
+		uint64_t node = pm_numa_cur_node();
+		uint64_t lo = (node * n + nn - 1) / nn;
+		uint64_t hi = ((node + 1) * n + nn - 1) / nn;
+
+		if (nn > 1 && hi > lo) {
+			start = lo + start % (hi - lo);
+		}
+	}
+#endif
+
+	for (;;) {
+		sig_count = os_event_reset(ptxl->free_block_event);
+
+		for (c = 0; c < n; c++) {
+			i = (start + c) % n;
+			pline = D_RW(D_RW(ptxl->buckets)[i]);
+
+			pmemobj_rwlock_wrlock(pop, &pline->lock);
+			for (j = 0; j < k; j++) {
+				uint64_t idx = (pline->cur_block_id + j) % k;
+				plog_block = D_RW(D_RW(pline->arr)[idx]);
+
+				if (plog_block->state != PMEM_FREE_LOG_BLOCK) {
+					continue;
+				}
+				/*header first, the state makes the block visible
+				 * to recovery*/
+				plog_block->tid = tid;
+				plog_block->prev_bid = prev_bid;
+				plog_block->cur_off = 0;
+				plog_block->n_log_recs = 0;
+				plog_block->firstLSN = 0;
+				plog_block->lastLSN = 0;
+				plog_block->count = 0;
+				pmemobj_persist(pop, plog_block, sizeof(*plog_block));
+
+				plog_block->state = PMEM_ACTIVE_LOG_BLOCK;
+				pmemobj_persist(pop, &plog_block->state,
+						sizeof(plog_block->state));
+
+				pline->cur_block_id = (idx + 1) % k;
+				pmemobj_rwlock_unlock(pop, &pline->lock);
+
+				__sync_fetch_and_sub(&ptxl->n_free_blocks, 1);
+				return plog_block;
+			}
+			pmemobj_rwlock_unlock(pop, &pline->lock);
+		}
+
+		/*the log is full*/
+		if (n_waits % 100 == 0) {
+			ib::warn() << "PMEM per-tx log is full ("
+				<< n * k << " blocks), waiting for the page"
+				" cleaner to reclaim log blocks."
+				" Consider a larger innodb_ptxl_blocks_per_bucket";
+		}
+		n_waits++;
+
+		__ptxl_request_reclaim(pop, ptxl);
+		os_event_wait_time_low(ptxl->free_block_event,
+				PMEM_TX_LOG_WAIT_US, sig_count);
+	}
+}
+
+/*Return a block that was never written to the free state*/
+static void
+__ptxl_free_block(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		PMEM_TX_LOG_BLOCK*	plog_block) {
+
+	pmemobj_rwlock_wrlock(pop, &plog_block->lock);
+	__reset_tx_log_block(plog_block);
+	pmemobj_persist(pop, plog_block, sizeof(*plog_block));
+	pmemobj_rwlock_unlock(pop, &plog_block->lock);
+
+	__sync_fetch_and_add(&ptxl->n_free_blocks, 1);
+	os_event_set(ptxl->free_block_event);
+}
+
+/*Reclaim a committed block that has no dirty page ref left
+ * Active blocks are skipped without taking the lock, the writer of an
+ * active block may be waiting for a free block*/
+static void
+__ptxl_check_and_reclaim(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		PMEM_TX_LOG_BLOCK*	plog_block) {
+
+	if (plog_block->state != PMEM_COMMIT_LOG_BLOCK) {
+		return;
+	}
+
+	pmemobj_rwlock_wrlock(pop, &plog_block->lock);
+	if (plog_block->state != PMEM_COMMIT_LOG_BLOCK ||
+		plog_block->count > 0) {
+		pmemobj_rwlock_unlock(pop, &plog_block->lock);
+		return;
+	}
+
+	/*the state is the only thing recovery reads from a free block*/
+	plog_block->state = PMEM_FREE_LOG_BLOCK;
+	pmemobj_persist(pop, &plog_block->state, sizeof(plog_block->state));
+	__reset_tx_log_block(plog_block);
+
+	pmemobj_rwlock_unlock(pop, &plog_block->lock);
+
+	__sync_fetch_and_add(&ptxl->n_free_blocks, 1);
+	os_event_set(ptxl->free_block_event);
+}
+
+/*Close a block, no rec is appended after this*/
+static void
+__ptxl_close_block(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		PMEM_TX_LOG_BLOCK*	plog_block) {
+
+	pmemobj_rwlock_wrlock(pop, &plog_block->lock);
+	plog_block->state = PMEM_COMMIT_LOG_BLOCK;
+	pmemobj_persist(pop, &plog_block->state, sizeof(plog_block->state));
+	pmemobj_rwlock_unlock(pop, &plog_block->lock);
+
+	__ptxl_check_and_reclaim(pop, ptxl, plog_block);
+}
+
+/*
+ * Append a log rec on the block of the transaction
+ * Called from mtr::add_rec_to_ppl() in the per-transaction mode, the
+ * counterpart of pm_ppl_write_rec()
+ * The rec has the same format as the per-page log, the LSN is written in
+ * the rec before it is copied
+ * @param[in] pop
+ * @param[in] ptxl
+ * @param[in] trx - the parent transaction of the mtr, NULL if none
+ * @param[in] key - fold of the page id
+ * @param[in] log_src
+ * @param[in] rec_size - rec size
+ * @return the LSN of the rec
+ * */
+uint64_t
+pm_ptxl_write_rec(
+			PMEMobjpool*		pop,
+			PMEM_TX_PART_LOG*	ptxl,
+			trx_t*				trx,
+			uint64_t			key,
+			byte*				log_src,
+			uint32_t			rec_size)
+{
+	byte*				temp;
+	mlog_id_t			type;
+	ulint				space, page_no;
+	uint64_t			tid;
+	uint64_t			bid;
+	uint64_t*			bid_ptr;
+	uint64_t			rec_lsn;
+	PMEM_TX_LOG_BLOCK*	plog_block;
+	PMEM_TX_LOG_BLOCK*	new_block;
+
+	assert(rec_size > 0);
+	assert(rec_size <= ptxl->block_size);
+
+	temp = mlog_parse_initial_log_record(
+			log_src, log_src + rec_size, &type, &space, &page_no);
+	assert(mach_read_from_2(temp) == rec_size);
+	temp += 2;
+
+	/*The purge trx is shared by the purge threads and never commits,
+	 * its recs go to the system blocks as the mtrs without trx*/
+	if (trx != NULL && trx->id != 0 && trx != purge_sys->trx) {
+		tid = trx->id;
+		bid_ptr = &trx->pm_log_block_id;
+	} else {
+		tid = 0;
+		bid_ptr = &ptxl->sys_bids[
+			((uint64_t) os_thread_get_curr_id()) % ptxl->n_sys_slots];
+	}
+
+	for (;;) {
+		bid = *bid_ptr;
+
+		if (bid != 0) {
+			plog_block = pm_ptxl_get_block_by_id(ptxl, bid);
+
+			pmemobj_rwlock_wrlock(pop, &plog_block->lock);
+			if (*bid_ptr == bid &&
+				plog_block->state == PMEM_ACTIVE_LOG_BLOCK &&
+				plog_block->cur_off + rec_size <= ptxl->block_size) {
+				break;
+			}
+			pmemobj_rwlock_unlock(pop, &plog_block->lock);
+		}
+
+		/*no block or the block is full, chain a new one*/
+		new_block = __ptxl_get_free_block(pop, ptxl, tid, bid);
+
+		if (__sync_bool_compare_and_swap(bid_ptr, bid, new_block->bid)) {
+			if (bid != 0 && tid == 0) {
+				/*a system block has no commit, close it here*/
+				__ptxl_close_block(pop, ptxl,
+						pm_ptxl_get_block_by_id(ptxl, bid));
+			}
+		} else {
+			/*another thread of the slot chained first*/
+			__ptxl_free_block(pop, ptxl, new_block);
+		}
+	}
+
+	/*(1) Write the rec, then the offset that makes it durable*/
+	rec_lsn = __ptxl_assign_lsn(ptxl);
+	mach_write_to_8(temp, rec_lsn);
+
+	pm_write_log_rec_low(pop,
+			ptxl->p_align + plog_block->pmemaddr + plog_block->cur_off,
+			log_src,
+			rec_size);
+
+	if (plog_block->firstLSN == 0) {
+		plog_block->firstLSN = rec_lsn;
+	}
+	plog_block->lastLSN = rec_lsn;
+	plog_block->n_log_recs++;
+	plog_block->cur_off += rec_size;
+	pmemobj_persist(pop, &plog_block->cur_off, sizeof(plog_block->cur_off));
+
+	/*(2) the page pins the block until it is flushed*/
+	__ptxl_dpt_add_ref(pop, ptxl, key, plog_block, rec_lsn);
+
+	pmemobj_rwlock_unlock(pop, &plog_block->lock);
+
+	return rec_lsn;
+}
+
+/*
+ * Called when a transaction commits or finishes its rollback
+ * Close every block of the transaction, the blocks whose pages are all
+ * flushed are reclaimed right away
+ * @param[in] tid - transaction id, for checking
+ * @param[in] bid - the last block of the transaction
+ * */
+void
+pm_ptxl_commit(
+		PMEMobjpool*		pop,
+		PMEM_TX_PART_LOG*	ptxl,
+		uint64_t			tid,
+		uint64_t			bid) {
+
+	PMEM_TX_LOG_BLOCK*	plog_block;
+	uint64_t			prev_bid;
+
+	while (bid != 0) {
+		plog_block = pm_ptxl_get_block_by_id(ptxl, bid);
+		assert(plog_block->tid == tid);
+
+		prev_bid = plog_block->prev_bid;
+		__ptxl_close_block(pop, ptxl, plog_block);
+		bid = prev_bid;
+	}
+}
+#endif /* UNIV_PMEMOBJ_TX_LOG */
@@ -0,0 +1,173 @@
+/*
+ * Author; Trong-Dat Nguyen
+ * MySQL UNDO pages with NVDIMM
+ * Using libpmemobj
+ * Copyright (c) 2017 VLDB Lab - Sungkyunkwan University
+ * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <stdint.h> //for uint64_t
+#include <assert.h>
+#include <unistd.h> //for access()
+
+#include "my_pmem_common.h"
+#include "my_pmemobj.h"
+
+#include "os0file.h"
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+/*Open the NVM undo page area of the pool, allocate it if it does not exist
+ * The number of slots and the slot size are fixed at allocation time
+ * */
+int pm_wrapper_undo_alloc_or_open(
+		PMEM_WRAPPER*	pmw,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+	assert(pmw);
+
+	if (!pmw->pundo) {
+		pmw->pundo = pm_pop_undo_alloc(pmw->pop, n_slots, slot_size);
+		if (!pmw->pundo)
+			return PMEM_ERROR;
+		printf("PMEMOBJ_INFO: allocate %zu undo page slots on PMEM\n", n_slots);
+	}
+	else {
+		pmw->pundo->is_new = false;
+		printf("PMEMOBJ_INFO: open %zu undo page slots on PMEM\n", pmw->pundo->n_slots);
+	}
+	return PMEM_SUCCESS;
+}
+
+PMEM_UNDO* pm_pop_get_undo(PMEMobjpool* pop) {
+	TOID(PMEM_UNDO) undo;
+	//get the first object in pmem has type PMEM_UNDO
+	undo = POBJ_FIRST(pop, PMEM_UNDO);
+
+	if (TOID_IS_NULL(undo)) {
+		return NULL;
+	}
+	else {
+		PMEM_UNDO *pundo = D_RW(undo);
+		if(!pundo) {
+			printf("PMEMOBJ_ERROR: message: %s\n",  pmemobj_errormsg() );
+			return NULL;
+		}
+		return pundo;
+	}
+}
+
+/*
+ * Allocate the undo page area in persistent memory
+ * The data area is n_slots page slots plus one page for alignment
+ * Each slot has a persistent header, a slot is VALID from the time its
+ * page image is persisted until it is superseded or checkpointed
+ * */
+PMEM_UNDO* pm_pop_undo_alloc(
+		PMEMobjpool*	pop,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+
+	TOID(PMEM_UNDO) undo;
+
+	POBJ_ZNEW(pop, &undo, PMEM_UNDO);
+
+	PMEM_UNDO *pundo = D_RW(undo);
+
+	pundo->size = (n_slots + 1) * slot_size;
+	pundo->type = UNDO_TYPE;
+	pundo->is_new = true;
+	pundo->n_slots = n_slots;
+	pundo->slot_size = slot_size;
+
+	pundo->data = pm_pop_alloc_bytes(pop, pundo->size);
+	if (OID_IS_NULL(pundo->data)){
+		return NULL;
+	}
+
+	pundo->hdr = pm_pop_alloc_bytes(pop,
+			n_slots * sizeof(PMEM_UNDO_SLOT_HDR));
+	if (OID_IS_NULL(pundo->hdr)){
+		return NULL;
+	}
+	pmemobj_memset_persist(pop, pmemobj_direct(pundo->hdr),
+			0, n_slots * sizeof(PMEM_UNDO_SLOT_HDR));
+
+	pmemobj_persist(pop, pundo, sizeof(*pundo));
+	return pundo;
+}
+
+/*Get the address of a slot in the undo page area
+ * slots are aligned to slot_size*/
+byte*
+pm_undo_get_slot(
+		PMEM_UNDO*		pundo,
+		uint64_t		slot) {
+	byte* p;
+
+	assert(slot < pundo->n_slots);
+
+	p = static_cast<byte*>(pmemobj_direct(pundo->data));
+	p = static_cast<byte*>(ut_align(p, pundo->slot_size));
+
+	return (p + slot * pundo->slot_size);
+}
+
+PMEM_UNDO_SLOT_HDR*
+pm_undo_get_slot_hdr(
+		PMEM_UNDO*		pundo,
+		uint64_t		slot) {
+	PMEM_UNDO_SLOT_HDR* hdr = static_cast<PMEM_UNDO_SLOT_HDR*>(
+			pmemobj_direct(pundo->hdr));
+
+	assert(slot < pundo->n_slots);
+
+	return (hdr + slot);
+}
+
+/*Persist an undo page image on a free slot then mark the slot valid
+ * The image and the page identity must be durable before the state word,
+ * otherwise recovery may restore a torn or misplaced copy
+ * */
+void
+pm_undo_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_UNDO*		pundo,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		space,
+		uint64_t		page_no,
+		uint64_t		lsn,
+		uint64_t		seq) {
+	byte*				p = pm_undo_get_slot(pundo, slot);
+	PMEM_UNDO_SLOT_HDR*	hdr = pm_undo_get_slot_hdr(pundo, slot);
+
+	assert(hdr->state == PMEM_UNDO_SLOT_FREE);
+
+	pmemobj_memcpy_persist(pop, p, src, pundo->slot_size);
+
+	hdr->space = space;
+	hdr->page_no = page_no;
+	hdr->lsn = lsn;
+	hdr->seq = seq;
+	pmemobj_persist(pop, hdr, sizeof(*hdr));
+
+	hdr->state = PMEM_UNDO_SLOT_VALID;
+	pmemobj_persist(pop, &hdr->state, sizeof(uint64_t));
+}
+
+/*Mark a slot free, called when a newer image of the page is valid or the
+ * page is older than the checkpoint*/
+void
+pm_undo_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_UNDO*		pundo,
+		uint64_t		slot) {
+	PMEM_UNDO_SLOT_HDR*	hdr = pm_undo_get_slot_hdr(pundo, slot);
+
+	hdr->state = PMEM_UNDO_SLOT_FREE;
+	pmemobj_persist(pop, &hdr->state, sizeof(uint64_t));
+}
+#endif /* UNIV_PMEMOBJ_UNDO */
@@ -0,0 +1,126 @@
+/*
+ * Author; Trong-Dat Nguyen
+ * Victim cache of clean buffer pool pages on NVDIMM
+ * Using libpmemobj
+ * Copyright (c) 2018 VLDB Lab - Sungkyunkwan University
+ * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <stdint.h> //for uint64_t
+#include <assert.h>
+#include <unistd.h> //for access()
+
+#include "my_pmem_common.h"
+#include "my_pmemobj.h"
+
+#include "os0file.h"
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+/*Open the victim cache area of the pool, allocate it if it does not exist
+ * The number of slots and the slot size are fixed at allocation time
+ * */
+int pm_wrapper_vcache_alloc_or_open(
+		PMEM_WRAPPER*	pmw,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+	assert(pmw);
+
+	if (!pmw->pvcache) {
+		pmw->pvcache = pm_pop_vcache_alloc(pmw->pop, n_slots, slot_size);
+		if (!pmw->pvcache)
+			return PMEM_ERROR;
+		printf("PMEMOBJ_INFO: allocate %zu victim cache page slots on PMEM\n", n_slots);
+	}
+	else {
+		pmw->pvcache->is_new = false;
+		printf("PMEMOBJ_INFO: open %zu victim cache page slots on PMEM\n", pmw->pvcache->n_slots);
+	}
+	return PMEM_SUCCESS;
+}
+
+PMEM_VCACHE* pm_pop_get_vcache(PMEMobjpool* pop) {
+	TOID(PMEM_VCACHE) vcache;
+	//get the first object in pmem has type PMEM_VCACHE
+	vcache = POBJ_FIRST(pop, PMEM_VCACHE);
+
+	if (TOID_IS_NULL(vcache)) {
+		return NULL;
+	}
+	else {
+		PMEM_VCACHE *pvcache = D_RW(vcache);
+		if(!pvcache) {
+			printf("PMEMOBJ_ERROR: message: %s\n",  pmemobj_errormsg() );
+			return NULL;
+		}
+		return pvcache;
+	}
+}
+
+/*
+ * Allocate the victim cache area in persistent memory
+ * The data area is n_slots page slots plus one page for alignment
+ * */
+PMEM_VCACHE* pm_pop_vcache_alloc(
+		PMEMobjpool*	pop,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+
+	TOID(PMEM_VCACHE) vcache;
+
+	POBJ_ZNEW(pop, &vcache, PMEM_VCACHE);
+
+	PMEM_VCACHE *pvcache = D_RW(vcache);
+
+	pvcache->size = (n_slots + 1) * slot_size;
+	pvcache->type = VCACHE_TYPE;
+	pvcache->is_new = true;
+	pvcache->n_slots = n_slots;
+	pvcache->slot_size = slot_size;
+
+	pvcache->data = pm_pop_alloc_bytes(pop, pvcache->size);
+	if (OID_IS_NULL(pvcache->data)){
+		return NULL;
+	}
+
+	pmemobj_persist(pop, pvcache, sizeof(*pvcache));
+	return pvcache;
+}
+
+/*Get the address of a slot in the victim cache area
+ * slots are aligned to slot_size*/
+byte*
+pm_vcache_get_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot) {
+	byte* p;
+
+	assert(slot < pvcache->n_slots);
+
+	p = static_cast<byte*>(pmemobj_direct(pvcache->data));
+	p = static_cast<byte*>(ut_align(p, pvcache->slot_size));
+
+	return (p + slot * pvcache->slot_size);
+}
+
+/*Copy a page image on a slot
+ * No flush: the slot is never read after a restart, the copy only has to be
+ * visible to the readers, which the cache coherence gives*/
+void
+pm_vcache_write_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot,
+		const byte*		src) {
+	memcpy(pm_vcache_get_slot(pvcache, slot), src, pvcache->slot_size);
+}
+
+void
+pm_vcache_read_slot(
+		PMEM_VCACHE*	pvcache,
+		uint64_t		slot,
+		byte*			dst) {
+	memcpy(dst, pm_vcache_get_slot(pvcache, slot), pvcache->slot_size);
+}
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
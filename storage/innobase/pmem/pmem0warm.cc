@@ -0,0 +1,187 @@
+/*
+ * Author; Trong-Dat Nguyen
+ * Warm restart of the buffer pool from NVM
+ * Using libpmemobj
+ * Copyright (c) 2018 VLDB Lab - Sungkyunkwan University
+ * */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <string.h>
+#include <stdint.h> //for uint64_t
+#include <assert.h>
+#include <unistd.h> //for access()
+
+#include "my_pmem_common.h"
+#include "my_pmemobj.h"
+
+#include "os0file.h"
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+/*Open the warm restart area of the pool, allocate it if it does not exist
+ * The number of slots and the slot size are fixed at allocation time
+ * */
+int pm_wrapper_warm_alloc_or_open(
+		PMEM_WRAPPER*	pmw,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+	assert(pmw);
+
+	if (!pmw->pwarm) {
+		pmw->pwarm = pm_pop_warm_alloc(pmw->pop, n_slots, slot_size);
+		if (!pmw->pwarm)
+			return PMEM_ERROR;
+		printf("PMEMOBJ_INFO: allocate %zu warm restart page slots on PMEM\n", n_slots);
+	}
+	else {
+		pmw->pwarm->is_new = false;
+		printf("PMEMOBJ_INFO: open %zu warm restart page slots on PMEM\n", pmw->pwarm->n_slots);
+	}
+	return PMEM_SUCCESS;
+}
+
+PMEM_WARM* pm_pop_get_warm(PMEMobjpool* pop) {
+	TOID(PMEM_WARM) warm;
+	//get the first object in pmem has type PMEM_WARM
+	warm = POBJ_FIRST(pop, PMEM_WARM);
+
+	if (TOID_IS_NULL(warm)) {
+		return NULL;
+	}
+	else {
+		PMEM_WARM *pwarm = D_RW(warm);
+		if(!pwarm) {
+			printf("PMEMOBJ_ERROR: message: %s\n",  pmemobj_errormsg() );
+			return NULL;
+		}
+		return pwarm;
+	}
+}
+
+/*
+ * Allocate the warm restart area in persistent memory
+ * The data area is n_slots page slots plus one page for alignment
+ * Each slot has a persistent header, the slots are only read while the area
+ * is PMEM_WARM_VALID
+ * */
+PMEM_WARM* pm_pop_warm_alloc(
+		PMEMobjpool*	pop,
+		const uint64_t	n_slots,
+		const size_t	slot_size) {
+
+	TOID(PMEM_WARM) warm;
+
+	POBJ_ZNEW(pop, &warm, PMEM_WARM);
+
+	PMEM_WARM *pwarm = D_RW(warm);
+
+	pwarm->size = (n_slots + 1) * slot_size;
+	pwarm->type = WARM_TYPE;
+	pwarm->is_new = true;
+	pwarm->state = PMEM_WARM_EMPTY;
+	pwarm->n_slots = n_slots;
+	pwarm->slot_size = slot_size;
+
+	pwarm->data = pm_pop_alloc_bytes(pop, pwarm->size);
+	if (OID_IS_NULL(pwarm->data)){
+		return NULL;
+	}
+
+	pwarm->hdr = pm_pop_alloc_bytes(pop,
+			n_slots * sizeof(PMEM_WARM_SLOT_HDR));
+	if (OID_IS_NULL(pwarm->hdr)){
+		return NULL;
+	}
+	pmemobj_memset_persist(pop, pmemobj_direct(pwarm->hdr),
+			0, n_slots * sizeof(PMEM_WARM_SLOT_HDR));
+
+	pmemobj_persist(pop, pwarm, sizeof(*pwarm));
+	return pwarm;
+}
+
+/*Get the address of a slot in the warm restart area
+ * slots are aligned to slot_size*/
+byte*
+pm_warm_get_slot(
+		PMEM_WARM*		pwarm,
+		uint64_t		slot) {
+	byte* p;
+
+	assert(slot < pwarm->n_slots);
+
+	p = static_cast<byte*>(pmemobj_direct(pwarm->data));
+	p = static_cast<byte*>(ut_align(p, pwarm->slot_size));
+
+	return (p + slot * pwarm->slot_size);
+}
+
+PMEM_WARM_SLOT_HDR*
+pm_warm_get_slot_hdr(
+		PMEM_WARM*		pwarm,
+		uint64_t		slot) {
+	PMEM_WARM_SLOT_HDR* hdr = static_cast<PMEM_WARM_SLOT_HDR*>(
+			pmemobj_direct(pwarm->hdr));
+
+	assert(slot < pwarm->n_slots);
+
+	return (hdr + slot);
+}
+
+/*Persist a page image on a slot then mark the slot valid
+ * The image and the page identity must be durable before the state word,
+ * otherwise a restart may load a torn or misplaced copy
+ * */
+void
+pm_warm_write_slot(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		slot,
+		const byte*		src,
+		uint64_t		space,
+		uint64_t		page_no) {
+	byte*				p = pm_warm_get_slot(pwarm, slot);
+	PMEM_WARM_SLOT_HDR*	hdr = pm_warm_get_slot_hdr(pwarm, slot);
+
+	pmemobj_memcpy_persist(pop, p, src, pwarm->slot_size);
+
+	hdr->space = space;
+	hdr->page_no = page_no;
+	pmemobj_persist(pop, hdr, sizeof(*hdr));
+
+	hdr->state = PMEM_WARM_VALID;
+	pmemobj_persist(pop, &hdr->state, sizeof(uint64_t));
+}
+
+/*Mark a slot empty, called when the page is written to its datafile*/
+void
+pm_warm_clear_slot(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		slot) {
+	PMEM_WARM_SLOT_HDR*	hdr = pm_warm_get_slot_hdr(pwarm, slot);
+
+	hdr->state = PMEM_WARM_EMPTY;
+	pmemobj_persist(pop, &hdr->state, sizeof(uint64_t));
+}
+
+/*
+ * Set the state of the whole area
+ * Going to PMEM_WARM_VALID, all slots must be empty first so that no slot
+ * of an older dump is read after a crash
+ * */
+void
+pm_warm_set_state(
+		PMEMobjpool*	pop,
+		PMEM_WARM*		pwarm,
+		uint64_t		state) {
+
+	if (state == PMEM_WARM_VALID) {
+		pmemobj_memset_persist(pop, pmemobj_direct(pwarm->hdr),
+				0, pwarm->n_slots * sizeof(PMEM_WARM_SLOT_HDR));
+	}
+
+	pwarm->state = state;
+	pmemobj_persist(pop, &pwarm->state, sizeof(uint64_t));
+}
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
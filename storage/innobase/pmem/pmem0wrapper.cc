@@ -59,6 +59,12 @@ PMEM_WRAPPER* pm_wrapper_create(const char* path, const size_t pool_size){
 	if (!pmw)
 		goto err;
 	pmw->is_new = true;
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	pm_numa_init();
+	for (ulint node = 0; node < PMEM_NUMA_MAX_NODES; node++) {
+		pmw->node_pops[node] = NULL;
+	}
+#endif
 
 	//Force use pmem
 	setenv("PMEM_IS_PMEM_FORCE", "1", 1);
@@ -103,9 +109,21 @@ PMEM_WRAPPER* pm_wrapper_create(const char* path, const size_t pool_size){
 #if defined (UNIV_PMEMOBJ_BUF)
 	pmw->pbuf = NULL;
 #endif 
+#if defined (UNIV_PMEMOBJ_UNDO)
+	pmw->pundo = NULL;
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	pmw->pwarm = NULL;
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	pmw->pvcache = NULL;
+#endif
 #if defined (UNIV_PMEMOBJ_PART_PL)
 	pmw->ppl = NULL;
 #endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	pmw->ptxl = NULL;
+#endif
 
 	/*If we have persistent data structures, get them*/
 	if(!pmw->is_new) {
@@ -117,6 +135,24 @@ PMEM_WRAPPER* pm_wrapper_create(const char* path, const size_t pool_size){
 		if(!pmw->pdbw){
 			printf("[PMEMOBJ_INFO] the pmem double write buffer is empty. The database is new or the previous double write buffer is in disk instead of PMEM\n");
 		}
+#if defined (UNIV_PMEMOBJ_UNDO)
+		pmw->pundo = pm_pop_get_undo(pop);
+		if(!pmw->pundo){
+			printf("[PMEMOBJ_INFO] the pmem undo page area is empty. The previous run kept undo pages with redo log only\n");
+		}
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+		pmw->pwarm = pm_pop_get_warm(pop);
+		if(!pmw->pwarm){
+			printf("[PMEMOBJ_INFO] the pmem warm restart area is empty. The buffer pool is loaded from disk\n");
+		}
+#endif
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+		pmw->pvcache = pm_pop_get_vcache(pop);
+		if(!pmw->pvcache){
+			printf("[PMEMOBJ_INFO] the pmem victim cache area is empty, it is allocated at startup\n");
+		}
+#endif
 
 #if defined (UNIV_PMEMOBJ_BUF)
 		pmw->pbuf = pm_pop_get_buf(pop);
@@ -130,6 +166,12 @@ PMEM_WRAPPER* pm_wrapper_create(const char* path, const size_t pool_size){
 			printf("[PMEMOBJ_INFO] the pmem ppl is empty. The database is new\n");
 		}
 		pmw->ppl->is_new = pmw->is_new;
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+		pmw->ptxl = pm_pop_get_ptxl(pop);
+		if(!pmw->ptxl){
+			printf("[PMEMOBJ_INFO] the pmem per-tx log is empty. The database is new\n");
+		}
 #endif
 	}
 
@@ -163,7 +205,14 @@ void pm_wrapper_free(PMEM_WRAPPER* pmw){
 	pm_wrapper_page_log_close(pmw);
 	pmw->ppl = NULL;
 #endif //UNIV_PMEMOBJ_PART_PL
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	pm_wrapper_tx_log_close(pmw);
+	pmw->ptxl = NULL;
+#endif //UNIV_PMEMOBJ_TX_LOG
 
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+	pm_numa_close_pools(pmw);
+#endif
 	if(pmw->pop)
 		pm_pop_free(pmw->pop);
 	pmw->plogbuf = NULL;
@@ -200,7 +200,11 @@ MVCC::validate() const
 {
 	ViewCheck	check;
 
+#if defined (UNIV_MVCC_CSN)
+	ut_ad(mutex_own(&m_mutex));
+#else
 	ut_ad(mutex_own(&trx_sys->mutex));
+#endif /* UNIV_MVCC_CSN */
 
 	ut_list_map(m_views, check);
 
@@ -344,6 +348,10 @@ MVCC::MVCC(ulint size)
 	UT_LIST_INIT(m_free, &ReadView::m_view_list);
 	UT_LIST_INIT(m_views, &ReadView::m_view_list);
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_create(LATCH_ID_MVCC, &m_mutex);
+#endif /* UNIV_MVCC_CSN */
+
 	for (ulint i = 0; i < size; ++i) {
 		ReadView*	view = UT_NEW_NOKEY(ReadView());
 
@@ -363,6 +371,10 @@ MVCC::~MVCC()
 	}
 
 	ut_a(UT_LIST_GET_LEN(m_views) == 0);
+
+#if defined (UNIV_MVCC_CSN)
+	mutex_free(&m_mutex);
+#endif /* UNIV_MVCC_CSN */
 }
 
 /**
@@ -467,6 +479,54 @@ ReadView::prepare(trx_id_t id)
 	}
 }
 
+#if defined (UNIV_MVCC_CSN)
+/**
+Opens a read view on the last published CSN. No transaction id is
+copied, the ids between the limits are resolved through the CSN map
+of trx_sys. Caller must own MVCC::m_mutex.
+@param id		Creator transaction id */
+
+void
+ReadView::prepare_csn(trx_id_t id)
+{
+	m_creator_trx_id = id;
+
+	m_ids.clear();
+
+	/* The order of the reads pairs with the order of the writes in
+	trx_serialisation_number_get() and trx_erase_lists(): a trx_t::no
+	assigned before max_trx_id is read is not above csn_low_limit_no,
+	the ids below csn_up_limit_id are committed with a CSN up to
+	m_csn, and every CSN up to m_csn is of an id below
+	m_low_limit_id. */
+	trx_id_t	max_trx_id = trx_sys->max_trx_id;
+	os_rmb;
+	trx_id_t	low_limit_no = trx_sys->csn_low_limit_no;
+	os_rmb;
+	m_up_limit_id = trx_sys->csn_up_limit_id;
+	os_rmb;
+	m_csn = trx_sys->csn;
+	os_rmb;
+	m_low_limit_id = trx_sys->max_trx_id;
+
+	m_low_limit_no = std::min(max_trx_id, low_limit_no);
+
+	ut_ad(m_up_limit_id <= m_low_limit_id);
+
+	m_closed = false;
+}
+
+/**
+@param id		transaction id between the limits
+@return true if id committed before the view was opened */
+
+bool
+ReadView::csn_visible(trx_id_t id) const
+{
+	return(trx_sys_csn_get(id) <= m_csn);
+}
+#endif /* UNIV_MVCC_CSN */
+
 /**
 Complete the read view creation */
 
@@ -489,7 +549,11 @@ a new view.
 ReadView*
 MVCC::get_view()
 {
+#if defined (UNIV_MVCC_CSN)
+	ut_ad(mutex_own(&m_mutex));
+#else
 	ut_ad(mutex_own(&trx_sys->mutex));
+#endif /* UNIV_MVCC_CSN */
 
 	ReadView*	view;
 
@@ -530,10 +594,18 @@ MVCC::view_release(ReadView*& view)
 
 	ut_ad(view->m_creator_trx_id == 0);
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_enter(&m_mutex);
+#endif /* UNIV_MVCC_CSN */
+
 	UT_LIST_REMOVE(m_views, view);
 
 	UT_LIST_ADD_LAST(m_free, view);
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_exit(&m_mutex);
+#endif /* UNIV_MVCC_CSN */
+
 	view = NULL;
 }
 
@@ -569,28 +641,49 @@ MVCC::view_open(ReadView*& view, trx_t* trx)
 
 			view->m_closed = false;
 
+#if defined (UNIV_MVCC_CSN)
+			/* Nothing committed since the view was opened, the
+			new ids are not visible anyway. The limits being the
+			same, purge did not drop what the view looks up. */
+			if (view->m_csn == trx_sys->csn
+			    && view->m_up_limit_id
+			    == trx_sys->csn_up_limit_id) {
+#else
 			if (view->m_low_limit_id == trx_sys_get_max_trx_id()) {
+#endif /* UNIV_MVCC_CSN */
 				return;
 			} else {
 				view->m_closed = true;
 			}
 		}
 
+#if defined (UNIV_MVCC_CSN)
+		mutex_enter(&m_mutex);
+#else
 		mutex_enter(&trx_sys->mutex);
+#endif /* UNIV_MVCC_CSN */
 
 		UT_LIST_REMOVE(m_views, view);
 
 	} else {
+#if defined (UNIV_MVCC_CSN)
+		mutex_enter(&m_mutex);
+#else
 		mutex_enter(&trx_sys->mutex);
+#endif /* UNIV_MVCC_CSN */
 
 		view = get_view();
 	}
 
 	if (view != NULL) {
 
+#if defined (UNIV_MVCC_CSN)
+		view->prepare_csn(trx->id);
+#else
 		view->prepare(trx->id);
 
 		view->complete();
+#endif /* UNIV_MVCC_CSN */
 
 		UT_LIST_ADD_FIRST(m_views, view);
 
@@ -599,7 +692,11 @@ MVCC::view_open(ReadView*& view, trx_t* trx)
 		ut_ad(validate());
 	}
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_exit(&m_mutex);
+#else
 	trx_sys_mutex_exit();
+#endif /* UNIV_MVCC_CSN */
 }
 
 /**
@@ -611,7 +708,11 @@ MVCC::get_oldest_view() const
 {
 	ReadView*	view;
 
+#if defined (UNIV_MVCC_CSN)
+	ut_ad(mutex_own(&m_mutex));
+#else
 	ut_ad(mutex_own(&trx_sys->mutex));
+#endif /* UNIV_MVCC_CSN */
 
 	for (view = UT_LIST_GET_LAST(m_views);
 	     view != NULL;
@@ -649,6 +750,10 @@ ReadView::copy_prepare(const ReadView& other)
 	m_low_limit_id = other.m_low_limit_id;
 
 	m_creator_trx_id = other.m_creator_trx_id;
+
+#if defined (UNIV_MVCC_CSN)
+	m_csn = other.m_csn;
+#endif /* UNIV_MVCC_CSN */
 }
 
 /**
@@ -684,6 +789,31 @@ purge the delete marked record or not.
 void
 MVCC::clone_oldest_view(ReadView* view)
 {
+#if defined (UNIV_MVCC_CSN)
+	mutex_enter(&m_mutex);
+
+	ReadView*	oldest_view = get_oldest_view();
+
+	if (oldest_view == NULL) {
+		view->prepare_csn(0);
+	} else {
+		view->copy_prepare(*oldest_view);
+	}
+
+	/* The views opened after the mutex is released have limits not
+	below the oldest ones, the ids that none of the views looks up
+	can leave the CSN map for good */
+	trx_id_t	drop_id = view->m_up_limit_id;
+	trx_id_t	drop_csn = view->m_csn;
+
+	mutex_exit(&m_mutex);
+
+	if (oldest_view != NULL) {
+		view->copy_complete();
+	}
+
+	trx_sys_csn_set_drop_limits(drop_id, drop_csn);
+#else
 	mutex_enter(&trx_sys->mutex);
 
 	ReadView*	oldest_view = get_oldest_view();
@@ -703,6 +833,7 @@ MVCC::clone_oldest_view(ReadView* view)
 
 		view->copy_complete();
 	}
+#endif /* UNIV_MVCC_CSN */
 }
 
 /**
@@ -711,7 +842,11 @@ MVCC::clone_oldest_view(ReadView* view)
 ulint
 MVCC::size() const
 {
+#if defined (UNIV_MVCC_CSN)
+	mutex_enter(&m_mutex);
+#else
 	trx_sys_mutex_enter();
+#endif /* UNIV_MVCC_CSN */
 
 	ulint	size = 0;
 
@@ -724,7 +859,11 @@ MVCC::size() const
 		}
 	}
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_exit(&m_mutex);
+#else
 	trx_sys_mutex_exit();
+#endif /* UNIV_MVCC_CSN */
 
 	return(size);
 }
@@ -754,6 +893,10 @@ MVCC::view_close(ReadView*& view, bool own_mutex)
 	} else {
 		view = reinterpret_cast<ReadView*>(p & ~1);
 
+#if defined (UNIV_MVCC_CSN)
+		mutex_enter(&m_mutex);
+#endif /* UNIV_MVCC_CSN */
+
 		view->close();
 
 		UT_LIST_REMOVE(m_views, view);
@@ -761,6 +904,10 @@ MVCC::view_close(ReadView*& view, bool own_mutex)
 
 		ut_ad(validate());
 
+#if defined (UNIV_MVCC_CSN)
+		mutex_exit(&m_mutex);
+#endif /* UNIV_MVCC_CSN */
+
 		view = NULL;
 	}
 }
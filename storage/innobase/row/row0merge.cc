@@ -40,6 +40,7 @@ Completed by Sunny Bains and Marko Makela
 #include "ut0sort.h"
 #include "row0ftsort.h"
 #include "row0import.h"
+#include "row0pread.h"
 #include "handler0alter.h"
 #include "btr0bulk.h"
 #include "fsp0sysspace.h"
@@ -848,6 +849,13 @@ row_merge_dup_report(
 	if (!dup->n_dup++) {
 		/* Only report the first duplicate record,
 		but count all duplicate records. */
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+		/* The scan threads of the parallel build only count,
+		see row_merge_pll_write_buf() */
+		if (dup->table == NULL) {
+			return;
+		}
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
 		innobase_fields_to_mysql(dup->table, dup->index, entry);
 	}
 }
@@ -4269,6 +4277,722 @@ row_merge_write_redo(
 	mtr.commit();
 }
 
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+/** Shared context of a parallel scan of the clustered index */
+struct row_merge_pll_t {
+	trx_t*			trx;		/*!< transaction, its read
+						view is used by all scans */
+	const dict_table_t*	table;		/*!< table where rows are
+						read and indexes created */
+	dict_index_t*		clust_index;	/*!< clustered index */
+	bool			online;		/*!< true if creating
+						indexes online */
+	dict_index_t**		index;		/*!< indexes to be created */
+	ulint			n_index;	/*!< number of indexes */
+	merge_file_t*		files;		/*!< one merge file per index,
+						shared by the scans */
+	volatile ulint		n_running;	/*!< number of scans that
+						have not exited yet */
+};
+
+/** A key range of the clustered index scanned by one thread */
+struct row_merge_pll_scan_t {
+	row_merge_pll_t*	pll;		/*!< shared context */
+	const dtuple_t*		low;		/*!< first key of the range,
+						NULL for the start of the
+						index */
+	const dtuple_t*		high;		/*!< first key after the
+						range, NULL for the end of
+						the index */
+	row_merge_buf_t**	merge_buf;	/*!< one sort buffer per
+						index */
+	row_merge_block_t*	block;		/*!< buffer for writing runs */
+	ut_new_pfx_t		block_pfx;	/*!< allocation of block */
+	dberr_t			err;		/*!< result of the scan */
+	ulint			err_index;	/*!< position in index[] of
+						the index that failed */
+	dfield_t*		dup_fields;	/*!< copy of a duplicate
+						entry, or NULL */
+	mem_heap_t*		dup_heap;	/*!< heap of dup_fields */
+	volatile ulint		n_pages;	/*!< leaf pages read */
+	volatile ulint		n_recs;		/*!< records read */
+	os_thread_id_t		thread;		/*!< scan thread */
+};
+
+/** Sort and load of one index by a thread */
+struct row_merge_pll_load_t {
+	trx_t*			trx;		/*!< transaction */
+	dict_index_t*		index;		/*!< index to load, NULL if
+						it is loaded serially */
+	const dict_table_t*	old_table;	/*!< table where rows are
+						read from */
+	merge_file_t*		file;		/*!< runs of the index */
+	FlushObserver*		observer;	/*!< flush observer */
+	row_merge_block_t*	block;		/*!< 3 merge buffers */
+	ut_new_pfx_t		block_pfx;	/*!< allocation of block */
+	int			tmpfd;		/*!< output of merge passes */
+	dberr_t			err;		/*!< result of the load */
+	os_thread_id_t		thread;		/*!< load thread */
+};
+
+/** Check if the indexes can be built by the parallel scan: secondary
+indexes added to a table that is not rebuilt, without FTS, spatial or
+virtual columns. row_merge_buf_add() evaluates virtual columns on the
+MySQL table object, which is not shared between threads.
+@return true if row_merge_read_clustered_index_pll() can be used */
+static
+bool
+row_merge_pll_possible(
+	const dict_table_t*	old_table,
+	const dict_table_t*	new_table,
+	dict_index_t**		indexes,
+	ulint			n_indexes,
+	ulint			add_autoinc,
+	bool			skip_pk_sort,
+	const dict_add_v_col_t*	add_v)
+{
+	if (srv_parallel_index_build_threads <= 1
+	    || old_table != new_table
+	    || add_autoinc != ULINT_UNDEFINED
+	    || skip_pk_sort
+	    || add_v != NULL) {
+		return(false);
+	}
+
+	for (ulint i = 0; i < n_indexes; i++) {
+		if ((indexes[i]->type & DICT_FTS)
+		    || dict_index_is_clust(indexes[i])
+		    || dict_index_is_spatial(indexes[i])
+		    || dict_index_has_virtual(indexes[i])) {
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/** Remember a copy of a duplicate entry of a sorted buffer, the MySQL
+row buffer for the error message is filled by the coordinator.
+@param[in,out]	scan	range scan
+@param[in]	buf	sorted buffer of a unique index */
+static
+void
+row_merge_pll_save_dup(
+	row_merge_pll_scan_t*	scan,
+	const row_merge_buf_t*	buf)
+{
+	const ulint	n_uniq = dict_index_get_n_unique(buf->index);
+	const ulint	n_fields = dict_index_get_n_fields(buf->index);
+
+	for (ulint j = 1; j < buf->n_tuples; j++) {
+		const dfield_t*	a = buf->tuples[j - 1].fields;
+		const dfield_t*	b = buf->tuples[j].fields;
+		ulint		k;
+
+		/* NULL columns are logically inequal, as in
+		row_merge_tuple_cmp() */
+		for (k = 0; k < n_uniq; k++) {
+			if (dfield_is_null(&a[k])
+			    || cmp_dfield_dfield(&a[k], &b[k])) {
+				break;
+			}
+		}
+
+		if (k < n_uniq) {
+			continue;
+		}
+
+		scan->dup_heap = mem_heap_create(n_fields * sizeof(dfield_t));
+		scan->dup_fields = static_cast<dfield_t*>(
+			mem_heap_alloc(scan->dup_heap,
+				       n_fields * sizeof(dfield_t)));
+
+		for (k = 0; k < n_fields; k++) {
+			scan->dup_fields[k] = a[k];
+			dfield_dup(&scan->dup_fields[k], scan->dup_heap);
+		}
+
+		return;
+	}
+}
+
+/** Sort the buffer of an index and append it as a run to the merge file
+of the index. The runs of the scans are appended in any order, every
+block is a run for row_merge_sort().
+@param[in,out]	scan	range scan
+@param[in]	i	position of the index in index[]
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_merge_pll_write_buf(
+	row_merge_pll_scan_t*	scan,
+	ulint			i)
+{
+	row_merge_buf_t*	buf = scan->merge_buf[i];
+	merge_file_t*		file = &scan->pll->files[i];
+
+	if (dict_index_is_unique(buf->index)) {
+		/* Count only, the MySQL row buffer is not ours */
+		row_merge_dup_t	dup = {buf->index, NULL, NULL, 0};
+
+		row_merge_buf_sort(buf, &dup);
+
+		if (dup.n_dup) {
+			row_merge_pll_save_dup(scan, buf);
+			scan->err_index = i;
+			return(DB_DUPLICATE_KEY);
+		}
+	} else {
+		row_merge_buf_sort(buf, NULL);
+	}
+
+	row_merge_buf_write(buf, file, scan->block);
+
+	ulint	offset = os_atomic_increment_ulint(&file->offset, 1) - 1;
+
+	if (!row_merge_write(file->fd, offset, scan->block)) {
+		scan->err_index = i;
+		return(DB_TEMP_FILE_WRITE_FAIL);
+	}
+
+	UNIV_MEM_INVALID(&scan->block[0], srv_sort_buf_size);
+
+	scan->merge_buf[i] = row_merge_buf_empty(buf);
+
+	return(DB_SUCCESS);
+}
+
+/** Scan a key range of the clustered index and write sorted runs of the
+entries of every index, see row_merge_read_clustered_index().
+@param[in,out]	scan	range scan
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_merge_pll_scan(
+	row_merge_pll_scan_t*	scan)
+{
+	row_merge_pll_t*	pll = scan->pll;
+	trx_t*			trx = pll->trx;
+	const dict_table_t*	table = pll->table;
+	dict_index_t*		clust_index = pll->clust_index;
+	row_pread_cur_t		cur;
+	mem_heap_t*		row_heap;
+	mem_heap_t*		v_heap = NULL;
+	ib_uint64_t*		n_rec;
+	doc_id_t		doc_id = 0;
+	dberr_t			err = DB_SUCCESS;
+
+	row_heap = mem_heap_create(sizeof(mrec_buf_t));
+
+	n_rec = static_cast<ib_uint64_t*>(
+		ut_zalloc_nokey(pll->n_index * sizeof *n_rec));
+
+	row_pread_cur_open(&cur, clust_index, scan->low, scan->high,
+			   NULL, &scan->n_pages);
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+		const dtuple_t*	row;
+		row_ext_t*	ext;
+
+		mem_heap_empty(row_heap);
+
+		rec = row_pread_cur_next(
+			&cur, trx, &offsets, &row_heap, &err);
+
+		if (rec == NULL) {
+			break;
+		}
+
+		scan->n_recs++;
+
+		if (pll->online) {
+			/* A REPEATABLE READ in the view of the ALTER,
+			see row_merge_read_clustered_index() */
+			if (!trx->read_view->changes_visible(
+				    row_get_rec_trx_id(
+					    rec, clust_index, offsets),
+				    table->name)) {
+				rec_t*	old_vers;
+
+				row_vers_build_for_consistent_read(
+					rec, &cur.mtr, clust_index, &offsets,
+					trx->read_view, &row_heap,
+					row_heap, &old_vers, NULL);
+
+				rec = old_vers;
+
+				if (!rec) {
+					continue;
+				}
+			}
+
+			if (rec_get_deleted_flag(
+				    rec, dict_table_is_comp(table))) {
+				continue;
+			}
+		} else if (rec_get_deleted_flag(
+				   rec, dict_table_is_comp(table))) {
+			continue;
+		}
+
+		row = row_build_w_add_vcol(ROW_COPY_POINTERS, clust_index,
+					   rec, offsets, table, NULL, NULL,
+					   NULL, &ext, row_heap);
+
+		for (ulint i = 0; i < pll->n_index; i++) {
+			ulint	rows_added = row_merge_buf_add(
+				scan->merge_buf[i], NULL, table, table, NULL,
+				row, ext, &doc_id, NULL, &err, &v_heap, NULL,
+				trx);
+
+			if (rows_added == 0) {
+				/* The buffer is full, write it out and
+				add the entry again */
+				ut_ad(err == DB_SUCCESS);
+
+				err = row_merge_pll_write_buf(scan, i);
+
+				if (err != DB_SUCCESS) {
+					goto scan_exit;
+				}
+
+				rows_added = row_merge_buf_add(
+					scan->merge_buf[i], NULL, table,
+					table, NULL, row, ext, &doc_id, NULL,
+					&err, &v_heap, NULL, trx);
+
+				/* An empty buffer should have enough
+				room for at least one record. */
+				ut_a(rows_added);
+			}
+
+			ut_ad(err == DB_SUCCESS);
+
+			n_rec[i] += rows_added;
+		}
+
+		if (v_heap) {
+			mem_heap_empty(v_heap);
+		}
+	}
+
+scan_exit:
+	row_pread_cur_close(&cur);
+
+	if (err == DB_SUCCESS) {
+		for (ulint i = 0; i < pll->n_index; i++) {
+			if (scan->merge_buf[i]->n_tuples == 0) {
+				continue;
+			}
+
+			err = row_merge_pll_write_buf(scan, i);
+
+			if (err != DB_SUCCESS) {
+				break;
+			}
+		}
+	}
+
+	for (ulint i = 0; i < pll->n_index; i++) {
+		os_atomic_increment_uint64(&pll->files[i].n_rec, n_rec[i]);
+	}
+
+	ut_free(n_rec);
+
+	if (v_heap) {
+		mem_heap_free(v_heap);
+	}
+
+	mem_heap_free(row_heap);
+
+	return(err);
+}
+
+/** Thread of a range scan
+@param[in,out]	arg	row_merge_pll_scan_t of the range
+@return OS_THREAD_DUMMY_RETURN */
+static
+os_thread_ret_t
+row_merge_pll_scan_thread(
+	void*	arg)
+{
+	row_merge_pll_scan_t*	scan = static_cast<row_merge_pll_scan_t*>(
+		arg);
+
+	scan->err = row_merge_pll_scan(scan);
+
+	os_atomic_decrement_ulint(&scan->pll->n_running, 1);
+
+	os_thread_exit(false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/** Read the clustered index with srv_parallel_index_build_threads threads,
+each one scanning a key range and appending sorted runs to the merge files
+of the indexes. Replaces row_merge_read_clustered_index() when
+row_merge_pll_possible().
+@param[in]	trx		transaction
+@param[in,out]	table		MySQL table object, for reporting erroneous
+records
+@param[in]	old_table	table where rows are read from and indexes
+created
+@param[in]	online		true if creating indexes online
+@param[in]	index		indexes to be created
+@param[out]	files		temporary files, fd is -1 for an index without
+entries
+@param[in]	key_numbers	MySQL key numbers to create
+@param[in]	n_index		number of indexes to create
+@param[in,out]	stage		performance schema accounting object
+@return DB_SUCCESS or error */
+static MY_ATTRIBUTE((warn_unused_result))
+dberr_t
+row_merge_read_clustered_index_pll(
+	trx_t*			trx,
+	struct TABLE*		table,
+	const dict_table_t*	old_table,
+	bool			online,
+	dict_index_t**		index,
+	merge_file_t*		files,
+	const ulint*		key_numbers,
+	ulint			n_index,
+	ut_stage_alter_t*	stage)
+{
+	row_merge_pll_t		pll;
+	row_merge_pll_scan_t*	scans;
+	dtuple_t**		bounds;
+	mem_heap_t*		heap;
+	ulint			n_ranges;
+	ulint			n_started = 0;
+	ulint			n_pages_done = 0;
+	ulint			n_recs_done = 0;
+	dberr_t			err = DB_SUCCESS;
+	/* The variable is dynamic, read it once */
+	const ulint		n_threads = srv_parallel_index_build_threads;
+	ut_allocator<row_merge_block_t>	alloc(mem_key_row_merge_sort);
+	DBUG_ENTER("row_merge_read_clustered_index_pll");
+
+	trx->op_info = "reading clustered index";
+
+	const char*	path = thd_innodb_tmpdir(trx->mysql_thd);
+
+	pll.trx = trx;
+	pll.table = old_table;
+	pll.clust_index = dict_table_get_first_index(old_table);
+	pll.online = online;
+	pll.index = index;
+	pll.n_index = n_index;
+	pll.files = files;
+	pll.n_running = 0;
+
+	for (ulint i = 0; i < n_index; i++) {
+		if (row_merge_file_create(&files[i], path) < 0) {
+			trx->error_key_num = i;
+			DBUG_RETURN(DB_OUT_OF_MEMORY);
+		}
+
+		MONITOR_ATOMIC_INC(MONITOR_ALTER_TABLE_SORT_FILES);
+	}
+
+	heap = mem_heap_create(1024);
+
+	bounds = static_cast<dtuple_t**>(
+		mem_heap_alloc(heap, n_threads * sizeof *bounds));
+
+	n_ranges = row_pread_split(pll.clust_index, n_threads, bounds, heap);
+
+	scans = static_cast<row_merge_pll_scan_t*>(
+		ut_zalloc_nokey(n_ranges * sizeof *scans));
+
+	for (ulint r = 0; r < n_ranges; r++) {
+		row_merge_pll_scan_t*	scan = &scans[r];
+
+		scan->pll = &pll;
+		scan->low = r > 0 ? bounds[r - 1] : NULL;
+		scan->high = r + 1 < n_ranges ? bounds[r] : NULL;
+		scan->err = DB_SUCCESS;
+
+		scan->block = alloc.allocate_large(
+			srv_sort_buf_size, &scan->block_pfx);
+
+		if (scan->block == NULL) {
+			err = DB_OUT_OF_MEMORY;
+			break;
+		}
+
+		scan->merge_buf = static_cast<row_merge_buf_t**>(
+			ut_malloc_nokey(n_index * sizeof *scan->merge_buf));
+
+		for (ulint i = 0; i < n_index; i++) {
+			scan->merge_buf[i] = row_merge_buf_create(index[i]);
+		}
+	}
+
+	if (err == DB_SUCCESS) {
+		pll.n_running = n_ranges;
+
+		for (n_started = 0; n_started < n_ranges; n_started++) {
+			os_thread_create(row_merge_pll_scan_thread,
+					 &scans[n_started],
+					 &scans[n_started].thread);
+		}
+
+		/* Report the progress of the scans, ut_stage_alter_t is
+		not thread safe */
+		do {
+			os_thread_sleep(100000);
+
+			ulint	n_pages = 0;
+			ulint	n_recs = 0;
+
+			for (ulint r = 0; r < n_ranges; r++) {
+				n_pages += scans[r].n_pages;
+				n_recs += scans[r].n_recs;
+			}
+
+			for (; n_recs_done < n_recs; n_recs_done++) {
+				stage->n_pk_recs_inc();
+			}
+
+			for (; n_pages_done < n_pages; n_pages_done++) {
+				stage->inc();
+			}
+		} while (pll.n_running > 0);
+
+		for (ulint r = 0; r < n_started; r++) {
+			os_thread_join(scans[r].thread);
+		}
+
+		for (ulint r = 0; r < n_ranges; r++) {
+			row_merge_pll_scan_t*	scan = &scans[r];
+
+			if (scan->err == DB_SUCCESS) {
+				continue;
+			}
+
+			err = scan->err;
+
+			switch (err) {
+			case DB_INTERRUPTED:
+				trx->error_key_num = 0;
+				break;
+			case DB_DUPLICATE_KEY:
+				if (scan->dup_fields != NULL) {
+					innobase_fields_to_mysql(
+						table,
+						index[scan->err_index],
+						scan->dup_fields);
+				}
+
+				trx->error_key_num
+					= key_numbers[scan->err_index];
+				break;
+			default:
+				trx->error_key_num = scan->err_index;
+			}
+
+			break;
+		}
+	}
+
+	if (err == DB_SUCCESS) {
+		for (ulint i = 0; i < n_index; i++) {
+			if (files[i].offset == 0) {
+				/* No entry, the index stays empty */
+				row_merge_file_destroy(&files[i]);
+			}
+
+			if (!online) {
+				continue;
+			}
+
+			/* Note the newest transaction that modified this
+			index when the scan was completed, as
+			row_merge_read_clustered_index() does. */
+			rw_lock_x_lock(dict_index_get_lock(index[i]));
+			ut_a(dict_index_get_online_status(index[i])
+			     == ONLINE_INDEX_CREATION);
+
+			trx_id_t	max_trx_id = row_log_get_max_trx(
+				index[i]);
+
+			if (max_trx_id > index[i]->trx_id) {
+				index[i]->trx_id = max_trx_id;
+			}
+
+			rw_lock_x_unlock(dict_index_get_lock(index[i]));
+		}
+	}
+
+	for (ulint r = 0; r < n_ranges; r++) {
+		row_merge_pll_scan_t*	scan = &scans[r];
+
+		if (scan->merge_buf != NULL) {
+			for (ulint i = 0; i < n_index; i++) {
+				row_merge_buf_free(scan->merge_buf[i]);
+			}
+
+			ut_free(scan->merge_buf);
+		}
+
+		if (scan->block != NULL) {
+			alloc.deallocate_large(scan->block, &scan->block_pfx);
+		}
+
+		if (scan->dup_heap != NULL) {
+			mem_heap_free(scan->dup_heap);
+		}
+	}
+
+	ut_free(scans);
+	mem_heap_free(heap);
+
+	trx->op_info = "";
+
+	DBUG_RETURN(err);
+}
+
+/** Thread of the sort and load of one index
+@param[in,out]	arg	row_merge_pll_load_t of the index
+@return OS_THREAD_DUMMY_RETURN */
+static
+os_thread_ret_t
+row_merge_pll_load_thread(
+	void*	arg)
+{
+	row_merge_pll_load_t*	load = static_cast<row_merge_pll_load_t*>(
+		arg);
+
+	/* Non-unique index, there is no duplicate to report */
+	row_merge_dup_t	dup = {load->index, NULL, NULL, 0};
+
+	load->err = row_merge_sort(
+		load->trx, &dup, load->file, load->block, &load->tmpfd);
+
+	if (load->err == DB_SUCCESS) {
+		BtrBulk	btr_bulk(load->index, load->trx->id, load->observer);
+		btr_bulk.init();
+
+		load->err = row_merge_insert_index_tuples(
+			load->trx->id, load->index, load->old_table,
+			load->file->fd, load->block, NULL, &btr_bulk);
+
+		load->err = btr_bulk.finish(load->err);
+	}
+
+	os_thread_exit(false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/** Merge sort and bulk load the non-unique indexes concurrently, up to
+srv_parallel_index_build_threads at a time. A unique index is left to the
+serial loop of row_merge_build_indexes(), which reports its duplicates on
+the MySQL table object.
+@param[in]	trx		transaction
+@param[in]	old_table	table where rows are read from
+@param[in]	indexes		indexes to be created
+@param[in]	n_indexes	size of indexes[]
+@param[in,out]	files		merge files of the indexes
+@param[in]	observer	flush observer
+@param[in,out]	stage		performance schema accounting object
+@return per index result, index is NULL for the indexes not loaded here,
+NULL if there are fewer than two indexes to load */
+static
+row_merge_pll_load_t*
+row_merge_pll_load(
+	trx_t*			trx,
+	const dict_table_t*	old_table,
+	dict_index_t**		indexes,
+	ulint			n_indexes,
+	merge_file_t*		files,
+	FlushObserver*		observer,
+	ut_stage_alter_t*	stage)
+{
+	ulint	n_load = 0;
+
+	for (ulint i = 0; i < n_indexes; i++) {
+		if (files[i].fd >= 0 && !dict_index_is_unique(indexes[i])) {
+			n_load++;
+		}
+	}
+
+	if (n_load < 2) {
+		return(NULL);
+	}
+
+	ut_allocator<row_merge_block_t>	alloc(mem_key_row_merge_sort);
+	const char*	path = thd_innodb_tmpdir(trx->mysql_thd);
+	row_merge_pll_load_t*	loads = static_cast<row_merge_pll_load_t*>(
+		ut_zalloc_nokey(n_indexes * sizeof *loads));
+	const ulint		n_threads = srv_parallel_index_build_threads;
+	ulint*	wave = static_cast<ulint*>(
+		ut_malloc_nokey(n_threads * sizeof *wave));
+	ulint	i = 0;
+
+	stage->begin_phase_sort(log2(n_threads));
+
+	while (i < n_indexes) {
+		ulint	n_wave = 0;
+
+		for (; i < n_indexes
+		       && n_wave < n_threads; i++) {
+			row_merge_pll_load_t*	load = &loads[i];
+
+			if (files[i].fd < 0
+			    || dict_index_is_unique(indexes[i])) {
+				continue;
+			}
+
+			load->trx = trx;
+			load->index = indexes[i];
+			load->old_table = old_table;
+			load->file = &files[i];
+			load->observer = observer;
+			load->err = DB_SUCCESS;
+			load->tmpfd = row_merge_file_create_low(path);
+			load->block = alloc.allocate_large(
+				3 * srv_sort_buf_size, &load->block_pfx);
+
+			if (load->tmpfd < 0 || load->block == NULL) {
+				load->err = DB_OUT_OF_MEMORY;
+				continue;
+			}
+
+			MONITOR_ATOMIC_INC(MONITOR_ALTER_TABLE_SORT_FILES);
+
+			wave[n_wave++] = i;
+
+			os_thread_create(row_merge_pll_load_thread,
+					 load, &load->thread);
+		}
+
+		for (ulint j = 0; j < n_wave; j++) {
+			os_thread_join(loads[wave[j]].thread);
+		}
+	}
+
+	for (i = 0; i < n_indexes; i++) {
+		if (loads[i].block != NULL) {
+			alloc.deallocate_large(
+				loads[i].block, &loads[i].block_pfx);
+		}
+
+		if (loads[i].index != NULL) {
+			row_merge_file_destroy_low(loads[i].tmpfd);
+		}
+	}
+
+	ut_free(wave);
+
+	stage->begin_phase_insert();
+
+	return(loads);
+}
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
+
 /** Build indexes on a table by reading a clustered index, creating a temporary
 file containing index entries, merge sorting these index entries and inserting
 sorted index entries to indexes.
@@ -4328,6 +5052,9 @@ row_merge_build_indexes(
 	fts_psort_t*		merge_info = NULL;
 	int64_t			sig_count = 0;
 	bool			fts_psort_initiated = false;
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+	row_merge_pll_load_t*	pll_load = NULL;
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
 	DBUG_ENTER("row_merge_build_indexes");
 
 	ut_ad(!srv_read_only_mode);
@@ -4425,6 +5152,14 @@ row_merge_build_indexes(
 
 	/* Read clustered index of the table and create files for
 	secondary index entries for merge sort */
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+	if (row_merge_pll_possible(old_table, new_table, indexes, n_indexes,
+				   add_autoinc, skip_pk_sort, add_v)) {
+		error = row_merge_read_clustered_index_pll(
+			trx, table, old_table, online, indexes, merge_files,
+			key_numbers, n_indexes, stage);
+	} else
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
 	error = row_merge_read_clustered_index(
 		trx, table, old_table, new_table, online, indexes,
 		fts_sort_idx, psort_info, merge_files, key_numbers,
@@ -4442,6 +5177,14 @@ row_merge_build_indexes(
 
 	/* Now we have files containing index entries ready for
 	sorting and inserting. */
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+	if (row_merge_pll_possible(old_table, new_table, indexes, n_indexes,
+				   add_autoinc, skip_pk_sort, add_v)) {
+		pll_load = row_merge_pll_load(
+			trx, old_table, indexes, n_indexes, merge_files,
+			flush_observer, stage);
+	}
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
 
 	for (i = 0; i < n_indexes; i++) {
 		dict_index_t*	sort_idx = indexes[i];
@@ -4522,6 +5265,11 @@ wait_again:
 #ifdef FTS_INTERNAL_DIAG_PRINT
 			DEBUG_FTS_SORT_PRINT("FTS_SORT: Complete Insert\n");
 #endif
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+		} else if (pll_load != NULL && pll_load[i].index != NULL) {
+			/* Sorted and loaded by row_merge_pll_load() */
+			error = pll_load[i].err;
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
 		} else if (merge_files[i].fd >= 0) {
 			row_merge_dup_t	dup = {
 				sort_idx, table, col_map, 0};
@@ -4602,6 +5350,12 @@ func_exit:
 
 	ut_free(merge_files);
 
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+	if (pll_load != NULL) {
+		ut_free(pll_load);
+	}
+#endif /* UNIV_PARALLEL_INDEX_BUILD */
+
 	alloc.deallocate_large(block, &block_pfx);
 
 	DICT_TF2_FLAG_UNSET(new_table, DICT_TF2_FTS_ADD_DOC_ID);
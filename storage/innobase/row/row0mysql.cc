@@ -67,6 +67,10 @@ Created 9/17/2000 Heikki Tuuri
 #include "trx0undo.h"
 #include "row0ext.h"
 #include "ut0new.h"
+#if defined (UNIV_PARALLEL_READ)
+#include "row0pread.h"
+#include "ut0counter.h"
+#endif /* UNIV_PARALLEL_READ */
 
 #include <algorithm>
 #include <deque>
@@ -994,6 +998,9 @@ row_create_prebuilt(
 
 	prebuilt->m_no_prefetch = false;
 	prebuilt->m_read_virtual_key = false;
+#if defined (UNIV_BATCHED_FETCH)
+	prebuilt->fetch_cache_size = MYSQL_FETCH_CACHE_SIZE;
+#endif /* UNIV_BATCHED_FETCH */
 
 	DBUG_RETURN(prebuilt);
 }
@@ -1043,7 +1050,11 @@ row_prebuilt_free(
 		byte*	base = prebuilt->fetch_cache[0] - 4;
 		byte*	ptr = base;
 
+#if defined (UNIV_BATCHED_FETCH)
+		for (ulint i = 0; i < prebuilt->n_fetch_cache_alloc; i++) {
+#else
 		for (ulint i = 0; i < MYSQL_FETCH_CACHE_SIZE; i++) {
+#endif /* UNIV_BATCHED_FETCH */
 			ulint	magic1 = mach_read_from_4(ptr);
 			ut_a(magic1 == ROW_PREBUILT_FETCH_MAGIC_N);
 			ptr += 4;
@@ -5974,6 +5985,257 @@ next_rec:
 	goto loop;
 }
 
+#if defined (UNIV_PARALLEL_READ)
+/** State of a scan thread of row_scan_index_parallel_for_mysql() */
+struct row_scan_check_t {
+	dtuple_t*	prev_entry;	/*!< previous entry of the range */
+	mem_heap_t*	heap;		/*!< heap of prev_entry */
+	ulint		range_no;	/*!< range of prev_entry */
+	ulint		n_rows;		/*!< entries counted */
+	dberr_t		err;		/*!< first check that failed */
+	byte		pad[CACHE_LINE_SIZE];
+};
+
+/** First and last entry of a key range, for the check of the order
+across the ranges */
+struct row_scan_range_t {
+	const rec_t*	first_rec;	/*!< copy of the first record,
+					or NULL if the range is empty */
+	const ulint*	first_offsets;	/*!< rec_get_offsets(first_rec) */
+	mem_heap_t*	first_heap;	/*!< heap of first_rec */
+	dtuple_t*	last_entry;	/*!< last entry */
+	mem_heap_t*	last_heap;	/*!< heap of last_entry */
+};
+
+/** Shared state of row_scan_index_parallel_for_mysql() */
+struct row_scan_parallel_t {
+	row_scan_check_t*	threads;	/*!< one per scan thread */
+	row_scan_range_t*	ranges;		/*!< one per key range */
+	ulint			n_ranges;	/*!< size of ranges[] */
+};
+
+/** Check that an index record follows the previous entry, as
+row_scan_index_for_mysql() does.
+@param[in]	index		clustered index
+@param[in]	prev_entry	previous entry
+@param[in]	rec		record
+@param[in]	offsets		rec_get_offsets(rec)
+@return DB_SUCCESS, DB_INDEX_CORRUPT or DB_DUPLICATE_KEY */
+static
+dberr_t
+row_scan_check_order(
+	const dict_index_t*	index,
+	const dtuple_t*		prev_entry,
+	const rec_t*		rec,
+	const ulint*		offsets)
+{
+	ulint		matched_fields = 0;
+	const char*	msg;
+	dberr_t		err;
+
+	int	cmp = cmp_dtuple_rec_with_match(
+		prev_entry, rec, offsets, &matched_fields);
+
+	/* The fields of a clustered index key are NOT NULL */
+	if (cmp > 0) {
+		err = DB_INDEX_CORRUPT;
+		msg = "index records in a wrong order in ";
+	} else if (dict_index_is_unique(index)
+		   && matched_fields
+		   >= dict_index_get_n_ordering_defined_by_user(index)) {
+		err = DB_DUPLICATE_KEY;
+		msg = "duplicate key in ";
+	} else {
+		return(DB_SUCCESS);
+	}
+
+	ib::error()
+		<< msg << index->name
+		<< " of table " << index->table->name
+		<< ": " << *prev_entry << ", "
+		<< rec_offsets_print(rec, offsets);
+
+	return(err);
+}
+
+/** Hand the last entry of the current range of a scan thread over to
+the range.
+@param[in,out]	par	shared state
+@param[in,out]	chk	scan thread */
+static
+void
+row_scan_check_end_range(
+	row_scan_parallel_t*	par,
+	row_scan_check_t*	chk)
+{
+	if (chk->prev_entry == NULL) {
+		return;
+	}
+
+	row_scan_range_t*	range = &par->ranges[chk->range_no];
+
+	ut_ad(range->last_heap == NULL);
+
+	range->last_entry = chk->prev_entry;
+	range->last_heap = chk->heap;
+
+	chk->prev_entry = NULL;
+	chk->heap = mem_heap_create(100);
+}
+
+/** Callback of row_scan_index_parallel_for_mysql(), the checks of
+row_scan_index_for_mysql() within a key range. A failed check is
+recorded and the scan goes on, as the serial scan does.
+@param[in]	row	visible record
+@param[in,out]	arg	row_scan_parallel_t
+@return DB_SUCCESS */
+static
+dberr_t
+row_scan_index_check_func(
+	const row_pread_row_t*	row,
+	void*			arg)
+{
+	row_scan_parallel_t*	par = static_cast<row_scan_parallel_t*>(arg);
+	row_scan_check_t*	chk = &par->threads[row->thread_no];
+	const dict_index_t*	index = row->index;
+	ulint			n_ext;
+
+	chk->n_rows++;
+
+	if (row->first_in_range) {
+		row_scan_range_t*	range;
+
+		row_scan_check_end_range(par, chk);
+
+		ut_ad(row->range_no < par->n_ranges);
+
+		chk->range_no = row->range_no;
+		range = &par->ranges[row->range_no];
+
+		/* Keep a copy of the first record for the comparison
+		with the last entry of the previous range */
+		range->first_heap = mem_heap_create(
+			rec_offs_size(row->offsets) + 100);
+
+		range->first_rec = rec_copy(
+			mem_heap_alloc(range->first_heap,
+				       rec_offs_size(row->offsets)),
+			row->rec, row->offsets);
+
+		range->first_offsets = rec_get_offsets(
+			range->first_rec, index, NULL, ULINT_UNDEFINED,
+			&range->first_heap);
+	}
+
+	if (chk->prev_entry != NULL) {
+		dberr_t	err = row_scan_check_order(
+			index, chk->prev_entry, row->rec, row->offsets);
+
+		if (err != DB_SUCCESS && chk->err == DB_SUCCESS) {
+			chk->err = err;
+		}
+	}
+
+	mem_heap_empty(chk->heap);
+
+	chk->prev_entry = row_rec_to_index_entry(
+		row->rec, index, row->offsets, &n_ext, chk->heap);
+
+	return(DB_SUCCESS);
+}
+
+/** Scans the clustered index for CHECK TABLE with the parallel reader.
+Does the checks of row_scan_index_for_mysql() within every key range and
+between the last entry of a range and the first record of the next one.
+@param[in]	prebuilt	prebuilt struct in MySQL handle
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads
+@param[out]	n_rows		number of entries seen in the consistent read
+@return DB_SUCCESS, DB_INTERRUPTED, DB_INDEX_CORRUPT or DB_DUPLICATE_KEY */
+dberr_t
+row_scan_index_parallel_for_mysql(
+	row_prebuilt_t*		prebuilt,
+	dict_index_t*		index,
+	ulint			n_threads,
+	ulint*			n_rows)
+{
+	row_scan_parallel_t	par;
+
+	ut_ad(dict_index_is_clust(index));
+
+	par.n_ranges = n_threads * ROW_PREAD_RANGES_PER_THREAD;
+
+	par.threads = static_cast<row_scan_check_t*>(
+		ut_zalloc_nokey(n_threads * sizeof *par.threads));
+
+	par.ranges = static_cast<row_scan_range_t*>(
+		ut_zalloc_nokey(par.n_ranges * sizeof *par.ranges));
+
+	for (ulint i = 0; i < n_threads; i++) {
+		par.threads[i].heap = mem_heap_create(100);
+		par.threads[i].err = DB_SUCCESS;
+	}
+
+	dberr_t	ret = row_pread_scan(prebuilt->trx, index, n_threads,
+				     row_scan_index_check_func, &par);
+
+	*n_rows = 0;
+
+	for (ulint i = 0; i < n_threads; i++) {
+		row_scan_check_t*	chk = &par.threads[i];
+
+		row_scan_check_end_range(&par, chk);
+
+		*n_rows += chk->n_rows;
+
+		if (ret == DB_SUCCESS) {
+			ret = chk->err;
+		}
+
+		mem_heap_free(chk->heap);
+	}
+
+	/* The ranges are in key order, the empty ones are skipped */
+	const dtuple_t*	prev_entry = NULL;
+
+	for (ulint r = 0; r < par.n_ranges; r++) {
+		row_scan_range_t*	range = &par.ranges[r];
+
+		if (range->first_rec == NULL) {
+			ut_ad(range->last_heap == NULL);
+			continue;
+		}
+
+		if (prev_entry != NULL) {
+			dberr_t	err = row_scan_check_order(
+				index, prev_entry, range->first_rec,
+				range->first_offsets);
+
+			if (ret == DB_SUCCESS) {
+				ret = err;
+			}
+		}
+
+		prev_entry = range->last_entry;
+	}
+
+	for (ulint r = 0; r < par.n_ranges; r++) {
+		if (par.ranges[r].first_heap != NULL) {
+			mem_heap_free(par.ranges[r].first_heap);
+		}
+
+		if (par.ranges[r].last_heap != NULL) {
+			mem_heap_free(par.ranges[r].last_heap);
+		}
+	}
+
+	ut_free(par.ranges);
+	ut_free(par.threads);
+
+	return(ret);
+}
+#endif /* UNIV_PARALLEL_READ */
+
 /*********************************************************************//**
 Initialize this module */
 void
@@ -0,0 +1,586 @@
+/*****************************************************************************
+
+Copyright (c) 2018, VLDB Lab - Sungkyunkwan University. All Rights Reserved.
+
+This program is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License as published by the Free Software
+Foundation; version 2 of the License.
+
+This program is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+FOR A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with
+this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Suite 500, Boston, MA 02110-1335 USA
+
+*****************************************************************************/
+
+/**************************************************//**
+@file row/row0pread.cc
+Parallel read of a clustered index
+*******************************************************/
+
+#include "ha_prototypes.h"
+
+#include "row0pread.h"
+
+#if defined (UNIV_PARALLEL_READ) || defined (UNIV_PARALLEL_INDEX_BUILD)
+#include <vector>
+
+#include "btr0btr.h"
+#include "btr0cur.h"
+#include "btr0pcur.h"
+#include "dict0dict.h"
+#include "lock0lock.h"
+#include "os0thread.h"
+#include "page0page.h"
+#include "read0read.h"
+#include "rem0cmp.h"
+#include "row0row.h"
+#include "row0vers.h"
+#include "trx0trx.h"
+#include "ut0counter.h"
+
+/** Split the clustered index in key ranges with about the same number of
+leaf pages. The bounds are node pointers of the highest level that has
+at least n_ranges of them, or of level 1; at most n_ranges pages are
+read per level.
+@param[in]	index		clustered index
+@param[in]	n_ranges	wanted number of ranges
+@param[out]	bounds		first key of the ranges 1 to n - 1
+@param[in,out]	heap		memory heap for the bounds
+@return number of ranges, 1 if the index is a single leaf page */
+ulint
+row_pread_split(
+	dict_index_t*	index,
+	ulint		n_ranges,
+	dtuple_t**	bounds,
+	mem_heap_t*	heap)
+{
+	mtr_t				mtr;
+	mem_heap_t*			offsets_heap = NULL;
+	ulint*				offsets = NULL;
+	std::vector<buf_block_t*>	blocks;
+	std::vector<rec_t*>		node_ptrs;
+	const page_size_t		page_size(
+		dict_table_page_size(index->table));
+
+	mtr_start(&mtr);
+	mtr_s_lock(dict_index_get_lock(index), &mtr);
+
+	buf_block_t*	block = btr_root_block_get(index, RW_S_LATCH, &mtr);
+	ulint		level = btr_page_get_level(
+		buf_block_get_frame(block), &mtr);
+
+	if (level == 0) {
+		mtr_commit(&mtr);
+		return(1);
+	}
+
+	/* Every page is S-latched once: a second S-latch on the root
+	would deadlock with an X or SX request queued in between */
+	blocks.push_back(block);
+
+	for (;;) {
+		node_ptrs.clear();
+
+		for (ulint i = 0; i < blocks.size(); i++) {
+			page_t*	page = buf_block_get_frame(blocks[i]);
+
+			for (rec_t* rec = page_rec_get_next(
+				     page_get_infimum_rec(page));
+			     !page_rec_is_supremum(rec);
+			     rec = page_rec_get_next(rec)) {
+				node_ptrs.push_back(rec);
+			}
+		}
+
+		if (node_ptrs.size() >= n_ranges || level == 1) {
+			break;
+		}
+
+		/* Fewer node pointers than ranges, so fewer than n_ranges
+		child pages to latch on the next level */
+		blocks.clear();
+
+		for (ulint i = 0; i < node_ptrs.size(); i++) {
+			offsets = rec_get_offsets(
+				node_ptrs[i], index, offsets,
+				ULINT_UNDEFINED, &offsets_heap);
+
+			blocks.push_back(btr_block_get(
+				page_id_t(dict_index_get_space(index),
+					  btr_node_ptr_get_child_page_no(
+						  node_ptrs[i], offsets)),
+				page_size, RW_S_LATCH, index, &mtr));
+		}
+
+		level--;
+	}
+
+	n_ranges = ut_min(n_ranges, static_cast<ulint>(node_ptrs.size()));
+
+	/* The first node pointer of the level is the minimum record, the
+	bounds skip it */
+	for (ulint i = 1; i < n_ranges; i++) {
+		bounds[i - 1] = dict_index_build_data_tuple(
+			index, node_ptrs[i * node_ptrs.size() / n_ranges],
+			dict_index_get_n_unique_in_tree(index), heap);
+	}
+
+	mtr_commit(&mtr);
+
+	if (offsets_heap != NULL) {
+		mem_heap_free(offsets_heap);
+	}
+
+	return(n_ranges);
+}
+
+/** Open a cursor before the first record of a key range.
+@param[out]	cur		range cursor
+@param[in]	index		clustered index
+@param[in]	low		first key of the range, NULL for the start
+of the index
+@param[in]	high		first key after the range, NULL for the end
+of the index
+@param[in]	stop		stop flag, or NULL
+@param[in,out]	n_pages		leaf page counter, or NULL */
+void
+row_pread_cur_open(
+	row_pread_cur_t*	cur,
+	dict_index_t*		index,
+	const dtuple_t*		low,
+	const dtuple_t*		high,
+	volatile bool*		stop,
+	volatile ulint*		n_pages)
+{
+	cur->index = index;
+	cur->high = high;
+	cur->stop = stop;
+	cur->n_pages = n_pages;
+
+	mtr_start(&cur->mtr);
+
+	if (low == NULL) {
+		btr_pcur_open_at_index_side(
+			true, index, BTR_SEARCH_LEAF, &cur->pcur, true, 0,
+			&cur->mtr);
+	} else {
+		btr_pcur_open(index, low, PAGE_CUR_GE, BTR_SEARCH_LEAF,
+			      &cur->pcur, &cur->mtr);
+
+		/* row_pread_cur_next() moves to the next record first */
+		btr_pcur_move_to_prev_on_page(&cur->pcur);
+	}
+}
+
+/** Move a range cursor to the next record. At a page end the tree lock
+is released if it has waiters, as row_merge_read_clustered_index() does.
+@param[in,out]	cur		range cursor
+@param[in]	trx		transaction, checked for interruption
+@param[out]	offsets		rec_get_offsets() of the record
+@param[in,out]	heap		memory heap for offsets
+@param[out]	err		DB_SUCCESS or DB_INTERRUPTED
+@return the record, or NULL at the end of the range, when the scan was
+stopped or on error */
+const rec_t*
+row_pread_cur_next(
+	row_pread_cur_t*	cur,
+	trx_t*			trx,
+	ulint**			offsets,
+	mem_heap_t**		heap,
+	dberr_t*		err)
+{
+	dict_index_t*	index = cur->index;
+	page_cur_t*	page_cur = btr_pcur_get_page_cur(&cur->pcur);
+	const rec_t*	rec;
+
+	*err = DB_SUCCESS;
+
+	page_cur_move_to_next(page_cur);
+
+	if (page_cur_is_after_last(page_cur)) {
+
+		if (cur->n_pages != NULL) {
+			(*cur->n_pages)++;
+		}
+
+		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
+			*err = DB_INTERRUPTED;
+			return(NULL);
+		}
+
+		if (cur->stop != NULL && *cur->stop) {
+			return(NULL);
+		}
+
+		if (rw_lock_get_waiters(dict_index_get_lock(index))) {
+			/* Let a page split or merge go, as
+			row_merge_read_clustered_index() does */
+			btr_pcur_move_to_prev_on_page(&cur->pcur);
+			btr_pcur_store_position(&cur->pcur, &cur->mtr);
+			mtr_commit(&cur->mtr);
+
+			os_thread_yield();
+
+			mtr_start(&cur->mtr);
+			btr_pcur_restore_position(
+				BTR_SEARCH_LEAF, &cur->pcur, &cur->mtr);
+
+			if (!btr_pcur_move_to_next_user_rec(
+				    &cur->pcur, &cur->mtr)) {
+				return(NULL);
+			}
+		} else {
+			ulint		next_page_no;
+			buf_block_t*	block;
+
+			next_page_no = btr_page_get_next(
+				page_cur_get_page(page_cur), &cur->mtr);
+
+			if (next_page_no == FIL_NULL) {
+				return(NULL);
+			}
+
+			block = page_cur_get_block(page_cur);
+			block = btr_block_get(
+				page_id_t(block->page.id.space(),
+					  next_page_no),
+				block->page.size,
+				BTR_SEARCH_LEAF, index, &cur->mtr);
+
+			btr_leaf_page_release(page_cur_get_block(page_cur),
+					      BTR_SEARCH_LEAF, &cur->mtr);
+			page_cur_set_before_first(block, page_cur);
+			page_cur_move_to_next(page_cur);
+
+			ut_ad(!page_cur_is_after_last(page_cur));
+		}
+	}
+
+	rec = page_cur_get_rec(page_cur);
+
+	*offsets = rec_get_offsets(rec, index, NULL, ULINT_UNDEFINED, heap);
+
+	if (cur->high != NULL
+	    && cmp_dtuple_rec(cur->high, rec, *offsets) <= 0) {
+		/* The next range starts here */
+		return(NULL);
+	}
+
+	return(rec);
+}
+
+/** Close a range cursor.
+@param[in,out]	cur		range cursor */
+void
+row_pread_cur_close(
+	row_pread_cur_t*	cur)
+{
+	if (cur->mtr.is_active()) {
+		mtr_commit(&cur->mtr);
+	}
+
+	btr_pcur_close(&cur->pcur);
+}
+#endif /* UNIV_PARALLEL_READ || UNIV_PARALLEL_INDEX_BUILD */
+
+#if defined (UNIV_PARALLEL_READ)
+/** Shared context of a parallel read */
+struct row_pread_t {
+	trx_t*			trx;		/*!< transaction */
+	dict_index_t*		index;		/*!< clustered index */
+	ReadView*		view;		/*!< read view, NULL in
+						READ UNCOMMITTED */
+	dtuple_t**		bounds;		/*!< bounds[r] is the first
+						key of the range r + 1 */
+	ulint			n_ranges;	/*!< number of ranges */
+	row_pread_func_t	func;		/*!< callback */
+	void*			arg;		/*!< argument of func */
+	volatile ulint		next_range;	/*!< next range to scan */
+	volatile bool		stop;		/*!< set by a thread that
+						failed, the others stop at
+						their next page */
+};
+
+/** Scan thread of a parallel read */
+struct row_pread_thread_t {
+	row_pread_t*		pread;		/*!< shared context */
+	ulint			thread_no;	/*!< number of the thread */
+	dberr_t			err;		/*!< result of the thread */
+	os_thread_id_t		thread;		/*!< thread handle */
+};
+
+/** Row counter of a scan thread, on its own cache line */
+struct row_pread_counter_t {
+	ulint		n_rows;				/*!< rows counted */
+	byte		pad[CACHE_LINE_SIZE - sizeof(ulint)];
+};
+
+/** Read a key range of the clustered index and pass its visible records
+to the callback.
+@param[in,out]	pread		shared context
+@param[in]	thread_no	number of the scan thread
+@param[in]	range_no	range to read
+@return DB_SUCCESS or error code */
+static
+dberr_t
+row_pread_range(
+	row_pread_t*	pread,
+	ulint		thread_no,
+	ulint		range_no)
+{
+	dict_index_t*	index = pread->index;
+	const bool	comp = dict_table_is_comp(index->table);
+	row_pread_cur_t	cur;
+	mem_heap_t*	heap;
+	row_pread_row_t	row;
+	dberr_t		err = DB_SUCCESS;
+
+	row.thread_no = thread_no;
+	row.range_no = range_no;
+	row.first_in_range = true;
+	row.index = index;
+
+	heap = mem_heap_create(UNIV_PAGE_SIZE);
+
+	row_pread_cur_open(
+		&cur, index,
+		range_no > 0 ? pread->bounds[range_no - 1] : NULL,
+		range_no + 1 < pread->n_ranges
+		? pread->bounds[range_no] : NULL,
+		&pread->stop, NULL);
+
+	for (;;) {
+		const rec_t*	rec;
+		ulint*		offsets;
+
+		mem_heap_empty(heap);
+
+		rec = row_pread_cur_next(
+			&cur, pread->trx, &offsets, &heap, &err);
+
+		if (rec == NULL) {
+			break;
+		}
+
+		if (pread->view != NULL
+		    && !lock_clust_rec_cons_read_sees(
+			    rec, index, offsets, pread->view)) {
+			rec_t*	old_vers;
+
+			err = row_vers_build_for_consistent_read(
+				rec, &cur.mtr, index, &offsets, pread->view,
+				&heap, heap, &old_vers, NULL);
+
+			if (err != DB_SUCCESS) {
+				break;
+			}
+
+			rec = old_vers;
+
+			if (rec == NULL) {
+				/* Inserted after the read view */
+				continue;
+			}
+		}
+
+		if (rec_get_deleted_flag(rec, comp)) {
+			continue;
+		}
+
+		row.rec = rec;
+		row.offsets = offsets;
+
+		err = pread->func(&row, pread->arg);
+
+		if (err != DB_SUCCESS) {
+			break;
+		}
+
+		row.first_in_range = false;
+	}
+
+	row_pread_cur_close(&cur);
+
+	mem_heap_free(heap);
+
+	return(err);
+}
+
+/** Read ranges until all of them are taken or a thread failed.
+@param[in,out]	thr	scan thread */
+static
+void
+row_pread_ranges(
+	row_pread_thread_t*	thr)
+{
+	row_pread_t*	pread = thr->pread;
+
+	thr->err = DB_SUCCESS;
+
+	while (!pread->stop) {
+		ulint	range_no = os_atomic_increment_ulint(
+			&pread->next_range, 1) - 1;
+
+		if (range_no >= pread->n_ranges) {
+			break;
+		}
+
+		thr->err = row_pread_range(pread, thr->thread_no, range_no);
+
+		if (thr->err != DB_SUCCESS) {
+			pread->stop = true;
+			break;
+		}
+	}
+}
+
+/** Scan thread of a parallel read
+@param[in,out]	arg	row_pread_thread_t of the thread
+@return OS_THREAD_DUMMY_RETURN */
+static
+os_thread_ret_t
+row_pread_thread(
+	void*	arg)
+{
+	row_pread_ranges(static_cast<row_pread_thread_t*>(arg));
+
+	os_thread_exit(false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/** Read the clustered index with n_threads threads. The records that are
+not delete-marked in the read view of the transaction are passed to func,
+in READ UNCOMMITTED the latest versions are. The read view is assigned
+to the transaction if it has none. Only non-locking reads are done.
+@param[in]	trx		transaction
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads, 1 reads in the
+calling thread
+@param[in]	func		callback
+@param[in,out]	arg		argument of the callback
+@return DB_SUCCESS, DB_INTERRUPTED or the error returned by func */
+dberr_t
+row_pread_scan(
+	trx_t*			trx,
+	dict_index_t*		index,
+	ulint			n_threads,
+	row_pread_func_t	func,
+	void*			arg)
+{
+	row_pread_t		pread;
+	row_pread_thread_t*	threads;
+	mem_heap_t*		heap;
+	dberr_t			err = DB_SUCCESS;
+
+	ut_ad(dict_index_is_clust(index));
+	ut_ad(n_threads > 0);
+
+	trx_start_if_not_started(trx, false);
+
+	pread.trx = trx;
+	pread.index = index;
+	pread.view = trx->isolation_level > TRX_ISO_READ_UNCOMMITTED
+		? trx_assign_read_view(trx) : NULL;
+	pread.func = func;
+	pread.arg = arg;
+	pread.next_range = 0;
+	pread.stop = false;
+
+	heap = mem_heap_create(1024);
+
+	pread.bounds = static_cast<dtuple_t**>(
+		mem_heap_alloc(heap, n_threads * ROW_PREAD_RANGES_PER_THREAD
+			       * sizeof *pread.bounds));
+
+	pread.n_ranges = n_threads == 1
+		? 1
+		: row_pread_split(index,
+				  n_threads * ROW_PREAD_RANGES_PER_THREAD,
+				  pread.bounds, heap);
+
+	n_threads = ut_min(n_threads, pread.n_ranges);
+
+	threads = static_cast<row_pread_thread_t*>(
+		ut_zalloc_nokey(n_threads * sizeof *threads));
+
+	for (ulint i = 0; i < n_threads; i++) {
+		threads[i].pread = &pread;
+		threads[i].thread_no = i;
+	}
+
+	/* The calling thread is the thread 0 */
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_create(row_pread_thread, &threads[i],
+				 &threads[i].thread);
+	}
+
+	row_pread_ranges(&threads[0]);
+
+	for (ulint i = 1; i < n_threads; i++) {
+		os_thread_join(threads[i].thread);
+	}
+
+	for (ulint i = 0; i < n_threads; i++) {
+		if (threads[i].err != DB_SUCCESS) {
+			err = threads[i].err;
+			break;
+		}
+	}
+
+	ut_free(threads);
+	mem_heap_free(heap);
+
+	return(err);
+}
+
+/** Callback of row_pread_count()
+@param[in]	row	visible record
+@param[in,out]	arg	row_pread_counter_t of the threads
+@return DB_SUCCESS */
+static
+dberr_t
+row_pread_count_func(
+	const row_pread_row_t*	row,
+	void*			arg)
+{
+	static_cast<row_pread_counter_t*>(arg)[row->thread_no].n_rows++;
+
+	return(DB_SUCCESS);
+}
+
+/** Count the visible records of the clustered index with n_threads
+threads, see row_pread_scan().
+@param[in]	trx		transaction
+@param[in]	index		clustered index
+@param[in]	n_threads	number of scan threads
+@param[out]	n_rows		number of records in the read view
+@return DB_SUCCESS or DB_INTERRUPTED */
+dberr_t
+row_pread_count(
+	trx_t*			trx,
+	dict_index_t*		index,
+	ulint			n_threads,
+	ulint*			n_rows)
+{
+	row_pread_counter_t*	counters = static_cast<row_pread_counter_t*>(
+		ut_zalloc_nokey(n_threads * sizeof *counters));
+
+	dberr_t	err = row_pread_scan(
+		trx, index, n_threads, row_pread_count_func, counters);
+
+	*n_rows = 0;
+
+	for (ulint i = 0; i < n_threads; i++) {
+		*n_rows += counters[i].n_rows;
+	}
+
+	ut_free(counters);
+
+	return(err);
+}
+#endif /* UNIV_PARALLEL_READ */
@@ -3946,23 +3946,78 @@ row_sel_dequeue_cached_row_for_mysql(
 	}
 }
 
+#if defined (UNIV_BATCHED_FETCH)
+/** Pop the rows of the fetch cache to a buffer of consecutive MySQL rows,
+for a batched read after a fetch that filled the cache.
+@param[out]	buf		first row to write
+@param[in]	stride		distance between two rows in buf
+@param[in]	max_rows	maximum number of rows to write
+@param[in,out]	prebuilt	prebuilt struct
+@return number of rows written */
+ulint
+row_sel_dequeue_cached_rows_for_mysql(
+	byte*		buf,
+	ulint		stride,
+	ulint		max_rows,
+	row_prebuilt_t*	prebuilt)
+{
+	ulint	n = 0;
+
+	ut_ad(stride >= prebuilt->mysql_row_len);
+
+	while (n < max_rows && prebuilt->n_fetch_cached > 0) {
+		row_sel_dequeue_cached_row_for_mysql(buf, prebuilt);
+
+		buf += stride;
+		n++;
+	}
+
+	prebuilt->n_rows_fetched += n;
+
+	return(n);
+}
+#endif /* UNIV_BATCHED_FETCH */
+
 /********************************************************************//**
 Initialise the prefetch cache. */
 UNIV_INLINE
 void
 row_sel_prefetch_cache_init(
 /*========================*/
+#if defined (UNIV_BATCHED_FETCH)
+	row_prebuilt_t*	prebuilt,	/*!< in/out: prebuilt struct */
+	ulint		n_rows)		/*!< in: number of rows to allocate,
+					an empty cache is freed first */
+#else
 	row_prebuilt_t*	prebuilt)	/*!< in/out: prebuilt struct */
+#endif /* UNIV_BATCHED_FETCH */
 {
 	ulint	i;
 	ulint	sz;
 	byte*	ptr;
 
+#if defined (UNIV_BATCHED_FETCH)
+	ut_ad(prebuilt->n_fetch_cached == 0);
+
+	if (prebuilt->fetch_cache[0] != NULL) {
+		ut_free(prebuilt->fetch_cache[0] - 4);
+	}
+
+	prebuilt->n_fetch_cache_alloc = n_rows;
+
+	/* Reserve space for the magic number. */
+	sz = n_rows * (prebuilt->mysql_row_len + 8);
+#else
 	/* Reserve space for the magic number. */
 	sz = UT_ARR_SIZE(prebuilt->fetch_cache) * (prebuilt->mysql_row_len + 8);
+#endif /* UNIV_BATCHED_FETCH */
 	ptr = static_cast<byte*>(ut_malloc_nokey(sz));
 
+#if defined (UNIV_BATCHED_FETCH)
+	for (i = 0; i < n_rows; i++) {
+#else
 	for (i = 0; i < UT_ARR_SIZE(prebuilt->fetch_cache); i++) {
+#endif /* UNIV_BATCHED_FETCH */
 
 		/* A user has reported memory corruption in these
 		buffers in Linux. Put magic numbers there to help
@@ -3989,14 +4044,42 @@ row_sel_fetch_last_buf(
 	row_prebuilt_t*	prebuilt)	/*!< in/out: prebuilt struct */
 {
 	ut_ad(!prebuilt->templ_contains_blob);
+#if defined (UNIV_BATCHED_FETCH)
+	ut_ad(prebuilt->n_fetch_cached < prebuilt->fetch_cache_size);
+#else
 	ut_ad(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
+#endif /* UNIV_BATCHED_FETCH */
+
+#if defined (UNIV_BATCHED_FETCH)
+	if (prebuilt->fetch_cache[0] == NULL) {
+		/* Allocate memory for the fetch cache, it grows with
+		fetch_cache_size */
+		ut_ad(prebuilt->n_fetch_cached == 0);
 
+		prebuilt->n_fetch_cache_max = ut_max(
+			static_cast<ulint>(MYSQL_FETCH_CACHE_SIZE),
+			ut_min(static_cast<ulint>(MYSQL_FETCH_CACHE_MAX_BYTES
+						  / (prebuilt->mysql_row_len
+						     + 8)),
+			       UT_ARR_SIZE(prebuilt->fetch_cache)));
+
+		row_sel_prefetch_cache_init(
+			prebuilt, prebuilt->fetch_cache_size);
+	} else if (prebuilt->n_fetch_cached == 0
+		   && prebuilt->fetch_cache_size
+		   > prebuilt->n_fetch_cache_alloc) {
+		/* The cache is empty, no row has to be copied */
+		row_sel_prefetch_cache_init(
+			prebuilt, prebuilt->fetch_cache_size);
+	}
+#else
 	if (prebuilt->fetch_cache[0] == NULL) {
 		/* Allocate memory for the fetch cache */
 		ut_ad(prebuilt->n_fetch_cached == 0);
 
 		row_sel_prefetch_cache_init(prebuilt);
 	}
+#endif /* UNIV_BATCHED_FETCH */
 
 	ut_ad(prebuilt->fetch_cache_first == 0);
 	UNIV_MEM_INVALID(prebuilt->fetch_cache[prebuilt->n_fetch_cached],
@@ -4718,6 +4801,10 @@ row_search_mvcc(
 		prebuilt->n_rows_fetched = 0;
 		prebuilt->n_fetch_cached = 0;
 		prebuilt->fetch_cache_first = 0;
+#if defined (UNIV_BATCHED_FETCH)
+		prebuilt->fetch_cache_size = MYSQL_FETCH_CACHE_SIZE;
+		prebuilt->fetch_cache_short = false;
+#endif /* UNIV_BATCHED_FETCH */
 
 		if (prebuilt->sel_graph == NULL) {
 			/* Build a dummy select query graph */
@@ -4742,6 +4829,9 @@ row_search_mvcc(
 			prebuilt->n_rows_fetched = 0;
 			prebuilt->n_fetch_cached = 0;
 			prebuilt->fetch_cache_first = 0;
+#if defined (UNIV_BATCHED_FETCH)
+			prebuilt->fetch_cache_short = false;
+#endif /* UNIV_BATCHED_FETCH */
 
 		} else if (UNIV_LIKELY(prebuilt->n_fetch_cached > 0)) {
 			row_sel_dequeue_cached_row_for_mysql(buf, prebuilt);
@@ -4758,8 +4848,15 @@ row_search_mvcc(
 			goto func_exit;
 		}
 
+#if defined (UNIV_BATCHED_FETCH)
+		/* fetch_cache_first is reset when the cache is emptied, and
+		the cache holds fetch_cache_size rows, not
+		MYSQL_FETCH_CACHE_SIZE */
+		if (prebuilt->fetch_cache_short) {
+#else
 		if (prebuilt->fetch_cache_first > 0
 		    && prebuilt->fetch_cache_first < MYSQL_FETCH_CACHE_SIZE) {
+#endif /* UNIV_BATCHED_FETCH */
 
 			/* The previous returned row was popped from the fetch
 			cache, but the cache was not full at the time of the
@@ -4865,8 +4962,13 @@ row_search_mvcc(
 			hash index semaphore! */
 
 			ut_a(!trx->has_search_latch);
+#if defined (UNIV_AHI_EPOCH)
+			/* The hash index is searched without the
+			search latch, and the page is latched */
+#else
 			rw_lock_s_lock(btr_get_search_latch(index));
 			trx->has_search_latch = true;
+#endif /* UNIV_AHI_EPOCH */
 
 			switch (row_sel_try_search_shortcut_for_mysql(
 					&rec, prebuilt, &offsets, &heap,
@@ -4918,8 +5020,10 @@ row_search_mvcc(
 
 				err = DB_SUCCESS;
 
+#if !defined (UNIV_AHI_EPOCH)
 				rw_lock_s_unlock(btr_get_search_latch(index));
 				trx->has_search_latch = false;
+#endif /* !UNIV_AHI_EPOCH */
 
 				goto func_exit;
 
@@ -4929,8 +5033,10 @@ row_search_mvcc(
 
 				err = DB_RECORD_NOT_FOUND;
 
+#if !defined (UNIV_AHI_EPOCH)
 				rw_lock_s_unlock(btr_get_search_latch(index));
 				trx->has_search_latch = false;
+#endif /* !UNIV_AHI_EPOCH */
 
 				/* NOTE that we do NOT store the cursor
 				position */
@@ -4947,8 +5053,10 @@ row_search_mvcc(
 			mtr_commit(&mtr);
 			mtr_start(&mtr);
 
+#if !defined (UNIV_AHI_EPOCH)
                         rw_lock_s_unlock(btr_get_search_latch(index));
                         trx->has_search_latch = false;
+#endif /* !UNIV_AHI_EPOCH */
 		}
 	}
 
@@ -5872,7 +5980,11 @@ requires_clust_rec:
 		not cache rows because there the cursor is a scrollable
 		cursor. */
 
+#if defined (UNIV_BATCHED_FETCH)
+		ut_a(prebuilt->n_fetch_cached < prebuilt->fetch_cache_size);
+#else
 		ut_a(prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE);
+#endif /* UNIV_BATCHED_FETCH */
 
 		/* We only convert from InnoDB row format to MySQL row
 		format when ICP is disabled. */
@@ -5925,9 +6037,27 @@ requires_clust_rec:
 			row_sel_enqueue_cache_row_for_mysql(buf, prebuilt);
 		}
 
+#if defined (UNIV_BATCHED_FETCH)
+		if (prebuilt->n_fetch_cached < prebuilt->fetch_cache_size) {
+			/* cleared below if the cache gets full */
+			prebuilt->fetch_cache_short = true;
+			goto next_rec;
+		}
+
+		prebuilt->fetch_cache_short = false;
+
+		/* The cursor was not exhausted, convert more rows under
+		the page latch in the next fetch */
+		if (prebuilt->fetch_cache_size < prebuilt->n_fetch_cache_max) {
+			prebuilt->fetch_cache_size = ut_min(
+				2 * prebuilt->fetch_cache_size,
+				prebuilt->n_fetch_cache_max);
+		}
+#else
 		if (prebuilt->n_fetch_cached < MYSQL_FETCH_CACHE_SIZE) {
 			goto next_rec;
 		}
+#endif /* UNIV_BATCHED_FETCH */
 
 	} else {
 		if (UNIV_UNLIKELY
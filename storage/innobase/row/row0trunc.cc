@@ -443,7 +443,7 @@ public:
 
 			mtr_start(&mtr);
 
-			log_ptr = mlog_open(&mtr, 11 + 8);
+			log_ptr = mlog_open(&mtr, MLOG_HEADER_SIZE + 8);
 			log_ptr = mlog_write_initial_log_record_low(
 				MLOG_TRUNCATE, m_table->space, 0,
 				log_ptr, &mtr);
@@ -209,6 +209,32 @@ extern bool		trx_commit_disallowed;
 #if defined (UNIV_AIO_IMPROVE)
 ulong	srv_aio_n_slots_per_seg	= 256;
 #endif 
+#if defined (UNIV_LOCK_SYS_SHARDED)
+ulong	srv_lock_sys_n_shards	= 64;
+#endif
+#if defined (UNIV_MVCC_CSN)
+ulong	srv_mvcc_csn_slots	= 1048576;
+#endif
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+ulong	srv_log_recent_written_size	= 1048576;
+#endif
+#if defined (UNIV_IO_URING)
+/* If this flag is TRUE, then the Linux native aio requests go through
+io_uring instead of libaio */
+my_bool	srv_use_io_uring	= TRUE;
+/* If this flag is TRUE, the completions of the tablespace i/o are polled */
+my_bool	srv_io_uring_poll	= FALSE;
+#endif
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+/* Number of threads scanning the clustered index and loading the secondary
+indexes of an ALTER TABLE ... ADD INDEX, 1 for the serial build */
+ulong	srv_parallel_index_build_threads	= 4;
+#endif
+#if defined (UNIV_PARALLEL_READ)
+/* Number of threads of the parallel reader of a clustered index, used by
+COUNT(*) and CHECK TABLE */
+ulong	srv_parallel_read_threads	= 4;
+#endif
 
 #if defined(UNIV_PMEMOBJ_BUF) || defined (UNIV_AIO_IMPROVE)
 ulong	srv_pmem_buf_bucket_size	= 256;
@@ -233,6 +259,30 @@ double	srv_pmem_bloom_fpr			= 0.01;
 ulong	srv_pmem_sim_latency			= 1000;
 #endif
 
+#if defined (UNIV_PMEMOBJ_DBW_PARTITION)
+ulong	srv_pmem_dbw_slots_per_part		= 128;
+#endif
+
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+/* Milliseconds between two spills of the NVM log buffer to ib_logfile */
+ulong	srv_pmem_log_spill_interval		= 100;
+#endif
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+/* Number of undo page slots in the PMEM pool */
+ulong	srv_pmem_undo_slots			= 1024;
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+/* Number of page slots of the warm restart area in the PMEM pool */
+ulong	srv_pmem_warm_slots			= 65536;
+#endif
+
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+/* Number of page slots of the victim cache of clean pages in the PMEM pool */
+ulong	srv_pmem_vcache_slots			= 65536;
+#endif
+
 #if defined(UNIV_PMEMOBJ_BUF) || defined (UNIV_PMEMOBJ_DBW) || defined (UNIV_PMEMOBJ_LOG) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PART_PL)
 char*	srv_pmem_home_dir			= NULL;
 ulong	srv_pmem_pool_size			= 8 * 1024;
@@ -253,8 +303,34 @@ double	srv_ppl_ckpt_threshold = 0.7;
 ulong	srv_ppl_log_flusher_wake_threshold = 5;
 ulong	srv_ppl_n_log_flush_threads = 32;
 ulong	srv_ppl_n_redoer_threads = 32;
+ulong	srv_ppl_n_init_threads = 8;
 ulong	srv_ppl_log_file_size = 16384;
 ulong	srv_ppl_log_files_per_bucket = 1;
+#if defined (UNIV_PMEMOBJ_PPL_RECV_SCHED)
+ulong	srv_ppl_recv_read_batch = 1024;
+#endif
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+ulong	srv_ppl_log_mode = PMEM_LOG_MODE_PAGE;
+ulong	srv_ptxl_n_buckets = 128;
+ulong	srv_ptxl_blocks_per_bucket = 64;
+ulong	srv_ptxl_block_size = 64 * 1024;
+ulong	srv_ptxl_dpt_n_lines = 512;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+ulong	srv_ppl_reclaim_queue_size = 65536;
+ulong	srv_ppl_reclaim_batch = 256;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_MAGAZINE)
+ulong	srv_ppl_magazine_size = 8;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH)
+ulong	srv_ppl_flush_pressure_pct = 50;
+#endif
+#if defined (UNIV_PMEMOBJ_PPL_NUMA)
+/* One PMEM dir per NUMA node separated by ';', NULL keeps all data in
+srv_pmem_home_dir */
+char*	srv_pmem_numa_home_dirs = NULL;
+#endif
 
 #endif //UNIV_PMEMOBJ_PART_PL
 char*	srv_log_group_home_dir	= NULL;
@@ -1563,6 +1639,10 @@ srv_export_innodb_status(void)
 
 	export_vars.innodb_rows_deleted = srv_stats.n_rows_deleted;
 
+#if defined (UNIV_BATCHED_FETCH)
+	export_vars.innodb_rows_read_batched = srv_stats.n_rows_read_batched;
+#endif /* UNIV_BATCHED_FETCH */
+
 	export_vars.innodb_num_open_files = fil_n_file_opened;
 
 	export_vars.innodb_truncated_status_writes =
@@ -1902,6 +1982,13 @@ srv_any_background_threads_are_active(void)
 	} else if (srv_dict_stats_thread_active) {
 		thread_active = "dict_stats_thread";
 	}
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+	else if (log_sys->spill_thread_active) {
+		thread_active = "log_spill_thread";
+	}
+
+	os_event_set(log_sys->spill_event);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
 
 	os_event_set(srv_error_event);
 	os_event_set(srv_monitor_event);
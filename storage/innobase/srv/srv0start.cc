@@ -54,6 +54,7 @@ Created 2/16/1996 Heikki Tuuri
 #include "dict0dict.h"
 #include "buf0buf.h"
 #include "buf0dump.h"
+#include "buf0lru.h"
 #include "os0file.h"
 #include "os0thread.h"
 #include "fil0fil.h"
@@ -66,6 +67,7 @@ Created 2/16/1996 Heikki Tuuri
 #include "page0cur.h"
 #include "trx0trx.h"
 #include "trx0sys.h"
+#include "trx0undo.h"
 #include "btr0btr.h"
 #include "btr0cur.h"
 #include "rem0rec.h"
@@ -1512,7 +1514,7 @@ innobase_start_or_create_for_mysql(void)
 		ulint start_rollback_time;
 		ulint end_rollback_time;
 		
-		ulint t1, t2, t3;
+		ulint t0, t1, t2, t3;
 		ulint other_time;
 		ulint total_recv_time;		
 
@@ -1521,7 +1523,7 @@ innobase_start_or_create_for_mysql(void)
 			start_create_undo_time = end_create_undo_time =
 			start_redo2_time = end_redo2_time =
 			start_rollback_time = end_rollback_time =
-			t1 = t2 = t3 = 0;
+			t0 = t1 = t2 = t3 = 0;
 #endif /* UNIV_TRACE_RECOVERY_TIME*/
 
 	/* Reset the start state. */
@@ -1784,13 +1786,79 @@ innobase_start_or_create_for_mysql(void)
 	ib::info() << "Hello NVM Log from VLDB lab ========\n";
 	gb_pfc = pfc_new(srv_log_file_size);
 #endif
+#if defined (UNIV_LOCK_SYS_SHARDED)
+	ib::info() << "+++++ add-in SHARDED lock_sys, shards = " << srv_lock_sys_n_shards << " ========\n";
+#endif
+#if defined (UNIV_MVCC_CSN)
+	ib::info() << "+++++ add-in CSN read views, CSN map slots = " << srv_mvcc_csn_slots << " ========\n";
+#endif
+#if defined (UNIV_LOG_CONCURRENT_COPY)
+	ib::info() << "+++++ add-in concurrent redo log copy, recent written window = " << srv_log_recent_written_size << " ========\n";
+#endif
+#if defined (UNIV_IO_URING)
+	ib::info() << "+++++ add-in io_uring AIO backend, use_io_uring = " << srv_use_io_uring << " poll = " << srv_io_uring_poll << " ========\n";
+#endif
+#if defined (UNIV_PARALLEL_INDEX_BUILD)
+	ib::info() << "+++++ add-in parallel index build, threads = " << srv_parallel_index_build_threads << " ========\n";
+#endif
+#if defined (UNIV_PARALLEL_READ)
+	ib::info() << "+++++ add-in parallel clustered index read, threads = " << srv_parallel_read_threads << " ========\n";
+#endif
+#if defined (UNIV_BATCHED_FETCH)
+	ib::info() << "+++++ add-in batched fetch, max cached rows = " << MYSQL_FETCH_CACHE_MAX_SIZE << " ========\n";
+#endif
+#if defined (UNIV_AHI_EPOCH)
+	ib::info() << "+++++ add-in lock-free adaptive hash index lookups, epoch slots = " << BTR_SEARCH_EPOCH_SLOTS << " ========\n";
+#endif
 #if defined (UNIV_PMEMOBJ_LOG) || defined(UNIV_PMEMOBJ_DBW) || defined (UNIV_PMEMOBJ_BUF) || defined (UNIV_PMEMOBJ_WAL) || defined (UNIV_PMEMOBJ_PART_PL)
 	#ifdef UNIV_PMEMOBJ_LOG
 		ib::info() << "======= Hello PMEMOBJ Log from VLDB lab ========\n";
 	#endif
+	#ifdef UNIV_PMEMOBJ_LOG_SPILL
+		ib::info() << "+++++ PMEMOBJ_LOG with add-in SPILL thread, interval = " << srv_pmem_log_spill_interval << " ms ========\n";
+	#endif
 	#ifdef UNIV_PMEMOBJ_DBW
 		ib::info() << "======= Hello PMEMOBJ Double Write Buffer from VLDB lab ========\n";
 	#endif
+	#ifdef UNIV_PMEMOBJ_DBW_PARTITION
+		ib::info() << "+++++ PMEMOBJ_DBW with add-in per page cleaner PARTITION, slots per partition = " << srv_pmem_dbw_slots_per_part << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_UNDO
+		ib::info() << "+++++ PMEMOBJ with add-in UNDO pages on NVM without redo, slots = " << srv_pmem_undo_slots << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_BUF_WARM
+		ib::info() << "+++++ PMEMOBJ with add-in WARM restart of the buffer pool from NVM, slots = " << srv_pmem_warm_slots << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_BUF_VCACHE
+		ib::info() << "+++++ PMEMOBJ with add-in VICTIM cache of clean pages on NVM, slots = " << srv_pmem_vcache_slots << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_COMPACT
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in COMPACT log rec encoding ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_CHECKSUM
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in CHECKSUM per log rec, recovery stops at the first bad rec ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_HYBRID
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in HYBRID mode, system/undo spaces on log_sys ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_RECV_SCHED
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in sorted recovery reads, batch = " << srv_ppl_recv_read_batch << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_MAGAZINE
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in per-CPU MAGAZINES of free log bufs, batch = " << srv_ppl_magazine_size << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_RECLAIMER
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in background RECLAIMER, queue = " << srv_ppl_reclaim_queue_size << " batch = " << srv_ppl_reclaim_batch << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_PRESSURE_FLUSH
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in log space PRESSURE FLUSH, pressure pct = " << srv_ppl_flush_pressure_pct << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_PPL_NUMA
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in NUMA placement, node dirs = " << (srv_pmem_numa_home_dirs ? srv_pmem_numa_home_dirs : "(pmem_home_dir)") << " ========\n";
+	#endif
+	#ifdef UNIV_PMEMOBJ_TX_LOG
+		ib::info() << "+++++ PMEMOBJ_PART_PL with add-in PER-TX log blocks, mode = " << (srv_ppl_log_mode == PMEM_LOG_MODE_TX ? "per-transaction" : "per-page") << " ========\n";
+	#endif
 	#ifdef UNIV_PMEMOBJ_BUF
 		ib::info() << "======= Hello PMEMOBJ Buffer from VLDB lab ========\n";
 	#endif
@@ -1997,6 +2065,25 @@ innobase_start_or_create_for_mysql(void)
 #if defined (UNIV_PMEMOBJ_PART_PL)
 	pm_wrapper_page_log_alloc_or_open(gb_pmw);
 #endif // UNIV_PMEMOBJ_PL
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	/*allocated in both modes, so the recs left by a run in the other
+	 * mode are still recovered*/
+	pm_wrapper_tx_log_alloc_or_open(gb_pmw,
+			ut_find_prime(srv_ptxl_n_buckets),
+			srv_ptxl_blocks_per_bucket,
+			srv_ptxl_block_size);
+#endif // UNIV_PMEMOBJ_TX_LOG
+
+#if defined (UNIV_PMEMOBJ_UNDO)
+	trx_undo_nvm_init();
+#endif /* UNIV_PMEMOBJ_UNDO */
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	/*before recovery, the pages it writes must drop their NVM images*/
+	buf_warm_init();
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	buf_vcache_init();
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 
 	recv_sys_create();
 	recv_sys_init(buf_pool_get_curr_size());
@@ -2053,6 +2140,9 @@ innobase_start_or_create_for_mysql(void)
 	for (i = 0; i < srv_ppl_n_log_flush_threads; ++i) {
 		os_thread_create(pm_log_flusher_worker, NULL, NULL);
 	}
+#if defined (UNIV_PMEMOBJ_PPL_RECLAIMER)
+	os_thread_create(pm_ppl_reclaimer_thread, NULL, NULL);
+#endif
 	
 #endif 
 
@@ -2421,7 +2511,16 @@ files_checked:
 		start_redo1_time = ut_time_us(NULL);
 #endif /* UNIV_TRACE_RECOVERY_TIME*/
 
-#if defined (UNIV_PMEMOBJ_PART_PL)
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+		/* log_sys first for the system and undo tablespaces, then
+		PPL for the user tablespaces. Both logs were checkpointed
+		together by pm_ppl_checkpoint(). */
+		err = recv_recovery_from_checkpoint_start(flushed_lsn);
+
+		if (err == DB_SUCCESS && !gb_pmw->ppl->is_new) {
+			err = pm_ppl_recovery(gb_pmw->pop, gb_pmw->ppl, flushed_lsn);
+		}
+#elif defined (UNIV_PMEMOBJ_PART_PL)
 		if (gb_pmw->ppl->is_new){
 			err = recv_recovery_from_checkpoint_start(flushed_lsn);
 		}			
@@ -2910,6 +3009,12 @@ files_checked:
 		/* Create the dict stats gathering thread */
 		os_thread_create(dict_stats_thread, NULL, NULL);
 
+#if defined (UNIV_PMEMOBJ_LOG_SPILL)
+		/* Create the thread that writes the NVM log buffer to
+		the log files */
+		os_thread_create(log_spill_thread, NULL, NULL);
+#endif /* UNIV_PMEMOBJ_LOG_SPILL */
+
 		/* Create the thread that will optimize the FTS sub-system. */
 		fts_optimize_init();
 
@@ -2937,8 +3042,13 @@ files_checked:
 	ulint tem = (ulint) (recv_sys->redo1_time * 1.0 / 1000);
 	t1 = t1 - tem;
 	t3 = t3 + tem;
+
+	/*the analysis is inside the redo phase1 window*/
+	t0 = (ulint) (recv_sys->analysis_time * 1.0 / 1000);
+	t1 = (t1 > t0) ? (t1 - t0) : 0;
 		
 	printf("============= RECOVERY OVERHEAD ==========\n");		
+	printf("Analysis time (ms):\t\t %zu\n", t0);
 	printf("Redo phase1 time (ms):\t\t %zu\n", t1); 
 	printf("Create RSEG time (ms):\t\t %zu\n", t2);
 	printf("Redo phase2 time (ms):\t\t %zu\n", t3); 
@@ -2947,6 +3057,10 @@ files_checked:
 	printf("Total time (ms):\t\t %zu\n", total_recv_time);
 
 	printf("==========================================\n");		
+	/*one line for bench_recovery.sh*/
+	printf("RECOVERY_TIME_MS analysis=%zu redo1=%zu rseg=%zu redo2=%zu others=%zu total=%zu\n",
+		t0, t1, t2, t3, other_time, total_recv_time);
+	fflush(stdout);
 #endif /* UNIV_TRACE_RECOVERY_TIME*/
 	return(DB_SUCCESS);
 }
@@ -3019,6 +3133,15 @@ innobase_shutdown_for_mysql(void)
 	//Print the statistic info
 	pm_buf_stat_print_all(gb_pmw->pbuf);	
 #endif
+#if defined (UNIV_PMEMOBJ_UNDO)
+	trx_undo_nvm_free();
+#endif /* UNIV_PMEMOBJ_UNDO */
+#if defined (UNIV_PMEMOBJ_BUF_WARM)
+	buf_warm_free();
+#endif /* UNIV_PMEMOBJ_BUF_WARM */
+#if defined (UNIV_PMEMOBJ_BUF_VCACHE)
+	buf_vcache_free();
+#endif /* UNIV_PMEMOBJ_BUF_VCACHE */
 	pm_wrapper_free(gb_pmw);
 #endif
 
@@ -3299,6 +3422,8 @@ srv_get_encryption_data_filename(
 /*
  * Create all part-log files if they are not exist
  * Only call this function when the server start
+ * The existing files are not opened here, the fil_node and the log group of
+ * a line are set up on its first log IO, see pm_ppl_get_log_group()
  * */
 dberr_t
 pm_create_or_open_part_log_files(
@@ -3311,15 +3436,14 @@ pm_create_or_open_part_log_files(
 	uint64_t i;
 	uint64_t n_log_files = ppl->n_log_files_per_bucket * ppl->n_buckets;
 
-	uint64_t n_log_files_found = n_log_files;
-
-	
 	ppl->node_arr = static_cast<fil_node_t**> (calloc(ppl->n_buckets, sizeof(fil_node_t*)));
 	
 	for (i = 0; i < ppl->n_buckets; i++){
-		ppl->node_arr[i] = static_cast<fil_node_t*> (malloc(sizeof(fil_node_t)));
+		ppl->node_arr[i] = static_cast<fil_node_t*> (calloc(1, sizeof(fil_node_t)));
 	}
 
+	ppl->log_dir = mem_strdupl(logfilename, dirnamelen);
+
 	ppl->log_space = static_cast<fil_space_t*> (malloc(sizeof(fil_space_t)));
 
 	if (ppl->is_new){
@@ -3348,32 +3472,6 @@ pm_create_or_open_part_log_files(
 
 		ib::info() << "End creating " << n_log_files << "part-log files  ...";
 	}
-	else {
-		// Open files
-		for (i = 0; i < n_log_files; i++) {
-			os_offset_t	size;
-			sprintf(logfilename + dirnamelen,
-				"pl_logfile%zu", i);
-			err = open_log_file(&ppl->log_files[i], logfilename, &size);
-			//err = open_log_file(&files[i], logfilename, &size);
-			if (err != DB_SUCCESS) {
-				printf("PMEM open log file\n");
-				assert(0);
-				return DB_ERROR;
-			}
-
-			ut_a(size != (os_offset_t) -1);
-			if (size & ((1 << UNIV_PAGE_SIZE_SHIFT) - 1)) {
-
-				ib::error() << "Log file " << logfilename
-					<< " size " << size << " is not a"
-					" multiple of innodb_page_size";
-				assert(0);
-				return DB_ERROR;
-			}
-		} //end for each log files
-		n_log_files_found = i;
-	}
 	
 	// (2) Create the log_space and add it to fil_system_t's hashtable
 	fil_space_t*	log_space = fil_space_create(
@@ -3395,53 +3493,103 @@ pm_create_or_open_part_log_files(
 
 	UT_LIST_INIT(ppl->log_space->chain, &fil_node_t::chain);
 
-	// (3) Create the fil_nodes	
-	
-	for (i = 0; i < n_log_files_found; i++) {
-		sprintf(logfilename + dirnamelen, "pl_logfile%zu", i);
-		fil_node_t* node;
-		node = pm_log_fil_node_create(
-				logfilename,
-				srv_ppl_log_file_size,
-				ppl->log_space);
-
-		//save the fil_node 
-		//ppl->node_arr[i] = node;	
-
-		ppl->node_arr[i]->space = ppl->log_space;
-		//update file handle
-		//if (ppl->node_arr[i]->handle.m_file != ppl->log_files[i].m_file) {
-		//	ppl->log_files[i].m_file = ppl->node_arr[i]->handle.m_file;
-		//}
-		ppl->node_arr[i]->handle = ppl->log_files[i];
-		ppl->node_arr[i]->is_open = false;
-
-		ppl->node_arr[i]->name =  mem_strdup(node->name);
-		ppl->node_arr[i]->sync_event = os_event_create("fsync_event");
-		ppl->node_arr[i]->is_raw_disk = false;
-
-		ppl->node_arr[i]->size = node->size;
-		ppl->node_arr[i]->magic_n = FIL_NODE_MAGIC_N;
-		ppl->node_arr[i]->max_size = node->max_size;
-
-	}
-	
-	//(4) Create log group for each bucket
+	// (3) The fil_nodes and the log groups are set up on first use
 	ppl->log_groups = static_cast<PMEM_LOG_GROUP**>(
 			ut_zalloc_nokey(sizeof(PMEM_LOG_GROUP*) * ppl->n_buckets));
 
-	for (i = 0; i < ppl->n_buckets; i++){
-		ppl->log_groups[i] = pm_log_group_init(
-				i, 
-				ppl->n_log_files_per_bucket,
-				srv_ppl_log_file_size * UNIV_PAGE_SIZE,
-				PMEM_LOG_SPACE_FIRST_ID);
+	return (DB_SUCCESS);
+}
+
+/*
+ * Get the log group of a line, open its log file on the first call
+ * Opening thousands of files and allocating their groups at startup is a
+ * large part of the restart time, most lines are only touched much later
+ * @param[in] pop
+ * @param[in] ppl
+ * @param[in] hashed_id	the line
+ * @return the log group, node_arr[hashed_id] is set up and open
+ * */
+PMEM_LOG_GROUP*
+pm_ppl_get_log_group(
+		PMEMobjpool*		pop,
+		PMEM_PAGE_PART_LOG*	ppl,
+		uint64_t			hashed_id)
+{
+	PMEM_LOG_GROUP*	group;
+	fil_node_t*		node;
+	fil_node_t*		pnode;
+	os_offset_t		size;
+	bool			success;
+	char			logfilename[OS_FILE_MAX_PATH];
+
+	group = ppl->log_groups[hashed_id];
+	if (group != NULL) {
+		os_rmb;
+		return group;
 	}
-	
-	//(5) open and keep pmem log files opened until shutdown
-	//fil_open_log_and_system_tablespace_files();
 
-	return (DB_SUCCESS);
+	pmemobj_rwlock_wrlock(pop, &ppl->log_open_lock);
+
+	group = ppl->log_groups[hashed_id];
+	if (group != NULL) {
+		pmemobj_rwlock_unlock(pop, &ppl->log_open_lock);
+		return group;
+	}
+
+	snprintf(logfilename, sizeof(logfilename), "%spl_logfile%zu",
+			ppl->log_dir, hashed_id);
+
+	/*adds the node to the log_space chain*/
+	node = pm_log_fil_node_create(
+			logfilename,
+			srv_ppl_log_file_size,
+			ppl->log_space);
+
+	pnode = ppl->node_arr[hashed_id];
+	pnode->space = ppl->log_space;
+	pnode->name = mem_strdup(node->name);
+	pnode->sync_event = os_event_create("fsync_event");
+	pnode->is_raw_disk = false;
+	pnode->size = node->size;
+	pnode->magic_n = FIL_NODE_MAGIC_N;
+	pnode->max_size = node->max_size;
+
+	pnode->handle = os_file_create(
+			innodb_log_file_key, pnode->name, OS_FILE_OPEN,
+			OS_FILE_AIO, OS_LOG_FILE, false, &success);
+	if (!success) {
+		ib::error() << "Cannot open part-log file " << pnode->name;
+		assert(0);
+	}
+	pnode->is_open = true;
+
+	size = os_file_get_size(pnode->handle);
+	ut_a(size != (os_offset_t) -1);
+	if (size & ((1 << UNIV_PAGE_SIZE_SHIFT) - 1)) {
+		ib::error() << "Log file " << pnode->name
+			<< " size " << size << " is not a"
+			" multiple of innodb_page_size";
+		assert(0);
+	}
+
+	group = pm_log_group_init(
+			hashed_id,
+			ppl->n_log_files_per_bucket,
+			srv_ppl_log_file_size * UNIV_PAGE_SIZE,
+			PMEM_LOG_SPACE_FIRST_ID);
+
+	/*the file may have been extended in the last run*/
+	if (size > group->file_size) {
+		group->file_size = size;
+	}
+
+	/*the node must be visible before the group*/
+	os_wmb;
+	ppl->log_groups[hashed_id] = group;
+
+	pmemobj_rwlock_unlock(pop, &ppl->log_open_lock);
+
+	return group;
 }
 
 /*
@@ -3511,9 +3659,12 @@ pm_close_and_free_log_files(
 		}
 		node->space = NULL;
 
-		os_event_destroy(node->sync_event);
-		ut_free(node->name);
-		node->name = NULL;
+		/*the line had no log IO in this run*/
+		if (node->name != NULL) {
+			os_event_destroy(node->sync_event);
+			ut_free(node->name);
+			node->name = NULL;
+		}
 		node->handle.m_psi = NULL;
 
 		free(ppl->node_arr[i]);
@@ -3523,10 +3674,14 @@ pm_close_and_free_log_files(
 	//space
 	ut_free(ppl->log_space->name);
 	free (ppl->log_space);
+	ut_free(ppl->log_dir);
+	ppl->log_dir = NULL;
 	
 	//group
 	for (i = 0; i < n; i++){
-		pm_log_group_free(ppl->log_groups[i]);
+		if (ppl->log_groups[i] != NULL) {
+			pm_log_group_free(ppl->log_groups[i]);
+		}
 	}
 	ut_free(ppl->log_groups);
 }
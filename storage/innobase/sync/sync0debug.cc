@@ -488,11 +488,14 @@ LatchDebug::LatchDebug()
 	LEVEL_MAP_INSERT(SYNC_LOG_WRITE);
 	LEVEL_MAP_INSERT(SYNC_PAGE_CLEANER);
 	LEVEL_MAP_INSERT(SYNC_PURGE_QUEUE);
+	LEVEL_MAP_INSERT(SYNC_TRX_SYS_CSN);
+	LEVEL_MAP_INSERT(SYNC_MVCC);
 	LEVEL_MAP_INSERT(SYNC_TRX_SYS_HEADER);
 	LEVEL_MAP_INSERT(SYNC_REC_LOCK);
 	LEVEL_MAP_INSERT(SYNC_THREADS);
 	LEVEL_MAP_INSERT(SYNC_TRX);
 	LEVEL_MAP_INSERT(SYNC_TRX_SYS);
+	LEVEL_MAP_INSERT(SYNC_LOCK_SYS_SHARD);
 	LEVEL_MAP_INSERT(SYNC_LOCK_SYS);
 	LEVEL_MAP_INSERT(SYNC_LOCK_WAIT_SYS);
 	LEVEL_MAP_INSERT(SYNC_INDEX_ONLINE_LOG);
@@ -776,6 +779,8 @@ LatchDebug::check_order(
 	case SYNC_LOCK_SYS:
 	case SYNC_LOCK_WAIT_SYS:
 	case SYNC_TRX_SYS:
+	case SYNC_TRX_SYS_CSN:
+	case SYNC_MVCC:
 	case SYNC_IBUF_BITMAP_MUTEX:
 	case SYNC_REDO_RSEG:
 	case SYNC_NOREDO_RSEG:
@@ -832,6 +837,16 @@ LatchDebug::check_order(
 		}
 		break;
 
+	case SYNC_LOCK_SYS_SHARD:
+
+		/* lock_sys_x_enter() latches every shard after the
+		lock_sys->mutex, a page operation the shards of two pages
+		in the order of their addresses. The shards are taken
+		before any trx_t::mutex or the trx_sys->mutex. */
+
+		basic_check(latches, level, level - 1);
+		break;
+
 	case SYNC_BUF_FLUSH_LIST:
 	case SYNC_BUF_POOL:
 
@@ -1475,8 +1490,15 @@ sync_latch_meta_init()
 
 	LATCH_ADD_MUTEX(BUF_DBLWR, SYNC_DOUBLEWRITE, buf_dblwr_mutex_key);
 
+	LATCH_ADD_MUTEX(BUF_WARM, SYNC_NO_ORDER_CHECK, buf_warm_mutex_key);
+
+	LATCH_ADD_MUTEX(BUF_VCACHE, SYNC_NO_ORDER_CHECK, buf_vcache_mutex_key);
+
 	LATCH_ADD_MUTEX(TRX_UNDO, SYNC_TRX_UNDO, trx_undo_mutex_key);
 
+	LATCH_ADD_MUTEX(TRX_UNDO_NVM, SYNC_NO_ORDER_CHECK,
+			trx_undo_nvm_mutex_key);
+
 	LATCH_ADD_MUTEX(TRX_POOL, SYNC_POOL, trx_pool_mutex_key);
 
 	LATCH_ADD_MUTEX(TRX_POOL_MANAGER, SYNC_POOL_MANAGER,
@@ -1489,8 +1511,15 @@ sync_latch_meta_init()
 	LATCH_ADD_MUTEX(LOCK_SYS_WAIT, SYNC_LOCK_WAIT_SYS,
 			lock_wait_mutex_key);
 
+	LATCH_ADD_MUTEX(LOCK_SYS_SHARD, SYNC_LOCK_SYS_SHARD,
+			lock_sys_shard_mutex_key);
+
 	LATCH_ADD_MUTEX(TRX_SYS, SYNC_TRX_SYS, trx_sys_mutex_key);
 
+	LATCH_ADD_MUTEX(TRX_SYS_CSN, SYNC_TRX_SYS_CSN, trx_sys_csn_mutex_key);
+
+	LATCH_ADD_MUTEX(MVCC, SYNC_MVCC, mvcc_mutex_key);
+
 	LATCH_ADD_MUTEX(SRV_SYS, SYNC_THREADS, srv_sys_mutex_key);
 
 	LATCH_ADD_MUTEX(SRV_SYS_TASKS, SYNC_ANY_LATCH, srv_threads_mutex_key);
@@ -99,13 +99,19 @@ mysql_pfs_key_t	srv_monitor_file_mutex_key;
 mysql_pfs_key_t	sync_thread_mutex_key;
 # endif /* UNIV_DEBUG */
 mysql_pfs_key_t	buf_dblwr_mutex_key;
+mysql_pfs_key_t	buf_warm_mutex_key;
+mysql_pfs_key_t	buf_vcache_mutex_key;
 mysql_pfs_key_t	trx_undo_mutex_key;
+mysql_pfs_key_t	trx_undo_nvm_mutex_key;
 mysql_pfs_key_t	trx_mutex_key;
 mysql_pfs_key_t	trx_pool_mutex_key;
 mysql_pfs_key_t	trx_pool_manager_mutex_key;
 mysql_pfs_key_t	lock_mutex_key;
 mysql_pfs_key_t	lock_wait_mutex_key;
+mysql_pfs_key_t	lock_sys_shard_mutex_key;
 mysql_pfs_key_t	trx_sys_mutex_key;
+mysql_pfs_key_t	trx_sys_csn_mutex_key;
+mysql_pfs_key_t	mvcc_mutex_key;
 mysql_pfs_key_t	srv_sys_mutex_key;
 mysql_pfs_key_t	srv_threads_mutex_key;
 #  ifndef PFS_SKIP_EVENT_MUTEX
@@ -139,6 +145,13 @@ mysql_pfs_key_t	fts_cache_rw_lock_key;
 mysql_pfs_key_t	fts_cache_init_rw_lock_key;
 mysql_pfs_key_t trx_i_s_cache_lock_key;
 mysql_pfs_key_t	trx_purge_latch_key;
+#if defined (UNIV_PMEMOBJ_PART_PL)
+mysql_pfs_key_t	pm_ppl_line_lock_key;
+mysql_pfs_key_t	pm_ppl_line_meta_lock_key;
+mysql_pfs_key_t	pm_ppl_free_pool_lock_key;
+mysql_pfs_key_t	pm_ppl_ckpt_lock_key;
+mysql_pfs_key_t	pm_ppl_tt_entry_lock_key;
+#endif
 #endif /* UNIV_PFS_RWLOCK */
 
 /* There are mutexes/rwlocks that we want to exclude from instrumentation
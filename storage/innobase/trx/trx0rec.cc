@@ -1924,6 +1924,14 @@ trx_undo_report_row_operation(
 	are not restored on restart. */
 	mtr_start(&mtr);
 	dict_disable_redo_if_temporary(index->table, &mtr);
+#if defined (UNIV_PMEMOBJ_UNDO)
+	/* Append the undo record to the current undo page without redo
+	log, the page image is persisted on NVM at mtr commit. Adding an undo
+	page below still writes redo log. */
+	if (!is_temp_table) {
+		trx_undo_nvm_mtr_start(&mtr);
+	}
+#endif /* UNIV_PMEMOBJ_UNDO */
 	mutex_enter(&trx->undo_mutex);
 
 #if defined (UNIV_PMEMOBJ_PART_PL)  && defined(UNIV_PMEMOBJ_USE_TT)
@@ -2058,6 +2066,19 @@ trx_undo_report_row_operation(
 
 			mutex_exit(&trx->undo_mutex);
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+			/* The undo log is logged in log_sys, the change of
+			the clustered index record that follows is logged in
+			PPL and is persistent as soon as it is written. The
+			caller makes the PPL records depend on this lsn, so
+			that a crash in between does not leave the record
+			without its undo log record, see
+			btr_cur_ins_lock_and_undo(). */
+			if (mtr.commit_lsn() > trx->hybrid_classic_lsn) {
+				trx->hybrid_classic_lsn = mtr.commit_lsn();
+			}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 			*roll_ptr = trx_undo_build_roll_ptr(
 				op_type == TRX_UNDO_INSERT_OP,
 				undo_ptr->rseg->id, page_no, offset);
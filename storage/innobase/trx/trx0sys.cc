@@ -451,6 +451,212 @@ trx_sysf_create(
 	ut_a(page_no == FSP_FIRST_RSEG_PAGE_NO);
 }
 
+#if defined (UNIV_MVCC_CSN)
+/** Compare the ids of two overflow entries */
+static
+bool
+trx_csn_overflow_less(
+	const trx_csn_overflow_t&	a,
+	const trx_csn_overflow_t&	b)
+{
+	return(a.id < b.id);
+}
+
+/*****************************************************************//**
+Registers a new read-write transaction id in the CSN map as active. The
+previous id of the slot is moved to trx_sys->csn_overflow if a view may
+still look it up. Caller must own trx_sys->mutex. */
+void
+trx_sys_csn_assign(
+/*===============*/
+	trx_id_t	id)	/*!< in: new read-write transaction id */
+{
+	trx_csn_slot_t*	slot = &trx_sys->csn_map[id & trx_sys->csn_map_mask];
+	trx_id_t	old_id = slot->id;
+	trx_id_t	old_csn = slot->csn;
+
+	ut_ad(trx_sys_mutex_own());
+	ut_ad(old_id < id);
+
+	/* An active id is always kept, a committed one only if a view
+	can still miss it: ids below csn_drop_id are below every
+	m_up_limit_id and CSNs up to csn_drop_csn are seen by all. A long
+	running transaction pins both limits, the slots of the ids that
+	commit meanwhile go to the overflow list. */
+	if (old_id != 0
+	    && old_id >= trx_sys->csn_drop_id
+	    && (old_csn == TRX_CSN_ACTIVE
+		|| old_csn > trx_sys->csn_drop_csn)) {
+
+		trx_csn_overflow_t	elem;
+
+		elem.id = old_id;
+		elem.csn = old_csn;
+
+		mutex_enter(&trx_sys->csn_overflow_mutex);
+
+		trx_csn_overflow_list_t::iterator	it = std::upper_bound(
+			trx_sys->csn_overflow.begin(),
+			trx_sys->csn_overflow.end(),
+			elem, trx_csn_overflow_less);
+
+		trx_sys->csn_overflow.insert(it, elem);
+
+		mutex_exit(&trx_sys->csn_overflow_mutex);
+	}
+
+	slot->id = TRX_ID_MAX;
+	os_wmb;
+	slot->csn = TRX_CSN_ACTIVE;
+	os_wmb;
+	slot->id = id;
+}
+
+/*****************************************************************//**
+Gives the next commit sequence number to a transaction and publishes
+it, the views opened from now on see the transaction. Caller must own
+trx_sys->mutex. */
+void
+trx_sys_csn_commit(
+/*===============*/
+	trx_id_t	id)	/*!< in: transaction id */
+{
+	trx_csn_slot_t*	slot = &trx_sys->csn_map[id & trx_sys->csn_map_mask];
+	trx_id_t	csn = trx_sys->csn + 1;
+
+	ut_ad(trx_sys_mutex_own());
+
+	if (slot->id == id) {
+		slot->csn = csn;
+	} else {
+		trx_csn_overflow_t	elem;
+
+		elem.id = id;
+
+		mutex_enter(&trx_sys->csn_overflow_mutex);
+
+		trx_csn_overflow_list_t::iterator	it = std::lower_bound(
+			trx_sys->csn_overflow.begin(),
+			trx_sys->csn_overflow.end(),
+			elem, trx_csn_overflow_less);
+
+		ut_a(it != trx_sys->csn_overflow.end() && it->id == id);
+
+		it->csn = csn;
+
+		mutex_exit(&trx_sys->csn_overflow_mutex);
+	}
+
+	/* A view that reads the new CSN must find it in the map */
+	os_wmb;
+	trx_sys->csn = csn;
+}
+
+/*****************************************************************//**
+Recomputes trx_sys->csn_up_limit_id and trx_sys->csn_low_limit_no after
+rw_trx_ids or the serialisation_list changed. Caller must own
+trx_sys->mutex. */
+void
+trx_sys_csn_set_limits(void)
+/*========================*/
+{
+	ut_ad(trx_sys_mutex_own());
+
+	const trx_t*	trx = UT_LIST_GET_FIRST(trx_sys->serialisation_list);
+
+	trx_sys->csn_low_limit_no = (trx != NULL) ? trx->no : TRX_ID_MAX;
+
+	trx_sys->csn_up_limit_id = trx_sys->rw_trx_ids.empty()
+		? trx_sys->max_trx_id : trx_sys->rw_trx_ids.front();
+}
+
+/*****************************************************************//**
+Looks up a transaction id whose slot of the CSN map is reused.
+@return CSN, TRX_CSN_ACTIVE if not committed, 0 if committed before
+any open view */
+trx_id_t
+trx_sys_csn_get_overflow(
+/*=====================*/
+	trx_id_t	id)	/*!< in: transaction id */
+{
+	trx_csn_overflow_t	elem;
+	trx_id_t		csn = 0;
+
+	elem.id = id;
+
+	mutex_enter(&trx_sys->csn_overflow_mutex);
+
+	trx_csn_overflow_list_t::const_iterator	it = std::lower_bound(
+		trx_sys->csn_overflow.begin(), trx_sys->csn_overflow.end(),
+		elem, trx_csn_overflow_less);
+
+	if (it != trx_sys->csn_overflow.end() && it->id == id) {
+		csn = it->csn;
+	}
+
+	mutex_exit(&trx_sys->csn_overflow_mutex);
+
+	return(csn);
+}
+
+/*****************************************************************//**
+Sets the limits below which no view looks up a transaction id: an id
+smaller than drop_id or committed with a CSN not greater than drop_csn
+is visible to every open and future view. The overflow entries below
+them are freed. */
+void
+trx_sys_csn_set_drop_limits(
+/*========================*/
+	trx_id_t	drop_id,	/*!< in: smallest m_up_limit_id of
+					the views */
+	trx_id_t	drop_csn)	/*!< in: smallest CSN of the views */
+{
+	ut_ad(!trx_sys_mutex_own());
+
+	/* trx_sys_csn_assign() reads the two limits as a pair under
+	trx_sys->mutex, they are changed under it only */
+	trx_sys_mutex_enter();
+
+	if (drop_id > trx_sys->csn_drop_id) {
+		trx_sys->csn_drop_id = drop_id;
+	}
+
+	if (drop_csn > trx_sys->csn_drop_csn) {
+		trx_sys->csn_drop_csn = drop_csn;
+	}
+
+	drop_id = trx_sys->csn_drop_id;
+	drop_csn = trx_sys->csn_drop_csn;
+
+	trx_sys_mutex_exit();
+
+	if (trx_sys->csn_overflow.empty()) {
+		return;
+	}
+
+	mutex_enter(&trx_sys->csn_overflow_mutex);
+
+	trx_csn_overflow_list_t::iterator	to = trx_sys->csn_overflow.begin();
+
+	for (trx_csn_overflow_list_t::iterator it = to;
+	     it != trx_sys->csn_overflow.end();
+	     ++it) {
+
+		if (it->id < drop_id
+		    || (it->csn != TRX_CSN_ACTIVE && it->csn <= drop_csn)) {
+
+			continue;
+		}
+
+		*to++ = *it;
+	}
+
+	trx_sys->csn_overflow.erase(to, trx_sys->csn_overflow.end());
+
+	mutex_exit(&trx_sys->csn_overflow_mutex);
+}
+#endif /* UNIV_MVCC_CSN */
+
 /*****************************************************************//**
 Creates and initializes the central memory structures for the transaction
 system. This is called when the database is started.
@@ -507,6 +713,21 @@ trx_sys_init_at_db_start(void)
 
 	trx_sys_mutex_enter();
 
+#if defined (UNIV_MVCC_CSN)
+	/* The recovered ACTIVE and PREPARED transactions are the only ids
+	below max_trx_id that are not committed */
+	for (trx_ids_t::const_iterator it = trx_sys->rw_trx_ids.begin();
+	     it != trx_sys->rw_trx_ids.end();
+	     ++it) {
+
+		trx_sys_csn_assign(*it);
+	}
+
+	trx_sys->csn_start_id = trx_sys->max_trx_id;
+
+	trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 	if (UT_LIST_GET_LEN(trx_sys->rw_trx_list) > 0) {
 		const trx_t*	trx;
 
@@ -562,6 +783,24 @@ trx_sys_create(void)
 			mem_key_trx_sys_t_rw_trx_ids));
 
 	new(&trx_sys->rw_trx_set) TrxIdSet();
+
+#if defined (UNIV_MVCC_CSN)
+	ulint	n_slots = 1;
+
+	while (n_slots < srv_mvcc_csn_slots) {
+		n_slots <<= 1;
+	}
+
+	trx_sys->csn_map = static_cast<trx_csn_slot_t*>(
+		ut_zalloc_nokey(n_slots * sizeof(*trx_sys->csn_map)));
+	trx_sys->csn_map_mask = n_slots - 1;
+
+	trx_sys->csn_low_limit_no = TRX_ID_MAX;
+
+	mutex_create(LATCH_ID_TRX_SYS_CSN, &trx_sys->csn_overflow_mutex);
+
+	new(&trx_sys->csn_overflow) trx_csn_overflow_list_t();
+#endif /* UNIV_MVCC_CSN */
 }
 
 /*****************************************************************//**
@@ -1234,6 +1473,14 @@ trx_sys_close(void)
 
 	trx_sys->rw_trx_set.~TrxIdSet();
 
+#if defined (UNIV_MVCC_CSN)
+	mutex_free(&trx_sys->csn_overflow_mutex);
+
+	trx_sys->csn_overflow.~trx_csn_overflow_list_t();
+
+	ut_free(trx_sys->csn_map);
+#endif /* UNIV_MVCC_CSN */
+
 	ut_free(trx_sys);
 
 	trx_sys = NULL;
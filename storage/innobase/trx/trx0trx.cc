@@ -134,6 +134,9 @@ trx_init(
 	//trx->pm_log_block_id = -1;
 #endif
 	trx->no = TRX_ID_MAX;
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	trx->hybrid_classic_lsn = 0;
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
 
 	trx->is_recovered = false;
 
@@ -1313,6 +1316,11 @@ trx_assign_rseg(
 
 		trx_sys->rw_trx_ids.push_back(trx->id);
 
+#if defined (UNIV_MVCC_CSN)
+		trx_sys_csn_assign(trx->id);
+		trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 		trx_sys->rw_trx_set.insert(TrxTrack(trx->id, trx));
 
 		mutex_exit(&trx_sys->mutex);
@@ -1412,6 +1420,11 @@ trx_start_low(
 
 		trx_sys->rw_trx_ids.push_back(trx->id);
 
+#if defined (UNIV_MVCC_CSN)
+		trx_sys_csn_assign(trx->id);
+		trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 		trx_sys_rw_trx_add(trx);
 
 		ut_ad(trx->rsegs.m_redo.rseg != 0
@@ -1452,6 +1465,11 @@ trx_start_low(
 
 				trx_sys->rw_trx_ids.push_back(trx->id);
 
+#if defined (UNIV_MVCC_CSN)
+				trx_sys_csn_assign(trx->id);
+				trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 				trx_sys->rw_trx_set.insert(
 					TrxTrack(trx->id, trx));
 
@@ -1508,6 +1526,17 @@ trx_serialisation_number_get(
 
 	trx_sys_mutex_enter();
 
+#if defined (UNIV_MVCC_CSN)
+	/* A view that reads the new max_trx_id without the mutex must
+	then read a csn_low_limit_no not above trx->no */
+	if (!trx->read_only
+	    && UT_LIST_GET_LEN(trx_sys->serialisation_list) == 0) {
+
+		trx_sys->csn_low_limit_no = trx_sys->max_trx_id;
+		os_wmb;
+	}
+#endif /* UNIV_MVCC_CSN */
+
 	trx->no = trx_sys_get_new_trx_id();
 
 	/* Track the minimum serialisation number. */
@@ -1876,6 +1905,12 @@ trx_erase_lists(
 	ut_ad(trx->id > 0);
 	trx_sys_mutex_enter();
 
+#if defined (UNIV_MVCC_CSN)
+	/* The CSN takes the place of the removal from rw_trx_ids, it
+	must be published before the limits below move past trx */
+	trx_sys_csn_commit(trx->id);
+#endif /* UNIV_MVCC_CSN */
+
 	if (serialised) {
 		UT_LIST_REMOVE(trx_sys->serialisation_list, trx);
 	}
@@ -1887,6 +1922,11 @@ trx_erase_lists(
 	ut_ad(*it == trx->id);
 	trx_sys->rw_trx_ids.erase(it);
 
+#if defined (UNIV_MVCC_CSN)
+	os_wmb;
+	trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 	if (trx->read_only || trx->rsegs.m_redo.rseg == NULL) {
 
 		ut_ad(!trx->in_rw_trx_list);
@@ -2183,6 +2223,17 @@ trx_commit_low(
 	}
 #endif
 
+#if defined (UNIV_PMEMOBJ_TX_LOG)
+	/* The commit mtr may have chained a new log block, close the
+	blocks here, trx_commit_in_memory() resets the trx */
+	if (srv_ppl_log_mode == PMEM_LOG_MODE_TX
+	    && trx->pm_log_block_id != 0) {
+		pm_ptxl_commit(gb_pmw->pop, gb_pmw->ptxl,
+			       trx->id, trx->pm_log_block_id);
+		trx->pm_log_block_id = 0;
+	}
+#endif /* UNIV_PMEMOBJ_TX_LOG */
+
 	trx_commit_in_memory(trx, mtr, serialised);
 }
 
@@ -3245,6 +3296,11 @@ trx_set_rw_mode(
 
 	trx_sys->rw_trx_ids.push_back(trx->id);
 
+#if defined (UNIV_MVCC_CSN)
+	trx_sys_csn_assign(trx->id);
+	trx_sys_csn_set_limits();
+#endif /* UNIV_MVCC_CSN */
+
 	trx_sys->rw_trx_set.insert(TrxTrack(trx->id, trx));
 
 	/* So that we can see our own changes. */
@@ -43,6 +43,17 @@ Created 3/26/1996 Heikki Tuuri
 #include "trx0rseg.h"
 #include "trx0trx.h"
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+#include "buf0flu.h"
+#include "fil0fil.h"
+#include "my_pmemobj.h"
+
+#include <map>
+#include <vector>
+
+extern PMEM_WRAPPER* gb_pmw;
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 /* How should the old versions in the history list be managed?
    ----------------------------------------------------------
 If each transaction is given a whole page for its update undo log, file
@@ -1886,6 +1897,14 @@ func_exit:
 	mutex_exit(&(rseg->mutex));
 	mtr_commit(&mtr);
 
+#if defined (UNIV_PMEMOBJ_PPL_HYBRID)
+	/* The undo log header is logged in log_sys, see
+	trx_undo_report_row_operation() */
+	if (mtr.commit_lsn() > trx->hybrid_classic_lsn) {
+		trx->hybrid_classic_lsn = mtr.commit_lsn();
+	}
+#endif /* UNIV_PMEMOBJ_PPL_HYBRID */
+
 	return(err);
 }
 
@@ -2235,4 +2254,417 @@ trx_undo_truncate_tablespace(
 	return(success);
 }
 
+#if defined (UNIV_PMEMOBJ_UNDO)
+/* Undo pages on NVM
+=================
+The mini-transaction that appends a record to the current undo page of a
+persistent table generates no redo log. At its commit, while the page is
+still X-latched, the whole page image is persisted on an NVM slot together
+with the end lsn of the mini-transaction. A page has at most one valid slot
+outside of the window where its newer image is being written, a sequence
+number orders images written at the same lsn.
+
+The page stays in the buffer pool and is flushed as usual, so purge and
+rollback read the undo records through the buffer pool. A slot is freed once
+the page was written and synced at or after its lsn, that is when its lsn is
+older than the previous checkpoint. At startup the newest image of each page
+is written back to the datafile before the redo log is applied, the redo log
+generated after the image is applied on top of it.
+
+The mini-transactions that allocate or free undo pages keep the redo log,
+and so does any undo write when no slot is free. */
+
+/** Map from a page to the NVM slot that holds its newest image */
+typedef std::map<
+	ib_uint64_t,
+	ulint,
+	std::less<ib_uint64_t>,
+	ut_allocator<std::pair<const ib_uint64_t, ulint> > >	undo_nvm_map_t;
+
+/** Stack of free NVM slots */
+typedef std::vector<ulint, ut_allocator<ulint> >	undo_nvm_slots_t;
+
+/** Newest NVM image of an undo page, listed at startup */
+struct undo_nvm_image_t {
+	ulint		space;		/*!< tablespace id */
+	ulint		page_no;	/*!< page number */
+	lsn_t		lsn;		/*!< lsn of the image */
+	ulint		slot;		/*!< NVM slot of the image */
+};
+
+/** Images to write back before the redo log is applied */
+typedef std::vector<undo_nvm_image_t, ut_allocator<undo_nvm_image_t> >
+	undo_nvm_images_t;
+
+/** DRAM bookkeeping of the NVM undo page area */
+struct trx_undo_nvm_t {
+	/** protects the fields below and the slot states */
+	ib_mutex_t		mutex;
+	/** slots that are neither reserved nor valid */
+	undo_nvm_slots_t	free_slots;
+	/** valid slot of each page */
+	undo_nvm_map_t		pages;
+	/** lsn of the image on each valid slot */
+	lsn_t*			slot_lsn;
+	/** sequence number of the next image */
+	ib_uint64_t		seq;
+	/** images listed by trx_undo_nvm_recover_snapshot() */
+	undo_nvm_images_t	images;
+};
+
+/** The NVM undo page area */
+static trx_undo_nvm_t*	trx_undo_nvm = NULL;
+
+/** @return the key of a page in trx_undo_nvm_t::pages */
+UNIV_INLINE
+ib_uint64_t
+trx_undo_nvm_key(
+	ulint	space,
+	ulint	page_no)
+{
+	return((ib_uint64_t(space) << 32) | page_no);
+}
+
+/** Opens or allocates the NVM undo page area and builds its DRAM
+bookkeeping. Called at startup before the redo log is scanned. */
+void
+trx_undo_nvm_init(void)
+{
+	PMEM_UNDO*	pundo;
+
+	if (pm_wrapper_undo_alloc_or_open(
+			gb_pmw, srv_pmem_undo_slots, UNIV_PAGE_SIZE)
+	    == PMEM_ERROR) {
+		ib::fatal() << "Cannot allocate the undo page area on PMEM";
+	}
+
+	pundo = gb_pmw->pundo;
+	ut_a(pundo->slot_size == UNIV_PAGE_SIZE);
+
+	trx_undo_nvm = UT_NEW_NOKEY(trx_undo_nvm_t());
+
+	mutex_create(LATCH_ID_TRX_UNDO_NVM, &trx_undo_nvm->mutex);
+
+	trx_undo_nvm->slot_lsn = static_cast<lsn_t*>(
+		ut_zalloc_nokey(pundo->n_slots * sizeof(lsn_t)));
+	trx_undo_nvm->seq = 0;
+
+	/* The valid slots of the previous run are kept until
+	trx_undo_nvm_recover() has written them back. */
+	for (ulint i = 0; i < pundo->n_slots; i++) {
+		const PMEM_UNDO_SLOT_HDR*	hdr
+			= pm_undo_get_slot_hdr(pundo, i);
+
+		if (hdr->state == PMEM_UNDO_SLOT_VALID) {
+			trx_undo_nvm->seq = ut_max(
+				trx_undo_nvm->seq, hdr->seq + 1);
+		} else {
+			trx_undo_nvm->free_slots.push_back(i);
+		}
+	}
+
+	ib::info() << "Undo pages on PMEM: " << pundo->n_slots << " slots, "
+		<< pundo->n_slots - trx_undo_nvm->free_slots.size()
+		<< " to recover";
+}
+
+/** Frees the DRAM bookkeeping of the NVM undo page area. */
+void
+trx_undo_nvm_free(void)
+{
+	if (trx_undo_nvm == NULL) {
+		return;
+	}
+
+	mutex_free(&trx_undo_nvm->mutex);
+	ut_free(trx_undo_nvm->slot_lsn);
+
+	UT_DELETE(trx_undo_nvm);
+	trx_undo_nvm = NULL;
+}
+
+/** Reserves an NVM slot for the undo page that a mini-transaction is
+about to modify. On success the mini-transaction generates no redo log and
+the page image is persisted on the slot at commit.
+@param[in,out]	mtr	mini-transaction, just started
+@return true if a slot was reserved, false if the redo log must be used */
+bool
+trx_undo_nvm_mtr_start(
+	mtr_t*	mtr)
+{
+	ulint	slot;
+
+	ut_ad(mtr->get_log_mode() == MTR_LOG_ALL);
+
+	if (trx_undo_nvm == NULL) {
+		return(false);
+	}
+
+	mutex_enter(&trx_undo_nvm->mutex);
+
+	if (trx_undo_nvm->free_slots.empty()) {
+		mutex_exit(&trx_undo_nvm->mutex);
+		return(false);
+	}
+
+	slot = trx_undo_nvm->free_slots.back();
+	trx_undo_nvm->free_slots.pop_back();
+
+	mutex_exit(&trx_undo_nvm->mutex);
+
+	mtr->set_log_mode(MTR_LOG_NO_REDO);
+	mtr->set_undo_nvm_slot(slot);
+
+	return(true);
+}
+
+/** Returns an NVM slot that was reserved but not written.
+@param[in]	slot	slot returned by the reservation */
+void
+trx_undo_nvm_release(
+	ulint	slot)
+{
+	mutex_enter(&trx_undo_nvm->mutex);
+	trx_undo_nvm->free_slots.push_back(slot);
+	mutex_exit(&trx_undo_nvm->mutex);
+}
+
+/** Persists the image of an undo page on its reserved NVM slot, the older
+image of the same page is freed once the new one is valid. Called at
+mini-transaction commit while the page is still X-latched.
+@param[in]	slot	reserved slot
+@param[in]	block	modified undo page
+@param[in]	lsn	end lsn of the mini-transaction */
+void
+trx_undo_nvm_write(
+	ulint			slot,
+	const buf_block_t*	block,
+	lsn_t			lsn)
+{
+	PMEM_UNDO*		pundo = gb_pmw->pundo;
+	const page_id_t&	page_id = block->page.id;
+	const ib_uint64_t	key = trx_undo_nvm_key(
+		page_id.space(), page_id.page_no());
+	ib_uint64_t		seq;
+
+	ut_ad(block->page.size.equals_to(univ_page_size));
+
+	mutex_enter(&trx_undo_nvm->mutex);
+	seq = trx_undo_nvm->seq++;
+	mutex_exit(&trx_undo_nvm->mutex);
+
+	/* The X-latch on the page orders the images of the page, the copy
+	is done outside of the mutex. */
+	pm_undo_write_slot(gb_pmw->pop, pundo, slot, block->frame,
+			   page_id.space(), page_id.page_no(), lsn, seq);
+
+	mutex_enter(&trx_undo_nvm->mutex);
+
+	trx_undo_nvm->slot_lsn[slot] = lsn;
+
+	undo_nvm_map_t::iterator	it = trx_undo_nvm->pages.find(key);
+
+	if (it != trx_undo_nvm->pages.end()) {
+		pm_undo_clear_slot(gb_pmw->pop, pundo, it->second);
+		trx_undo_nvm->free_slots.push_back(it->second);
+		it->second = slot;
+	} else {
+		trx_undo_nvm->pages.insert(std::make_pair(key, slot));
+	}
+
+	mutex_exit(&trx_undo_nvm->mutex);
+}
+
+/** Frees the NVM slots whose page images are older than an lsn all pages
+below which were written to the datafiles and synced.
+@param[in]	lsn	lsn of the previous checkpoint */
+void
+trx_undo_nvm_checkpoint(
+	lsn_t	lsn)
+{
+	if (trx_undo_nvm == NULL) {
+		return;
+	}
+
+	mutex_enter(&trx_undo_nvm->mutex);
+
+	for (undo_nvm_map_t::iterator it = trx_undo_nvm->pages.begin();
+	     it != trx_undo_nvm->pages.end();) {
+
+		if (trx_undo_nvm->slot_lsn[it->second] < lsn) {
+			pm_undo_clear_slot(gb_pmw->pop, gb_pmw->pundo,
+					   it->second);
+			trx_undo_nvm->free_slots.push_back(it->second);
+			trx_undo_nvm->pages.erase(it++);
+		} else {
+			++it;
+		}
+	}
+
+	mutex_exit(&trx_undo_nvm->mutex);
+}
+
+/** Lists the NVM slot of the newest image of each undo page. Called with
+log_sys->mutex held during the recovery, only the slot headers are read:
+trx_undo_nvm_recover() writes the images back one page at a time once the
+mutex is released. Nothing writes to the slots in between. */
+void
+trx_undo_nvm_recover_snapshot(void)
+{
+	PMEM_UNDO*	pundo = gb_pmw->pundo;
+	undo_nvm_map_t	newest;
+
+	ut_ad(trx_undo_nvm->images.empty());
+
+	if (srv_read_only_mode) {
+		return;
+	}
+
+	for (ulint i = 0; i < pundo->n_slots; i++) {
+		const PMEM_UNDO_SLOT_HDR*	hdr
+			= pm_undo_get_slot_hdr(pundo, i);
+
+		if (hdr->state != PMEM_UNDO_SLOT_VALID) {
+			continue;
+		}
+
+		const ib_uint64_t	key = trx_undo_nvm_key(
+			hdr->space, hdr->page_no);
+
+		undo_nvm_map_t::iterator	it = newest.find(key);
+
+		if (it == newest.end()) {
+			newest.insert(std::make_pair(key, i));
+			continue;
+		}
+
+		const PMEM_UNDO_SLOT_HDR*	other
+			= pm_undo_get_slot_hdr(pundo, it->second);
+
+		if (hdr->lsn > other->lsn
+		    || (hdr->lsn == other->lsn && hdr->seq > other->seq)) {
+			it->second = i;
+		}
+	}
+
+	trx_undo_nvm->images.reserve(newest.size());
+
+	for (undo_nvm_map_t::const_iterator it = newest.begin();
+	     it != newest.end(); ++it) {
+
+		const PMEM_UNDO_SLOT_HDR*	hdr
+			= pm_undo_get_slot_hdr(pundo, it->second);
+		undo_nvm_image_t		image;
+
+		image.space = hdr->space;
+		image.page_no = hdr->page_no;
+		image.lsn = hdr->lsn;
+		image.slot = it->second;
+
+		trx_undo_nvm->images.push_back(image);
+	}
+}
+
+/** Writes the images listed by trx_undo_nvm_recover_snapshot() back to the
+datafiles when the page on disk is older, then frees all slots. Called
+before the redo log is applied, the redo log after the images is applied
+on top. */
+void
+trx_undo_nvm_recover(void)
+{
+	PMEM_UNDO*	pundo = gb_pmw->pundo;
+	ulint		n_restored = 0;
+
+	ut_ad(!log_mutex_own());
+
+	if (srv_read_only_mode) {
+		return;
+	}
+
+	if (!trx_undo_nvm->images.empty()) {
+		byte*	unaligned_buf = static_cast<byte*>(
+			ut_malloc_nokey(2 * UNIV_PAGE_SIZE));
+		byte*	buf = static_cast<byte*>(
+			ut_align(unaligned_buf, UNIV_PAGE_SIZE));
+
+		for (undo_nvm_images_t::const_iterator it
+			     = trx_undo_nvm->images.begin();
+		     it != trx_undo_nvm->images.end(); ++it) {
+
+			const ulint		space_id = it->space;
+			const page_id_t		page_id(space_id, it->page_no);
+			const bool		skip_checksum
+				= fsp_is_checksum_disabled(space_id);
+
+			if (fil_space_get(space_id) == NULL
+			    || it->page_no >= fil_space_get_size(space_id)) {
+				/* The undo tablespace was truncated. */
+				continue;
+			}
+
+			memset(buf, 0x0, UNIV_PAGE_SIZE);
+
+			IORequest	read_request(IORequest::READ);
+
+			dberr_t	err = fil_io(read_request, true, page_id,
+					     univ_page_size, 0, UNIV_PAGE_SIZE,
+					     buf, NULL);
+
+			/* An image written at the lsn of the page on disk
+			may hold a later change made without redo log. */
+			if (err == DB_SUCCESS
+			    && !buf_page_is_corrupted(
+				    false, buf, univ_page_size, skip_checksum)
+			    && mach_read_from_8(buf + FIL_PAGE_LSN)
+			    > it->lsn) {
+				continue;
+			}
+
+			memcpy(buf, pm_undo_get_slot(pundo, it->slot),
+			       UNIV_PAGE_SIZE);
+
+			buf_flush_init_for_writing(
+				NULL, buf, NULL, it->lsn, skip_checksum);
+
+			IORequest	write_request(IORequest::WRITE);
+
+			write_request.disable_compression();
+
+			fil_io(write_request, true, page_id, univ_page_size,
+			       0, UNIV_PAGE_SIZE, buf, NULL);
+
+			n_restored++;
+		}
+
+		fil_flush_file_spaces(FIL_TYPE_TABLESPACE);
+
+		ut_free(unaligned_buf);
+
+		trx_undo_nvm->images.clear();
+	}
+
+	/* The datafiles are synced, no slot is needed anymore. */
+	mutex_enter(&trx_undo_nvm->mutex);
+
+	trx_undo_nvm->free_slots.clear();
+	trx_undo_nvm->pages.clear();
+
+	for (ulint i = 0; i < pundo->n_slots; i++) {
+		if (pm_undo_get_slot_hdr(pundo, i)->state
+		    == PMEM_UNDO_SLOT_VALID) {
+			pm_undo_clear_slot(gb_pmw->pop, pundo, i);
+		}
+
+		trx_undo_nvm->free_slots.push_back(i);
+	}
+
+	mutex_exit(&trx_undo_nvm->mutex);
+
+	if (n_restored > 0) {
+		ib::info() << "Restored " << n_restored
+			<< " undo pages from PMEM";
+	}
+}
+#endif /* UNIV_PMEMOBJ_UNDO */
+
 #endif /* !UNIV_HOTBACKUP */